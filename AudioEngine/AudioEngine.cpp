@@ -5,48 +5,391 @@
 
 #include "AudioEngine.h"
 
+#include "Source/Tools/Stopwatch.h"
+
 #include <FMOD/fmod_errors.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+
+namespace
+{
+    // FMOD caps the systems alive in a process, and creating or releasing them is not thread-safe,
+    // so engines initialized or terminated from different session threads take turns
+    std::mutex systemLifetimeMutex;
+    int liveInstances = 0;
+}
 
 AudioEngine::AudioEngine() 
     : sounds()
     , loopsPlaying()
+    , buses()
+    , duckingDetectors()
+    , duckers()
+    , busEffects()
+    , convolutionReverbs()
+    , loudnessMeters()
     , soundBanks()
     , eventDescriptions()
     , eventInstances() 
 {
 }
 
-void AudioEngine::Init() 
+void AudioEngine::Init(const AudioEngineSettings& settings) 
 {
-    ERRCHECK(FMOD::Studio::System::create(&studioSystem));
-    ERRCHECK(studioSystem->getCoreSystem(&lowLevelSystem));
-    ERRCHECK(lowLevelSystem->setSoftwareFormat(AUDIO_SAMPLE_RATE, FMOD_SPEAKERMODE_STEREO, 0));
+    if (ready)
+    {
+        std::cout << "Audio Engine: Already initialized!\n";
+        return;
+    }
+
+    Stopwatch stopwatch;
+    distanceCulling = settings.distanceCulling;
+    cullVolumeThreshold = settings.cullVolumeThreshold;
+    convolutionWorkerThread = settings.convolutionWorkerThread;
+    hrtfHighQualityEmitters = settings.hrtfHighQualityEmitters;
+    hrtfMediumQualityEmitters = settings.hrtfMediumQualityEmitters;
+
+    {
+        std::lock_guard<std::mutex> lock(systemLifetimeMutex);
+        if (liveInstances >= MAX_INSTANCES)
+        {
+            std::cout << "Audio Engine: Can't initialize, FMOD allows at most " << MAX_INSTANCES << " engines per process!\n";
+            return;
+        }
+
+        // FMOD's allocator must be installed before the first system is created
+        if (settings.memory.enabled)
+            AudioMemory::Initialize(settings.memory);
+
+        // Studio cannot adopt an existing core system, so it is either created up front or not at all
+        if (settings.enableStudio)
+        {
+            ERRCHECK(FMOD::Studio::System::create(&studioSystem));
+            ERRCHECK(studioSystem->getCoreSystem(&lowLevelSystem));
+        }
+        else
+            ERRCHECK(FMOD::System_Create(&lowLevelSystem));
+        ++liveInstances;
+    }
+    startupTimings.createMS = stopwatch.Lap();
+
+    // Loaded once the instance is accepted, so a rejected Init() holds nothing
+    if (settings.manifestPath && manifest.Load(settings.manifestPath))
+        std::cout << "Audio Engine: Loaded " << manifest.GetCount() << " sound definitions from " << settings.manifestPath << '\n';
+    startupTimings.manifestMS = stopwatch.Lap();
+
+    latencyProfile = settings.latencyProfile;
+    const LatencySettings requested = latencyProfile == LatencyProfile::Custom
+        ? settings.customLatency : LatencySettings::FromProfile(latencyProfile);
+
+    FMOD_ADVANCEDSETTINGS advancedSettings;
+    memset(&advancedSettings, 0, sizeof(advancedSettings));
+    advancedSettings.cbSize = sizeof(advancedSettings);
+    ERRCHECK(lowLevelSystem->getAdvancedSettings(&advancedSettings));
+    advancedSettings.defaultDecodeBufferSize = requested.streamDecodeBufferMS;
+    ERRCHECK(lowLevelSystem->setAdvancedSettings(&advancedSettings));
+
+    // Highest priority, so .aead files are recognized from their header before FMOD's own codecs
+    // scan them; other files are turned away after reading a few bytes
+    ERRCHECK(lowLevelSystem->registerCodec(AdpcmCodec::GetDescription(), &adpcmCodecHandle, 0));
+
+    SharedMemoryOutputSettings sharedOutput;
+    if (settings.sharedMemoryOutput)
+    {
+        unsigned int outputHandle = 0;
+        ERRCHECK(lowLevelSystem->registerOutput(SharedMemoryOutput::GetDescription(), &outputHandle));
+        ERRCHECK(lowLevelSystem->setOutputByPlugin(outputHandle));
+        sharedOutput.name = settings.sharedMemoryOutput;
+        sharedOutput.ringBlocks = settings.sharedMemoryOutputBlocks;
+    }
+    else
+        ERRCHECK(lowLevelSystem->setOutput(settings.outputType));
+    ERRCHECK(lowLevelSystem->setDSPBufferSize(requested.dspBufferLength, requested.dspBufferCount));
+    ERRCHECK(lowLevelSystem->setStreamBufferSize(requested.streamFileBufferBytes, FMOD_TIMEUNIT_RAWBYTES));
+    ERRCHECK(lowLevelSystem->setSoftwareFormat(requested.sampleRate, settings.speakerMode, 0));
     ERRCHECK(lowLevelSystem->set3DSettings(1.0, DISTANCEFACTOR, 0.5f));
-    ERRCHECK(studioSystem->initialize(MAX_AUDIO_CHANNELS, FMOD_STUDIO_INIT_NORMAL, FMOD_INIT_NORMAL, 0));
+    void* extraDriverData = settings.sharedMemoryOutput ? &sharedOutput : nullptr;
+    if (studioSystem)
+    {
+        const FMOD_STUDIO_INITFLAGS studioFlags = settings.synchronousStudioUpdate ? FMOD_STUDIO_INIT_SYNCHRONOUS_UPDATE : FMOD_STUDIO_INIT_NORMAL;
+        ERRCHECK(studioSystem->initialize(MAX_AUDIO_CHANNELS, studioFlags, FMOD_INIT_NORMAL, extraDriverData));
+    }
+    else
+        ERRCHECK(lowLevelSystem->init(MAX_AUDIO_CHANNELS, FMOD_INIT_NORMAL, extraDriverData));
     ERRCHECK(lowLevelSystem->getMasterChannelGroup(&mastergroup));
-    InitializeReverb();
+
+    // The output can refuse the requested format or block size, so report what it settled on
+    latency = requested;
+    ERRCHECK(lowLevelSystem->getSoftwareFormat(&latency.sampleRate, nullptr, nullptr));
+    ERRCHECK(lowLevelSystem->getDSPBufferSize(&latency.dspBufferLength, &latency.dspBufferCount));
+    if (latency.sampleRate != requested.sampleRate || latency.dspBufferLength != requested.dspBufferLength
+        || latency.dspBufferCount != requested.dspBufferCount)
+    {
+        std::cout << "Audio Engine: Output overrode the " << GetLatencyProfileName(latencyProfile) << " latency profile ("
+                  << requested.dspBufferCount << " x " << requested.dspBufferLength << " samples at " << requested.sampleRate << " Hz)\n";
+    }
+    std::cout << "Audio Engine: Mixing " << latency.dspBufferCount << " x " << latency.dspBufferLength << " samples at "
+              << latency.sampleRate << " Hz, " << latency.GetBufferLatencyMS() << " ms buffered ("
+              << GetLatencyProfileName(latencyProfile) << " profile)\n";
+
+    for (int listener = 0; listener < MAX_LISTENERS; ++listener)
+        listenerPositions[listener] = Vector3(listeners[listener].position.x, listeners[listener].position.y, listeners[listener].position.z);
+    SetListenerCount(settings.listeners);
+    if (settings.mixerTelemetry)
+    {
+        mixerTelemetry = std::make_unique<MixerTelemetry>();
+        mixerTelemetry->Attach(lowLevelSystem, mastergroup);
+    }
+    startupTimings.initializeMS = stopwatch.Lap();
+
+    CreateBus(BUS_MUSIC);
+    CreateBus(BUS_SFX);
+    CreateBus(BUS_VOICE);
+    CreateBus(BUS_UI);
+    startupTimings.busesMS = stopwatch.Lap();
+
+    startupTimings.totalMS = stopwatch.ElapsedMS();
+    std::cout << "Audio Engine: Initialized in " << startupTimings.totalMS << " ms (manifest " << startupTimings.manifestMS
+              << ", create " << startupTimings.createMS << ", initialize " << startupTimings.initializeMS
+              << ", buses " << startupTimings.busesMS << ")\n";
+    ready = true;
+}
+
+std::shared_future<void> AudioEngine::InitAsync(const AudioEngineSettings& settings)
+{
+    if (initFuture.valid())
+    {
+        std::cout << "Audio Engine: Init has already been started!\n";
+        return initFuture;
+    }
+
+    // The settings' paths are copied too, so the caller's strings needn't outlive the call
+    const std::string manifestPath = settings.manifestPath ? settings.manifestPath : "";
+    const std::string sharedMemoryOutput = settings.sharedMemoryOutput ? settings.sharedMemoryOutput : "";
+    initFuture = std::async(std::launch::async, [this, settings, manifestPath, sharedMemoryOutput]()
+    {
+        AudioEngineSettings owned = settings;
+        owned.manifestPath = settings.manifestPath ? manifestPath.c_str() : nullptr;
+        owned.sharedMemoryOutput = settings.sharedMemoryOutput ? sharedMemoryOutput.c_str() : nullptr;
+        Init(owned);
+    }).share();
+    return initFuture;
+}
+
+bool AudioEngine::IsReady() const
+{
+    return ready;
+}
+
+int AudioEngine::GetInstanceCount()
+{
+    std::lock_guard<std::mutex> lock(systemLifetimeMutex);
+    return liveInstances;
+}
+
+const AudioEngineStartupTimings& AudioEngine::GetStartupTimings() const
+{
+    return startupTimings;
+}
+
+LatencyReport AudioEngine::GetLatencyReport() const
+{
+    LatencyReport report;
+    report.profile = latencyProfile;
+    report.applied = latency;
+    if (latency.sampleRate > 0)
+        report.blockMS = 1000.0f * latency.dspBufferLength / latency.sampleRate;
+    report.bufferLatencyMS = latency.GetBufferLatencyMS();
+
+    if (mixerTelemetry)
+    {
+        const MixerTimingStats mixer = mixerTelemetry->GetStats();
+        report.measuredBlockIntervalMS = mixer.meanIntervalMS;
+        report.measuredLatencyMS = mixer.meanIntervalMS * latency.dspBufferCount;
+        if (report.blockMS > 0.0f)
+            report.mixerLoadPercent = 100.0f * mixer.p99MS / report.blockMS;
+    }
+    if (lowLevelSystem)
+        ERRCHECK(lowLevelSystem->getCPUUsage(&report.mixerCPUPercent, nullptr, nullptr, nullptr, nullptr));
+    return report;
+}
+
+AudioEngineStats AudioEngine::GetStats() const
+{
+    AudioEngineStats current = stats;
+    current.virtualLoops = 0;
+    for (const auto& loop : loopsPlaying)
+    {
+        if (!loop.second.channel)
+            ++current.virtualLoops;
+    }
+    if (mixerTelemetry)
+        current.mixer = mixerTelemetry->GetStats();
+    current.parameters = parameterBatch.GetStats();
+    current.limits = playbackLimiter.GetStats();
+
+    current.loadedSounds = static_cast<unsigned int>(sounds.size());
+    current.playingLoops = static_cast<unsigned int>(loopsPlaying.size());
+    current.eventInstances = static_cast<unsigned int>(eventInstances.size());
+    for (FMOD::Studio::EventInstance* instance : handleInstances)
+    {
+        if (instance)
+            ++current.eventInstances;
+    }
+    current.hrtfEmitters = static_cast<unsigned int>(hrtfEmitters.size());
+    if (lowLevelSystem)
+        ERRCHECK(lowLevelSystem->getChannelsPlaying(&current.channelsPlaying, &current.realChannels));
+    return current;
+}
+
+void AudioEngine::ResetStats()
+{
+    stats = AudioEngineStats();
+    parameterBatch.ResetStats();
+    playbackLimiter.ResetStats();
+    if (mixerTelemetry)
+        mixerTelemetry->Reset();
 }
 
 void AudioEngine::Terminate() 
 {
+    // Forgotten even if Init() was rejected, so InitAsync() can be called again
+    if (initFuture.valid())
+        initFuture.wait();
+    initFuture = std::shared_future<void>();
+    if (!ready)
+        return;
+
+    duckers.clear();
+    duckingDetectors.clear();
+    for (auto& effect : busEffects)
+    {
+        ERRCHECK(FindBus(effect.first.first)->removeDSP(effect.second));
+        ERRCHECK(effect.second->release());
+    }
+    busEffects.clear();
+    convolutionReverbs.clear();
+    loudnessMeters.clear();
+    StopRecording();
+    for (HrtfEmitter& emitter : hrtfEmitters)
+    {
+        emitter.channel->removeDSP(emitter.dsp); // fails harmlessly if the channel has already stopped
+        ERRCHECK(emitter.dsp->release());
+    }
+    hrtfEmitters.clear();
+    occlusion.reset();
+    mixerTelemetry.reset();
+    starvingStreams.clear();
+
+    // Released before the system closes, so a later Init() doesn't find stale sounds
+    loopsPlaying.clear();
+    for (auto& sound : sounds)
+        ERRCHECK(sound.second->release());
+    sounds.clear();
+    containers.clear();
+    containerVariants.clear();
+    playbackLimiter.ReleaseAll();
+    for (auto& bus : buses)
+        ERRCHECK(bus.second->release());
+    buses.clear();
+    if (reverb)
+        ERRCHECK(reverb->release());
+    reverb = nullptr;
     lowLevelSystem->close();
-    studioSystem->release();
+    {
+        std::lock_guard<std::mutex> lock(systemLifetimeMutex);
+        if (studioSystem)
+            studioSystem->release(); // also releases the low level system
+        else
+            lowLevelSystem->release();
+        --liveInstances;
+    }
+    studioSystem = nullptr;
+    lowLevelSystem = nullptr;
+    eventInstances.clear();
+    eventDescriptions.clear();
+    eventIndex.Clear();
+    handleInstances.clear();
+    handleEvents.clear();
+    parameterIds.clear();
+    parameterEvents.clear();
+    parameterHandles.clear();
+    parameterBatch.Clear();
+    soundBanks.clear();
+    hrirSet.reset();
+    hrtfHandle = 0;
+    adpcmCodecHandle = 0;
+    mastergroup = nullptr;
+    listenerCount = 1;
+    effectsRegistered = false;
+    manifest.Unload();
+    ready = false;
 }
 
 void AudioEngine::Update() {
-    ERRCHECK(studioSystem->update()); // also updates the low level system
+    if (recorder)
+        recorder->RecordFrame();
+
+    if (!ready)
+        return;
+
+    if (occlusion)
+        occlusion->Update(listenerPositions, listenerCount);
+
+    if (distanceCulling)
+        CullLoops();
+
+    if (!hrtfEmitters.empty())
+        UpdateHrtf();
+
+    ApplyEventParameters();
+
+    if (studioSystem)
+        ERRCHECK(studioSystem->update()); // also updates the low level system
+    else
+        ERRCHECK(lowLevelSystem->update());
+
+    if (mixerTelemetry)
+    {
+        mixerTelemetry->Update();
+        CheckStreamStarvation();
+    }
+}
+
+AudioData AudioEngine::GetAudioData(SoundId id)
+{
+    AudioData audioData;
+    if (!manifest.GetAudioData(id, audioData))
+        std::cout << "Audio Engine: Sound " << id << " is not defined in the manifest!\n";
+    return audioData;
 }
 
 void AudioEngine::Load(AudioData audioData) 
 {
-    if (!audioData.IsLoaded()) 
+    if (recorder)
+        recorder->Record(EngineCall::Load, audioData);
+
+    if (!IsLoaded(audioData)) 
     {
         std::cout << "Audio Engine: Loading Sound from file " << audioData.GetFilePath() << '\n';
         FMOD::Sound* sound;
-        ERRCHECK(lowLevelSystem->createSound(audioData.GetFilePath(), audioData.Is3D() ? FMOD_3D : FMOD_2D, 0, &sound));
+        FMOD_MODE mode = audioData.Is3D() ? FMOD_3D : FMOD_2D;
+        if (audioData.IsStreaming())
+            mode |= FMOD_CREATESTREAM;
+        ERRCHECK(lowLevelSystem->createSound(audioData.GetFilePath(), mode, 0, &sound));
         ERRCHECK(sound->setMode(audioData.Loop() ? FMOD_LOOP_NORMAL : FMOD_LOOP_OFF));
-        ERRCHECK(sound->set3DMinMaxDistance(0.5f * DISTANCEFACTOR, 5000.0f * DISTANCEFACTOR));
+        ERRCHECK(sound->set3DMinMaxDistance(MIN_3D_DISTANCE * DISTANCEFACTOR, audioData.GetMaxDistance() * DISTANCEFACTOR));
+
+        // FMOD converts other rates to the mixer's on every voice; AssetConditioner does it once offline
+        float frequency = 0.0f;
+        ERRCHECK(sound->getDefaults(&frequency, nullptr));
+        if (static_cast<int>(frequency) != latency.sampleRate)
+            std::cout << "Audio Engine: " << audioData.GetFilePath() << " is sampled at " << frequency << " Hz and is resampled to "
+                      << latency.sampleRate << " Hz whenever it plays; condition it with AssetConditioner\n";
         sounds.insert({ audioData.GetUniqueID(), sound });
         unsigned int msLength = 0;
         ERRCHECK(sounds[audioData.GetUniqueID()]->getLength(&msLength, FMOD_TIMEUNIT_MS));
@@ -57,41 +400,247 @@ void AudioEngine::Load(AudioData audioData)
         std::cout << "Audio Engine: Sound File was already loaded!\n";
 }
 
+void AudioEngine::Unload(AudioData audioData)
+{
+    if (recorder)
+        recorder->Record(EngineCall::Unload, audioData);
+
+    auto it = sounds.find(audioData.GetUniqueID());
+    if (it == sounds.end())
+    {
+        std::cout << "Audio Engine: Can't unload a sound that was not loaded!\n";
+        return;
+    }
+
+    // Releasing the sound stops its channels; UpdateHrtf() drops their spatializers
+    auto loop = loopsPlaying.find(audioData.GetUniqueID());
+    if (loop != loopsPlaying.end())
+    {
+        if (!loop->second.channel)
+            playbackLimiter.Release(loop->second.voice);
+        loopsPlaying.erase(loop);
+    }
+    starvingStreams.erase(std::remove(starvingStreams.begin(), starvingStreams.end(), it->second), starvingStreams.end());
+    ERRCHECK(it->second->release());
+    sounds.erase(it);
+}
+
 void AudioEngine::Play(AudioData audioData) 
 {
-    if (!audioData.IsLoaded()) {
-        //std::cout << "Playing Sound\n";
-        FMOD::Channel* channel;
-        // start play in 'paused' state
-        ERRCHECK(lowLevelSystem->playSound(sounds[audioData.GetUniqueID()], 0, true /* start paused */, &channel));
+    if (recorder)
+        recorder->Record(EngineCall::Play, audioData);
 
-        if (audioData.Is3D())
+    if (IsLoaded(audioData)) {
+        ++stats.playsRequested;
+
+        // Sounds out of earshot don't get a channel; loops are tracked so they can start later
+        const bool culled = audioData.Is3D() && distanceCulling && !IsAudible(audioData);
+        if (culled && !audioData.Loop())
         {
-            Set3DChannelPosition(audioData, channel);
+            ++stats.playsCulled;
+            return;
         }
 
-        //std::cout << "Playing sound at volume " << soundInfo.getVolume() << '\n';
-        channel->setVolume(audioData.GetVolume());
-
-        if (audioData.Loop()) // add to channel map of sounds currently playing, to stop later
-            loopsPlaying.insert({ audioData.GetUniqueID(), channel });
+        // A virtual loop counts against its limits as if it had a channel
+        const double nowMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        PlaybackTicket ticket;
+        if (!AdmitPlay(audioData, nowMS, ticket))
+            return;
 
-        ERRCHECK(channel->setReverbProperties(0, audioData.GetReverbAmount()));
+        FMOD::Channel* channel = nullptr;
+        if (culled)
+            ++stats.loopsVirtualized;
+        else
+            channel = StartChannel(audioData);
 
-        // start audio playback
-        ERRCHECK(channel->setPaused(false));
+        const int voice = playbackLimiter.Register(ticket, audioData.GetUniqueID(), channel, nowMS);
+        if (channel)
+            TrackLimitedChannel(channel, voice);
 
+        if (audioData.Loop()) // add to channel map of sounds currently playing, to stop later
+        {
+            // A loop already playing keeps its entry; a virtual duplicate would never release its voice
+            const bool tracked = loopsPlaying.insert({ audioData.GetUniqueID(), { channel, audioData, 0, voice } }).second;
+            if (!tracked && !channel)
+                playbackLimiter.Release(voice);
+        }
     }
     else
         std::cout << "Audio Engine: Can't play, sound was not loaded yet from " << audioData.GetFilePath() << '\n';
 
 }
 
+void AudioEngine::LoadContainer(const SoundContainer& container)
+{
+    const SoundId id = container.GetUniqueID();
+    if (!id.IsValid() || container.GetVariantCount() == 0)
+    {
+        std::cout << "Audio Engine: Can't load a sound container without an ID and variants!\n";
+        return;
+    }
+    if (containers.count(id) > 0)
+    {
+        std::cout << "Audio Engine: Sound container " << id << " was already loaded!\n";
+        return;
+    }
+
+    // Variants may be shared with other containers or played on their own
+    for (int i = 0; i < container.GetVariantCount(); ++i)
+    {
+        const AudioData& variant = container.GetVariant(i);
+        ContainerVariant& reference = containerVariants[variant.GetUniqueID()];
+        ++reference.containers;
+        if (!IsLoaded(variant))
+        {
+            Load(variant);
+            reference.loadedByContainer = true;
+        }
+    }
+    containers.insert({ id, container });
+}
+
+void AudioEngine::UnloadContainer(SoundId id)
+{
+    auto it = containers.find(id);
+    if (it == containers.end())
+    {
+        std::cout << "Audio Engine: Can't unload sound container " << id << ", it was not loaded!\n";
+        return;
+    }
+
+    // Only variants containers loaded are unloaded, once the last container using them goes
+    for (int i = 0; i < it->second.GetVariantCount(); ++i)
+    {
+        const AudioData& variant = it->second.GetVariant(i);
+        auto reference = containerVariants.find(variant.GetUniqueID());
+        if (reference == containerVariants.end() || --reference->second.containers > 0)
+            continue;
+
+        if (reference->second.loadedByContainer && IsLoaded(variant))
+            Unload(variant);
+        containerVariants.erase(reference);
+    }
+    containers.erase(it);
+}
+
+void AudioEngine::PlayContainer(SoundId id)
+{
+    AudioData variant;
+    if (SelectVariant(id, variant))
+        Play(variant);
+}
+
+void AudioEngine::PlayContainer(SoundId id, const Vector3& position)
+{
+    AudioData variant;
+    if (SelectVariant(id, variant))
+    {
+        variant.SetPosition(position);
+        Play(variant);
+    }
+}
+
+void AudioEngine::SetSoundLimit(SoundId id, const PlaybackLimit& limit)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetSoundLimit, id, limit);
+
+    playbackLimiter.SetSoundLimit(id, limit);
+}
+
+void AudioEngine::SetBusLimit(const char* busName, const PlaybackLimit& limit)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetBusLimit, busName, limit);
+
+    playbackLimiter.SetCategoryLimit(busName, limit);
+}
+
+bool AudioEngine::AdmitPlay(const AudioData& audioData, double nowMS, PlaybackTicket& ticket)
+{
+    // Stolen channels may have ended since the last Update(), so their handles can be stale and errors are ignored
+    return playbackLimiter.Admit(audioData.GetUniqueID(), audioData.GetBus(), nowMS, ticket,
+        [](void* playing)
+        {
+            // Virtual loops have no channel and are heard least
+            float audibility = 0.0f;
+            if (playing)
+                static_cast<FMOD::Channel*>(playing)->getAudibility(&audibility);
+            return audibility;
+        },
+        [this](int voice, void* stolen, SoundId sound)
+        {
+            // Its voice is already released, so OnChannelEnd() must not release it again
+            if (FMOD::Channel* channel = static_cast<FMOD::Channel*>(stolen))
+            {
+                channel->setUserData(nullptr);
+                channel->stop();
+            }
+
+            auto loop = loopsPlaying.find(sound);
+            if (loop != loopsPlaying.end() && loop->second.voice == voice)
+                loopsPlaying.erase(loop);
+        });
+}
+
+void AudioEngine::TrackLimitedChannel(FMOD::Channel* channel, int voice)
+{
+    if (voice < 0)
+        return;
+
+    limitedChannels[voice].engine = this;
+    limitedChannels[voice].voice = voice;
+    ERRCHECK(channel->setUserData(&limitedChannels[voice]));
+    ERRCHECK(channel->setCallback(&AudioEngine::OnChannelEnd));
+}
+
+FMOD_RESULT F_CALL AudioEngine::OnChannelEnd(FMOD_CHANNELCONTROL* channelControl, FMOD_CHANNELCONTROL_TYPE controlType,
+                                             FMOD_CHANNELCONTROL_CALLBACK_TYPE callbackType, void*, void*)
+{
+    if (controlType != FMOD_CHANNELCONTROL_CHANNEL || callbackType != FMOD_CHANNELCONTROL_CALLBACK_END)
+        return FMOD_OK;
+
+    FMOD::Channel* channel = reinterpret_cast<FMOD::Channel*>(channelControl);
+    void* userData = nullptr;
+    if (channel->getUserData(&userData) != FMOD_OK || !userData)
+        return FMOD_OK;
+
+    const LimitedChannel* limited = static_cast<const LimitedChannel*>(userData);
+    limited->engine->playbackLimiter.Release(limited->voice);
+    channel->setUserData(nullptr);
+    return FMOD_OK;
+}
+
+bool AudioEngine::SelectVariant(SoundId id, AudioData& variant)
+{
+    auto it = containers.find(id);
+    if (it == containers.end())
+    {
+        std::cout << "Audio Engine: Can't play sound container " << id << ", it was not loaded!\n";
+        return false;
+    }
+
+    float pitch = 1.0f;
+    float volume = 1.0f;
+    variant = it->second.GetVariant(it->second.Select(pitch, volume));
+    variant.SetPitch(variant.GetPitch() * pitch);
+    variant.SetVolume(variant.GetVolume() * volume);
+    return true;
+}
+
 void AudioEngine::Stop(AudioData audioData) 
 {
+    if (recorder)
+        recorder->Record(EngineCall::Stop, audioData);
+
     if (IsPlaying(audioData)) 
     {
-        ERRCHECK(loopsPlaying[audioData.GetUniqueID()]->stop());
+        // A real loop's voice is released when its channel ends, a virtual loop's here
+        PlayingLoop& loop = loopsPlaying[audioData.GetUniqueID()];
+        if (loop.channel)
+            ERRCHECK(loop.channel->stop());
+        else
+            playbackLimiter.Release(loop.voice);
         loopsPlaying.erase(audioData.GetUniqueID());
     }
     else
@@ -100,12 +649,17 @@ void AudioEngine::Stop(AudioData audioData)
 
 void AudioEngine::UpdateVolume(AudioData& audioData, float newVolume, unsigned int fadeSampleLength) 
 {    
+    if (recorder)
+        recorder->Record(EngineCall::UpdateVolume, audioData, newVolume, fadeSampleLength);
+
     if (IsPlaying(audioData)) 
     {
-        FMOD::Channel* channel = loopsPlaying[audioData.GetUniqueID()];
-        if (fadeSampleLength <= 64) // 64 samples is default volume fade out
+        PlayingLoop& loop = loopsPlaying[audioData.GetUniqueID()];
+        loop.audioData.SetVolume(newVolume); // a virtual loop uses it once it gets a channel
+        FMOD::Channel* channel = loop.channel;
+        if (channel && fadeSampleLength <= 64) // 64 samples is default volume fade out
             ERRCHECK(channel->setVolume(newVolume));
-        else {
+        else if (channel) {
             bool fadeUp = newVolume > audioData.GetVolume();
             // get current audio clock time
             unsigned long long parentclock = 0;
@@ -130,9 +684,15 @@ void AudioEngine::UpdateVolume(AudioData& audioData, float newVolume, unsigned i
 
 void AudioEngine::Update3DPosition(AudioData audioData) 
 {
+    if (recorder)
+        recorder->Record(EngineCall::Update3DPosition, audioData);
+
     if (IsPlaying(audioData))
     {
-        Set3DChannelPosition(audioData, loopsPlaying[audioData.GetUniqueID()]);
+        PlayingLoop& loop = loopsPlaying[audioData.GetUniqueID()];
+        loop.audioData.SetPosition(audioData.GetPosition());
+        if (loop.channel)
+            Set3DChannelPosition(audioData, loop.channel);
     }
     else
         std::cout << "Audio Engine: Can't update sound position!\n";
@@ -148,13 +708,40 @@ void AudioEngine::Set3DListenerPosition
 (
     float posX, float posY, float posZ, 
     float forwardX, float forwardY, float forwardZ, 
-    float upX, float upY, float upZ
+    float upX, float upY, float upZ,
+    int listener
 ) 
 {
-    listenerPosition =  { posX,     posY,     posZ };
-    forward =           { forwardX, forwardY, forwardZ };
-    up =                { upX,      upY,      upZ };
-    ERRCHECK(lowLevelSystem->set3DListenerAttributes(0, &listenerPosition, 0, &forward, &up));
+    if (recorder)
+        recorder->Record(EngineCall::Set3DListenerPosition, posX, posY, posZ, forwardX, forwardY, forwardZ, upX, upY, upZ, listener);
+
+    if (listener < 0 || listener >= MAX_LISTENERS)
+    {
+        std::cout << "Audio Engine: Listener " << listener << " is out of range!\n";
+        return;
+    }
+
+    Listener& target = listeners[listener];
+    target.position =   { posX,     posY,     posZ };
+    target.forward =    { forwardX, forwardY, forwardZ };
+    target.up =         { upX,      upY,      upZ };
+    listenerPositions[listener] = Vector3(posX, posY, posZ);
+    ERRCHECK(lowLevelSystem->set3DListenerAttributes(listener, &target.position, 0, &target.forward, &target.up));
+}
+
+void AudioEngine::SetListenerCount(int count)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetListenerCount, count);
+
+    if (count < 1 || count > MAX_LISTENERS)
+    {
+        std::cout << "Audio Engine: Listener count must be between 1 and " << MAX_LISTENERS << "!\n";
+        return;
+    }
+
+    ERRCHECK(lowLevelSystem->set3DNumListeners(count));
+    listenerCount = count;
 }
 
 unsigned int AudioEngine::GetLengthMS(AudioData audioData) 
@@ -167,17 +754,45 @@ unsigned int AudioEngine::GetLengthMS(AudioData audioData)
 
 void AudioEngine::LoadBank(const char* filepath) 
 {
+    if (recorder)
+        recorder->Record(EngineCall::LoadBank, filepath);
+
+    if (!HasStudio())
+        return;
+
     std::cout << "Audio Engine: Loading FMOD Studio Sound Bank " << filepath << '\n';
     FMOD::Studio::Bank* bank = NULL;
     ERRCHECK(studioSystem->loadBankFile(filepath, FMOD_STUDIO_LOAD_BANK_NORMAL, &bank));
+    if (!bank)
+        return;
+
     soundBanks.insert({ filepath, bank });
+    const int eventCount = eventIndex.AddBank(bank);
+    if (eventCount > 0)
+        std::cout << "Audio Engine: Indexed " << eventCount << " events from " << filepath << '\n';
 }
 
 void AudioEngine::LoadEvent(const char* eventName, std::vector<std::pair<const char*, float>> paramsValues) // std::vector<std::map<const char*, float>> perInstanceParameterValues)
 {
+    if (recorder)
+        recorder->Record(EngineCall::LoadEvent, eventName, paramsValues);
+
+    if (!HasStudio())
+        return;
+
     std::cout << "AudioEngine: Loading FMOD Studio Event " << eventName << '\n';
-    FMOD::Studio::EventDescription* eventDescription = NULL;
-    ERRCHECK(studioSystem->getEvent(eventName, &eventDescription));
+    const EventId eventId = EventId::FromPath(eventName);
+    FMOD::Studio::EventDescription* eventDescription = eventIndex.Find(eventId);
+    FMOD_GUID guid;
+    if (!eventDescription && eventName[0] == '{' && FMOD::Studio::parseID(eventName, &guid) == FMOD_OK)
+        eventDescription = eventIndex.Find(guid);
+    if (!eventDescription)
+    {
+        // Not in a loaded bank's index, e.g. a path of a bank loaded without its strings bank
+        ERRCHECK(studioSystem->getEvent(eventName, &eventDescription));
+        if (!eventDescription)
+            return;
+    }
     // Create an instance of the event
     FMOD::Studio::EventInstance* eventInstance = NULL;
     ERRCHECK(eventDescription->createInstance(&eventInstance));
@@ -186,63 +801,364 @@ void AudioEngine::LoadEvent(const char* eventName, std::vector<std::pair<const c
         // Set the parameter values of the event instance
         ERRCHECK(eventInstance->setParameterByName(parVal.first, parVal.second));
     }
-    eventInstances.insert({ eventName, eventInstance });
-    eventDescriptions.insert({ eventName, eventDescription });
+    eventInstances.insert({ eventId, eventInstance });
+    eventDescriptions.insert({ eventId, eventDescription });
 }
 
-void AudioEngine::SetEventParamValue(const char* eventName, const char* parameterName, float value) 
+void AudioEngine::SetEventParamValue(EventId eventId, const char* parameterName, float value) 
 {
-    if (eventInstances.count(eventName) > 0)
-        ERRCHECK(eventInstances[eventName]->setParameterByName(parameterName, value));
+    if (recorder)
+        recorder->Record(EngineCall::SetEventParamValue, eventId, parameterName, value);
+
+    auto it = eventInstances.find(eventId);
+    if (it != eventInstances.end())
+        ERRCHECK(it->second->setParameterByName(parameterName, value));
     else
-        std::cout << "AudioEngine: Event " << eventName << " was not in event instance cache, can't set param \n";
+        std::cout << "AudioEngine: Event " << eventId << " was not in event instance cache, can't set param \n";
 
 }
 
+void AudioEngine::SetEventParamValue(const char* eventName, const char* parameterName, float value) 
+{
+    SetEventParamValue(EventId::FromPath(eventName), parameterName, value);
+}
+
+void AudioEngine::PlayEvent(EventId eventId, int instanceIndex) {
+    if (recorder)
+        recorder->Record(EngineCall::PlayEvent, eventId, instanceIndex);
+
+    // printEventInfo(eventDescriptions[eventId]);
+    auto it = eventInstances.find(eventId);
+    if (it != eventInstances.end())
+        ERRCHECK(it->second->start());
+    else
+        std::cout << "AudioEngine: Event " << eventId << " was not in event instance cache, cannot play \n";
+}
+
 void AudioEngine::PlayEvent(const char* eventName, int instanceIndex) {
-    // printEventInfo(eventDescriptions[eventName]);
-    auto eventInstance = eventInstances[eventName];
-    if (eventInstances.count(eventName) > 0)
-        ERRCHECK(eventInstances[eventName]->start());
+    PlayEvent(EventId::FromPath(eventName), instanceIndex);
+}
+
+void AudioEngine::StopEvent(EventId eventId, int instanceIndex) {
+    if (recorder)
+        recorder->Record(EngineCall::StopEvent, eventId, instanceIndex);
+
+    auto it = eventInstances.find(eventId);
+    if (it != eventInstances.end())
+        ERRCHECK(it->second->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT));
     else
-        std::cout << "AudioEngine: Event " << eventName << " was not in event instance cache, cannot play \n";
+        std::cout << "AudioEngine: Event " << eventId << " was not in event instance cache, cannot stop \n";
 }
 
 void AudioEngine::StopEvent(const char* eventName, int instanceIndex) {
-    if (eventInstances.count(eventName) > 0)
-        ERRCHECK(eventInstances[eventName]->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT));
-    else
-        std::cout << "AudioEngine: Event " << eventName << " was not in event instance cache, cannot stop \n";
+    StopEvent(EventId::FromPath(eventName), instanceIndex);
 }
 
-void AudioEngine::SetEventVolume(const char* eventName, float volume0to1) 
+void AudioEngine::SetEventVolume(EventId eventId, float volume0to1) 
 {
+    if (recorder)
+        recorder->Record(EngineCall::SetEventVolume, eventId, volume0to1);
+
+    auto it = eventInstances.find(eventId);
+    if (it == eventInstances.end())
+    {
+        std::cout << "AudioEngine: Event " << eventId << " was not in event instance cache, can't set volume \n";
+        return;
+    }
+
     std::cout << "AudioEngine: Setting Event Volume\n";
-    ERRCHECK(eventInstances[eventName]->setVolume(volume0to1));
+    ERRCHECK(it->second->setVolume(volume0to1));
 }
 
-bool AudioEngine::IsPlaying(const char* eventName, int instance /*= 0*/) 
+void AudioEngine::SetEventVolume(const char* eventName, float volume0to1) 
+{
+    SetEventVolume(EventId::FromPath(eventName), volume0to1);
+}
+
+bool AudioEngine::IsPlaying(EventId eventId, int instance /*= 0*/) 
 {
+    auto it = eventInstances.find(eventId);
+    if (it == eventInstances.end())
+        return false;
+
     FMOD_STUDIO_PLAYBACK_STATE playbackState;
-    ERRCHECK(eventInstances[eventName]->getPlaybackState(&playbackState));
+    ERRCHECK(it->second->getPlaybackState(&playbackState));
     return playbackState == FMOD_STUDIO_PLAYBACK_PLAYING;
 }
 
+bool AudioEngine::IsPlaying(const char* eventName, int instance /*= 0*/) 
+{
+    return IsPlaying(EventId::FromPath(eventName), instance);
+}
+
+
+EventInstanceHandle AudioEngine::CreateEventInstance(EventId eventId)
+{
+    if (recorder)
+        recorder->Record(EngineCall::CreateEventInstance, eventId);
+
+    EventInstanceHandle handle;
+    FMOD::Studio::EventDescription* eventDescription = FindEventDescription(eventId);
+    if (!eventDescription)
+    {
+        std::cout << "AudioEngine: Event " << eventId << " is not in a loaded bank, can't create an instance \n";
+        return handle;
+    }
+
+    FMOD::Studio::EventInstance* eventInstance = nullptr;
+    ERRCHECK(eventDescription->createInstance(&eventInstance));
+    if (!eventInstance)
+        return handle;
+
+    // Released handles are reused so the table stays as small as the peak instance count
+    auto freeSlot = std::find(handleInstances.begin(), handleInstances.end(), nullptr);
+    handle.index = static_cast<uint32_t>(freeSlot - handleInstances.begin());
+    if (freeSlot == handleInstances.end())
+    {
+        handleInstances.push_back(eventInstance);
+        handleEvents.push_back(eventDescription);
+    }
+    else
+    {
+        *freeSlot = eventInstance;
+        handleEvents[handle.index] = eventDescription;
+    }
+    return handle;
+}
+
+void AudioEngine::ReleaseEventInstance(EventInstanceHandle instance)
+{
+    if (recorder)
+        recorder->Record(EngineCall::ReleaseEventInstance, instance);
+
+    if (!instance.IsValid() || instance.index >= handleInstances.size() || !handleInstances[instance.index])
+    {
+        std::cout << "AudioEngine: Can't release an event instance that doesn't exist \n";
+        return;
+    }
+
+    ERRCHECK(handleInstances[instance.index]->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT));
+    ERRCHECK(handleInstances[instance.index]->release()); // destroyed by Studio once it has stopped
+    handleInstances[instance.index] = nullptr;
+    handleEvents[instance.index] = nullptr;
+    parameterBatch.ForgetInstance(instance);
+}
+
+void AudioEngine::PlayEvent(EventInstanceHandle instance)
+{
+    if (recorder)
+        recorder->Record(EngineCall::PlayEventInstance, instance);
+
+    if (instance.IsValid() && instance.index < handleInstances.size() && handleInstances[instance.index])
+        ERRCHECK(handleInstances[instance.index]->start());
+    else
+        std::cout << "AudioEngine: Can't play an event instance that doesn't exist \n";
+}
+
+void AudioEngine::StopEvent(EventInstanceHandle instance)
+{
+    if (recorder)
+        recorder->Record(EngineCall::StopEventInstance, instance);
+
+    if (instance.IsValid() && instance.index < handleInstances.size() && handleInstances[instance.index])
+        ERRCHECK(handleInstances[instance.index]->stop(FMOD_STUDIO_STOP_ALLOWFADEOUT));
+    else
+        std::cout << "AudioEngine: Can't stop an event instance that doesn't exist \n";
+}
+
+EventParameterHandle AudioEngine::GetEventParameterHandle(EventId eventId, const char* parameterName)
+{
+    if (recorder)
+        recorder->Record(EngineCall::GetEventParameterHandle, eventId, parameterName);
+
+    const std::pair<EventId, uint64_t> key(eventId, HashFNV1a64(parameterName));
+    auto it = parameterHandles.find(key);
+    if (it != parameterHandles.end())
+        return it->second;
+
+    EventParameterHandle handle;
+    FMOD::Studio::EventDescription* eventDescription = FindEventDescription(eventId);
+    if (!eventDescription)
+    {
+        std::cout << "AudioEngine: Event " << eventId << " is not in a loaded bank, can't find parameter " << parameterName << '\n';
+        return handle;
+    }
+
+    FMOD_STUDIO_PARAMETER_DESCRIPTION parameter;
+    if (eventDescription->getParameterDescriptionByName(parameterName, &parameter) != FMOD_OK)
+    {
+        std::cout << "AudioEngine: Event " << eventId << " has no parameter " << parameterName << '\n';
+        return handle;
+    }
+
+    handle.index = static_cast<uint32_t>(parameterIds.size());
+    parameterIds.push_back(parameter.id);
+    parameterEvents.push_back(eventDescription);
+    parameterHandles.insert({ key, handle });
+    return handle;
+}
+
+void AudioEngine::SetEventParameters(const std::vector<EventParameterWrite>& writes)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetEventParameters, writes);
+
+    // Handles index the batch's tables and parameterIds, so stale or foreign ones are turned away here.
+    // A parameter of another event would fail the whole FMOD call it is batched into.
+    size_t rejected = 0;
+    for (const EventParameterWrite& write : writes)
+    {
+        if (write.instance.index < handleInstances.size() && handleInstances[write.instance.index]
+            && write.parameter.index < parameterIds.size()
+            && parameterEvents[write.parameter.index] == handleEvents[write.instance.index])
+            parameterBatch.Queue(&write, 1);
+        else
+            ++rejected;
+    }
+    if (rejected > 0)
+        std::cout << "Audio Engine: Ignored " << rejected << " event parameter writes to released instances, unknown parameters or parameters of other events!\n";
+}
+
+FMOD::Studio::EventDescription* AudioEngine::FindEventDescription(EventId eventId)
+{
+    auto it = eventDescriptions.find(eventId);
+    return it != eventDescriptions.end() ? it->second : eventIndex.Find(eventId);
+}
+
+void AudioEngine::ApplyEventParameters()
+{
+    FMOD_STUDIO_PARAMETER_ID batchIds[EVENT_PARAMETER_BATCH];
+    float batchValues[EVENT_PARAMETER_BATCH];
+    parameterBatch.Flush([&](uint32_t instance, const uint32_t* parameters, const float* values, int count)
+    {
+        if (instance >= handleInstances.size() || !handleInstances[instance])
+            return false;
+
+        // Handles map to IDs here, in stack chunks, so each chunk is a single FMOD call
+        bool applied = true;
+        for (int first = 0; first < count; first += EVENT_PARAMETER_BATCH)
+        {
+            const int last = count - first < EVENT_PARAMETER_BATCH ? count : first + EVENT_PARAMETER_BATCH;
+            int chunk = 0;
+            for (int i = first; i < last; ++i)
+            {
+                if (parameters[i] >= parameterIds.size())
+                    continue;
+                batchIds[chunk] = parameterIds[parameters[i]];
+                batchValues[chunk] = values[i];
+                ++chunk;
+            }
+            if (chunk == 0)
+                continue;
+            const FMOD_RESULT result = handleInstances[instance]->setParametersByIDs(batchIds, batchValues, chunk);
+            ERRCHECK(result);
+            applied = applied && result == FMOD_OK;
+        }
+        return applied;
+    });
+}
 
 void AudioEngine::MuteAll() 
 {
+    if (recorder)
+        recorder->Record(EngineCall::MuteAll);
+
     ERRCHECK(mastergroup->setMute(true));
     muted = true;
 }
 
 void AudioEngine::UnmuteAll() 
 {
+    if (recorder)
+        recorder->Record(EngineCall::UnmuteAll);
+
     ERRCHECK(mastergroup->setMute(false));
     muted = false;
 }
 
 bool AudioEngine::IsMute() { return muted; }
 
+void AudioEngine::CreateBus(const char* busName, const char* parentBusName)
+{
+    if (recorder)
+        recorder->Record(EngineCall::CreateBus, busName, parentBusName);
+
+    if (buses.count(busName))
+    {
+        std::cout << "Audio Engine: Bus " << busName << " already exists!\n";
+        return;
+    }
+
+    FMOD::ChannelGroup* parent = FindBus(parentBusName ? parentBusName : "");
+    if (!parent)
+        return;
+
+    FMOD::ChannelGroup* bus = nullptr;
+    ERRCHECK(lowLevelSystem->createChannelGroup(busName, &bus));
+    ERRCHECK(parent->addGroup(bus));
+    buses.insert({ busName, bus });
+}
+
+void AudioEngine::SetBusVolume(const char* busName, float volume)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetBusVolume, busName, volume);
+
+    if (FMOD::ChannelGroup* bus = FindBus(busName))
+        ERRCHECK(bus->setVolume(volume));
+}
+
+float AudioEngine::GetBusVolume(const char* busName)
+{
+    float volume = 0.0f;
+    if (FMOD::ChannelGroup* bus = FindBus(busName))
+        ERRCHECK(bus->getVolume(&volume));
+    return volume;
+}
+
+void AudioEngine::SetBusMute(const char* busName, bool mute)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetBusMute, busName, mute);
+
+    if (FMOD::ChannelGroup* bus = FindBus(busName))
+        ERRCHECK(bus->setMute(mute));
+}
+
+bool AudioEngine::IsBusMuted(const char* busName)
+{
+    bool mute = false;
+    if (FMOD::ChannelGroup* bus = FindBus(busName))
+        ERRCHECK(bus->getMute(&mute));
+    return mute;
+}
+
+void AudioEngine::SetBusPaused(const char* busName, bool paused)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetBusPaused, busName, paused);
+
+    if (FMOD::ChannelGroup* bus = FindBus(busName))
+        ERRCHECK(bus->setPaused(paused));
+}
+
+bool AudioEngine::IsBusPaused(const char* busName)
+{
+    bool paused = false;
+    if (FMOD::ChannelGroup* bus = FindBus(busName))
+        ERRCHECK(bus->getPaused(&paused));
+    return paused;
+}
+
+void AudioEngine::SetBusPitch(const char* busName, float pitch)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetBusPitch, busName, pitch);
+
+    if (FMOD::ChannelGroup* bus = FindBus(busName))
+        ERRCHECK(bus->setPitch(pitch));
+}
+
 // Private definitions 
 bool AudioEngine::IsLoaded(AudioData audioData) 
 {
@@ -269,12 +1185,537 @@ void AudioEngine::Set3DChannelPosition(AudioData audioData, FMOD::Channel* chann
     ERRCHECK(channel->set3DAttributes(&position, &velocity));
 }
 
+FMOD::Channel* AudioEngine::StartChannel(const AudioData& audioData)
+{
+    FMOD::Channel* channel;
+    // start play in 'paused' state
+    ERRCHECK(lowLevelSystem->playSound(sounds[audioData.GetUniqueID()], FindBus(audioData.GetBus()), true /* start paused */, &channel));
+
+    if (audioData.Is3D())
+    {
+        Set3DChannelPosition(audioData, channel);
+    }
+
+    channel->setVolume(audioData.GetVolume());
+    if (audioData.GetPitch() != 1.0f)
+        ERRCHECK(channel->setPitch(audioData.GetPitch()));
+
+    if (audioData.GetReverbAmount() > 0.0f)
+        InitializeReverb();
+    ERRCHECK(channel->setReverbProperties(0, audioData.GetReverbAmount()));
+
+    if (audioData.Is3D() && audioData.UsesHrtf() && hrirSet)
+        AttachHrtf(channel);
+
+    // start audio playback
+    ERRCHECK(channel->setPaused(false));
+    return channel;
+}
+
+float AudioEngine::GetAudibleRadius(const AudioData& audioData) const
+{
+    return AudibilityCuller::GetAudibleRadius(audioData.GetVolume(), MIN_3D_DISTANCE * DISTANCEFACTOR,
+                                              audioData.GetMaxDistance() * DISTANCEFACTOR, cullVolumeThreshold);
+}
+
+bool AudioEngine::IsAudible(const AudioData& audioData) const
+{
+    const Vector3 position = audioData.GetPosition();
+    return AudibilityCuller::IsAudible(listenerPositions, listenerCount,
+                                       Vector3(position.x * DISTANCEFACTOR, position.y * DISTANCEFACTOR, position.z * DISTANCEFACTOR),
+                                       GetAudibleRadius(audioData));
+}
+
+const AudioEngine::Listener& AudioEngine::FindNearestListener(const FMOD_VECTOR& position, float& distanceSquared) const
+{
+    return listeners[AudibilityCuller::FindNearestListener(listenerPositions, listenerCount,
+                                                            Vector3(position.x, position.y, position.z), distanceSquared)];
+}
+
+void AudioEngine::CullLoops()
+{
+    culler.Clear();
+    culledLoopIDs.clear();
+    for (const auto& loop : loopsPlaying)
+    {
+        const AudioData& audioData = loop.second.audioData;
+        if (!audioData.Is3D())
+            continue;
+
+        const Vector3 position = audioData.GetPosition();
+        culler.Add(Vector3(position.x * DISTANCEFACTOR, position.y * DISTANCEFACTOR, position.z * DISTANCEFACTOR),
+                   GetAudibleRadius(audioData));
+        culledLoopIDs.push_back(loop.first);
+    }
+
+    culler.Test(listenerPositions, listenerCount, audibleLoops);
+
+    for (size_t i = 0; i < culledLoopIDs.size(); ++i)
+    {
+        PlayingLoop& loop = loopsPlaying[culledLoopIDs[i]];
+        if (audibleLoops[i] && !loop.channel)
+        {
+            loop.channel = StartChannel(loop.audioData);
+            ERRCHECK(loop.channel->setPosition(loop.positionMS, FMOD_TIMEUNIT_MS));
+            playbackLimiter.SetChannel(loop.voice, loop.channel);
+            TrackLimitedChannel(loop.channel, loop.voice);
+            ++stats.loopsResumed;
+        }
+        else if (!audibleLoops[i] && loop.channel)
+        {
+            // Remember where the loop was so it resumes in place rather than restarting
+            ERRCHECK(loop.channel->getPosition(&loop.positionMS, FMOD_TIMEUNIT_MS));
+
+            // The loop keeps its voice while virtual, so stopping the channel mustn't release it
+            ERRCHECK(loop.channel->setUserData(nullptr));
+            playbackLimiter.SetChannel(loop.voice, nullptr);
+            ERRCHECK(loop.channel->stop());
+            loop.channel = nullptr;
+            ++stats.loopsVirtualized;
+        }
+    }
+}
+
+void AudioEngine::AddDucking(const char* triggerBusName, const char* targetBusName, DuckingSettings settings)
+{
+    if (recorder)
+        recorder->Record(EngineCall::AddDucking, triggerBusName, targetBusName, settings);
+
+    const auto key = std::make_pair(std::string(triggerBusName), std::string(targetBusName));
+    auto existing = duckers.find(key);
+    if (existing != duckers.end())
+    {
+        existing->second->SetSettings(settings);
+        return;
+    }
+
+    FMOD::ChannelGroup* triggerBus = FindBus(triggerBusName);
+    FMOD::ChannelGroup* targetBus = FindBus(targetBusName);
+    if (!triggerBus || !targetBus)
+        return;
+
+    auto& detector = duckingDetectors[triggerBusName];
+    if (!detector)
+    {
+        detector = std::make_unique<SidechainDetector>();
+        detector->Attach(lowLevelSystem, triggerBus);
+    }
+
+    auto ducker = std::make_unique<Ducker>(*detector, settings);
+    ducker->Attach(lowLevelSystem, targetBus);
+    duckers.insert({ key, std::move(ducker) });
+}
+
+void AudioEngine::RemoveDucking(const char* triggerBusName, const char* targetBusName)
+{
+    if (recorder)
+        recorder->Record(EngineCall::RemoveDucking, triggerBusName, targetBusName);
+
+    const std::string trigger(triggerBusName);
+    if (duckers.erase(std::make_pair(trigger, std::string(targetBusName))) == 0)
+    {
+        std::cout << "Audio Engine: Bus " << targetBusName << " is not ducked by " << triggerBusName << "!\n";
+        return;
+    }
+
+    // Duckers are keyed trigger first, so any still following this trigger sort right after it.
+    // Once none do, the detector is removed from the trigger bus rather than left costing mixer time.
+    auto remaining = duckers.lower_bound(std::make_pair(trigger, std::string()));
+    if (remaining == duckers.end() || remaining->first.first != trigger)
+        duckingDetectors.erase(trigger);
+}
+
+float AudioEngine::GetDuckingAttenuationdB(const char* triggerBusName, const char* targetBusName)
+{
+    auto it = duckers.find(std::make_pair(std::string(triggerBusName), std::string(targetBusName)));
+    return it != duckers.end() ? it->second->GetAttenuationdB() : 0.0f;
+}
+
+void AudioEngine::AddBusEffect(const char* busName, EngineEffect effect)
+{
+    if (recorder)
+        recorder->Record(EngineCall::AddBusEffect, busName, effect);
+
+    const auto key = std::make_pair(std::string(busName), effect);
+    if (busEffects.count(key))
+    {
+        std::cout << "Audio Engine: Bus " << busName << " already has this effect!\n";
+        return;
+    }
+
+    FMOD::ChannelGroup* bus = FindBus(busName);
+    if (!bus)
+        return;
+
+    RegisterEffects();
+
+    FMOD::DSP* dsp = nullptr;
+    ERRCHECK(lowLevelSystem->createDSPByPlugin(effectHandles[static_cast<int>(effect)], &dsp));
+    ERRCHECK(bus->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, dsp));
+    busEffects.insert({ key, dsp });
+}
+
+void AudioEngine::RemoveBusEffect(const char* busName, EngineEffect effect)
+{
+    if (recorder)
+        recorder->Record(EngineCall::RemoveBusEffect, busName, effect);
+
+    auto it = busEffects.find(std::make_pair(std::string(busName), effect));
+    if (it == busEffects.end())
+    {
+        std::cout << "Audio Engine: Can't remove an effect that is not on bus " << busName << "!\n";
+        return;
+    }
+
+    ERRCHECK(FindBus(busName)->removeDSP(it->second));
+    ERRCHECK(it->second->release());
+    busEffects.erase(it);
+}
+
+void AudioEngine::SetBusEffectParameter(const char* busName, EngineEffect effect, int parameter, float value)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetBusEffectParameter, busName, effect, parameter, value);
+
+    auto it = busEffects.find(std::make_pair(std::string(busName), effect));
+    if (it != busEffects.end())
+        ERRCHECK(it->second->setParameterFloat(parameter, value));
+    else
+        std::cout << "Audio Engine: Can't set parameter of an effect that is not on bus " << busName << "!\n";
+}
+
+void AudioEngine::AddConvolutionReverb(const char* busName, const char* impulsePath, float wetdB, float drydB)
+{
+    if (recorder)
+        recorder->Record(EngineCall::AddConvolutionReverb, busName, impulsePath, wetdB, drydB);
+
+    FMOD::ChannelGroup* bus = FindBus(busName);
+    if (!bus)
+        return;
+
+    // The impulse response can't change under a running DSP, so a replacement gets a new reverb
+    auto reverb = std::make_unique<ConvolutionReverb>();
+    if (!reverb->LoadImpulse(lowLevelSystem, impulsePath, convolutionWorkerThread))
+        return;
+    reverb->SetMix(wetdB, drydB);
+
+    convolutionReverbs.erase(busName);
+    reverb->Attach(lowLevelSystem, bus);
+    std::cout << "Audio Engine: Added convolution reverb " << impulsePath << " (" << reverb->GetStats().impulseLength
+              << " samples) to bus " << busName << '\n';
+    convolutionReverbs.insert({ busName, std::move(reverb) });
+}
+
+void AudioEngine::SetConvolutionReverbMix(const char* busName, float wetdB, float drydB)
+{
+    if (recorder)
+        recorder->Record(EngineCall::SetConvolutionReverbMix, busName, wetdB, drydB);
+
+    auto it = convolutionReverbs.find(busName);
+    if (it != convolutionReverbs.end())
+        it->second->SetMix(wetdB, drydB);
+    else
+        std::cout << "Audio Engine: Bus " << busName << " has no convolution reverb!\n";
+}
+
+void AudioEngine::RemoveConvolutionReverb(const char* busName)
+{
+    if (recorder)
+        recorder->Record(EngineCall::RemoveConvolutionReverb, busName);
+
+    if (convolutionReverbs.erase(busName) == 0)
+        std::cout << "Audio Engine: Bus " << busName << " has no convolution reverb!\n";
+}
+
+ConvolutionReverbStats AudioEngine::GetConvolutionReverbStats(const char* busName)
+{
+    auto it = convolutionReverbs.find(busName);
+    return it != convolutionReverbs.end() ? it->second->GetStats() : ConvolutionReverbStats();
+}
+
+void AudioEngine::AddLoudnessMeter(const char* busName)
+{
+    if (recorder)
+        recorder->Record(EngineCall::AddLoudnessMeter, busName);
+
+    if (loudnessMeters.count(busName))
+    {
+        std::cout << "Audio Engine: Bus " << busName << " is already metered!\n";
+        return;
+    }
+
+    FMOD::ChannelGroup* bus = FindBus(busName);
+    if (!bus)
+        return;
+
+    auto meter = std::make_unique<LoudnessMeter>();
+    meter->Attach(lowLevelSystem, bus);
+    loudnessMeters.insert({ busName, std::move(meter) });
+}
+
+void AudioEngine::RemoveLoudnessMeter(const char* busName)
+{
+    if (recorder)
+        recorder->Record(EngineCall::RemoveLoudnessMeter, busName);
+
+    if (loudnessMeters.erase(busName) == 0)
+        std::cout << "Audio Engine: Bus " << busName << " has no loudness meter!\n";
+}
+
+LoudnessSnapshot AudioEngine::GetLoudness(const char* busName)
+{
+    auto it = loudnessMeters.find(busName);
+    return it != loudnessMeters.end() ? it->second->GetSnapshot() : LoudnessSnapshot();
+}
+
+void AudioEngine::ResetLoudness(const char* busName)
+{
+    if (recorder)
+        recorder->Record(EngineCall::ResetLoudness, busName);
+
+    auto it = loudnessMeters.find(busName);
+    if (it != loudnessMeters.end())
+        it->second->Reset();
+    else
+        std::cout << "Audio Engine: Bus " << busName << " has no loudness meter!\n";
+}
+
+void AudioEngine::LoadLevelGeometry(const char* filePath, const std::map<std::string, OcclusionMaterial>& materials)
+{
+    if (recorder)
+        recorder->Record(EngineCall::LoadLevelGeometry, filePath, materials);
+
+    LevelMesh mesh;
+    if (!LevelMesh::LoadObj(filePath, mesh, materials))
+        return;
+
+    if (!occlusion)
+    {
+        Stopwatch stopwatch;
+        occlusion = std::make_unique<OcclusionSystem>(lowLevelSystem);
+        startupTimings.geometryMS = stopwatch.ElapsedMS();
+    }
+
+    const int triangles = occlusion->AddMesh(mesh);
+    std::cout << "Audio Engine: Loaded " << triangles << " occluding triangles from " << filePath << '\n';
+}
+
+void AudioEngine::UnloadLevelGeometry()
+{
+    if (recorder)
+        recorder->Record(EngineCall::UnloadLevelGeometry);
+
+    if (occlusion)
+        occlusion->Clear();
+}
+
+OcclusionResult AudioEngine::GetOcclusion(AudioData audioData)
+{
+    if (!occlusion)
+        return OcclusionResult();
+
+    const Vector3 position(audioData.GetPosition().x * DISTANCEFACTOR,
+                           audioData.GetPosition().y * DISTANCEFACTOR,
+                           audioData.GetPosition().z * DISTANCEFACTOR);
+    float distanceSquared = 0.0f;
+    const int listener = AudibilityCuller::FindNearestListener(listenerPositions, listenerCount, position, distanceSquared);
+    return occlusion->GetOcclusion(listenerPositions[listener], position);
+}
+
+void AudioEngine::LoadHrtf(const char* filePath)
+{
+    if (recorder)
+        recorder->Record(EngineCall::LoadHrtf, filePath);
+
+    if (hrirSet)
+    {
+        std::cout << "Audio Engine: An HRIR set is already loaded!\n";
+        return;
+    }
+
+    Stopwatch stopwatch;
+    std::unique_ptr<HrirSet> set = std::make_unique<HrirSet>();
+    if (!set->Load(filePath))
+        return;
+
+    // Responses are not resampled, so a mismatched set places sounds slightly off
+    if (set->GetSampleRate() != latency.sampleRate)
+        std::cout << "Audio Engine: HRIR set " << filePath << " is sampled at " << set->GetSampleRate()
+                  << " Hz rather than " << latency.sampleRate << " Hz, directions will be less accurate\n";
+
+    ERRCHECK(lowLevelSystem->registerDSP(HrtfSpatializer::GetDescription(), &hrtfHandle));
+    hrirSet = std::move(set);
+    startupTimings.hrtfMS = stopwatch.ElapsedMS();
+    std::cout << "Audio Engine: Loaded " << hrirSet->GetMeasurementCount() << " HRIR measurements from " << filePath << '\n';
+}
+
+bool AudioEngine::StartRecording(const char* filePath)
+{
+    auto newRecorder = std::make_unique<CommandRecorder>();
+    if (!newRecorder->Open(filePath))
+        return false;
+
+    std::cout << "Audio Engine: Recording engine calls to " << filePath << '\n';
+    recorder = std::move(newRecorder);
+    return true;
+}
+
+void AudioEngine::StopRecording()
+{
+    if (!recorder)
+        return;
+
+    std::cout << "Audio Engine: Recorded " << recorder->GetFrame() << " frames of engine calls\n";
+    recorder.reset();
+}
+
+bool AudioEngine::IsRecording() const
+{
+    return recorder != nullptr;
+}
+
+FMOD::ChannelGroup* AudioEngine::FindBus(const std::string& busName)
+{
+    if (busName.empty())
+        return mastergroup;
+
+    auto it = buses.find(busName);
+    if (it != buses.end())
+        return it->second;
+
+    std::cout << "Audio Engine: Bus " << busName << " does not exist!\n";
+    return nullptr;
+}
+
+void AudioEngine::CheckStreamStarvation()
+{
+    std::vector<FMOD::Sound*> starving;
+    for (const auto& sound : sounds)
+    {
+        FMOD_MODE mode = 0;
+        ERRCHECK(sound.second->getMode(&mode));
+        if (!(mode & FMOD_CREATESTREAM))
+            continue;
+
+        bool isStarving = false;
+        ERRCHECK(sound.second->getOpenState(nullptr, nullptr, &isStarving, nullptr));
+        if (!isStarving)
+            continue;
+
+        starving.push_back(sound.second);
+        if (std::find(starvingStreams.begin(), starvingStreams.end(), sound.second) == starvingStreams.end())
+        {
+            ++stats.streamStarvations;
+            std::cout << "Audio Engine: Stream " << sound.first << " is starving!\n";
+        }
+    }
+    starvingStreams.swap(starving);
+}
+
+void AudioEngine::AttachHrtf(FMOD::Channel* channel)
+{
+    FMOD::DSP* dsp = nullptr;
+    ERRCHECK(lowLevelSystem->createDSPByPlugin(hrtfHandle, &dsp));
+    ERRCHECK(dsp->setUserData(hrirSet.get()));
+
+    // Point the spatializer at the sound before its first block, and start it in the tier it
+    // would be ranked into if it were the farthest sound
+    FMOD_VECTOR position;
+    ERRCHECK(channel->get3DAttributes(&position, nullptr));
+    float azimuth = 0.0f, elevation = 0.0f, distanceSquared = 0.0f;
+    const Listener& listener = FindNearestListener(position, distanceSquared);
+    HrtfSpatializer::GetDirection(listener.position, listener.forward, listener.up, position, azimuth, elevation);
+    const HrtfQuality quality = GetHrtfQuality(static_cast<int>(hrtfEmitters.size()));
+    ERRCHECK(dsp->setParameterFloat(HRTF_AZIMUTH, azimuth));
+    ERRCHECK(dsp->setParameterFloat(HRTF_ELEVATION, elevation));
+    ERRCHECK(dsp->setParameterFloat(HRTF_QUALITY, static_cast<float>(quality)));
+
+    // Panning is left to the spatializer; FMOD's 3D attenuation still applies
+    ERRCHECK(channel->set3DLevel(0.0f));
+    ERRCHECK(channel->addDSP(FMOD_CHANNELCONTROL_DSP_TAIL, dsp));
+
+    HrtfEmitter emitter;
+    emitter.channel = channel;
+    emitter.dsp = dsp;
+    hrtfEmitters.push_back(emitter);
+}
+
+void AudioEngine::UpdateHrtf()
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < hrtfEmitters.size(); ++i)
+    {
+        HrtfEmitter emitter = hrtfEmitters[i];
+
+        // A finished or stolen channel reports an invalid handle rather than playing
+        bool playing = false;
+        emitter.channel->isPlaying(&playing);
+        if (!playing)
+        {
+            emitter.channel->removeDSP(emitter.dsp); // fails harmlessly if the channel has already stopped
+            ERRCHECK(emitter.dsp->release());
+            continue;
+        }
+
+        FMOD_VECTOR position;
+        ERRCHECK(emitter.channel->get3DAttributes(&position, nullptr));
+        // Rendered, and ranked for quality, from the nearest listener
+        float azimuth = 0.0f, elevation = 0.0f;
+        const Listener& listener = FindNearestListener(position, emitter.distanceSquared);
+        HrtfSpatializer::GetDirection(listener.position, listener.forward, listener.up, position, azimuth, elevation);
+        ERRCHECK(emitter.dsp->setParameterFloat(HRTF_AZIMUTH, azimuth));
+        ERRCHECK(emitter.dsp->setParameterFloat(HRTF_ELEVATION, elevation));
+        hrtfEmitters[kept++] = emitter;
+    }
+    hrtfEmitters.resize(kept);
+
+    // Closest sounds get the most accurate rendering
+    std::sort(hrtfEmitters.begin(), hrtfEmitters.end(),
+              [](const HrtfEmitter& a, const HrtfEmitter& b) { return a.distanceSquared < b.distanceSquared; });
+    for (size_t i = 0; i < hrtfEmitters.size(); ++i)
+        ERRCHECK(hrtfEmitters[i].dsp->setParameterFloat(HRTF_QUALITY, static_cast<float>(GetHrtfQuality(static_cast<int>(i)))));
+}
+
+HrtfQuality AudioEngine::GetHrtfQuality(int rank) const
+{
+    if (rank < hrtfHighQualityEmitters)
+        return HrtfQuality::High;
+    if (rank < hrtfHighQualityEmitters + hrtfMediumQualityEmitters)
+        return HrtfQuality::Medium;
+    return HrtfQuality::Low;
+}
+
 void AudioEngine::InitializeReverb() 
 {
+    if (reverb)
+        return;
+
+    Stopwatch stopwatch;
     ERRCHECK(lowLevelSystem->createReverb3D(&reverb));
     FMOD_REVERB_PROPERTIES prop2 = FMOD_PRESET_CONCERTHALL;
     ERRCHECK(reverb->setProperties(&prop2));
     ERRCHECK(reverb->set3DAttributes(&revPos, revMinDist, revMaxDist));
+    startupTimings.reverbMS = stopwatch.ElapsedMS();
+}
+
+void AudioEngine::RegisterEffects()
+{
+    if (effectsRegistered)
+        return;
+
+    Stopwatch stopwatch;
+    EngineEffects::Register(lowLevelSystem, effectHandles);
+    effectsRegistered = true;
+    startupTimings.effectsMS = stopwatch.ElapsedMS();
+}
+
+bool AudioEngine::HasStudio() const
+{
+    if (studioSystem)
+        return true;
+
+    std::cout << "Audio Engine: FMOD Studio is disabled in the engine settings!\n";
+    return false;
 }
 
 // Error checking/debugging function definitions
@@ -13,13 +13,36 @@
 #include <FMOD/fmod_studio.hpp>
 #include <FMOD/fmod.hpp>
 
+#include <atomic>
+#include <future>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <list>
 #include <map>
+#include <memory>
+#include <unordered_map>
 
+#include "Source/Codec/AdpcmCodec.h"
 #include "Source/Data/AudioData.h"
+#include "Source/Data/AudioEngineSettings.h"
+#include "Source/Data/AudioEngineStats.h"
+#include "Source/Data/EventIndex.h"
+#include "Source/Data/EventParameterBatch.h"
+#include "Source/Data/PlaybackLimiter.h"
+#include "Source/Data/SoundContainer.h"
+#include "Source/Data/SoundManifest.h"
+#include "Source/DSP/ConvolutionReverb.h"
+#include "Source/DSP/EngineEffects.h"
+#include "Source/DSP/HrirSet.h"
+#include "Source/DSP/HrtfSpatializer.h"
+#include "Source/DSP/LoudnessMeter.h"
+#include "Source/DSP/SidechainDucking.h"
+#include "Source/Output/SharedMemoryOutput.h"
+#include "Source/Spatial/AudibilityCuller.h"
+#include "Source/Spatial/OcclusionSystem.h"
+#include "Source/Tools/CommandRecorder.h"
+#include "Source/Tools/MixerTelemetry.h"
 
 /**
  * Error Handling Function for FMOD Errors
@@ -31,7 +54,9 @@ void ERRCHECK_fn(FMOD_RESULT result, const char* file, int line);
 /**
  * Class that handles the process of loading and playing sounds by wrapping FMOD's functionality.
  * Deals with all FMOD calls so that FMOD-specific code does not need to be used outside this class.
- * Only one AudioEngine should be constructed for an application.
+ * Up to MAX_INSTANCES engines can run side by side, e.g. one per session on a rendering server, each
+ * with its own FMOD systems, listeners, buses and stats. An engine is not itself thread-safe, so each
+ * must only be called from one thread at a time. The FMOD allocator (AudioMemory) is shared by all.
  */
 class AudioEngine 
 {
@@ -44,8 +69,49 @@ public:
 
     /**
      * Initializes Audio Engine Studio and Core systems to default values. 
+     * The reverb and the engine DSP effects are created on first use rather than here,
+     * and the time spent in each phase is recorded in GetStartupTimings().
      */
-    void Init();
+    void Init(const AudioEngineSettings& settings = AudioEngineSettings());
+
+    /**
+     * Runs Init() on a background thread so it overlaps the rest of application startup.
+     * No other engine method may be called until the returned future is ready or IsReady()
+     * returns true, apart from Update(), which does nothing until then.
+     * The settings, including the strings they point to, are copied before this returns.
+     */
+    std::shared_future<void> InitAsync(const AudioEngineSettings& settings = AudioEngineSettings());
+
+    /**
+     * Returns true once Init() has completed.
+     */
+    bool IsReady() const;
+
+    /**
+     * Returns the number of engines in the process which hold FMOD systems, i.e. are between Init() and Terminate().
+     */
+    static int GetInstanceCount();
+
+    /**
+     * Returns how long each startup phase took.
+     */
+    const AudioEngineStartupTimings& GetStartupTimings() const;
+
+    /**
+     * Returns the mixer buffering in effect and how the mixer thread is keeping up with it.
+     * The measured values fill in once the mixer has run for a while with mixer telemetry on.
+     */
+    LatencyReport GetLatencyReport() const;
+
+    /**
+     * Returns the engine's running counters.
+     */
+    AudioEngineStats GetStats() const;
+
+    /**
+     * Zeroes the engine's running counters.
+     */
+    void ResetStats();
 
     /**
      * Halts the engine instance and frees all held memory.
@@ -57,6 +123,13 @@ public:
     */
     void Update();
     
+    /**
+     * Returns the AudioData defined for a sound in the manifest loaded at Init.
+     * If the sound is not defined, a console message is displayed and the returned
+     * AudioData has an invalid ID.
+     */
+    AudioData GetAudioData(SoundId id);
+
     /**
      * Loads a sound from disk using provided settings
      * Prepares for later playback with Play()
@@ -65,11 +138,56 @@ public:
      */
     void Load(AudioData audioData);
 
+    /**
+     * Checks if a sound file is in the soundCache
+     */
+    bool IsLoaded(AudioData audioData);
+
+    /**
+     * Releases a loaded sound, stopping every channel that plays it and forgetting its loop.
+     */
+    void Unload(AudioData audioData);
+
     /**
     * Plays a sound file using FMOD's low level audio system. If the sound file has not been
     * previously loaded using Load(), a console message is displayed.
+    * 3D one-shots out of earshot of the listener are skipped, and 3D loops out of earshot play
+    * virtually, without a channel, until Update() finds them audible again.
     */
     void Play(AudioData audioData);
+
+    /**
+     * Loads every variant of a sound container together, so no pick waits on a file,
+     * and keeps the container for PlayContainer().
+     */
+    void LoadContainer(const SoundContainer& container);
+
+    /**
+     * Unloads a container, and the variants it loaded once no other loaded container uses them.
+     * Variants which were loaded before any container loaded them stay loaded.
+     */
+    void UnloadContainer(SoundId id);
+
+    /**
+     * Picks a variant of a loaded container and plays it with Play(), its pitch and volume
+     * scaled by random amounts from the container's ranges.
+     * @param position - where to play a 3D variant, e.g. the foot that landed
+     */
+    void PlayContainer(SoundId id);
+    void PlayContainer(SoundId id, const Vector3& position);
+
+    /**
+     * Limits how many channels of a sound play at once and how soon it can be retriggered.
+     * Plays over the limit are dropped or stop an older channel, per the limit's behavior,
+     * and are counted in AudioEngineStats::limits. Calling this again replaces the limit.
+     */
+    void SetSoundLimit(SoundId id, const PlaybackLimit& limit);
+
+    /**
+     * Limits the channels of every sound routed through a bus together, e.g. all impacts on "SFX".
+     * A play must be within both its sound's and its bus's limits.
+     */
+    void SetBusLimit(const char* busName, const PlaybackLimit& limit);
     
     /**
      * Stops a looping sound if it's currently playing.
@@ -100,14 +218,24 @@ public:
    
 
     /**
-     * Sets the position of the listener in the 3D scene.
+     * Sets the position of a listener in the 3D scene.
      * @param posX, posY, posZ - 3D translation of listener
      * @param forwardX, forwardY, forwardZ - forward angle character is looking in
      * @param upX, upY, upZ - up which must be perpendicular to forward vector
+     * @param listener - index of the listener, below GetListenerCount()
      */
     void Set3DListenerPosition(float posX,     float posY,     float posZ,
                                float forwardX, float forwardY, float forwardZ,
-                               float upX,      float upY,      float upZ);
+                               float upX,      float upY,      float upZ,
+                               int listener = 0);
+
+    /**
+     * Sets how many 3D listeners there are, e.g. one per split-screen player, up to MAX_LISTENERS.
+     * Each sound plays once, heard from its nearest listener; distance culling and HRTF quality
+     * ranking also go by the nearest listener, so extra listeners don't multiply channel use.
+     */
+    void SetListenerCount(int count);
+    int GetListenerCount() const { return listenerCount; }
 
     /**
     * Utility method that returns the length of a AudioData's audio file in milliseconds
@@ -116,7 +244,9 @@ public:
     unsigned int GetLengthMS(AudioData audioData);
 
     /**
-     * Loads an FMOD Studio soundbank 
+     * Loads an FMOD Studio soundbank and adds its events to the event index, so they can be found
+     * by hashed path or GUID without Studio parsing the path. Load the bank's strings bank first
+     * to index events by path; otherwise they are indexed by GUID only.
      * TODO Fix
      */
     void LoadBank(const char* filePath);
@@ -124,6 +254,8 @@ public:
     /**
      * Loads an FMOD Studio Event. The Soundbank that this event is in must have been loaded before
      * calling this method.
+     * @param eventName - event path ("event:/UI/Click") or GUID ("{...}"). Later calls identify
+     *                    the event by EventId::FromPath(eventName).
      * TODO Fix
      */
     void LoadEvent(const char* eventName, std::vector<std::pair<const char*, float>> paramsValues = { });
@@ -131,6 +263,7 @@ public:
     /**
      * Sets the parameter of an FMOD Soundbank Event Instance.
      */
+    void SetEventParamValue(EventId eventId, const char* parameterName, float value);
     void SetEventParamValue(const char* eventName, const char* parameterName, float value);
     
     /**
@@ -138,24 +271,57 @@ public:
      * TODO support playback of multiple event instances
      * TODO Fix playback
      */
+    void PlayEvent(EventId eventId, int instanceIndex = 0);
     void PlayEvent(const char* eventName, int instanceIndex = 0);
     
     /**
      * Stops the specified instance of an event, if it is playing.
      */
+    void StopEvent(EventId eventId, int instanceIndex = 0);
     void StopEvent(const char* eventName, int instanceIndex = 0);
  
     /**
      * Sets the volume of an event.
      * @param normalizedVolume - volume of the event, from 0 (min vol) to 1 (max vol)
      */
+    void SetEventVolume(EventId eventId, float normalizedVolume = 0.75f);
     void SetEventVolume(const char* eventName, float normalizedVolume = 0.75f);
 
     /**
      * Checks if an event is playing.
      */
+    bool IsPlaying(EventId eventId, int instance = 0);
     bool IsPlaying(const char* eventName, int instance = 0);
 
+    /**
+     * Creates an instance of an event in a loaded soundbank, e.g. one per vehicle, whose
+     * parameters are driven with SetEventParameters().
+     * @return an invalid handle if the event isn't in a loaded bank
+     */
+    EventInstanceHandle CreateEventInstance(EventId eventId);
+
+    /**
+     * Stops an instance, letting it fade out, and releases it. The handle may be reused.
+     */
+    void ReleaseEventInstance(EventInstanceHandle instance);
+
+    void PlayEvent(EventInstanceHandle instance);
+    void StopEvent(EventInstanceHandle instance);
+
+    /**
+     * Returns the handle of a parameter of an event, for SetEventParameters().
+     * Look handles up once, e.g. after loading the bank, not every frame.
+     * @return an invalid handle if the event or parameter doesn't exist
+     */
+    EventParameterHandle GetEventParameterHandle(EventId eventId, const char* parameterName);
+
+    /**
+     * Queues parameter writes to event instances. They are applied in the next Update(): the last
+     * write to each parameter wins, values that didn't change are skipped, and each instance's
+     * parameters are set with one FMOD call. See AudioEngineStats::parameters for the savings.
+     */
+    void SetEventParameters(const std::vector<EventParameterWrite>& writes);
+
     /**
      * Mutes all sounds.
      */
@@ -171,15 +337,206 @@ public:
      */
 	bool IsMute();
 
-    // The audio sampling rate of the audio engine
-    static const int AUDIO_SAMPLE_RATE = 44100;
+    /**
+     * Creates a named mixer bus that sounds can be routed through with AudioData::SetBus().
+     * Each bus is an FMOD::ChannelGroup, so volume, mute, pause and pitch changes apply to
+     * every channel on the bus (and its sub-buses) with a single FMOD call.
+     * @param busName - unique name of the new bus
+     * @param parentBusName - bus to nest the new bus under, or nullptr to route into the master group
+     */
+    void CreateBus(const char* busName, const char* parentBusName = nullptr);
 
-private:  
+    /**
+     * Sets the volume of a bus.
+     * @param volume - linear volume, 0 (silent) to 1 (full volume)
+     */
+    void SetBusVolume(const char* busName, float volume);
 
     /**
-     * Checks if a sound file is in the soundCache
+     * Returns the volume of a bus, or 0 if the bus does not exist.
      */
-    bool IsLoaded(AudioData audioData);
+    float GetBusVolume(const char* busName);
+
+    /**
+     * Mutes or unmutes every sound routed through a bus.
+     */
+    void SetBusMute(const char* busName, bool mute);
+
+    /**
+     * Returns true if the bus is muted, false if not.
+     */
+    bool IsBusMuted(const char* busName);
+
+    /**
+     * Pauses or resumes every sound routed through a bus.
+     */
+    void SetBusPaused(const char* busName, bool paused);
+
+    /**
+     * Returns true if the bus is paused, false if not.
+     */
+    bool IsBusPaused(const char* busName);
+
+    /**
+     * Sets the pitch of a bus, which scales the pitch of every sound routed through it.
+     * @param pitch - pitch multiplier, 1 being the original pitch
+     */
+    void SetBusPitch(const char* busName, float pitch);
+
+    /**
+     * Ducks a target bus whenever a trigger bus is active, e.g. Music and SFX under Voice.
+     * The trigger level is followed and the attenuation applied on FMOD's mixer thread, so
+     * ducking responds within one DSP block and needs no per-frame calls from game code.
+     * Calling this again for the same pair of buses updates its settings.
+     * @param triggerBusName - bus whose level drives the ducking
+     * @param targetBusName - bus which is attenuated
+     */
+    void AddDucking(const char* triggerBusName, const char* targetBusName, DuckingSettings settings = DuckingSettings());
+
+    /**
+     * Stops a target bus from being ducked by a trigger bus.
+     */
+    void RemoveDucking(const char* triggerBusName, const char* targetBusName);
+
+    /**
+     * Returns the attenuation in decibels currently applied to a target bus by a trigger bus,
+     * or 0 if the pair has no ducking.
+     */
+    float GetDuckingAttenuationdB(const char* triggerBusName, const char* targetBusName);
+
+    /**
+     * Inserts one of the engine's DSP effects at the output of a bus. A bus holds at most
+     * one instance of each effect.
+     */
+    void AddBusEffect(const char* busName, EngineEffect effect);
+
+    /**
+     * Removes an engine DSP effect from a bus.
+     */
+    void RemoveBusEffect(const char* busName, EngineEffect effect);
+
+    /**
+     * Sets a parameter of an engine DSP effect on a bus.
+     * @param parameter - index from the effect's parameter enum, e.g. BIQUADEQ_LOW_GAIN
+     */
+    void SetBusEffectParameter(const char* busName, EngineEffect effect, int parameter, float value);
+
+    /**
+     * Adds a convolution reverb to the output of a bus, which reverberates the bus with a recorded
+     * impulse response (any mono or stereo audio file FMOD can decode). The long tail of the response
+     * is convolved on a worker thread, so responses of several seconds are affordable.
+     * Calling this again for the same bus replaces the impulse response.
+     * @param wetdB, drydB - levels of the reverberated and untouched signal
+     */
+    void AddConvolutionReverb(const char* busName, const char* impulsePath, float wetdB = -6.0f, float drydB = 0.0f);
+
+    /**
+     * Sets the wet and dry levels of a bus's convolution reverb.
+     */
+    void SetConvolutionReverbMix(const char* busName, float wetdB, float drydB);
+
+    /**
+     * Removes the convolution reverb from a bus.
+     */
+    void RemoveConvolutionReverb(const char* busName);
+
+    /**
+     * Returns the cost and deadline misses of a bus's convolution reverb.
+     */
+    ConvolutionReverbStats GetConvolutionReverbStats(const char* busName);
+
+    /**
+     * Starts metering the loudness (EBU R128) of a bus's output. Pass "" to meter the master bus.
+     */
+    void AddLoudnessMeter(const char* busName);
+
+    /**
+     * Stops metering a bus.
+     */
+    void RemoveLoudnessMeter(const char* busName);
+
+    /**
+     * Returns the latest loudness of a metered bus. Safe to call from any thread while the meter
+     * exists; measurements are refreshed every 100ms by the mixer.
+     */
+    LoudnessSnapshot GetLoudness(const char* busName);
+
+    /**
+     * Restarts a bus's integrated loudness and true peak, e.g. at the start of a level or cutscene.
+     */
+    void ResetLoudness(const char* busName);
+
+    /**
+     * Imports a simplified level mesh (.obj) whose walls occlude 3D sounds. Geometry near the
+     * listener is streamed into FMOD during Update(). Can be called again to add more meshes.
+     * @param materials - occlusion of each OBJ material name; other faces block sound fully
+     */
+    void LoadLevelGeometry(const char* filePath, const std::map<std::string, OcclusionMaterial>& materials = { });
+
+    /**
+     * Removes all level geometry, so sounds are no longer occluded.
+     */
+    void UnloadLevelGeometry();
+
+    /**
+     * Returns how much level geometry blocks a sound's position from the listener.
+     */
+    OcclusionResult GetOcclusion(AudioData audioData);
+
+    /**
+     * Loads an HRIR set (a JSON export of a SOFA file, see HrirSet.h) for binaural spatialization.
+     * From then on 3D sounds with AudioData::SetHrtf() are rendered through the HRTF spatializer
+     * instead of FMOD's panner; distance attenuation, occlusion and reverb still apply.
+     * Only one set can be loaded per Init().
+     */
+    void LoadHrtf(const char* filePath);
+
+    /**
+     * Starts logging every state-changing engine call, with its arguments, to a command log that
+     * CommandReplayer can play back. Start right after Init() so the log holds every sound, bus
+     * and effect its later calls depend on. Replaces any recording in progress.
+     * @return false if the log file can't be created
+     */
+    bool StartRecording(const char* filePath);
+
+    /**
+     * Finishes the command log. Also done by Terminate().
+     */
+    void StopRecording();
+
+    /**
+     * Returns true while engine calls are being recorded
+     */
+    bool IsRecording() const;
+
+    // Most engines which can be initialized at once; FMOD allows this many systems per process
+    static const int MAX_INSTANCES = FMOD_MAX_SYSTEMS;
+
+    // Most 3D listeners FMOD supports
+    static const int MAX_LISTENERS = FMOD_MAX_LISTENERS;
+
+    // Default buses created during Init()
+    static constexpr const char* BUS_MUSIC = "Music";
+    static constexpr const char* BUS_SFX   = "SFX";
+    static constexpr const char* BUS_VOICE = "Voice";
+    static constexpr const char* BUS_UI    = "UI";
+
+private:  
+
+    /*
+     * Orientation of a 3D listener
+     */
+    struct Listener
+    {
+        // Listener head position, initialized to default value
+        FMOD_VECTOR position    = { 0.0f, 0.0f, -1.0f };
+
+        // Listener forward vector, initialized to default value
+        FMOD_VECTOR forward     = { 0.0f, 0.0f, 1.0f };
+
+        // Listener upwards vector, initialized to default value
+        FMOD_VECTOR up          = { 0.0f, 1.0f, 0.0f };
+    };
 
     /**
      * Sets the 3D position of a sound
@@ -187,41 +544,181 @@ private:
     void Set3DChannelPosition(AudioData audioData, FMOD::Channel* channel);
 
     /**
-     * Initializes the reverb effect
+     * Plays a loaded sound on a new channel and returns the channel
+     */
+    FMOD::Channel* StartChannel(const AudioData& audioData);
+
+    /**
+     * Picks the next variant of a loaded container, with its randomized pitch and volume applied.
+     * Returns false and prints a console message if the container isn't loaded.
+     */
+    bool SelectVariant(SoundId id, AudioData& variant);
+
+    /**
+     * Checks a play against its sound's and bus's instance limits, stopping the channels it steals.
+     * Returns false if the limits drop the play.
+     */
+    bool AdmitPlay(const AudioData& audioData, double nowMS, PlaybackTicket& ticket);
+
+    /**
+     * Has a limited channel release its voice when it ends
+     */
+    void TrackLimitedChannel(FMOD::Channel* channel, int voice);
+
+    /**
+     * Releases a limited channel's voice when it ends, finding the engine through the channel's user data
+     */
+    static FMOD_RESULT F_CALL OnChannelEnd(FMOD_CHANNELCONTROL* channelControl, FMOD_CHANNELCONTROL_TYPE controlType,
+                                           FMOD_CHANNELCONTROL_CALLBACK_TYPE callbackType, void* commandData1, void* commandData2);
+
+    /**
+     * Returns the distance within which a 3D sound can be heard
+     */
+    float GetAudibleRadius(const AudioData& audioData) const;
+
+    /**
+     * Returns true if a 3D sound can be heard from the listener
+     */
+    bool IsAudible(const AudioData& audioData) const;
+
+    /**
+     * Returns the listener nearest to a position in FMOD units, and its squared distance.
+     */
+    const Listener& FindNearestListener(const FMOD_VECTOR& position, float& distanceSquared) const;
+
+    /**
+     * Gives channels to virtual loops which came into earshot and takes them from real loops which left it
+     */
+    void CullLoops();
+
+    /**
+     * Places a channel's sound with an HRTF spatializer DSP instead of FMOD's panner
+     */
+    void AttachHrtf(FMOD::Channel* channel);
+
+    /**
+     * Points the HRTF spatializers at their sounds, ranks them by distance into quality tiers
+     * and releases the ones whose channels have stopped
+     */
+    void UpdateHrtf();
+
+    /**
+     * Returns the HRTF quality tier of the sound ranked at a given distance order, 0 being the closest
+     */
+    HrtfQuality GetHrtfQuality(int rank) const;
+
+    /**
+     * Counts the streams which started starving since the previous Update()
+     */
+    void CheckStreamStarvation();
+
+    /**
+     * Creates the reverb effect if it does not exist yet
      */
     void InitializeReverb();
 
+    /**
+     * Registers the engine DSP effects with FMOD if they are not registered yet
+     */
+    void RegisterEffects();
+
+    /**
+     * Returns true if the Studio system was created, otherwise prints a console message
+     */
+    bool HasStudio() const;
+
+    /**
+     * Finds a bus by name. An empty name resolves to the master group.
+     * Returns nullptr and prints a console message if the bus does not exist.
+     */
+    FMOD::ChannelGroup* FindBus(const std::string& busName);
+
     /**
      * Prints debug info about an FMOD event description
      */
     void DebugEventInfo(FMOD::Studio::EventDescription* eventDescription);
 
-    // FMOD Studio API system, which can play FMOD sound banks (*.bank)
+    /**
+     * Returns the description of a loaded or indexed event, or nullptr.
+     */
+    FMOD::Studio::EventDescription* FindEventDescription(EventId eventId);
+
+    /**
+     * Applies the batched event parameter writes.
+     */
+    void ApplyEventParameters();
+
+    // Level geometry occlusion, created by the first LoadLevelGeometry()
+    std::unique_ptr<OcclusionSystem> occlusion;
+
+    // Mixer block timing, created by Init when AudioEngineSettings::mixerTelemetry is set
+    std::unique_ptr<MixerTelemetry> mixerTelemetry;
+
+    // Streams which were starving at the previous Update(), so each starvation is counted once
+    std::vector<FMOD::Sound*> starvingStreams;
+
+    // Sound definitions loaded from a compiled manifest at Init
+    SoundManifest manifest;
+
+    // Set once Init() has completed, possibly on the InitAsync() thread
+    std::atomic<bool> ready { false };
+
+    // Pending or completed InitAsync() call, waited on by Terminate()
+    std::shared_future<void> initFuture;
+
+    // Time spent in each startup phase
+    AudioEngineStartupTimings startupTimings;
+
+    // Latency profile chosen at Init, and the buffering FMOD applied for it
+    LatencyProfile latencyProfile = LatencyProfile::Balanced;
+    LatencySettings latency;
+
+    // FMOD Studio API system, which can play FMOD sound banks (*.bank). nullptr if disabled in AudioEngineSettings
     FMOD::Studio::System* studioSystem = nullptr;       
     
-    // FMOD's low-level audio system which plays audio files and is obtained from Studio System
+    // FMOD's low-level audio system which plays audio files and is obtained from Studio System, or created standalone
     FMOD::System* lowLevelSystem = nullptr;          
 
     // Max FMOD::Channels for the audio engine 
     static const unsigned int MAX_AUDIO_CHANNELS = 255; 
+
+    // Instance limits, with a voice for every channel
+    PlaybackLimiter playbackLimiter { static_cast<int>(MAX_AUDIO_CHANNELS) };
+
+    /*
+     * User data of a limited channel, leading OnChannelEnd() to its engine and voice.
+     * The system user data can't be used for this, as MixerTelemetry takes it over.
+     */
+    struct LimitedChannel
+    {
+        AudioEngine* engine = nullptr;
+        int voice = -1;
+    };
+
+    // Indexed by voice
+    LimitedChannel limitedChannels[MAX_AUDIO_CHANNELS];
+
+    // Parameters set per FMOD call when applying batched event parameter writes
+    static const int EVENT_PARAMETER_BATCH = 32;
+
+    // Distance at which 3D sounds start to attenuate
+    const float MIN_3D_DISTANCE = 0.5f;
     
     // Units per meter.  I.e feet would = 3.28.  centimeters would = 100.
     const float DISTANCEFACTOR = 1.0f;  
  
-    // Listener head position, initialized to default value
-    FMOD_VECTOR listenerPosition = { 0.0f, 0.0f, -1.0f * DISTANCEFACTOR };
-    
-    // Listener forward vector, initialized to default value
-    FMOD_VECTOR forward     = { 0.0f, 0.0f, 1.0f };
-    
-    // Listener upwards vector, initialized to default value
-    FMOD_VECTOR up          = { 0.0f, 1.0f, 0.0f };
+    // Listeners set with Set3DListenerPosition(), of which the first listenerCount are in use
+    Listener listeners[MAX_LISTENERS];
+    int listenerCount = 1;
+
+    // Positions of the listeners in use, kept in step with listeners for the culler and occlusion
+    Vector3 listenerPositions[MAX_LISTENERS];
 
     // Main group for low level system which all sounds go though
     FMOD::ChannelGroup* mastergroup = 0;
 
     // Low-level system reverb TODO add multi-reverb support
-	FMOD::Reverb3D* reverb;
+	FMOD::Reverb3D* reverb = nullptr;
 
 	// Reverb origin position
 	FMOD_VECTOR revPos = { 0.0f, 0.0f, 0.0f };
@@ -232,33 +729,174 @@ private:
     // flag tracking if the Audio Engin is muted
     bool muted = false;
 
+    // Convolution reverb tails run on a worker thread, from Init
+    bool convolutionWorkerThread = true;
+
+    // Distance culling settings from Init
+    bool distanceCulling = true;
+    float cullVolumeThreshold = 0.001f;
+
+    // Scratch state for CullLoops(), kept to avoid reallocating every frame
+    AudibilityCuller culler;
+    std::vector<SoundId> culledLoopIDs;
+    std::vector<char> audibleLoops;
+
+    // Running counters returned by GetStats()
+    AudioEngineStats stats;
+
+    // HRIR set loaded with LoadHrtf(), shared by every spatializer DSP through its user data
+    std::unique_ptr<HrirSet> hrirSet;
+
+    // Plugin handle of the HRTF spatializer, registered by LoadHrtf()
+    unsigned int hrtfHandle = 0;
+
+    // Plugin handle of the engine's ADPCM codec, registered by Init()
+    unsigned int adpcmCodecHandle = 0;
+
+    // HRTF quality tier sizes from Init
+    int hrtfHighQualityEmitters = 16;
+    int hrtfMediumQualityEmitters = 32;
+
+    /*
+     * A channel rendered through an HRTF spatializer DSP
+     */
+    struct HrtfEmitter
+    {
+        FMOD::Channel* channel = nullptr;
+        FMOD::DSP* dsp = nullptr;
+        float distanceSquared = 0.0f;
+    };
+
+    // Channels with an HRTF spatializer, ordered by distance from the listener after UpdateHrtf()
+    std::vector<HrtfEmitter> hrtfEmitters;
+
+    /*
+     * A looping sound started with Play(). channel is nullptr while the loop is virtual,
+     * in which case positionMS is where playback resumes.
+     */
+    struct PlayingLoop
+    {
+        FMOD::Channel* channel = nullptr;
+        AudioData audioData;
+        unsigned int positionMS = 0;
+        int voice = -1; // instance limit voice, held while the loop is virtual too
+    };
+
     /*
      * Map which caches FMOD Low-Level sounds
-     * Key is the AudioData's uniqueKey field.
+     * Key is the AudioData's hashed uniqueID.
      * Value is the FMOD::Sound* to be played back.
-     * TODO Refactor to use numeric UID as key
      */
-    std::map<std::string, FMOD::Sound*> sounds;
+    std::map<SoundId, FMOD::Sound*> sounds;
+
+    /*
+     * Map which stores the containers loaded with LoadContainer(), and where each is in its sequence
+     * Key is the container's hashed uniqueID.
+     */
+    std::map<SoundId, SoundContainer> containers;
+
+    /*
+     * Variants of the loaded containers
+     */
+    struct ContainerVariant
+    {
+        int containers = 0;             // loaded containers using the variant
+        bool loadedByContainer = false; // unloaded with the last of them, rather than left to its owner
+    };
+
+    /*
+     * Map which stores the variants of the loaded containers
+     * Key is the variant's hashed uniqueID.
+     */
+    std::map<SoundId, ContainerVariant> containerVariants;
+
+    /*
+     * Map which stores the current playback state of any playing sound loop
+     * Key is the AudioData's hashed uniqueID.
+     * Value is the channel the FMOD::Sound* is playing back on and the settings it was played with.
+     */
+    std::map<SoundId, PlayingLoop> loopsPlaying;
+
+    /*
+     * Map which stores the mixer buses created with CreateBus()
+     * Key is the bus name.
+     * Value is the FMOD::ChannelGroup* the bus mixes through.
+     */
+    std::map<std::string, FMOD::ChannelGroup*> buses;
 
     /*
-     * Map which stores the current playback channels of any playing sound loop
-     * Key is the AudioData's uniqueKey field.
-     * Value is the FMOD::Channel* the FMOD::Sound* is playing back on.
+     * Map which stores the level detectors placed on trigger buses by AddDucking()
+     * and removed by RemoveDucking() once no ducker follows them.
+     * Key is the trigger bus name.
      */
-    std::map<std::string, FMOD::Channel*> loopsPlaying;
+    std::map<std::string, std::unique_ptr<SidechainDetector>> duckingDetectors;
+
+    /*
+     * Map which stores the duckers placed on target buses by AddDucking()
+     * Key is the (trigger bus name, target bus name) pair.
+     */
+    std::map<std::pair<std::string, std::string>, std::unique_ptr<Ducker>> duckers;
+
+    // Plugin handles of the engine DSP effects, indexed by EngineEffect
+    unsigned int effectHandles[static_cast<int>(EngineEffect::Count)] = { };
+
+    // flag tracking if the engine DSP effects have been registered
+    bool effectsRegistered = false;
+
+    /*
+     * Map which stores the engine DSP effects added with AddBusEffect()
+     * Key is the (bus name, effect) pair.
+     */
+    std::map<std::pair<std::string, EngineEffect>, FMOD::DSP*> busEffects;
+
+    /*
+     * Map which stores the convolution reverbs added with AddConvolutionReverb()
+     * Key is the bus name.
+     */
+    std::map<std::string, std::unique_ptr<ConvolutionReverb>> convolutionReverbs;
+
+    /*
+     * Map which stores the loudness meters added with AddLoudnessMeter()
+     * Key is the bus name, "" for the master bus.
+     */
+    std::map<std::string, std::unique_ptr<LoudnessMeter>> loudnessMeters;
+
+    // Command log written while recording, nullptr otherwise
+    std::unique_ptr<CommandRecorder> recorder;
 
     /*
      * Map which stores the soundbanks loaded with loadFMODStudioBank()
      */
     std::map<std::string, FMOD::Studio::Bank*> soundBanks;
     
+    // Every event in the loaded soundbanks, by hashed path and GUID
+    EventIndex eventIndex;
+
     /*
      * Map which stores event descriptions created during loadFMODStudioEvent()
+     * Key is the hashed event name.
      */
-    std::map<std::string, FMOD::Studio::EventDescription*> eventDescriptions;
+    std::unordered_map<EventId, FMOD::Studio::EventDescription*> eventDescriptions;
     
     /*
      * Map which stores event instances created during loadFMODStudioEvent()
+     * Key is the hashed event name.
      */
-    std::map<std::string, FMOD::Studio::EventInstance*> eventInstances;
+    std::unordered_map<EventId, FMOD::Studio::EventInstance*> eventInstances;
+
+    // Instances created with CreateEventInstance(), indexed by handle; nullptr once released
+    std::vector<FMOD::Studio::EventInstance*> handleInstances;
+
+    // Event of each instance in handleInstances, so writes can be matched against parameterEvents
+    std::vector<FMOD::Studio::EventDescription*> handleEvents;
+
+    // Parameter IDs indexed by EventParameterHandle, and the handle of each (event, hashed name) pair
+    std::vector<FMOD_STUDIO_PARAMETER_ID> parameterIds;
+
+    // Event each parameter in parameterIds belongs to; IDs are only meaningful on that event's instances
+    std::vector<FMOD::Studio::EventDescription*> parameterEvents;
+    std::map<std::pair<EventId, uint64_t>, EventParameterHandle> parameterHandles;
+
+    // Parameter writes waiting for Update()
+    EventParameterBatch parameterBatch;
 };
@@ -0,0 +1,446 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file AdpcmCodec.cpp
+/// @author JDSherbert
+
+#include "AdpcmCodec.h"
+
+#include "../DSP/SimdLanes.h"
+
+#include <cstring>
+
+static_assert(sizeof(AdpcmCodec::Header) == 24, "AEAD header layout changed");
+
+namespace
+{
+    const int INDEX_TABLE[16] = { -1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8 };
+
+    const int STEP_TABLE[89] =
+    {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+        337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+        2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+
+    const int MAX_INDEX = 88;
+
+    /**
+     * Applies one nibble to the predictor and step index, exactly as every decoder must
+     */
+    void DecodeNibble(int nibble, int& predictor, int& index)
+    {
+        const int step = STEP_TABLE[index];
+        int diff = step >> 3;
+        if (nibble & 4)
+            diff += step;
+        if (nibble & 2)
+            diff += step >> 1;
+        if (nibble & 1)
+            diff += step >> 2;
+        predictor += (nibble & 8) ? -diff : diff;
+        predictor = predictor < -32768 ? -32768 : (predictor > 32767 ? 32767 : predictor);
+        index += INDEX_TABLE[nibble];
+        index = index < 0 ? 0 : (index > MAX_INDEX ? MAX_INDEX : index);
+    }
+
+    int EncodeNibble(int sample, int& predictor, int& index)
+    {
+        int diff = sample - predictor;
+        int nibble = 0;
+        if (diff < 0)
+        {
+            nibble = 8;
+            diff = -diff;
+        }
+
+        int step = STEP_TABLE[index];
+        if (diff >= step)
+        {
+            nibble |= 4;
+            diff -= step;
+        }
+        step >>= 1;
+        if (diff >= step)
+        {
+            nibble |= 2;
+            diff -= step;
+        }
+        step >>= 1;
+        if (diff >= step)
+            nibble |= 1;
+
+        // Track the decoder's state rather than the input, so errors don't accumulate
+        DecodeNibble(nibble, predictor, index);
+        return nibble;
+    }
+
+    void WriteU16(uint8_t* bytes, uint16_t value)
+    {
+        bytes[0] = static_cast<uint8_t>(value);
+        bytes[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void DecodeUnit(const AdpcmUnit& unit, uint32_t samplesPerBlock, int outputStride)
+    {
+        const uint8_t* block = unit.block;
+        int predictor = static_cast<int16_t>(block[0] | block[1] << 8);
+        int index = block[2] > MAX_INDEX ? MAX_INDEX : block[2];
+        const uint8_t* nibbles = block + 4;
+
+        int16_t* output = unit.output;
+        output[0] = static_cast<int16_t>(predictor);
+        for (uint32_t sample = 1; sample < samplesPerBlock; ++sample)
+        {
+            const int nibble = (nibbles[(sample - 1) >> 1] >> (((sample - 1) & 1) << 2)) & 15;
+            DecodeNibble(nibble, predictor, index);
+            output[sample * outputStride] = static_cast<int16_t>(predictor);
+        }
+    }
+
+#if defined(AUDIO_ENGINE_SSE)
+
+    __m128i Select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    /**
+     * Decodes four units in the lanes of SSE2 integer registers. The step table lookup is the
+     * only per-lane scalar work; everything else is branch-free and runs once for all four.
+     */
+    void DecodeFourUnits(const AdpcmUnit* units, uint32_t samplesPerBlock, int outputStride)
+    {
+        alignas(16) int32_t predictors[4];
+        alignas(16) int32_t indices[4];
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const uint8_t* block = units[lane].block;
+            predictors[lane] = static_cast<int16_t>(block[0] | block[1] << 8);
+            indices[lane] = block[2] > MAX_INDEX ? MAX_INDEX : block[2];
+            units[lane].output[0] = static_cast<int16_t>(predictors[lane]);
+        }
+
+        __m128i predictor = _mm_load_si128(reinterpret_cast<const __m128i*>(predictors));
+        __m128i index = _mm_load_si128(reinterpret_cast<const __m128i*>(indices));
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i two = _mm_set1_epi32(2);
+        const __m128i three = _mm_set1_epi32(3);
+        const __m128i four = _mm_set1_epi32(4);
+        const __m128i seven = _mm_set1_epi32(7);
+        const __m128i eight = _mm_set1_epi32(8);
+        const __m128i minusOne = _mm_set1_epi32(-1);
+        const __m128i maxIndex = _mm_set1_epi32(MAX_INDEX);
+
+        const uint8_t* nibbles0 = units[0].block + 4;
+        const uint8_t* nibbles1 = units[1].block + 4;
+        const uint8_t* nibbles2 = units[2].block + 4;
+        const uint8_t* nibbles3 = units[3].block + 4;
+        for (uint32_t sample = 1; sample < samplesPerBlock; ++sample)
+        {
+            const uint32_t byte = (sample - 1) >> 1;
+            const int shift = ((sample - 1) & 1) << 2;
+            const __m128i nibble = _mm_and_si128(_mm_srl_epi32(_mm_setr_epi32(nibbles0[byte], nibbles1[byte], nibbles2[byte], nibbles3[byte]),
+                                                               _mm_cvtsi32_si128(shift)), _mm_set1_epi32(15));
+
+            const __m128i step = _mm_setr_epi32(STEP_TABLE[indices[0]], STEP_TABLE[indices[1]], STEP_TABLE[indices[2]], STEP_TABLE[indices[3]]);
+            __m128i diff = _mm_srai_epi32(step, 3);
+            diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, four), four), step));
+            diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, two), two), _mm_srai_epi32(step, 1)));
+            diff = _mm_add_epi32(diff, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(nibble, one), one), _mm_srai_epi32(step, 2)));
+
+            // Negate where the sign bit is set: (diff ^ mask) - mask
+            const __m128i negative = _mm_cmpeq_epi32(_mm_and_si128(nibble, eight), eight);
+            predictor = _mm_add_epi32(predictor, _mm_sub_epi32(_mm_xor_si128(diff, negative), negative));
+
+            // Saturate to 16 bits and sign extend back
+            const __m128i packed = _mm_packs_epi32(predictor, predictor);
+            predictor = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+
+            // Index steps by -1 for magnitudes 0-3, else by 2, 4, 6 or 8
+            const __m128i magnitude = _mm_and_si128(nibble, seven);
+            const __m128i increase = _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(magnitude, three), 1), two);
+            index = _mm_add_epi32(index, Select(_mm_cmpgt_epi32(magnitude, three), increase, minusOne));
+            index = _mm_and_si128(index, _mm_cmpgt_epi32(index, minusOne));
+            index = Select(_mm_cmpgt_epi32(index, maxIndex), maxIndex, index);
+
+            _mm_store_si128(reinterpret_cast<__m128i*>(indices), index);
+            alignas(16) int16_t outputs[8];
+            _mm_store_si128(reinterpret_cast<__m128i*>(outputs), packed);
+            const size_t offset = static_cast<size_t>(sample) * outputStride;
+            units[0].output[offset] = outputs[0];
+            units[1].output[offset] = outputs[1];
+            units[2].output[offset] = outputs[2];
+            units[3].output[offset] = outputs[3];
+        }
+    }
+
+#endif
+
+    /**
+     * Plugin state of an open .aead file
+     */
+    struct CodecInstance
+    {
+        AdpcmCodec::Header header;
+        uint32_t unitBytes = 0;
+        uint32_t blockBytes = 0;    // all channels' units
+        uint32_t blockCount = 0;
+
+        uint32_t nextBlock = 0;     // next block to read from the file
+        uint32_t skipFrames = 0;    // frames of nextBlock before the position set by SetPosition()
+
+        // A block decoded for a read which needed only part of it
+        std::vector<int16_t> pending;
+        uint32_t pendingStart = 0;
+        uint32_t pendingFrames = 0;
+
+        std::vector<uint8_t> compressed;
+        std::vector<AdpcmUnit> units;
+        FMOD_CODEC_WAVEFORMAT waveFormat;
+    };
+
+    // Blocks decoded per file read when FMOD asks for many at once, e.g. decoding a whole sample at load
+    const uint32_t BATCH_BLOCKS = 16;
+
+    CodecInstance* Get(FMOD_CODEC_STATE* codecState) { return static_cast<CodecInstance*>(codecState->plugindata); }
+
+    FMOD_RESULT ReadBytes(FMOD_CODEC_STATE* codecState, void* buffer, unsigned int bytes)
+    {
+        unsigned int read = 0;
+        const FMOD_RESULT result = codecState->fileread(codecState->filehandle, buffer, bytes, &read, nullptr);
+        if (result != FMOD_OK && result != FMOD_ERR_FILE_EOF)
+            return result;
+        return read == bytes ? FMOD_OK : FMOD_ERR_FILE_EOF;
+    }
+
+    /**
+     * Reads and decodes blocks into interleaved PCM
+     */
+    FMOD_RESULT DecodeBlocks(FMOD_CODEC_STATE* codecState, uint32_t blocks, int16_t* output)
+    {
+        CodecInstance* instance = Get(codecState);
+        const int channels = instance->header.channels;
+        const uint32_t samplesPerBlock = instance->header.samplesPerBlock;
+        instance->compressed.resize(static_cast<size_t>(blocks) * instance->blockBytes);
+        const FMOD_RESULT result = ReadBytes(codecState, instance->compressed.data(), static_cast<unsigned int>(instance->compressed.size()));
+        if (result != FMOD_OK)
+            return result;
+
+        instance->units.resize(static_cast<size_t>(blocks) * channels);
+        for (uint32_t block = 0; block < blocks; ++block)
+        {
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                AdpcmUnit& unit = instance->units[block * channels + channel];
+                unit.block = instance->compressed.data() + block * instance->blockBytes + channel * instance->unitBytes;
+                unit.output = output + static_cast<size_t>(block) * samplesPerBlock * channels + channel;
+            }
+        }
+        AdpcmCodec::DecodeUnits(instance->units.data(), static_cast<int>(instance->units.size()), samplesPerBlock, channels);
+        instance->nextBlock += blocks;
+        return FMOD_OK;
+    }
+
+    uint32_t FramesInBlock(const CodecInstance* instance, uint32_t block)
+    {
+        const uint32_t start = block * instance->header.samplesPerBlock;
+        const uint32_t remaining = instance->header.frames - start;
+        return remaining < instance->header.samplesPerBlock ? remaining : instance->header.samplesPerBlock;
+    }
+
+    FMOD_RESULT F_CALLBACK Open(FMOD_CODEC_STATE* codecState, FMOD_MODE /*userMode*/, FMOD_CREATESOUNDEXINFO* /*userExInfo*/)
+    {
+        AdpcmCodec::Header header;
+        if (codecState->fileseek(codecState->filehandle, 0, nullptr) != FMOD_OK
+            || ReadBytes(codecState, &header, sizeof(header)) != FMOD_OK || header.magic != AdpcmCodec::MAGIC)
+            return FMOD_ERR_FORMAT;
+        if (header.version != AdpcmCodec::VERSION || header.channels == 0 || header.sampleRate == 0
+            || header.samplesPerBlock < 2 || header.samplesPerBlock % 2 == 0)
+            return FMOD_ERR_FORMAT;
+
+        CodecInstance* instance = new CodecInstance();
+        instance->header = header;
+        instance->unitBytes = AdpcmCodec::GetUnitBytes(header.samplesPerBlock);
+        instance->blockBytes = instance->unitBytes * header.channels;
+        instance->blockCount = (header.frames + header.samplesPerBlock - 1) / header.samplesPerBlock;
+        instance->pending.resize(static_cast<size_t>(header.samplesPerBlock) * header.channels);
+
+        FMOD_CODEC_WAVEFORMAT& format = instance->waveFormat;
+        memset(&format, 0, sizeof(format));
+        format.name = "Engine ADPCM";
+        format.format = FMOD_SOUND_FORMAT_PCM16;
+        format.channels = header.channels;
+        format.frequency = static_cast<int>(header.sampleRate);
+        format.lengthbytes = codecState->filesize;
+        format.lengthpcm = header.frames;
+        format.pcmblocksize = header.samplesPerBlock;
+
+        codecState->plugindata = instance;
+        codecState->waveformat = &instance->waveFormat;
+        codecState->numsubsounds = 0;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALLBACK Close(FMOD_CODEC_STATE* codecState)
+    {
+        delete Get(codecState);
+        codecState->plugindata = nullptr;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALLBACK Read(FMOD_CODEC_STATE* codecState, void* buffer, unsigned int samplesIn, unsigned int* samplesOut)
+    {
+        CodecInstance* instance = Get(codecState);
+        const int channels = instance->header.channels;
+        const uint32_t samplesPerBlock = instance->header.samplesPerBlock;
+        int16_t* output = static_cast<int16_t*>(buffer);
+        uint32_t written = 0;
+        FMOD_RESULT result = FMOD_OK;
+
+        while (written < samplesIn && result == FMOD_OK)
+        {
+            if (instance->pendingFrames > 0)
+            {
+                const uint32_t frames = instance->pendingFrames < samplesIn - written ? instance->pendingFrames : samplesIn - written;
+                memcpy(output + static_cast<size_t>(written) * channels, instance->pending.data() + static_cast<size_t>(instance->pendingStart) * channels,
+                       static_cast<size_t>(frames) * channels * sizeof(int16_t));
+                instance->pendingStart += frames;
+                instance->pendingFrames -= frames;
+                written += frames;
+                continue;
+            }
+            if (instance->nextBlock >= instance->blockCount)
+                break;
+
+            // Whole blocks go straight to FMOD's buffer; the last block may hold fewer frames
+            const uint32_t wholeBlocks = (samplesIn - written) / samplesPerBlock;
+            const uint32_t blocksLeft = instance->blockCount - instance->nextBlock;
+            uint32_t blocks = wholeBlocks < blocksLeft ? wholeBlocks : blocksLeft;
+            blocks = blocks < BATCH_BLOCKS ? blocks : BATCH_BLOCKS;
+            if (instance->skipFrames == 0 && blocks > 0)
+            {
+                const uint32_t firstBlock = instance->nextBlock;
+                result = DecodeBlocks(codecState, blocks, output + static_cast<size_t>(written) * channels);
+                if (result == FMOD_OK)
+                    written += (blocks - 1) * samplesPerBlock + FramesInBlock(instance, firstBlock + blocks - 1);
+                continue;
+            }
+
+            const uint32_t block = instance->nextBlock;
+            result = DecodeBlocks(codecState, 1, instance->pending.data());
+            if (result != FMOD_OK)
+                break;
+            instance->pendingStart = instance->skipFrames;
+            instance->pendingFrames = FramesInBlock(instance, block) - instance->skipFrames;
+            instance->skipFrames = 0;
+        }
+
+        *samplesOut = written;
+        if (written == 0)
+            return result == FMOD_OK ? FMOD_ERR_FILE_EOF : result;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALLBACK SetPosition(FMOD_CODEC_STATE* codecState, int /*subsound*/, unsigned int position, FMOD_TIMEUNIT positionType)
+    {
+        if (positionType != FMOD_TIMEUNIT_PCM)
+            return FMOD_ERR_FORMAT;
+
+        CodecInstance* instance = Get(codecState);
+        if (position > instance->header.frames)
+            return FMOD_ERR_INVALID_POSITION;
+
+        const uint32_t block = position / instance->header.samplesPerBlock;
+        const FMOD_RESULT result = codecState->fileseek(codecState->filehandle, sizeof(AdpcmCodec::Header) + block * instance->blockBytes, nullptr);
+        if (result != FMOD_OK)
+            return result;
+
+        instance->nextBlock = block;
+        instance->skipFrames = position - block * instance->header.samplesPerBlock;
+        instance->pendingFrames = 0;
+        return FMOD_OK;
+    }
+}
+
+void AdpcmCodec::Encode(const int16_t* samples, uint32_t frames, int channels, int sampleRate,
+                        std::vector<uint8_t>& file, uint32_t samplesPerBlock)
+{
+    if (samplesPerBlock < 3)
+        samplesPerBlock = 3;
+    samplesPerBlock |= 1;
+
+    const uint32_t unitBytes = GetUnitBytes(samplesPerBlock);
+    const uint32_t blockCount = (frames + samplesPerBlock - 1) / samplesPerBlock;
+    file.assign(sizeof(Header) + static_cast<size_t>(blockCount) * unitBytes * channels, 0);
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = static_cast<uint16_t>(VERSION);
+    header.channels = static_cast<uint16_t>(channels);
+    header.sampleRate = static_cast<uint32_t>(sampleRate);
+    header.frames = frames;
+    header.samplesPerBlock = samplesPerBlock;
+    memcpy(file.data(), &header, sizeof(header));
+
+    // The step index carries over between blocks, so each block starts adapted to the signal
+    std::vector<int> indices(channels, 0);
+    for (uint32_t block = 0; block < blockCount; ++block)
+    {
+        const uint32_t first = block * samplesPerBlock;
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            uint8_t* unit = file.data() + sizeof(Header) + (static_cast<size_t>(block) * channels + channel) * unitBytes;
+            auto sampleAt = [&](uint32_t frame) { return frame < frames ? samples[static_cast<size_t>(frame) * channels + channel] : 0; };
+
+            int predictor = sampleAt(first);
+            int& index = indices[channel];
+            WriteU16(unit, static_cast<uint16_t>(static_cast<int16_t>(predictor)));
+            unit[2] = static_cast<uint8_t>(index);
+
+            uint8_t* nibbles = unit + 4;
+            for (uint32_t sample = 1; sample < samplesPerBlock; ++sample)
+            {
+                const int nibble = EncodeNibble(sampleAt(first + sample), predictor, index);
+                nibbles[(sample - 1) >> 1] |= static_cast<uint8_t>(nibble << (((sample - 1) & 1) << 2));
+            }
+        }
+    }
+}
+
+void AdpcmCodec::DecodeUnits(const AdpcmUnit* units, int count, uint32_t samplesPerBlock, int outputStride)
+{
+    int unit = 0;
+#if defined(AUDIO_ENGINE_SSE)
+    for (; unit + 4 <= count; unit += 4)
+        DecodeFourUnits(units + unit, samplesPerBlock, outputStride);
+#endif
+    DecodeUnitsScalar(units + unit, count - unit, samplesPerBlock, outputStride);
+}
+
+void AdpcmCodec::DecodeUnitsScalar(const AdpcmUnit* units, int count, uint32_t samplesPerBlock, int outputStride)
+{
+    for (int unit = 0; unit < count; ++unit)
+        DecodeUnit(units[unit], samplesPerBlock, outputStride);
+}
+
+FMOD_CODEC_DESCRIPTION* AdpcmCodec::GetDescription()
+{
+    static FMOD_CODEC_DESCRIPTION description = []()
+    {
+        FMOD_CODEC_DESCRIPTION result;
+        memset(&result, 0, sizeof(result));
+        result.name = "Engine ADPCM";
+        result.version = 0x00010000;
+        result.defaultasstream = 0;
+        result.timeunits = FMOD_TIMEUNIT_PCM;
+        result.open = &Open;
+        result.close = &Close;
+        result.read = &Read;
+        result.setposition = &SetPosition;
+        return result;
+    }();
+    return &description;
+}
@@ -0,0 +1,91 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file AdpcmCodec.h
+///
+/// The engine's own compressed format for short sound effects: 4-bit IMA ADPCM, a quarter of
+/// the size of 16-bit PCM, in ".aead" files FMOD opens through a codec plugin registered by
+/// AudioEngine::Init(). Decoding costs a few integer operations per sample, far less than
+/// Vorbis or MP3, so sounds load quickly. FMOD can only keep its own codecs compressed in
+/// memory, so a sample loaded from this format is held as 16-bit PCM like a WAV; streams
+/// decode as they play.
+///
+/// Layout, little-endian:
+///     Header      "AEAD", version, channels, sample rate, frames, samples per block
+///     Blocks      one per samplesPerBlock frames; each holds one unit per channel
+/// A unit is one channel's share of a block and decodes on its own:
+///     int16       first sample
+///     uint8       step index
+///     uint8       reserved
+///     nibbles     the remaining samplesPerBlock - 1 samples, low nibble first
+/// Since units are independent, the decoder decodes four at a time in SSE lanes.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+#include <FMOD/fmod_codec.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * One unit to decode, and where its samples go: output[0], output[stride], ...
+ */
+struct AdpcmUnit
+{
+    const uint8_t* block = nullptr;
+    int16_t* output = nullptr;
+};
+
+class AdpcmCodec
+{
+public:
+
+    static const uint32_t MAGIC = 0x44414541; // "AEAD"
+    static const uint32_t VERSION = 1;
+
+    // Frames per block in files written by Encode(): 512-byte units, as in Microsoft's IMA ADPCM
+    static const uint32_t DEFAULT_SAMPLES_PER_BLOCK = 1017;
+
+#pragma pack(push, 1)
+    struct Header
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t channels;
+        uint32_t sampleRate;
+        uint32_t frames;
+        uint32_t samplesPerBlock;
+        uint32_t reserved;
+    };
+#pragma pack(pop)
+
+    /**
+     * Returns the bytes of one channel's unit
+     */
+    static uint32_t GetUnitBytes(uint32_t samplesPerBlock) { return 4 + samplesPerBlock / 2; }
+
+    /**
+     * Compresses interleaved 16-bit PCM into a complete file.
+     * @param samplesPerBlock Frames per block, odd so the nibbles fill whole bytes; rounded up if even
+     */
+    static void Encode(const int16_t* samples, uint32_t frames, int channels, int sampleRate,
+                       std::vector<uint8_t>& file, uint32_t samplesPerBlock = DEFAULT_SAMPLES_PER_BLOCK);
+
+    /**
+     * Decodes units of samplesPerBlock samples each, four at a time where SSE is available.
+     */
+    static void DecodeUnits(const AdpcmUnit* units, int count, uint32_t samplesPerBlock, int outputStride);
+
+    /**
+     * Decodes units one at a time, the reference the SSE kernel must match bit for bit.
+     */
+    static void DecodeUnitsScalar(const AdpcmUnit* units, int count, uint32_t samplesPerBlock, int outputStride);
+
+    /**
+     * Returns the FMOD plugin description of the codec.
+     */
+    static FMOD_CODEC_DESCRIPTION* GetDescription();
+};
@@ -0,0 +1,194 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file WavFile.cpp
+/// @author JDSherbert
+
+#include "WavFile.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+    const uint16_t FORMAT_PCM = 1;
+    const uint16_t FORMAT_FLOAT = 3;
+    const uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+    uint16_t ReadU16(const uint8_t* bytes) { return static_cast<uint16_t>(bytes[0] | bytes[1] << 8); }
+    uint32_t ReadU32(const uint8_t* bytes) { return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24; }
+
+    void WriteU16(std::vector<uint8_t>& out, uint16_t value)
+    {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void WriteU32(std::vector<uint8_t>& out, uint32_t value)
+    {
+        WriteU16(out, static_cast<uint16_t>(value));
+        WriteU16(out, static_cast<uint16_t>(value >> 16));
+    }
+
+    void WriteTag(std::vector<uint8_t>& out, const char* tag)
+    {
+        out.insert(out.end(), tag, tag + 4);
+    }
+
+    float Clip(float sample)
+    {
+        return sample < -1.0f ? -1.0f : (sample > 1.0f ? 1.0f : sample);
+    }
+
+    bool Fail(std::string* error, const std::string& message)
+    {
+        if (error)
+            *error = message;
+        else
+            std::cout << "WavFile: " << message << '\n';
+        return false;
+    }
+}
+
+bool WavFile::Load(const char* filePath, std::string* error)
+{
+    FILE* file = fopen(filePath, "rb");
+    if (!file)
+        return Fail(error, std::string("Could not open ") + filePath);
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[65536];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        bytes.insert(bytes.end(), chunk, chunk + read);
+    fclose(file);
+
+    if (bytes.size() < 12 || memcmp(bytes.data(), "RIFF", 4) != 0 || memcmp(bytes.data() + 8, "WAVE", 4) != 0)
+        return Fail(error, std::string(filePath) + " is not a WAV file");
+
+    uint16_t format = 0;
+    int fileChannels = 0;
+    int fileRate = 0;
+    int bits = 0;
+    const uint8_t* data = nullptr;
+    size_t dataBytes = 0;
+    for (size_t offset = 12; offset + 8 <= bytes.size();)
+    {
+        const uint8_t* header = bytes.data() + offset;
+        const size_t size = ReadU32(header + 4);
+        const size_t available = bytes.size() - offset - 8;
+        const uint8_t* body = header + 8;
+        if (memcmp(header, "fmt ", 4) == 0 && size >= 16 && size <= available)
+        {
+            format = ReadU16(body);
+            fileChannels = ReadU16(body + 2);
+            fileRate = static_cast<int>(ReadU32(body + 4));
+            bits = ReadU16(body + 14);
+            if (format == FORMAT_EXTENSIBLE && size >= 26)
+                format = ReadU16(body + 24); // first two bytes of the subformat GUID
+        }
+        else if (memcmp(header, "data", 4) == 0)
+        {
+            // Truncated files are read up to where they end
+            data = body;
+            dataBytes = size < available ? size : available;
+        }
+        offset += 8 + size + (size & 1);
+    }
+
+    const bool isFloat = format == FORMAT_FLOAT && bits == 32;
+    const bool isInteger = format == FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+    if (!data || fileChannels <= 0 || fileRate <= 0 || (!isFloat && !isInteger))
+    {
+        return Fail(error, std::string(filePath) + " is not uncompressed PCM (format " + std::to_string(format)
+                           + ", " + std::to_string(bits) + " bits)");
+    }
+
+    const int bytesPerSample = bits / 8;
+    const size_t count = dataBytes / bytesPerSample / fileChannels * fileChannels;
+    std::vector<float> decoded(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint8_t* sample = data + i * bytesPerSample;
+        if (isFloat)
+        {
+            const uint32_t raw = ReadU32(sample);
+            memcpy(&decoded[i], &raw, sizeof(float));
+        }
+        else if (bits == 8)
+            decoded[i] = (sample[0] - 128) / 128.0f;
+        else if (bits == 16)
+            decoded[i] = static_cast<int16_t>(ReadU16(sample)) / 32768.0f;
+        else if (bits == 24)
+            decoded[i] = static_cast<int32_t>(static_cast<uint32_t>(sample[0]) << 8 | static_cast<uint32_t>(sample[1]) << 16 | static_cast<uint32_t>(sample[2]) << 24) / 2147483648.0f;
+        else
+            decoded[i] = static_cast<int32_t>(ReadU32(sample)) / 2147483648.0f;
+    }
+
+    sampleRate = fileRate;
+    channels = fileChannels;
+    sourceBits = bits;
+    sourceFloat = isFloat;
+    samples = std::move(decoded);
+    return true;
+}
+
+bool WavFile::Save(const char* filePath, SampleFormat format, std::string* error) const
+{
+    const int bits = format == SampleFormat::Pcm16 ? 16 : (format == SampleFormat::Pcm24 ? 24 : 32);
+    const uint32_t dataBytes = static_cast<uint32_t>(samples.size() * (bits / 8));
+
+    std::vector<uint8_t> out;
+    out.reserve(44 + dataBytes + 1);
+    WriteTag(out, "RIFF");
+    WriteU32(out, 36 + dataBytes + (dataBytes & 1));
+    WriteTag(out, "WAVE");
+    WriteTag(out, "fmt ");
+    WriteU32(out, 16);
+    WriteU16(out, format == SampleFormat::Float32 ? FORMAT_FLOAT : FORMAT_PCM);
+    WriteU16(out, static_cast<uint16_t>(channels));
+    WriteU32(out, static_cast<uint32_t>(sampleRate));
+    WriteU32(out, static_cast<uint32_t>(sampleRate * channels * (bits / 8)));
+    WriteU16(out, static_cast<uint16_t>(channels * (bits / 8)));
+    WriteU16(out, static_cast<uint16_t>(bits));
+    WriteTag(out, "data");
+    WriteU32(out, dataBytes);
+
+    for (float sample : samples)
+    {
+        if (format == SampleFormat::Float32)
+        {
+            uint32_t raw;
+            memcpy(&raw, &sample, sizeof(raw));
+            WriteU32(out, raw);
+        }
+        else if (format == SampleFormat::Pcm16)
+            WriteU16(out, static_cast<uint16_t>(static_cast<int16_t>(lrintf(Clip(sample) * 32767.0f))));
+        else
+        {
+            const int32_t value = static_cast<int32_t>(lrintf(Clip(sample) * 8388607.0f));
+            out.push_back(static_cast<uint8_t>(value));
+            out.push_back(static_cast<uint8_t>(value >> 8));
+            out.push_back(static_cast<uint8_t>(value >> 16));
+        }
+    }
+    if (dataBytes & 1)
+        out.push_back(0);
+
+    FILE* file = fopen(filePath, "wb");
+    if (!file)
+        return Fail(error, std::string("Could not create ") + filePath);
+    const bool written = fwrite(out.data(), 1, out.size(), file) == out.size();
+    fclose(file);
+    if (!written)
+        return Fail(error, std::string("Could not write ") + filePath);
+    return true;
+}
+
+void WavFile::Assign(int newSampleRate, int newChannels, std::vector<float> newSamples)
+{
+    sampleRate = newSampleRate;
+    channels = newChannels;
+    samples = std::move(newSamples);
+}
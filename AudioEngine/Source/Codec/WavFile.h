@@ -0,0 +1,64 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file WavFile.h
+///
+/// Reads and writes RIFF WAVE files for the offline asset tools. Samples are held as interleaved
+/// floats in [-1, 1] whatever the file's format. Reads 8, 16, 24 and 32-bit integer and 32-bit
+/// float PCM, including WAVE_FORMAT_EXTENSIBLE; writes 16 or 24-bit integer or 32-bit float.
+///
+/// @author JDSherbert
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class WavFile
+{
+public:
+
+    enum class SampleFormat
+    {
+        Pcm16,
+        Pcm24,
+        Float32
+    };
+
+    /**
+     * Reads a WAV file, replacing the current contents.
+     * @param error - receives the reason for a failure instead of the console, e.g. on worker threads
+     * @return false, with a message, if the file is missing, malformed or compressed
+     */
+    bool Load(const char* filePath, std::string* error = nullptr);
+
+    /**
+     * Writes the samples, clipped to [-1, 1] for integer formats.
+     * @param error - receives the reason for a failure instead of the console
+     * @return false, with a message, if the file can't be written
+     */
+    bool Save(const char* filePath, SampleFormat format = SampleFormat::Pcm16, std::string* error = nullptr) const;
+
+    /**
+     * Replaces the format and samples, e.g. after resampling.
+     */
+    void Assign(int newSampleRate, int newChannels, std::vector<float> newSamples);
+
+    int GetSampleRate() const { return sampleRate; }
+    int GetChannels() const { return channels; }
+    uint32_t GetFrameCount() const { return channels > 0 ? static_cast<uint32_t>(samples.size() / channels) : 0; }
+
+    /** Bits per sample and sample type of the file last loaded */
+    int GetSourceBits() const { return sourceBits; }
+    bool IsSourceFloat() const { return sourceFloat; }
+
+    const std::vector<float>& GetSamples() const { return samples; }
+
+private:
+
+    int sampleRate = 0;
+    int channels = 0;
+    int sourceBits = 0;
+    bool sourceFloat = false;
+    std::vector<float> samples;
+};
@@ -0,0 +1,424 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file ConvolutionReverb.cpp
+/// @author JDSherbert
+
+#include "ConvolutionReverb.h"
+
+#include "../../AudioEngine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    // The head covers the part of the response heard before the first tail block is due
+    const int HEAD_LENGTH = 2 * ConvolutionReverb::TAIL_BLOCK_SIZE;
+
+    // How long the worker sleeps if it misses a wake-up
+    const std::chrono::milliseconds WORKER_POLL_INTERVAL(1);
+
+    float DecibelsToGain(float decibels)
+    {
+        return powf(10.0f, 0.05f * decibels);
+    }
+
+    /** Converts one sample of a locked FMOD sound to float */
+    float ReadSample(const unsigned char* data, FMOD_SOUND_FORMAT format, size_t index)
+    {
+        switch (format)
+        {
+            case FMOD_SOUND_FORMAT_PCM8:
+                return reinterpret_cast<const int8_t*>(data)[index] / 128.0f;
+            case FMOD_SOUND_FORMAT_PCM16:
+                return reinterpret_cast<const int16_t*>(data)[index] / 32768.0f;
+            case FMOD_SOUND_FORMAT_PCM24:
+            {
+                const unsigned char* sample = data + index * 3;
+                const int32_t value = static_cast<int32_t>((sample[0] << 8) | (sample[1] << 16) | (sample[2] << 24)) >> 8;
+                return value / 8388608.0f;
+            }
+            case FMOD_SOUND_FORMAT_PCM32:
+                return static_cast<float>(reinterpret_cast<const int32_t*>(data)[index] / 2147483648.0);
+            case FMOD_SOUND_FORMAT_PCMFLOAT:
+                return reinterpret_cast<const float*>(data)[index];
+            default:
+                return 0.0f;
+        }
+    }
+}
+
+ConvolutionReverb::ConvolutionReverb()
+    : wetGain(DecibelsToGain(-6.0f))
+    , dryGain(1.0f)
+    , jobsPosted(0)
+    , jobsDone(0)
+    , workerRunning(false)
+    , tailBlocks(0)
+    , tailNanoseconds(0)
+    , deadlineMisses(0)
+{
+    for (int slot = 0; slot < JOB_SLOTS; ++slot)
+    {
+        jobInputIDs[slot].store(-1);
+        jobOutputIDs[slot].store(-1);
+    }
+    memset(headInput, 0, sizeof(headInput));
+    memset(wetOutput, 0, sizeof(wetOutput));
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    Detach();
+    StopWorker();
+}
+
+void ConvolutionReverb::SetImpulse(const float* const* channels, int channelCount, int length, bool worker)
+{
+    StopWorker();
+
+    impulseChannels = std::min(std::max(channelCount, 0), static_cast<int>(MAX_IMPULSE_CHANNELS));
+    impulseLength = std::max(length, 0);
+    useWorker = worker;
+
+    headConvolver.Prepare(HEAD_BLOCK_SIZE, HEAD_LENGTH / HEAD_BLOCK_SIZE);
+    for (int channel = 0; channel < impulseChannels; ++channel)
+        headFilters[channel].Set(channels[channel], std::min(impulseLength, HEAD_LENGTH), headConvolver.GetFFT());
+
+    hasTail = impulseChannels > 0 && impulseLength > HEAD_LENGTH;
+    if (hasTail)
+    {
+        const int tailLength = impulseLength - HEAD_LENGTH;
+        tailConvolver.Prepare(TAIL_BLOCK_SIZE, (tailLength + TAIL_BLOCK_SIZE - 1) / TAIL_BLOCK_SIZE);
+        for (int channel = 0; channel < impulseChannels; ++channel)
+            tailFilters[channel].Set(channels[channel] + HEAD_LENGTH, tailLength, tailConvolver.GetFFT());
+    }
+
+    tailInput.assign(TAIL_BLOCK_SIZE, 0.0f);
+    jobInputs.assign(static_cast<size_t>(JOB_SLOTS) * TAIL_BLOCK_SIZE, 0.0f);
+    jobOutputs.assign(static_cast<size_t>(JOB_SLOTS) * MAX_IMPULSE_CHANNELS * TAIL_BLOCK_SIZE, 0.0f);
+    for (int slot = 0; slot < JOB_SLOTS; ++slot)
+    {
+        jobInputIDs[slot].store(-1);
+        jobOutputIDs[slot].store(-1);
+    }
+    jobsPosted.store(0);
+    jobsDone.store(0);
+    tailFill = 0;
+    tailBlock = 0;
+    tailReady = false;
+
+    memset(headInput, 0, sizeof(headInput));
+    memset(wetOutput, 0, sizeof(wetOutput));
+    blockFill = 0;
+
+    tailBlocks.store(0);
+    tailNanoseconds.store(0);
+    deadlineMisses.store(0);
+
+    if (hasTail && useWorker)
+        StartWorker();
+}
+
+bool ConvolutionReverb::LoadImpulse(FMOD::System* system, const char* filePath, bool worker)
+{
+    FMOD::Sound* sound = nullptr;
+    if (system->createSound(filePath, FMOD_CREATESAMPLE | FMOD_2D | FMOD_LOOP_OFF, nullptr, &sound) != FMOD_OK)
+    {
+        std::cout << "ConvolutionReverb: Can't read impulse response " << filePath << '\n';
+        return false;
+    }
+
+    FMOD_SOUND_FORMAT format = FMOD_SOUND_FORMAT_NONE;
+    int channels = 0, bits = 0;
+    unsigned int frames = 0;
+    float frequency = 0.0f;
+    ERRCHECK(sound->getFormat(nullptr, &format, &channels, &bits));
+    ERRCHECK(sound->getLength(&frames, FMOD_TIMEUNIT_PCM));
+    ERRCHECK(sound->getDefaults(&frequency, nullptr));
+
+    if (format < FMOD_SOUND_FORMAT_PCM8 || format > FMOD_SOUND_FORMAT_PCMFLOAT || channels <= 0)
+    {
+        std::cout << "ConvolutionReverb: Impulse response " << filePath << " did not decode to PCM!\n";
+        ERRCHECK(sound->release());
+        return false;
+    }
+
+    void* data = nullptr;
+    void* wrapped = nullptr;
+    unsigned int bytes = 0, wrappedBytes = 0;
+    ERRCHECK(sound->lock(0, frames * channels * (bits / 8), &data, &wrapped, &bytes, &wrappedBytes));
+
+    // Only as many channels as the reverb renders are kept
+    const int kept = std::min(channels, static_cast<int>(MAX_IMPULSE_CHANNELS));
+    std::vector<std::vector<float>> samples(kept, std::vector<float>(frames));
+    const unsigned char* bytesIn = static_cast<const unsigned char*>(data);
+    for (unsigned int frame = 0; frame < frames && data; ++frame)
+    {
+        for (int channel = 0; channel < kept; ++channel)
+            samples[channel][frame] = ReadSample(bytesIn, format, static_cast<size_t>(frame) * channels + channel);
+    }
+    ERRCHECK(sound->unlock(data, wrapped, bytes, wrappedBytes));
+    ERRCHECK(sound->release());
+
+    // Responses are not resampled, so a mismatched rate stretches or shrinks the room
+    int mixerRate = 0;
+    ERRCHECK(system->getSoftwareFormat(&mixerRate, nullptr, nullptr));
+    if (static_cast<int>(frequency) != mixerRate)
+        std::cout << "ConvolutionReverb: Impulse response " << filePath << " is sampled at " << frequency
+                  << " Hz rather than the mixer's " << mixerRate << " Hz\n";
+
+    const float* pointers[MAX_IMPULSE_CHANNELS] = { };
+    for (int channel = 0; channel < kept; ++channel)
+        pointers[channel] = samples[channel].data();
+    SetImpulse(pointers, kept, static_cast<int>(frames), worker);
+    return true;
+}
+
+void ConvolutionReverb::SetMix(float wetdB, float drydB)
+{
+    wetGain.store(DecibelsToGain(wetdB), std::memory_order_relaxed);
+    dryGain.store(DecibelsToGain(drydB), std::memory_order_relaxed);
+}
+
+void ConvolutionReverb::Process(const float* input, float* output, unsigned int frames, int channels)
+{
+    const float wet = wetGain.load(std::memory_order_relaxed);
+    const float dry = dryGain.load(std::memory_order_relaxed);
+    if (impulseChannels == 0)
+    {
+        for (unsigned int i = 0; i < frames * channels; ++i)
+            output[i] = input[i] * dry;
+        return;
+    }
+
+    const float downmix = 1.0f / static_cast<float>(std::max(channels, 1));
+    for (unsigned int frame = 0; frame < frames; ++frame)
+    {
+        const float* in = input + frame * channels;
+        float* out = output + frame * channels;
+
+        // Read the whole input frame before writing, as output may alias input
+        float mono = 0.0f;
+        for (int channel = 0; channel < channels; ++channel)
+            mono += in[channel];
+        headInput[blockFill] = mono * downmix;
+
+        for (int channel = 0; channel < channels; ++channel)
+            out[channel] = in[channel] * dry + wetOutput[channel % impulseChannels][blockFill] * wet;
+
+        if (++blockFill == HEAD_BLOCK_SIZE)
+        {
+            ProcessBlock();
+            blockFill = 0;
+        }
+    }
+}
+
+void ConvolutionReverb::ProcessBlock()
+{
+    headConvolver.PushBlock(headInput);
+    for (int channel = 0; channel < impulseChannels; ++channel)
+        headConvolver.ConvolveBlock(headFilters[channel], wetOutput[channel]);
+
+    if (!hasTail)
+        return;
+
+    // Tail output heard during a tail block comes from the job posted two blocks earlier
+    if (tailFill == 0)
+    {
+        const long long due = tailBlock - 2;
+        tailReady = due >= 0 && jobOutputIDs[due % JOB_SLOTS].load(std::memory_order_acquire) == due;
+        if (due >= 0 && !tailReady)
+            deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (tailReady)
+    {
+        const int slot = static_cast<int>((tailBlock - 2) % JOB_SLOTS);
+        for (int channel = 0; channel < impulseChannels; ++channel)
+        {
+            const float* tail = &jobOutputs[(static_cast<size_t>(slot) * MAX_IMPULSE_CHANNELS + channel) * TAIL_BLOCK_SIZE + tailFill];
+            for (int n = 0; n < HEAD_BLOCK_SIZE; ++n)
+                wetOutput[channel][n] += tail[n];
+        }
+    }
+
+    memcpy(&tailInput[tailFill], headInput, sizeof(headInput));
+    tailFill += HEAD_BLOCK_SIZE;
+    if (tailFill < TAIL_BLOCK_SIZE)
+        return;
+
+    // Post the completed input block, unless the worker is so far behind that its slot is still in use
+    const long long job = tailBlock;
+    const int slot = static_cast<int>(job % JOB_SLOTS);
+    if (job - jobsDone.load(std::memory_order_acquire) < JOB_SLOTS)
+    {
+        memcpy(&jobInputs[static_cast<size_t>(slot) * TAIL_BLOCK_SIZE], tailInput.data(), TAIL_BLOCK_SIZE * sizeof(float));
+        jobInputIDs[slot].store(job, std::memory_order_release);
+    }
+    else
+        deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+    jobsPosted.store(job + 1, std::memory_order_release);
+
+    if (useWorker)
+        workerWake.notify_one();
+    else
+    {
+        RunTailJob(job);
+        jobsDone.store(job + 1, std::memory_order_release);
+    }
+
+    tailFill = 0;
+    ++tailBlock;
+}
+
+void ConvolutionReverb::RunTailJob(long long job)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const int slot = static_cast<int>(job % JOB_SLOTS);
+
+    // A job that could not be posted still advances the delay line, with silence
+    float* input = &jobInputs[static_cast<size_t>(slot) * TAIL_BLOCK_SIZE];
+    if (jobInputIDs[slot].load(std::memory_order_acquire) != job)
+        std::fill(input, input + TAIL_BLOCK_SIZE, 0.0f);
+    tailConvolver.PushBlock(input);
+
+    jobOutputIDs[slot].store(-1, std::memory_order_relaxed);
+    for (int channel = 0; channel < impulseChannels; ++channel)
+        tailConvolver.ConvolveBlock(tailFilters[channel], &jobOutputs[(static_cast<size_t>(slot) * MAX_IMPULSE_CHANNELS + channel) * TAIL_BLOCK_SIZE]);
+    jobOutputIDs[slot].store(job, std::memory_order_release);
+
+    tailBlocks.fetch_add(1, std::memory_order_relaxed);
+    tailNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+                              std::memory_order_relaxed);
+}
+
+void ConvolutionReverb::StartWorker()
+{
+    workerRunning.store(true);
+    worker = std::thread(&ConvolutionReverb::WorkerLoop, this);
+}
+
+void ConvolutionReverb::StopWorker()
+{
+    if (!worker.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        workerRunning.store(false);
+    }
+    workerWake.notify_one();
+    worker.join();
+}
+
+void ConvolutionReverb::WorkerLoop()
+{
+    while (workerRunning.load())
+    {
+        // The mixer notifies without taking the lock, so a wake-up can be missed; polling bounds the delay
+        {
+            std::unique_lock<std::mutex> lock(workerMutex);
+            workerWake.wait_for(lock, WORKER_POLL_INTERVAL, [this]()
+            {
+                return !workerRunning.load() || jobsDone.load(std::memory_order_relaxed) < jobsPosted.load(std::memory_order_acquire);
+            });
+        }
+
+        const long long posted = jobsPosted.load(std::memory_order_acquire);
+        for (long long job = jobsDone.load(std::memory_order_relaxed); job < posted && workerRunning.load(); ++job)
+        {
+            RunTailJob(job);
+            jobsDone.store(job + 1, std::memory_order_release);
+        }
+    }
+}
+
+void ConvolutionReverb::Attach(FMOD::System* system, FMOD::ChannelGroup* targetBus)
+{
+    static FMOD_DSP_DESCRIPTION description = []()
+    {
+        FMOD_DSP_DESCRIPTION result;
+        memset(&result, 0, sizeof(result));
+        result.pluginsdkversion = FMOD_PLUGIN_SDK_VERSION;
+        strncpy(result.name, "Engine Convolution Reverb", sizeof(result.name) - 1);
+        result.version = 0x00010000;
+        result.numinputbuffers = 1;
+        result.numoutputbuffers = 1;
+        result.read = &ConvolutionReverb::Read;
+        result.shouldiprocess = &ConvolutionReverb::ShouldIProcess;
+        return result;
+    }();
+
+    bus = targetBus;
+    ERRCHECK(system->createDSP(&description, &dsp));
+    ERRCHECK(dsp->setUserData(this));
+    ERRCHECK(bus->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, dsp));
+}
+
+void ConvolutionReverb::Detach()
+{
+    if (!dsp)
+        return;
+
+    ERRCHECK(bus->removeDSP(dsp));
+    ERRCHECK(dsp->release());
+    dsp = nullptr;
+    bus = nullptr;
+}
+
+ConvolutionReverbStats ConvolutionReverb::GetStats() const
+{
+    ConvolutionReverbStats stats;
+    stats.impulseLength = impulseLength;
+    stats.tailBlocks = tailBlocks.load(std::memory_order_relaxed);
+    stats.tailMilliseconds = tailNanoseconds.load(std::memory_order_relaxed) / 1e6;
+    stats.tailDeadlineMisses = deadlineMisses.load(std::memory_order_relaxed);
+    return stats;
+}
+
+FMOD_RESULT F_CALL ConvolutionReverb::ShouldIProcess
+(
+    FMOD_DSP_STATE* dspState, FMOD_BOOL inputsIdle, unsigned int length,
+    FMOD_CHANNELMASK /*inMask*/, int /*inChannels*/, FMOD_SPEAKERMODE /*speakerMode*/
+)
+{
+    void* userData = nullptr;
+    FMOD_DSP_GETUSERDATA(dspState, &userData);
+    ConvolutionReverb* reverb = static_cast<ConvolutionReverb*>(userData);
+    if (!inputsIdle || !reverb)
+    {
+        if (reverb)
+            reverb->idleSamples = 0;
+        return FMOD_OK;
+    }
+
+    // Keep processing silence until the tail has rung out
+    if (reverb->idleSamples > static_cast<unsigned int>(reverb->impulseLength + HEAD_BLOCK_SIZE))
+        return FMOD_ERR_DSP_DONTPROCESS;
+    reverb->idleSamples += length;
+    return FMOD_OK;
+}
+
+FMOD_RESULT F_CALL ConvolutionReverb::Read
+(
+    FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+    unsigned int length, int inChannels, int* outChannels
+)
+{
+    void* userData = nullptr;
+    FMOD_DSP_GETUSERDATA(dspState, &userData);
+    ConvolutionReverb* reverb = static_cast<ConvolutionReverb*>(userData);
+
+    *outChannels = inChannels;
+    if (reverb)
+        reverb->Process(inBuffer, outBuffer, length, inChannels);
+    else
+        memcpy(outBuffer, inBuffer, length * inChannels * sizeof(float));
+    return FMOD_OK;
+}
@@ -0,0 +1,160 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file ConvolutionReverb.h
+///
+/// Convolution reverb placed on a bus, which reverberates the bus with a recorded impulse response.
+/// The response is split non-uniformly into two segments (Gardner):
+///     head - the first 2 * TAIL_BLOCK_SIZE samples, convolved in HEAD_BLOCK_SIZE partitions on the
+///            mixer thread, which sets the reverb's latency
+///     tail - the rest, convolved in TAIL_BLOCK_SIZE partitions on a worker thread
+/// A tail block is posted once its input is complete and is not heard until a whole tail block
+/// later, so the worker has TAIL_BLOCK_SIZE samples of time to compute it and multi-second responses
+/// cost the mixer thread no more than the head does. A tail block the worker has not finished in
+/// time is dropped rather than waited on, and counted in the stats.
+///
+/// The bus is summed to mono and convolved with each channel of the response; output channels
+/// take the response channels in turn.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PartitionedConvolver.h"
+
+struct ConvolutionReverbStats
+{
+    // Length of the impulse response in samples
+    int impulseLength = 0;
+
+    // Tail blocks convolved by the worker (or inline), and the time spent on them
+    unsigned int tailBlocks = 0;
+    double tailMilliseconds = 0.0;
+
+    // Tail blocks which were not ready when they were due, or could not be posted, and were left silent
+    unsigned int tailDeadlineMisses = 0;
+};
+
+class ConvolutionReverb
+{
+public:
+
+    static const int HEAD_BLOCK_SIZE = 128;
+    static const int TAIL_BLOCK_SIZE = 2048;
+    static const int MAX_IMPULSE_CHANNELS = 2;
+
+    ConvolutionReverb();
+    ~ConvolutionReverb();
+
+    /**
+     * Prepares convolution with an impulse response, replacing any previous one.
+     * Must not be called while attached or from the mixer thread.
+     * @param channels - channelCount pointers to length samples each
+     * @param useWorker - convolve the tail on a worker thread; false convolves it inline, which
+     *                    suits offline rendering but puts the whole cost on the calling thread
+     */
+    void SetImpulse(const float* const* channels, int channelCount, int length, bool useWorker = true);
+
+    /**
+     * Decodes an audio file with FMOD and uses it as the impulse response.
+     * @return false, with a console message, if the file can't be read
+     */
+    bool LoadImpulse(FMOD::System* system, const char* filePath, bool useWorker = true);
+
+    /**
+     * Sets the levels of the reverberated and untouched signal. Takes effect on the next block.
+     */
+    void SetMix(float wetdB, float drydB);
+
+    /**
+     * Reverberates an interleaved buffer, HEAD_BLOCK_SIZE samples late. input and output may be the same buffer.
+     */
+    void Process(const float* input, float* output, unsigned int frames, int channels);
+
+    /**
+     * Creates the reverb DSP and inserts it at the head (post-fader) of a bus.
+     */
+    void Attach(FMOD::System* system, FMOD::ChannelGroup* targetBus);
+
+    /**
+     * Removes the reverb DSP from its bus and releases it.
+     */
+    void Detach();
+
+    ConvolutionReverbStats GetStats() const;
+
+private:
+
+    static FMOD_RESULT F_CALL Read(FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+                                   unsigned int length, int inChannels, int* outChannels);
+
+    static FMOD_RESULT F_CALL ShouldIProcess(FMOD_DSP_STATE* dspState, FMOD_BOOL inputsIdle, unsigned int length,
+                                             FMOD_CHANNELMASK inMask, int inChannels, FMOD_SPEAKERMODE speakerMode);
+
+    /** Convolves one head block and mixes in the matching tail output */
+    void ProcessBlock();
+
+    /** Convolves the tail input of a job into its output slot */
+    void RunTailJob(long long job);
+
+    void StartWorker();
+    void StopWorker();
+    void WorkerLoop();
+
+    FMOD::ChannelGroup* bus = nullptr;
+    FMOD::DSP* dsp = nullptr;
+
+    int impulseChannels = 0;
+    int impulseLength = 0;
+    bool hasTail = false;
+    bool useWorker = true;
+
+    std::atomic<float> wetGain;
+    std::atomic<float> dryGain;
+
+    // Samples the bus has been idle for, so the reverb stops once its tail has rung out
+    unsigned int idleSamples = 0;
+
+    // Head segment, mixer thread
+    PartitionedConvolver headConvolver;
+    ConvolutionFilter headFilters[MAX_IMPULSE_CHANNELS];
+    float headInput[HEAD_BLOCK_SIZE];
+    float wetOutput[MAX_IMPULSE_CHANNELS][HEAD_BLOCK_SIZE];    // previous block, being played out
+    int blockFill = 0;
+
+    // Tail segment. Jobs are numbered by tail block; job n holds input block n and its output
+    // is heard during tail block n + 2. Slots are reused every JOB_SLOTS jobs.
+    static const int JOB_SLOTS = 4;
+    PartitionedConvolver tailConvolver;
+    ConvolutionFilter tailFilters[MAX_IMPULSE_CHANNELS];
+    std::vector<float> tailInput;                               // block being gathered, mixer thread
+    int tailFill = 0;
+    long long tailBlock = 0;                                    // tail block being gathered
+    std::vector<float> jobInputs;                               // JOB_SLOTS blocks
+    std::vector<float> jobOutputs;                              // JOB_SLOTS * MAX_IMPULSE_CHANNELS blocks
+    std::atomic<long long> jobInputIDs[JOB_SLOTS];              // job whose input is in each slot
+    std::atomic<long long> jobOutputIDs[JOB_SLOTS];             // job whose output is in each slot
+    std::atomic<long long> jobsPosted;                          // one past the newest posted job
+    std::atomic<long long> jobsDone;                            // one past the newest finished job
+    bool tailReady = false;                                     // output for the current tail block is valid
+
+    // Worker
+    std::thread worker;
+    std::mutex workerMutex;
+    std::condition_variable workerWake;
+    std::atomic<bool> workerRunning;
+
+    // Stats
+    std::atomic<unsigned int> tailBlocks;
+    std::atomic<long long> tailNanoseconds;
+    std::atomic<unsigned int> deadlineMisses;
+};
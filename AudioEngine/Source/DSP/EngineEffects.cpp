@@ -0,0 +1,253 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file EngineEffects.cpp
+/// @author JDSherbert
+
+#include "EngineEffects.h"
+
+#include "../../AudioEngine.h"
+#include "Filters.h"
+#include "LookaheadLimiter.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    /**
+     * Float parameters shared between the game thread (FMOD parameter callbacks) and the
+     * mixer thread, which re-derives filter coefficients at the start of a block when dirty.
+     */
+    template <int COUNT>
+    struct EffectParameters
+    {
+        std::atomic<float> values[COUNT];
+        std::atomic<bool> dirty;
+
+        float Get(int index) const { return values[index].load(std::memory_order_relaxed); }
+
+        void Set(int index, float value)
+        {
+            values[index].store(value, std::memory_order_relaxed);
+            dirty.store(true, std::memory_order_release);
+        }
+
+        bool ConsumeDirty() { return dirty.exchange(false, std::memory_order_acquire); }
+    };
+
+    // Effect implementations
+
+    struct BiquadEQEffect
+    {
+        static const int NUM_PARAMETERS = BIQUADEQ_NUM_PARAMETERS;
+        static const char* Name() { return "Engine Biquad EQ"; }
+
+        static void Describe(FMOD_DSP_PARAMETER_DESC* descriptions)
+        {
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[BIQUADEQ_LOW_FREQUENCY], "Low Freq", "Hz", "Low shelf corner frequency", 20.0f, 1000.0f, 200.0f);
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[BIQUADEQ_LOW_GAIN], "Low Gain", "dB", "Low shelf gain", -24.0f, 24.0f, 0.0f);
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[BIQUADEQ_MID_FREQUENCY], "Mid Freq", "Hz", "Peaking band centre frequency", 100.0f, 10000.0f, 1000.0f);
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[BIQUADEQ_MID_GAIN], "Mid Gain", "dB", "Peaking band gain", -24.0f, 24.0f, 0.0f);
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[BIQUADEQ_MID_Q], "Mid Q", "", "Peaking band quality factor", 0.1f, 10.0f, 0.707f);
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[BIQUADEQ_HIGH_FREQUENCY], "High Freq", "Hz", "High shelf corner frequency", 1000.0f, 20000.0f, 8000.0f);
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[BIQUADEQ_HIGH_GAIN], "High Gain", "dB", "High shelf gain", -24.0f, 24.0f, 0.0f);
+        }
+
+        explicit BiquadEQEffect(int sampleRate)
+            : sampleRate(static_cast<float>(sampleRate))
+        {
+            cascade.SetStageCount(3);
+        }
+
+        void Update()
+        {
+            cascade.SetStage(0, BiquadCoefficients::LowShelf(sampleRate, parameters.Get(BIQUADEQ_LOW_FREQUENCY), parameters.Get(BIQUADEQ_LOW_GAIN)));
+            cascade.SetStage(1, BiquadCoefficients::Peaking(sampleRate, parameters.Get(BIQUADEQ_MID_FREQUENCY), parameters.Get(BIQUADEQ_MID_GAIN), parameters.Get(BIQUADEQ_MID_Q)));
+            cascade.SetStage(2, BiquadCoefficients::HighShelf(sampleRate, parameters.Get(BIQUADEQ_HIGH_FREQUENCY), parameters.Get(BIQUADEQ_HIGH_GAIN)));
+        }
+
+        void Reset() { cascade.Reset(); }
+        void Process(const float* input, float* output, unsigned int frames, int channels) { cascade.Process(input, output, frames, channels); }
+
+        EffectParameters<NUM_PARAMETERS> parameters;
+        float sampleRate;
+        BiquadCascade cascade;
+    };
+
+    struct OnePoleLowPassEffect
+    {
+        static const int NUM_PARAMETERS = ONEPOLE_NUM_PARAMETERS;
+        static const char* Name() { return "Engine One-Pole Low-Pass"; }
+
+        static void Describe(FMOD_DSP_PARAMETER_DESC* descriptions)
+        {
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[ONEPOLE_CUTOFF], "Cutoff", "Hz", "-3dB cutoff frequency", 10.0f, 22000.0f, 22000.0f);
+        }
+
+        explicit OnePoleLowPassEffect(int sampleRate)
+            : sampleRate(static_cast<float>(sampleRate))
+        {
+        }
+
+        void Update() { filter.SetCutoff(sampleRate, parameters.Get(ONEPOLE_CUTOFF)); }
+        void Reset() { filter.Reset(); }
+        void Process(const float* input, float* output, unsigned int frames, int channels) { filter.Process(input, output, frames, channels); }
+
+        EffectParameters<NUM_PARAMETERS> parameters;
+        float sampleRate;
+        OnePoleLowPass filter;
+    };
+
+    struct LookaheadLimiterEffect
+    {
+        static const int NUM_PARAMETERS = LIMITER_NUM_PARAMETERS;
+        static const char* Name() { return "Engine Lookahead Limiter"; }
+
+        static void Describe(FMOD_DSP_PARAMETER_DESC* descriptions)
+        {
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[LIMITER_CEILING], "Ceiling", "dB", "Highest output peak level", -12.0f, 0.0f, -0.3f);
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[LIMITER_LOOKAHEAD], "Lookahead", "ms", "Delay used to anticipate peaks", 0.1f, LookaheadLimiter::MAX_LOOKAHEAD_MS, 5.0f);
+            FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[LIMITER_RELEASE], "Release", "ms", "Gain recovery time", 1.0f, 1000.0f, 50.0f);
+        }
+
+        explicit LookaheadLimiterEffect(int sampleRate)
+        {
+            limiter.Prepare(sampleRate);
+        }
+
+        void Update() { limiter.SetParameters(parameters.Get(LIMITER_CEILING), parameters.Get(LIMITER_LOOKAHEAD), parameters.Get(LIMITER_RELEASE)); }
+        void Reset() { limiter.Reset(); }
+        void Process(const float* input, float* output, unsigned int frames, int channels) { limiter.Process(input, output, frames, channels); }
+
+        EffectParameters<NUM_PARAMETERS> parameters;
+        LookaheadLimiter limiter;
+    };
+
+    /**
+     * Adapts an effect implementation to FMOD's plugin callbacks.
+     */
+    template <typename Effect>
+    struct EffectPlugin
+    {
+        struct ParameterTable
+        {
+            FMOD_DSP_PARAMETER_DESC descriptions[Effect::NUM_PARAMETERS];
+            FMOD_DSP_PARAMETER_DESC* pointers[Effect::NUM_PARAMETERS];
+
+            ParameterTable()
+            {
+                Effect::Describe(descriptions);
+                for (int i = 0; i < Effect::NUM_PARAMETERS; ++i)
+                    pointers[i] = &descriptions[i];
+            }
+        };
+
+        /**
+         * Filled once, on first use. FMOD reads it through paramdesc from then on, so it is
+         * never written again, even when several engines create DSPs on different threads.
+         */
+        static const ParameterTable& Parameters()
+        {
+            static ParameterTable table;
+            return table;
+        }
+
+        static Effect* Get(FMOD_DSP_STATE* dspState) { return static_cast<Effect*>(dspState->plugindata); }
+
+        static FMOD_RESULT F_CALL Create(FMOD_DSP_STATE* dspState)
+        {
+            int sampleRate = 0;
+            FMOD_DSP_GETSAMPLERATE(dspState, &sampleRate);
+
+            Effect* effect = new Effect(sampleRate);
+            const ParameterTable& table = Parameters();
+            for (int i = 0; i < Effect::NUM_PARAMETERS; ++i)
+                effect->parameters.Set(i, table.descriptions[i].floatdesc.defaultval);
+            dspState->plugindata = effect;
+            return FMOD_OK;
+        }
+
+        static FMOD_RESULT F_CALL Release(FMOD_DSP_STATE* dspState)
+        {
+            delete Get(dspState);
+            dspState->plugindata = nullptr;
+            return FMOD_OK;
+        }
+
+        static FMOD_RESULT F_CALL Reset(FMOD_DSP_STATE* dspState)
+        {
+            Get(dspState)->Reset();
+            return FMOD_OK;
+        }
+
+        static FMOD_RESULT F_CALL Read(FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+                                       unsigned int length, int inChannels, int* outChannels)
+        {
+            Effect* effect = Get(dspState);
+            if (effect->parameters.ConsumeDirty())
+                effect->Update();
+            effect->Process(inBuffer, outBuffer, length, inChannels);
+            *outChannels = inChannels;
+            return FMOD_OK;
+        }
+
+        static FMOD_RESULT F_CALL SetParameterFloat(FMOD_DSP_STATE* dspState, int index, float value)
+        {
+            if (index < 0 || index >= Effect::NUM_PARAMETERS)
+                return FMOD_ERR_INVALID_PARAM;
+            Get(dspState)->parameters.Set(index, value);
+            return FMOD_OK;
+        }
+
+        static FMOD_RESULT F_CALL GetParameterFloat(FMOD_DSP_STATE* dspState, int index, float* value, char* valueString)
+        {
+            if (index < 0 || index >= Effect::NUM_PARAMETERS)
+                return FMOD_ERR_INVALID_PARAM;
+            *value = Get(dspState)->parameters.Get(index);
+            if (valueString)
+                snprintf(valueString, FMOD_DSP_GETPARAM_VALUESTR_LENGTH, "%.2f", *value);
+            return FMOD_OK;
+        }
+
+        static FMOD_DSP_DESCRIPTION Describe()
+        {
+            FMOD_DSP_DESCRIPTION description;
+            memset(&description, 0, sizeof(description));
+            description.pluginsdkversion = FMOD_PLUGIN_SDK_VERSION;
+            strncpy(description.name, Effect::Name(), sizeof(description.name) - 1);
+            description.version = 0x00010000;
+            description.numinputbuffers = 1;
+            description.numoutputbuffers = 1;
+            description.create = &Create;
+            description.release = &Release;
+            description.reset = &Reset;
+            description.read = &Read;
+            description.numparameters = Effect::NUM_PARAMETERS;
+            description.paramdesc = const_cast<FMOD_DSP_PARAMETER_DESC**>(Parameters().pointers);
+            description.setparameterfloat = &SetParameterFloat;
+            description.getparameterfloat = &GetParameterFloat;
+            return description;
+        }
+    };
+}
+
+const FMOD_DSP_DESCRIPTION* EngineEffects::GetDescription(EngineEffect effect)
+{
+    static const FMOD_DSP_DESCRIPTION descriptions[] =
+    {
+        EffectPlugin<BiquadEQEffect>::Describe(),
+        EffectPlugin<OnePoleLowPassEffect>::Describe(),
+        EffectPlugin<LookaheadLimiterEffect>::Describe(),
+    };
+    static_assert(sizeof(descriptions) / sizeof(descriptions[0]) == static_cast<size_t>(EngineEffect::Count),
+                  "Every EngineEffect needs a plugin description");
+
+    return &descriptions[static_cast<int>(effect)];
+}
+
+void EngineEffects::Register(FMOD::System* system, unsigned int (&handles)[static_cast<int>(EngineEffect::Count)])
+{
+    for (int i = 0; i < static_cast<int>(EngineEffect::Count); ++i)
+        ERRCHECK(system->registerDSP(GetDescription(static_cast<EngineEffect>(i)), &handles[i]));
+}
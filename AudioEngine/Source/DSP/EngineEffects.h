@@ -0,0 +1,81 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file EngineEffects.h
+///
+/// Engine-owned DSP effects exposed to FMOD as FMOD_DSP_DESCRIPTION plugins.
+/// Each effect runs a SIMD kernel from Filters.h or LookaheadLimiter.h on the mixer thread
+/// and is controlled with ordinary float parameters.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+
+/**
+ * Effects provided by the engine.
+ */
+enum class EngineEffect
+{
+    BiquadEQ,           // three band EQ: low shelf, peaking mid, high shelf
+    OnePoleLowPass,     // cheap low-pass for distance filtering
+    LookaheadLimiter,   // brickwall peak limiter
+
+    Count
+};
+
+/**
+ * Parameters of EngineEffect::BiquadEQ
+ */
+enum BiquadEQParameter
+{
+    BIQUADEQ_LOW_FREQUENCY,     // Hz
+    BIQUADEQ_LOW_GAIN,          // dB
+    BIQUADEQ_MID_FREQUENCY,     // Hz
+    BIQUADEQ_MID_GAIN,          // dB
+    BIQUADEQ_MID_Q,
+    BIQUADEQ_HIGH_FREQUENCY,    // Hz
+    BIQUADEQ_HIGH_GAIN,         // dB
+
+    BIQUADEQ_NUM_PARAMETERS
+};
+
+/**
+ * Parameters of EngineEffect::OnePoleLowPass
+ */
+enum OnePoleLowPassParameter
+{
+    ONEPOLE_CUTOFF,             // Hz
+
+    ONEPOLE_NUM_PARAMETERS
+};
+
+/**
+ * Parameters of EngineEffect::LookaheadLimiter
+ */
+enum LimiterParameter
+{
+    LIMITER_CEILING,            // dB
+    LIMITER_LOOKAHEAD,          // ms
+    LIMITER_RELEASE,            // ms
+
+    LIMITER_NUM_PARAMETERS
+};
+
+class EngineEffects
+{
+public:
+
+    /**
+     * Returns the FMOD plugin description of an engine effect.
+     */
+    static const FMOD_DSP_DESCRIPTION* GetDescription(EngineEffect effect);
+
+    /**
+     * Registers every engine effect with an FMOD system so they can be created with
+     * System::createDSPByPlugin().
+     * @param handles - receives one plugin handle per effect, indexed by EngineEffect
+     */
+    static void Register(FMOD::System* system, unsigned int (&handles)[static_cast<int>(EngineEffect::Count)]);
+};
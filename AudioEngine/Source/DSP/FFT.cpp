@@ -0,0 +1,130 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file FFT.cpp
+/// @author JDSherbert
+
+#include "FFT.h"
+
+#include <cmath>
+
+namespace
+{
+    const double TWO_PI = 6.283185307179586;
+}
+
+FFT::FFT(int size)
+    : size(size)
+    , half(size / 2)
+    , bitReverse(size / 2)
+    , twiddleReal(size / 2)
+    , twiddleImaginary(size / 2)
+    , splitReal(size / 2 + 1)
+    , splitImaginary(size / 2 + 1)
+    , workReal(size / 2)
+    , workImaginary(size / 2)
+{
+    int bits = 0;
+    while ((1 << bits) < half)
+        ++bits;
+
+    for (int i = 0; i < half; ++i)
+    {
+        int reversed = 0;
+        for (int bit = 0; bit < bits; ++bit)
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        bitReverse[i] = reversed;
+
+        twiddleReal[i] = static_cast<float>(cos(TWO_PI * i / half));
+        twiddleImaginary[i] = static_cast<float>(-sin(TWO_PI * i / half));
+    }
+
+    for (int k = 0; k <= half; ++k)
+    {
+        splitReal[k] = static_cast<float>(cos(TWO_PI * k / size));
+        splitImaginary[k] = static_cast<float>(-sin(TWO_PI * k / size));
+    }
+}
+
+void FFT::Forward(const float* input, float* real, float* imaginary)
+{
+    // Pack even samples as real and odd samples as imaginary parts of a half-length signal
+    for (int n = 0; n < half; ++n)
+    {
+        workReal[bitReverse[n]] = input[2 * n];
+        workImaginary[bitReverse[n]] = input[2 * n + 1];
+    }
+    Transform(false);
+
+    // Separate the spectra of the even and odd samples and combine them into the full spectrum
+    for (int k = 0; k <= half; ++k)
+    {
+        const int a = k == half ? 0 : k;
+        const int b = k == 0 ? 0 : half - k;
+
+        const float evenReal = 0.5f * (workReal[a] + workReal[b]);
+        const float evenImaginary = 0.5f * (workImaginary[a] - workImaginary[b]);
+        const float oddReal = 0.5f * (workImaginary[a] + workImaginary[b]);
+        const float oddImaginary = -0.5f * (workReal[a] - workReal[b]);
+
+        real[k] = evenReal + splitReal[k] * oddReal - splitImaginary[k] * oddImaginary;
+        imaginary[k] = evenImaginary + splitReal[k] * oddImaginary + splitImaginary[k] * oddReal;
+    }
+}
+
+void FFT::Inverse(const float* real, const float* imaginary, float* output)
+{
+    // Rebuild the half-length spectrum of the packed even/odd signal
+    for (int k = 0; k < half; ++k)
+    {
+        const int b = half - k;
+
+        const float evenReal = 0.5f * (real[k] + real[b]);
+        const float evenImaginary = 0.5f * (imaginary[k] - imaginary[b]);
+        const float differenceReal = 0.5f * (real[k] - real[b]);
+        const float differenceImaginary = 0.5f * (imaginary[k] + imaginary[b]);
+
+        // Multiply by the conjugate split twiddle to undo the odd-sample phase shift
+        const float oddReal = differenceReal * splitReal[k] + differenceImaginary * splitImaginary[k];
+        const float oddImaginary = differenceImaginary * splitReal[k] - differenceReal * splitImaginary[k];
+
+        workReal[bitReverse[k]] = evenReal - oddImaginary;
+        workImaginary[bitReverse[k]] = evenImaginary + oddReal;
+    }
+    Transform(true);
+
+    const float scale = 1.0f / half;
+    for (int n = 0; n < half; ++n)
+    {
+        output[2 * n] = workReal[n] * scale;
+        output[2 * n + 1] = workImaginary[n] * scale;
+    }
+}
+
+void FFT::Transform(bool inverse)
+{
+    // Iterative radix-2 decimation in time over bit-reversed input
+    const float direction = inverse ? -1.0f : 1.0f;
+    for (int length = 2; length <= half; length <<= 1)
+    {
+        const int span = length / 2;
+        const int step = half / length;
+        for (int start = 0; start < half; start += length)
+        {
+            for (int j = 0; j < span; ++j)
+            {
+                const float wr = twiddleReal[j * step];
+                const float wi = direction * twiddleImaginary[j * step];
+
+                const int top = start + j;
+                const int bottom = top + span;
+                const float br = workReal[bottom] * wr - workImaginary[bottom] * wi;
+                const float bi = workReal[bottom] * wi + workImaginary[bottom] * wr;
+
+                workReal[bottom] = workReal[top] - br;
+                workImaginary[bottom] = workImaginary[top] - bi;
+                workReal[top] += br;
+                workImaginary[top] += bi;
+            }
+        }
+    }
+}
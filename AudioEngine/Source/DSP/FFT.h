@@ -0,0 +1,61 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file FFT.h
+///
+/// Real-input FFT used by the engine's convolution effects.
+/// Spectra are stored split (separate real and imaginary arrays of size / 2 + 1 bins), which is
+/// the layout the SIMD spectrum multiply-accumulate in PartitionedConvolver works on.
+///
+/// @author JDSherbert
+
+#include <vector>
+
+class FFT
+{
+public:
+
+    /**
+     * Precomputes twiddle factors and the bit-reversal table.
+     * @param size - transform length, a power of two of at least 4
+     */
+    explicit FFT(int size);
+
+    int GetSize() const { return size; }
+
+    /** Number of bins in a spectrum, size / 2 + 1 */
+    int GetBinCount() const { return size / 2 + 1; }
+
+    /**
+     * Transforms size real samples into GetBinCount() complex bins.
+     */
+    void Forward(const float* input, float* real, float* imaginary);
+
+    /**
+     * Transforms GetBinCount() complex bins back into size real samples, scaled so that
+     * Inverse(Forward(x)) == x.
+     */
+    void Inverse(const float* real, const float* imaginary, float* output);
+
+private:
+
+    /** In-place complex FFT of length size / 2 over the work buffers */
+    void Transform(bool inverse);
+
+    int size;
+    int half;
+
+    std::vector<int> bitReverse;
+
+    // Twiddles of the half-length complex FFT, e^(-2*pi*i*k / half)
+    std::vector<float> twiddleReal;
+    std::vector<float> twiddleImaginary;
+
+    // Twiddles which split the half-length result into the real spectrum, e^(-2*pi*i*k / size)
+    std::vector<float> splitReal;
+    std::vector<float> splitImaginary;
+
+    std::vector<float> workReal;
+    std::vector<float> workImaginary;
+};
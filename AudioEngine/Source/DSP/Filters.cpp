@@ -0,0 +1,230 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file Filters.cpp
+/// @author JDSherbert
+
+#include "Filters.h"
+
+#include "SimdLanes.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const float PI = 3.14159265358979f;
+
+    struct BiquadPrototype
+    {
+        float cosW0;
+        float alpha;
+        float a;
+    };
+
+    BiquadPrototype MakePrototype(float sampleRate, float frequency, float gaindB, float q)
+    {
+        const float w0 = 2.0f * PI * fminf(frequency, 0.49f * sampleRate) / sampleRate;
+        return { cosf(w0), sinf(w0) / (2.0f * q), powf(10.0f, gaindB / 40.0f) };
+    }
+
+    BiquadCoefficients Normalize(float b0, float b1, float b2, float a0, float a1, float a2)
+    {
+        BiquadCoefficients coefficients;
+        coefficients.b0 = b0 / a0;
+        coefficients.b1 = b1 / a0;
+        coefficients.b2 = b2 / a0;
+        coefficients.a1 = a1 / a0;
+        coefficients.a2 = a2 / a0;
+        return coefficients;
+    }
+
+    void CopyUnprocessedChannels(const float* input, float* output, unsigned int frames, int channels, int processed)
+    {
+        if (input == output || channels <= processed)
+            return;
+        for (unsigned int frame = 0; frame < frames; ++frame)
+            for (int channel = processed; channel < channels; ++channel)
+                output[frame * channels + channel] = input[frame * channels + channel];
+    }
+}
+
+// BiquadCoefficients
+
+BiquadCoefficients BiquadCoefficients::LowPass(float sampleRate, float frequency, float q)
+{
+    const BiquadPrototype p = MakePrototype(sampleRate, frequency, 0.0f, q);
+    return Normalize((1.0f - p.cosW0) * 0.5f, 1.0f - p.cosW0, (1.0f - p.cosW0) * 0.5f,
+                     1.0f + p.alpha, -2.0f * p.cosW0, 1.0f - p.alpha);
+}
+
+BiquadCoefficients BiquadCoefficients::HighPass(float sampleRate, float frequency, float q)
+{
+    const BiquadPrototype p = MakePrototype(sampleRate, frequency, 0.0f, q);
+    return Normalize((1.0f + p.cosW0) * 0.5f, -(1.0f + p.cosW0), (1.0f + p.cosW0) * 0.5f,
+                     1.0f + p.alpha, -2.0f * p.cosW0, 1.0f - p.alpha);
+}
+
+BiquadCoefficients BiquadCoefficients::Peaking(float sampleRate, float frequency, float gaindB, float q)
+{
+    const BiquadPrototype p = MakePrototype(sampleRate, frequency, gaindB, q);
+    return Normalize(1.0f + p.alpha * p.a, -2.0f * p.cosW0, 1.0f - p.alpha * p.a,
+                     1.0f + p.alpha / p.a, -2.0f * p.cosW0, 1.0f - p.alpha / p.a);
+}
+
+BiquadCoefficients BiquadCoefficients::LowShelf(float sampleRate, float frequency, float gaindB, float q)
+{
+    const BiquadPrototype p = MakePrototype(sampleRate, frequency, gaindB, q);
+    const float sqrtA2Alpha = 2.0f * sqrtf(p.a) * p.alpha;
+    return Normalize(p.a * ((p.a + 1.0f) - (p.a - 1.0f) * p.cosW0 + sqrtA2Alpha),
+                     2.0f * p.a * ((p.a - 1.0f) - (p.a + 1.0f) * p.cosW0),
+                     p.a * ((p.a + 1.0f) - (p.a - 1.0f) * p.cosW0 - sqrtA2Alpha),
+                     (p.a + 1.0f) + (p.a - 1.0f) * p.cosW0 + sqrtA2Alpha,
+                     -2.0f * ((p.a - 1.0f) + (p.a + 1.0f) * p.cosW0),
+                     (p.a + 1.0f) + (p.a - 1.0f) * p.cosW0 - sqrtA2Alpha);
+}
+
+BiquadCoefficients BiquadCoefficients::HighShelf(float sampleRate, float frequency, float gaindB, float q)
+{
+    const BiquadPrototype p = MakePrototype(sampleRate, frequency, gaindB, q);
+    const float sqrtA2Alpha = 2.0f * sqrtf(p.a) * p.alpha;
+    return Normalize(p.a * ((p.a + 1.0f) + (p.a - 1.0f) * p.cosW0 + sqrtA2Alpha),
+                     -2.0f * p.a * ((p.a - 1.0f) + (p.a + 1.0f) * p.cosW0),
+                     p.a * ((p.a + 1.0f) + (p.a - 1.0f) * p.cosW0 - sqrtA2Alpha),
+                     (p.a + 1.0f) - (p.a - 1.0f) * p.cosW0 + sqrtA2Alpha,
+                     2.0f * ((p.a - 1.0f) - (p.a + 1.0f) * p.cosW0),
+                     (p.a + 1.0f) - (p.a - 1.0f) * p.cosW0 - sqrtA2Alpha);
+}
+
+// BiquadCascade
+
+struct BiquadCascade::Kernel
+{
+    BiquadCascade& filter;
+    const float* input;
+    float* output;
+    unsigned int frames;
+    int channels;
+
+    template <typename L>
+    void Process(int firstChannel)
+    {
+        typedef typename L::Register Register;
+
+        Register b0[MAX_STAGES], b1[MAX_STAGES], b2[MAX_STAGES], a1[MAX_STAGES], a2[MAX_STAGES];
+        Register z1[MAX_STAGES], z2[MAX_STAGES];
+        const int stageCount = filter.stageCount;
+
+        for (int s = 0; s < stageCount; ++s)
+        {
+            b0[s] = L::Set(filter.stages[s].b0);
+            b1[s] = L::Set(filter.stages[s].b1);
+            b2[s] = L::Set(filter.stages[s].b2);
+            a1[s] = L::Set(filter.stages[s].a1);
+            a2[s] = L::Set(filter.stages[s].a2);
+            z1[s] = L::Load(&filter.z1[s][firstChannel]);
+            z2[s] = L::Load(&filter.z2[s][firstChannel]);
+        }
+
+        for (unsigned int frame = 0; frame < frames; ++frame)
+        {
+            const unsigned int offset = frame * channels + firstChannel;
+            Register x = L::Load(input + offset);
+            for (int s = 0; s < stageCount; ++s)
+            {
+                const Register y = L::Add(L::Mul(b0[s], x), z1[s]);
+                z1[s] = L::Add(L::Sub(L::Mul(b1[s], x), L::Mul(a1[s], y)), z2[s]);
+                z2[s] = L::Sub(L::Mul(b2[s], x), L::Mul(a2[s], y));
+                x = y;
+            }
+            L::Store(output + offset, x);
+        }
+
+        for (int s = 0; s < stageCount; ++s)
+        {
+            L::Store(&filter.z1[s][firstChannel], z1[s]);
+            L::Store(&filter.z2[s][firstChannel], z2[s]);
+        }
+    }
+};
+
+BiquadCascade::BiquadCascade()
+{
+    Reset();
+}
+
+void BiquadCascade::SetStageCount(int count)
+{
+    stageCount = count < 0 ? 0 : (count > MAX_STAGES ? MAX_STAGES : count);
+}
+
+void BiquadCascade::SetStage(int stage, const BiquadCoefficients& coefficients)
+{
+    if (stage >= 0 && stage < MAX_STAGES)
+        stages[stage] = coefficients;
+}
+
+void BiquadCascade::Reset()
+{
+    memset(z1, 0, sizeof(z1));
+    memset(z2, 0, sizeof(z2));
+}
+
+void BiquadCascade::Process(const float* input, float* output, unsigned int frames, int channels)
+{
+    const int filtered = channels < MAX_CHANNELS ? channels : MAX_CHANNELS;
+    Kernel kernel = { *this, input, output, frames, channels };
+    ForEachChannelGroup(kernel, filtered);
+    CopyUnprocessedChannels(input, output, frames, channels, filtered);
+}
+
+// OnePoleLowPass
+
+struct OnePoleLowPass::Kernel
+{
+    OnePoleLowPass& filter;
+    const float* input;
+    float* output;
+    unsigned int frames;
+    int channels;
+
+    template <typename L>
+    void Process(int firstChannel)
+    {
+        typedef typename L::Register Register;
+
+        const Register coefficient = L::Set(filter.coefficient);
+        Register y = L::Load(&filter.state[firstChannel]);
+
+        for (unsigned int frame = 0; frame < frames; ++frame)
+        {
+            const unsigned int offset = frame * channels + firstChannel;
+            y = L::Add(y, L::Mul(coefficient, L::Sub(L::Load(input + offset), y)));
+            L::Store(output + offset, y);
+        }
+
+        L::Store(&filter.state[firstChannel], y);
+    }
+};
+
+OnePoleLowPass::OnePoleLowPass()
+{
+    Reset();
+}
+
+void OnePoleLowPass::SetCutoff(float sampleRate, float frequency)
+{
+    coefficient = 1.0f - expf(-2.0f * PI * fminf(frequency, 0.5f * sampleRate) / sampleRate);
+}
+
+void OnePoleLowPass::Reset()
+{
+    memset(state, 0, sizeof(state));
+}
+
+void OnePoleLowPass::Process(const float* input, float* output, unsigned int frames, int channels)
+{
+    const int filtered = channels < MAX_CHANNELS ? channels : MAX_CHANNELS;
+    Kernel kernel = { *this, input, output, frames, channels };
+    ForEachChannelGroup(kernel, filtered);
+    CopyUnprocessedChannels(input, output, frames, channels, filtered);
+}
@@ -0,0 +1,108 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file Filters.h
+///
+/// SIMD filter kernels shared by the engine's DSP effects.
+/// All filters work on interleaved buffers and keep one state value per channel, filtering
+/// several channels at once (see SimdLanes.h).
+///
+/// @author JDSherbert
+
+/**
+ * Normalized biquad coefficients (a0 == 1), designed with the RBJ audio EQ cookbook formulas.
+ */
+struct BiquadCoefficients
+{
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+
+    static BiquadCoefficients LowPass(float sampleRate, float frequency, float q = 0.7071f);
+    static BiquadCoefficients HighPass(float sampleRate, float frequency, float q = 0.7071f);
+    static BiquadCoefficients Peaking(float sampleRate, float frequency, float gaindB, float q = 0.7071f);
+    static BiquadCoefficients LowShelf(float sampleRate, float frequency, float gaindB, float q = 0.7071f);
+    static BiquadCoefficients HighShelf(float sampleRate, float frequency, float gaindB, float q = 0.7071f);
+};
+
+/**
+ * Series of biquad stages in transposed direct form II.
+ */
+class BiquadCascade
+{
+public:
+
+    static const int MAX_STAGES = 8;
+    static const int MAX_CHANNELS = 32;
+
+    BiquadCascade();
+
+    /**
+     * Sets how many stages are run, from 0 (pass-through) to MAX_STAGES.
+     */
+    void SetStageCount(int count);
+    int GetStageCount() const { return stageCount; }
+
+    /**
+     * Replaces the coefficients of one stage without clearing its state.
+     */
+    void SetStage(int stage, const BiquadCoefficients& coefficients);
+
+    /**
+     * Clears the filter history of every stage.
+     */
+    void Reset();
+
+    /**
+     * Filters an interleaved buffer. input and output may be the same buffer.
+     * Channels past MAX_CHANNELS are passed through untouched.
+     */
+    void Process(const float* input, float* output, unsigned int frames, int channels);
+
+private:
+
+    struct Kernel;
+
+    int stageCount = 0;
+    BiquadCoefficients stages[MAX_STAGES];
+    float z1[MAX_STAGES][MAX_CHANNELS];
+    float z2[MAX_STAGES][MAX_CHANNELS];
+};
+
+/**
+ * First-order low-pass, cheap enough to run on every 3D channel for distance filtering.
+ */
+class OnePoleLowPass
+{
+public:
+
+    static const int MAX_CHANNELS = 32;
+
+    OnePoleLowPass();
+
+    /**
+     * Sets the -3dB cutoff frequency.
+     */
+    void SetCutoff(float sampleRate, float frequency);
+
+    /**
+     * Clears the filter history.
+     */
+    void Reset();
+
+    /**
+     * Filters an interleaved buffer. input and output may be the same buffer.
+     * Channels past MAX_CHANNELS are passed through untouched.
+     */
+    void Process(const float* input, float* output, unsigned int frames, int channels);
+
+private:
+
+    struct Kernel;
+
+    float coefficient = 1.0f;
+    float state[MAX_CHANNELS];
+};
@@ -0,0 +1,191 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file HrirSet.cpp
+/// @author JDSherbert
+
+#include "HrirSet.h"
+
+#include "../Tools/Json.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    const float DEGREES_TO_RADIANS = 0.01745329252f;
+
+    // Onset is the first sample within -20 dB of the ear's peak, less a little pre-ringing
+    const float ONSET_THRESHOLD = 0.1f;
+    const int ONSET_MARGIN = 2;
+
+    void ToDirection(float azimuth, float elevation, float& x, float& y, float& z)
+    {
+        const float a = azimuth * DEGREES_TO_RADIANS;
+        const float e = elevation * DEGREES_TO_RADIANS;
+        x = cosf(e) * cosf(a);
+        y = cosf(e) * sinf(a);
+        z = sinf(e);
+    }
+
+    int FindOnset(const std::vector<JsonValue>& ir)
+    {
+        float peak = 0.0f;
+        for (const JsonValue& sample : ir)
+            peak = std::max(peak, fabsf(static_cast<float>(sample.AsNumber())));
+
+        for (size_t i = 0; i < ir.size(); ++i)
+        {
+            if (fabsf(static_cast<float>(ir[i].AsNumber())) >= peak * ONSET_THRESHOLD)
+                return std::max(static_cast<int>(i) - ONSET_MARGIN, 0);
+        }
+        return 0;
+    }
+}
+
+bool HrirSet::Load(const char* filePath)
+{
+    JsonValue root;
+    std::string error;
+    if (!JsonValue::ParseFile(filePath, root, error))
+    {
+        std::cout << "HrirSet: Can't read " << filePath << ": " << error << '\n';
+        return false;
+    }
+
+    const std::vector<JsonValue>& positions = root["SourcePosition"].GetElements();
+    const std::vector<JsonValue>& irs = root["Data.IR"].GetElements();
+    const int newSampleRate = static_cast<int>(root["Data.SamplingRate"].AsNumber(0.0));
+    if (positions.empty() || positions.size() != irs.size() || newSampleRate <= 0)
+    {
+        std::cout << "HrirSet: " << filePath << " needs matching SourcePosition and Data.IR arrays and a Data.SamplingRate!\n";
+        return false;
+    }
+
+    // Responses are trimmed to the shortest measurement after onset removal
+    int newTaps = MAX_TAPS;
+    std::vector<Measurement> newMeasurements(positions.size());
+    for (size_t m = 0; m < positions.size(); ++m)
+    {
+        const std::vector<JsonValue>& position = positions[m].GetElements();
+        const std::vector<JsonValue>& ears = irs[m].GetElements();
+        if (position.size() < 2 || ears.size() != 2 || ears[0].GetElements().empty() || ears[1].GetElements().empty())
+        {
+            std::cout << "HrirSet: Measurement " << m << " in " << filePath << " is malformed!\n";
+            return false;
+        }
+
+        Measurement& measurement = newMeasurements[m];
+        ToDirection(static_cast<float>(position[0].AsNumber()), static_cast<float>(position[1].AsNumber()),
+                    measurement.x, measurement.y, measurement.z);
+        for (int ear = 0; ear < 2; ++ear)
+        {
+            const std::vector<JsonValue>& ir = ears[ear].GetElements();
+            const int onset = FindOnset(ir);
+            measurement.delay[ear] = static_cast<float>(onset);
+            newTaps = std::min(newTaps, static_cast<int>(ir.size()) - onset);
+        }
+    }
+
+    float maxDelay = 0.0f;
+    std::vector<float> newResponses(newMeasurements.size() * 2 * newTaps);
+    for (size_t m = 0; m < newMeasurements.size(); ++m)
+    {
+        for (int ear = 0; ear < 2; ++ear)
+        {
+            const std::vector<JsonValue>& ir = irs[m].GetElements()[ear].GetElements();
+            const int onset = static_cast<int>(newMeasurements[m].delay[ear]);
+            float* response = &newResponses[(m * 2 + ear) * newTaps];
+            for (int i = 0; i < newTaps; ++i)
+                response[i] = static_cast<float>(ir[onset + i].AsNumber());
+            maxDelay = std::max(maxDelay, newMeasurements[m].delay[ear]);
+        }
+    }
+
+    // Normalize to unit average energy per ear, so HRTF rendering is about as loud as the plain signal
+    double energy = 0.0;
+    for (float sample : newResponses)
+        energy += sample * sample;
+    if (energy > 0.0)
+    {
+        const float scale = static_cast<float>(sqrt(2.0 * newMeasurements.size() / energy));
+        for (float& sample : newResponses)
+            sample *= scale;
+    }
+
+    sampleRate = newSampleRate;
+    taps = newTaps;
+    length = std::min(taps + static_cast<int>(maxDelay) + 1, static_cast<int>(MAX_TAPS));
+    measurements.swap(newMeasurements);
+    responses.swap(newResponses);
+    return true;
+}
+
+void HrirSet::Interpolate(float azimuth, float elevation, int neighbours, int outputTaps, float* left, float* right) const
+{
+    std::fill(left, left + outputTaps, 0.0f);
+    std::fill(right, right + outputTaps, 0.0f);
+    if (measurements.empty())
+        return;
+
+    float x, y, z;
+    ToDirection(azimuth, elevation, x, y, z);
+
+    // Keep the closest measurements, ordered by decreasing cosine of their angle to the direction
+    neighbours = std::max(std::min(neighbours, static_cast<int>(MAX_NEIGHBOURS)), 1);
+    int nearest[MAX_NEIGHBOURS];
+    float cosines[MAX_NEIGHBOURS];
+    int found = 0;
+    for (int m = 0; m < static_cast<int>(measurements.size()); ++m)
+    {
+        const float cosine = measurements[m].x * x + measurements[m].y * y + measurements[m].z * z;
+        if (found == neighbours && cosine <= cosines[found - 1])
+            continue;
+
+        int slot = found < neighbours ? found++ : found - 1;
+        while (slot > 0 && cosines[slot - 1] < cosine)
+        {
+            nearest[slot] = nearest[slot - 1];
+            cosines[slot] = cosines[slot - 1];
+            --slot;
+        }
+        nearest[slot] = m;
+        cosines[slot] = cosine;
+    }
+
+    float weights[MAX_NEIGHBOURS];
+    float weightSum = 0.0f;
+    for (int i = 0; i < found; ++i)
+    {
+        weights[i] = 1.0f / (acosf(std::min(std::max(cosines[i], -1.0f), 1.0f)) + 1e-3f);
+        weightSum += weights[i];
+    }
+
+    float* outputs[2] = { left, right };
+    for (int ear = 0; ear < 2; ++ear)
+    {
+        float delay = 0.0f;
+        for (int i = 0; i < found; ++i)
+            delay += weights[i] * measurements[nearest[i]].delay[ear];
+        delay /= weightSum;
+
+        // Blend the delay-free responses and put the delay back with linear interpolation
+        const int whole = static_cast<int>(delay);
+        const float fraction = delay - static_cast<float>(whole);
+        float* output = outputs[ear];
+        for (int i = 0; i < found; ++i)
+        {
+            const float* response = &responses[(nearest[i] * 2 + ear) * taps];
+            const float weight = weights[i] / weightSum;
+            for (int n = 0; n < taps; ++n)
+            {
+                const float sample = weight * response[n];
+                if (whole + n < outputTaps)
+                    output[whole + n] += sample * (1.0f - fraction);
+                if (whole + n + 1 < outputTaps)
+                    output[whole + n + 1] += sample * fraction;
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file HrirSet.h
+///
+/// Head-related impulse responses measured around a listener, used by the HRTF spatializer.
+/// Sets are read from a JSON export of a SOFA (SimpleFreeFieldHRIR) file:
+///
+///     { "Data.SamplingRate": 48000,
+///       "SourcePosition": [ [azimuth, elevation, radius], ... ],
+///       "Data.IR": [ [ [left taps...], [right taps...] ], ... ] }
+///
+/// Azimuth and elevation are in degrees, azimuth counterclockwise from the front (90 is left)
+/// as in SOFA. Each response is stored with its onset delay removed, so blending neighbouring
+/// measurements does not comb filter; the interpolated delay is put back afterwards.
+/// Responses are normalized to unit average energy per ear.
+///
+/// @author JDSherbert
+
+#include <vector>
+
+class HrirSet
+{
+public:
+
+    // Longest response kept per ear, longer measurements are truncated
+    static const int MAX_TAPS = 512;
+
+    // Most measurements Interpolate() can blend
+    static const int MAX_NEIGHBOURS = 4;
+
+    /**
+     * Reads a SOFA JSON export, replacing the current contents.
+     * @return false, with a console message, if the file is missing or malformed
+     */
+    bool Load(const char* filePath);
+
+    int GetSampleRate() const { return sampleRate; }
+    int GetMeasurementCount() const { return static_cast<int>(measurements.size()); }
+
+    /** Length of the stored responses including the largest onset delay, at most MAX_TAPS */
+    int GetLength() const { return length; }
+
+    /**
+     * Builds the response pair for a direction by blending the nearest measurements, weighted by
+     * the inverse of their angular distance. Does not allocate, so it can run on the mixer thread.
+     * @param azimuth, elevation - direction in degrees, in the same convention as the file
+     * @param neighbours - measurements to blend, 1 picks the nearest
+     * @param taps - samples written to left and right, zero padded past GetLength()
+     */
+    void Interpolate(float azimuth, float elevation, int neighbours, int taps, float* left, float* right) const;
+
+private:
+
+    struct Measurement
+    {
+        // Unit direction: x forward, y left, z up
+        float x, y, z;
+
+        // Onset delay of each ear in samples
+        float delay[2];
+    };
+
+    int sampleRate = 0;
+    int length = 0;     // delay-free taps plus the largest delay
+    int taps = 0;       // delay-free taps stored per ear
+
+    std::vector<Measurement> measurements;
+
+    // Delay-free responses, measurement-major then left and right, taps samples each
+    std::vector<float> responses;
+};
@@ -0,0 +1,423 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file HrtfSpatializer.cpp
+/// @author JDSherbert
+
+#include "HrtfSpatializer.h"
+
+#include "HrirSet.h"
+#include "PartitionedConvolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    const float PI = 3.14159265359f;
+    const float RADIANS_TO_DEGREES = 57.2957795131f;
+
+    const int BLOCK_SIZE = HrtfSpatializer::BLOCK_SIZE;
+    const int MAX_PARTITIONS = HrirSet::MAX_TAPS / BLOCK_SIZE;
+
+    // Measurements blended at HrtfQuality::High
+    const int HIGH_NEIGHBOURS = 3;
+
+    // Directions closer than this to the last rendered one reuse its filters
+    const float DIRECTION_TOLERANCE = 0.5f;
+
+    // Woodworth spherical head model used by HrtfQuality::Low
+    const float HEAD_RADIUS = 0.0875f;       // meters
+    const float SPEED_OF_SOUND = 343.0f;     // meters per second
+    const float FAR_EAR_ATTENUATION = 0.5f;  // gain of the far ear for a source at 90 degrees
+    const float SHADOW_CUTOFF_OPEN = 20000.0f;
+    const float SHADOW_CUTOFF_SHADOWED = 1500.0f;
+
+    // History kept for the Low tier's fractional interaural delay, a power of two
+    const int DELAY_LINE_SIZE = 256;
+    const int DELAY_LINE_MASK = DELAY_LINE_SIZE - 1;
+
+    // Processing continues this long after the input goes idle, so reverberant tails ring out
+    const int TAIL_SAMPLES = HrirSet::MAX_TAPS + BLOCK_SIZE;
+
+    /**
+     * Per-ear settings of the Low tier
+     */
+    struct LowTierSettings
+    {
+        float delay[2] = { 0.0f, 0.0f };        // samples
+        float gain[2] = { 1.0f, 1.0f };
+        float coefficient[2] = { 0.0f, 0.0f };  // one-pole head shadow low-pass
+    };
+
+    struct HrtfInstance
+    {
+        explicit HrtfInstance(int sampleRate)
+            : sampleRate(static_cast<float>(sampleRate))
+        {
+            parameters[HRTF_AZIMUTH].store(0.0f);
+            parameters[HRTF_ELEVATION].store(0.0f);
+            parameters[HRTF_QUALITY].store(static_cast<float>(HrtfQuality::High));
+            dirty.store(true);
+
+            // Allocate everything up front so the mixer thread never does
+            convolver.Prepare(BLOCK_SIZE, MAX_PARTITIONS);
+            std::vector<float> silence(HrirSet::MAX_TAPS, 0.0f);
+            for (auto& filterPair : filters)
+            {
+                for (ConvolutionFilter& filter : filterPair)
+                    filter.Set(silence.data(), HrirSet::MAX_TAPS, convolver.GetFFT());
+            }
+            leftTaps.assign(HrirSet::MAX_TAPS, 0.0f);
+            rightTaps.assign(HrirSet::MAX_TAPS, 0.0f);
+            Reset();
+        }
+
+        void Reset()
+        {
+            convolver.Reset();
+            convolving = false;
+            memset(inputBlock, 0, sizeof(inputBlock));
+            memset(outputBlock, 0, sizeof(outputBlock));
+            memset(delayLine, 0, sizeof(delayLine));
+            blockFill = 0;
+            delayWrite = 0;
+            shadowState[0] = shadowState[1] = 0.0f;
+            idleSamples = 0;
+        }
+
+        HrtfQuality GetQuality(const HrirSet* set) const
+        {
+            if (!set || set->GetMeasurementCount() == 0)
+                return HrtfQuality::Low;
+            const int quality = static_cast<int>(parameters[HRTF_QUALITY].load(std::memory_order_relaxed) + 0.5f);
+            return static_cast<HrtfQuality>(std::min(std::max(quality, 0), static_cast<int>(HrtfQuality::High)));
+        }
+
+        LowTierSettings ComputeLowTier(float azimuth, float elevation) const
+        {
+            // Lateral angle of the source, positive towards the left ear
+            const float lateralSine = cosf(elevation / RADIANS_TO_DEGREES) * sinf(azimuth / RADIANS_TO_DEGREES);
+            const float lateral = asinf(std::min(std::max(lateralSine, -1.0f), 1.0f));
+            const float itd = HEAD_RADIUS / SPEED_OF_SOUND * (lateral + sinf(lateral)) * sampleRate;
+
+            LowTierSettings settings;
+            const int farEar = lateralSine >= 0.0f ? 1 : 0;
+            const float shadow = fabsf(lateralSine);
+            const float cutoff = SHADOW_CUTOFF_OPEN * powf(SHADOW_CUTOFF_SHADOWED / SHADOW_CUTOFF_OPEN, shadow);
+            settings.delay[farEar] = fabsf(itd);
+            settings.gain[farEar] = 1.0f - (1.0f - FAR_EAR_ATTENUATION) * shadow;
+            settings.coefficient[farEar] = expf(-2.0f * PI * std::min(cutoff, 0.45f * sampleRate) / sampleRate);
+            return settings;
+        }
+
+        void BuildFilters(const HrirSet& set, HrtfQuality tier, int slot)
+        {
+            const bool high = tier == HrtfQuality::High;
+            const int taps = high ? std::min(set.GetLength(), static_cast<int>(HrirSet::MAX_TAPS)) : HrtfSpatializer::MEDIUM_TAPS;
+            set.Interpolate(azimuth, elevation, high ? HIGH_NEIGHBOURS : 1, taps, leftTaps.data(), rightTaps.data());
+            filters[slot][0].Set(leftTaps.data(), taps, convolver.GetFFT());
+            filters[slot][1].Set(rightTaps.data(), taps, convolver.GetFFT());
+        }
+
+        void RenderConvolution(int slot, float* left, float* right)
+        {
+            convolver.ConvolveBlock(filters[slot][0], left);
+            convolver.ConvolveBlock(filters[slot][1], right);
+        }
+
+        void RenderLowTier(const LowTierSettings& settings, float* state, float* left, float* right) const
+        {
+            float* outputs[2] = { left, right };
+            const int blockStart = delayWrite - BLOCK_SIZE;
+            for (int ear = 0; ear < 2; ++ear)
+            {
+                const int whole = static_cast<int>(settings.delay[ear]);
+                const float fraction = settings.delay[ear] - static_cast<float>(whole);
+                const float coefficient = settings.coefficient[ear];
+                const float gain = settings.gain[ear];
+                float y = state[ear];
+                for (int n = 0; n < BLOCK_SIZE; ++n)
+                {
+                    const int index = blockStart + n - whole;
+                    const float x = delayLine[index & DELAY_LINE_MASK] * (1.0f - fraction)
+                                  + delayLine[(index - 1) & DELAY_LINE_MASK] * fraction;
+                    y = x + coefficient * (y - x);
+                    outputs[ear][n] = y * gain;
+                }
+                state[ear] = y;
+            }
+        }
+
+        void Render(const HrtfQuality tier, const LowTierSettings& low, int slot, bool stateful, float* left, float* right)
+        {
+            if (tier == HrtfQuality::Low)
+            {
+                // A render which is only faded out must not advance the filter state
+                float scratchState[2] = { shadowState[0], shadowState[1] };
+                RenderLowTier(low, stateful ? shadowState : scratchState, left, right);
+            }
+            else
+                RenderConvolution(slot, left, right);
+        }
+
+        /**
+         * Spatializes inputBlock into outputBlock, crossfading from the previous direction and tier if either changed.
+         */
+        void ProcessBlock(const HrirSet* set)
+        {
+            for (int n = 0; n < BLOCK_SIZE; ++n)
+                delayLine[(delayWrite + n) & DELAY_LINE_MASK] = inputBlock[n];
+            delayWrite = (delayWrite + BLOCK_SIZE) & DELAY_LINE_MASK;
+
+            const HrtfQuality previousTier = tier;
+            const int previousSlot = slot;
+            const LowTierSettings previousLow = low;
+
+            tier = GetQuality(set);
+            bool changed = tier != previousTier || !initialized;
+            if (dirty.exchange(false, std::memory_order_acquire))
+            {
+                const float newAzimuth = parameters[HRTF_AZIMUTH].load(std::memory_order_relaxed);
+                const float newElevation = parameters[HRTF_ELEVATION].load(std::memory_order_relaxed);
+                if (fabsf(newAzimuth - azimuth) > DIRECTION_TOLERANCE || fabsf(newElevation - elevation) > DIRECTION_TOLERANCE)
+                {
+                    azimuth = newAzimuth;
+                    elevation = newElevation;
+                    changed = true;
+                }
+            }
+
+            if (changed)
+            {
+                if (tier == HrtfQuality::Low)
+                    low = ComputeLowTier(azimuth, elevation);
+                else
+                {
+                    slot = 1 - slot;
+                    BuildFilters(*set, tier, slot);
+                }
+            }
+
+            const bool fade = changed && initialized;
+            initialized = true;
+
+            const bool needsConvolution = tier != HrtfQuality::Low || (fade && previousTier != HrtfQuality::Low);
+            if (needsConvolution)
+            {
+                if (!convolving)
+                    convolver.Reset();
+                convolver.PushBlock(inputBlock);
+            }
+            convolving = needsConvolution;
+
+            float* left = outputBlock;
+            float* right = outputBlock + BLOCK_SIZE;
+            Render(tier, low, slot, true, left, right);
+            if (!fade)
+                return;
+
+            Render(previousTier, previousLow, previousSlot, false, fadeLeft, fadeRight);
+            for (int n = 0; n < BLOCK_SIZE; ++n)
+            {
+                const float t = static_cast<float>(n + 1) / BLOCK_SIZE;
+                left[n] = fadeLeft[n] + t * (left[n] - fadeLeft[n]);
+                right[n] = fadeRight[n] + t * (right[n] - fadeRight[n]);
+            }
+        }
+
+        /**
+         * Downmixes an interleaved buffer into the input FIFO and writes the matching stereo output,
+         * one block behind.
+         */
+        void Process(const float* input, int inChannels, float* output, unsigned int length, const HrirSet* set)
+        {
+            const float downmix = 1.0f / static_cast<float>(std::max(inChannels, 1));
+            for (unsigned int frame = 0; frame < length; ++frame)
+            {
+                float mono = 0.0f;
+                if (input)
+                {
+                    for (int channel = 0; channel < inChannels; ++channel)
+                        mono += input[frame * inChannels + channel];
+                }
+                inputBlock[blockFill] = mono * downmix;
+                output[frame * 2] = outputBlock[blockFill];
+                output[frame * 2 + 1] = outputBlock[BLOCK_SIZE + blockFill];
+
+                if (++blockFill == BLOCK_SIZE)
+                {
+                    ProcessBlock(set);
+                    blockFill = 0;
+                }
+            }
+        }
+
+        std::atomic<float> parameters[HRTF_NUM_PARAMETERS];
+        std::atomic<bool> dirty;
+
+        float sampleRate;
+        float azimuth = 0.0f;
+        float elevation = 0.0f;
+        HrtfQuality tier = HrtfQuality::Low;
+        bool initialized = false;
+        int idleSamples = 0;
+
+        // Convolution tiers; the filter pair in use alternates between two slots so the old pair
+        // is still available to crossfade from
+        PartitionedConvolver convolver;
+        ConvolutionFilter filters[2][2];
+        int slot = 0;
+        bool convolving = false;
+        std::vector<float> leftTaps;
+        std::vector<float> rightTaps;
+
+        // Low tier
+        LowTierSettings low;
+        float shadowState[2];
+        float delayLine[DELAY_LINE_SIZE];
+        int delayWrite = 0;
+
+        // Block FIFO: mono input being gathered, and the stereo output of the previous block
+        float inputBlock[BLOCK_SIZE];
+        float outputBlock[2 * BLOCK_SIZE];
+        float fadeLeft[BLOCK_SIZE];
+        float fadeRight[BLOCK_SIZE];
+        int blockFill = 0;
+    };
+
+    HrtfInstance* Get(FMOD_DSP_STATE* dspState) { return static_cast<HrtfInstance*>(dspState->plugindata); }
+
+    FMOD_RESULT F_CALL Create(FMOD_DSP_STATE* dspState)
+    {
+        int sampleRate = 0;
+        FMOD_DSP_GETSAMPLERATE(dspState, &sampleRate);
+        dspState->plugindata = new HrtfInstance(sampleRate);
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL Release(FMOD_DSP_STATE* dspState)
+    {
+        delete Get(dspState);
+        dspState->plugindata = nullptr;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL Reset(FMOD_DSP_STATE* dspState)
+    {
+        Get(dspState)->Reset();
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL Process(FMOD_DSP_STATE* dspState, unsigned int length, const FMOD_DSP_BUFFER_ARRAY* inBuffers,
+                               FMOD_DSP_BUFFER_ARRAY* outBuffers, FMOD_BOOL inputsIdle, FMOD_DSP_PROCESS_OPERATION operation)
+    {
+        HrtfInstance* instance = Get(dspState);
+        if (operation == FMOD_DSP_PROCESS_QUERY)
+        {
+            // Always stereo out, whatever comes in
+            if (outBuffers)
+            {
+                outBuffers->buffernumchannels[0] = 2;
+                outBuffers->bufferchannelmask[0] = 0;
+                outBuffers->speakermode = FMOD_SPEAKERMODE_STEREO;
+            }
+
+            if (!inputsIdle)
+                instance->idleSamples = 0;
+            else if (instance->idleSamples >= TAIL_SAMPLES)
+                return FMOD_ERR_DSP_DONTPROCESS;
+            return FMOD_OK;
+        }
+
+        void* userData = nullptr;
+        FMOD_DSP_GETUSERDATA(dspState, &userData);
+
+        // Idle input is not guaranteed to be silent, so feed silence while the tail rings out
+        if (inputsIdle)
+            instance->idleSamples += static_cast<int>(length);
+        const float* input = inputsIdle ? nullptr : inBuffers->buffers[0];
+        instance->Process(input, inBuffers->buffernumchannels[0], outBuffers->buffers[0], length, static_cast<const HrirSet*>(userData));
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL SetParameterFloat(FMOD_DSP_STATE* dspState, int index, float value)
+    {
+        if (index < 0 || index >= HRTF_NUM_PARAMETERS)
+            return FMOD_ERR_INVALID_PARAM;
+        HrtfInstance* instance = Get(dspState);
+        instance->parameters[index].store(value, std::memory_order_relaxed);
+        instance->dirty.store(true, std::memory_order_release);
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL GetParameterFloat(FMOD_DSP_STATE* dspState, int index, float* value, char* valueString)
+    {
+        if (index < 0 || index >= HRTF_NUM_PARAMETERS)
+            return FMOD_ERR_INVALID_PARAM;
+        *value = Get(dspState)->parameters[index].load(std::memory_order_relaxed);
+        if (valueString)
+            snprintf(valueString, FMOD_DSP_GETPARAM_VALUESTR_LENGTH, "%.2f", *value);
+        return FMOD_OK;
+    }
+
+    FMOD_DSP_PARAMETER_DESC** DescribeParameters()
+    {
+        static FMOD_DSP_PARAMETER_DESC descriptions[HRTF_NUM_PARAMETERS];
+        static FMOD_DSP_PARAMETER_DESC* pointers[HRTF_NUM_PARAMETERS];
+        FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[HRTF_AZIMUTH], "Azimuth", "deg", "Source direction counterclockwise from the front", -180.0f, 180.0f, 0.0f);
+        FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[HRTF_ELEVATION], "Elevation", "deg", "Source direction up from the horizontal plane", -90.0f, 90.0f, 0.0f);
+        FMOD_DSP_INIT_PARAMDESC_FLOAT(descriptions[HRTF_QUALITY], "Quality", "", "0 interaural model, 1 short nearest response, 2 full interpolated response", 0.0f, 2.0f, 2.0f);
+        for (int i = 0; i < HRTF_NUM_PARAMETERS; ++i)
+            pointers[i] = &descriptions[i];
+        return pointers;
+    }
+
+    FMOD_DSP_DESCRIPTION Describe()
+    {
+        FMOD_DSP_DESCRIPTION description;
+        memset(&description, 0, sizeof(description));
+        description.pluginsdkversion = FMOD_PLUGIN_SDK_VERSION;
+        strncpy(description.name, "Engine HRTF Spatializer", sizeof(description.name) - 1);
+        description.version = 0x00010000;
+        description.numinputbuffers = 1;
+        description.numoutputbuffers = 1;
+        description.create = &Create;
+        description.release = &Release;
+        description.reset = &Reset;
+        description.process = &Process;
+        description.numparameters = HRTF_NUM_PARAMETERS;
+        description.paramdesc = DescribeParameters();
+        description.setparameterfloat = &SetParameterFloat;
+        description.getparameterfloat = &GetParameterFloat;
+        return description;
+    }
+}
+
+const FMOD_DSP_DESCRIPTION* HrtfSpatializer::GetDescription()
+{
+    static const FMOD_DSP_DESCRIPTION description = Describe();
+    return &description;
+}
+
+void HrtfSpatializer::GetDirection(const FMOD_VECTOR& listenerPosition, const FMOD_VECTOR& forward, const FMOD_VECTOR& up,
+                                   const FMOD_VECTOR& sourcePosition, float& azimuth, float& elevation)
+{
+    const float dx = sourcePosition.x - listenerPosition.x;
+    const float dy = sourcePosition.y - listenerPosition.y;
+    const float dz = sourcePosition.z - listenerPosition.z;
+
+    // In left-handed coordinates up x forward points right, so forward x up points left
+    const float leftX = forward.y * up.z - forward.z * up.y;
+    const float leftY = forward.z * up.x - forward.x * up.z;
+    const float leftZ = forward.x * up.y - forward.y * up.x;
+
+    const float front = dx * forward.x + dy * forward.y + dz * forward.z;
+    const float side = dx * leftX + dy * leftY + dz * leftZ;
+    const float height = dx * up.x + dy * up.y + dz * up.z;
+
+    azimuth = atan2f(side, front) * RADIANS_TO_DEGREES;
+    elevation = atan2f(height, sqrtf(front * front + side * side)) * RADIANS_TO_DEGREES;
+}
@@ -0,0 +1,64 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file HrtfSpatializer.h
+///
+/// Binaural spatializer DSP for headphone playback. Placed on a channel, it downmixes the
+/// channel to mono and renders it to stereo through the HrirSet given as the DSP's user data.
+/// Convolution is partitioned FFT convolution (PartitionedConvolver), 128 samples per block,
+/// which is also the latency the spatializer adds.
+///
+/// Each instance runs at one of three quality tiers so the engine can bound the cost of many
+/// emitters by giving the full treatment only to the closest ones:
+///     High   - full length responses blended from the three nearest measurements
+///     Medium - responses truncated to 64 taps from the nearest measurement
+///     Low    - no convolution; interaural time and level difference and a head shadow filter
+/// Direction and tier changes crossfade over one block.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+
+/**
+ * Parameters of the HRTF spatializer DSP
+ */
+enum HrtfParameter
+{
+    HRTF_AZIMUTH,               // degrees, counterclockwise from the front
+    HRTF_ELEVATION,             // degrees, up from the horizontal plane
+    HRTF_QUALITY,               // HrtfQuality
+
+    HRTF_NUM_PARAMETERS
+};
+
+enum class HrtfQuality
+{
+    Low,
+    Medium,
+    High
+};
+
+class HrtfSpatializer
+{
+public:
+
+    // Samples per convolution block, and the latency of the spatializer
+    static const int BLOCK_SIZE = 128;
+
+    // Response length used at HrtfQuality::Medium
+    static const int MEDIUM_TAPS = 64;
+
+    /**
+     * Returns the FMOD plugin description of the spatializer.
+     */
+    static const FMOD_DSP_DESCRIPTION* GetDescription();
+
+    /**
+     * Returns the direction of a source relative to a listener in the spatializer's convention.
+     * Uses FMOD's default left-handed coordinates; forward and up must be perpendicular.
+     */
+    static void GetDirection(const FMOD_VECTOR& listenerPosition, const FMOD_VECTOR& forward, const FMOD_VECTOR& up,
+                             const FMOD_VECTOR& sourcePosition, float& azimuth, float& elevation);
+};
@@ -0,0 +1,153 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file LookaheadLimiter.cpp
+/// @author JDSherbert
+
+#include "LookaheadLimiter.h"
+
+#include "SimdLanes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    /** Largest absolute sample of one interleaved frame */
+    float FramePeak(const float* frame, int channels)
+    {
+        int channel = 0;
+        float peak = 0.0f;
+#if defined(AUDIO_ENGINE_SSE)
+        if (channels >= SseLanes::WIDTH)
+        {
+            SseLanes::Register peaks = SseLanes::Zero();
+            for (; channel + SseLanes::WIDTH <= channels; channel += SseLanes::WIDTH)
+                peaks = SseLanes::Max(peaks, SseLanes::Abs(SseLanes::Load(frame + channel)));
+            peak = SseLanes::HorizontalMax(peaks);
+        }
+        for (; channel + SseHalfLanes::WIDTH <= channels; channel += SseHalfLanes::WIDTH)
+            peak = fmaxf(peak, SseHalfLanes::HorizontalMax(SseHalfLanes::Abs(SseHalfLanes::Load(frame + channel))));
+#endif
+        for (; channel < channels; ++channel)
+            peak = fmaxf(peak, fabsf(frame[channel]));
+        return peak;
+    }
+
+    /** destination = source * gain for one interleaved frame */
+    void ScaleFrame(const float* source, float* destination, int channels, float gain)
+    {
+        int channel = 0;
+#if defined(AUDIO_ENGINE_SSE)
+        const SseLanes::Register gains = SseLanes::Set(gain);
+        for (; channel + SseLanes::WIDTH <= channels; channel += SseLanes::WIDTH)
+            SseLanes::Store(destination + channel, SseLanes::Mul(SseLanes::Load(source + channel), gains));
+        for (; channel + SseHalfLanes::WIDTH <= channels; channel += SseHalfLanes::WIDTH)
+            SseHalfLanes::Store(destination + channel, SseHalfLanes::Mul(SseHalfLanes::Load(source + channel), gains));
+#endif
+        for (; channel < channels; ++channel)
+            destination[channel] = source[channel] * gain;
+    }
+}
+
+LookaheadLimiter::LookaheadLimiter()
+{
+}
+
+void LookaheadLimiter::Prepare(int newSampleRate)
+{
+    sampleRate = newSampleRate;
+    capacity = static_cast<int>(ceilf(MAX_LOOKAHEAD_MS * 0.001f * sampleRate)) + 2;
+    delayLine.assign(static_cast<size_t>(capacity) * MAX_CHANNELS, 0.0f);
+    framePeaks.assign(capacity, 0.0f);
+    peakQueue.assign(capacity, 0);
+    Reset();
+}
+
+void LookaheadLimiter::SetParameters(float ceilingdB, float lookaheadMS, float releaseMS)
+{
+    ceiling = powf(10.0f, 0.05f * ceilingdB);
+
+    const int newLookahead = static_cast<int>(fminf(lookaheadMS, MAX_LOOKAHEAD_MS) * 0.001f * sampleRate);
+    const int clampedLookahead = newLookahead < 1 ? 1 : (newLookahead > capacity - 2 ? capacity - 2 : newLookahead);
+    if (clampedLookahead != lookahead)
+    {
+        lookahead = clampedLookahead;
+        Reset();
+    }
+
+    // Attack settles within the lookahead, so the gain is down before the peak leaves the delay line
+    attackCoefficient = expf(-4.6f / static_cast<float>(lookahead));
+    releaseCoefficient = releaseMS > 0.0f ? expf(-1.0f / (0.001f * releaseMS * sampleRate)) : 0.0f;
+}
+
+void LookaheadLimiter::Reset()
+{
+    std::fill(delayLine.begin(), delayLine.end(), 0.0f);
+    std::fill(framePeaks.begin(), framePeaks.end(), 0.0f);
+    writeIndex = 0;
+    queueHead = 0;
+    queueSize = 0;
+    gain = 1.0f;
+}
+
+void LookaheadLimiter::Process(const float* input, float* output, unsigned int frames, int channels)
+{
+    if (capacity == 0 || channels > MAX_CHANNELS)
+    {
+        if (input != output)
+            memcpy(output, input, frames * channels * sizeof(float));
+        return;
+    }
+
+    if (channels != channelCount)
+    {
+        channelCount = channels;
+        Reset();
+    }
+
+    for (unsigned int frame = 0; frame < frames; ++frame)
+    {
+        const float* in = input + frame * channels;
+        float* slot = &delayLine[static_cast<size_t>(writeIndex) * MAX_CHANNELS];
+
+        // Push the incoming frame's peak into the sliding window maximum
+        const float peak = FramePeak(in, channels);
+        framePeaks[writeIndex] = peak;
+        while (queueSize > 0 && framePeaks[peakQueue[(queueHead + queueSize - 1) % capacity]] <= peak)
+            --queueSize;
+        peakQueue[(queueHead + queueSize) % capacity] = writeIndex;
+        ++queueSize;
+
+        // The frame leaving the delay line is 'lookahead' frames behind the one coming in
+        const int readIndex = (writeIndex - lookahead + capacity) % capacity;
+        const int expired = (readIndex - 1 + capacity) % capacity;
+        if (queueSize > 1 && peakQueue[queueHead] == expired)
+        {
+            queueHead = (queueHead + 1) % capacity;
+            --queueSize;
+        }
+
+        const float windowPeak = framePeaks[peakQueue[queueHead]];
+        const float targetGain = windowPeak > ceiling ? ceiling / windowPeak : 1.0f;
+        const float coefficient = targetGain < gain ? attackCoefficient : releaseCoefficient;
+        gain = targetGain + coefficient * (gain - targetGain);
+
+        // Never let the delayed frame through above the ceiling, even if the attack has not settled
+        const float delayedPeak = framePeaks[readIndex];
+        if (delayedPeak * gain > ceiling)
+            gain = ceiling / delayedPeak;
+
+        // Store the incoming frame before writing output, as output may alias input
+        memcpy(slot, in, channels * sizeof(float));
+        const float* delayedFrame = &delayLine[static_cast<size_t>(readIndex) * MAX_CHANNELS];
+        ScaleFrame(delayedFrame, output + frame * channels, channels, gain);
+
+        writeIndex = (writeIndex + 1) % capacity;
+    }
+}
+
+float LookaheadLimiter::GetGainReductiondB() const
+{
+    return 20.0f * log10f(gain);
+}
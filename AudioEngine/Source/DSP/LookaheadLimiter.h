@@ -0,0 +1,76 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file LookaheadLimiter.h
+///
+/// Peak limiter which delays the signal by a short lookahead so gain reduction is already
+/// in place when a peak arrives. All channels share one gain so the stereo image is kept.
+///
+/// @author JDSherbert
+
+#include <vector>
+
+class LookaheadLimiter
+{
+public:
+
+    static const int MAX_CHANNELS = 32;
+
+    // Longest lookahead that can be set after Prepare()
+    static constexpr float MAX_LOOKAHEAD_MS = 20.0f;
+
+    LookaheadLimiter();
+
+    /**
+     * Allocates the delay line for the given sample rate. Must be called before Process(),
+     * and never from the mixer thread.
+     */
+    void Prepare(int sampleRate);
+
+    /**
+     * @param ceilingdB - highest output peak level in decibels
+     * @param lookaheadMS - delay used to anticipate peaks, clamped to MAX_LOOKAHEAD_MS
+     * @param releaseMS - time for gain reduction to recover
+     */
+    void SetParameters(float ceilingdB, float lookaheadMS, float releaseMS);
+
+    /**
+     * Clears the delay line and gain history.
+     */
+    void Reset();
+
+    /**
+     * Limits an interleaved buffer. input and output may be the same buffer.
+     */
+    void Process(const float* input, float* output, unsigned int frames, int channels);
+
+    /**
+     * Returns the gain reduction applied to the last processed frame, in decibels.
+     */
+    float GetGainReductiondB() const;
+
+private:
+
+    int sampleRate = 0;
+    int capacity = 0;           // delay line length in frames
+    int lookahead = 1;          // current lookahead in frames
+    int writeIndex = 0;
+    int channelCount = 0;       // channel count the delay line is laid out for
+
+    float ceiling = 1.0f;
+    float attackCoefficient = 0.0f;
+    float releaseCoefficient = 0.0f;
+    float gain = 1.0f;
+
+    // Interleaved delay line, capacity * MAX_CHANNELS samples
+    std::vector<float> delayLine;
+
+    // Peak of each frame in the delay line
+    std::vector<float> framePeaks;
+
+    // Monotonic queue of frame indices used for an O(1) sliding window maximum
+    std::vector<int> peakQueue;
+    int queueHead = 0;
+    int queueSize = 0;
+};
@@ -0,0 +1,408 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file LoudnessMeter.cpp
+/// @author JDSherbert
+
+#include "LoudnessMeter.h"
+
+#include "SimdLanes.h"
+#include "../../AudioEngine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const double PI = 3.14159265358979;
+
+    // Gates and offsets from BS.1770-4
+    const float ABSOLUTE_GATE_LUFS = -70.0f;
+    const float RELATIVE_GATE_LU = -10.0f;
+    const float LOUDNESS_OFFSET = -0.691f;
+    const float HISTOGRAM_BINS_PER_LU = 10.0f;
+
+    // Weight of surround channels, +1.5 dB
+    const float SURROUND_WEIGHT = 1.41f;
+
+    // Pass band of the oversampling filter, as a fraction of the input Nyquist frequency
+    const double OVERSAMPLING_PASS_BAND = 0.9;
+
+    float PowerToLUFS(double power)
+    {
+        if (power <= 0.0)
+            return LoudnessSnapshot::SILENCE_LUFS;
+        return fmaxf(LOUDNESS_OFFSET + 10.0f * static_cast<float>(log10(power)), LoudnessSnapshot::SILENCE_LUFS);
+    }
+
+    /**
+     * BS.1770 K-weighting stages, designed for any sample rate so that they match the
+     * coefficients the standard tabulates for 48kHz.
+     */
+    BiquadCoefficients HeadShelf(double sampleRate)
+    {
+        const double frequency = 1681.974450955533;
+        const double gaindB = 3.999843853973347;
+        const double q = 0.7071752369554196;
+
+        const double k = tan(PI * frequency / sampleRate);
+        const double vh = pow(10.0, gaindB / 20.0);
+        const double vb = pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+
+        BiquadCoefficients coefficients;
+        coefficients.b0 = static_cast<float>((vh + vb * k / q + k * k) / a0);
+        coefficients.b1 = static_cast<float>(2.0 * (k * k - vh) / a0);
+        coefficients.b2 = static_cast<float>((vh - vb * k / q + k * k) / a0);
+        coefficients.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+        coefficients.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+        return coefficients;
+    }
+
+    BiquadCoefficients RlbHighPass(double sampleRate)
+    {
+        const double frequency = 38.13547087602444;
+        const double q = 0.5003270373238773;
+
+        const double k = tan(PI * frequency / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+
+        BiquadCoefficients coefficients;
+        coefficients.b0 = 1.0f;
+        coefficients.b1 = -2.0f;
+        coefficients.b2 = 1.0f;
+        coefficients.a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+        coefficients.a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+        return coefficients;
+    }
+
+    /** Weight of a channel in FMOD's speaker order for the given channel count */
+    float ChannelWeight(int channel, int channels)
+    {
+        switch (channels)
+        {
+            case 4:                         // L R Ls Rs
+                return channel >= 2 ? SURROUND_WEIGHT : 1.0f;
+            case 5:                         // L R C Ls Rs
+                return channel >= 3 ? SURROUND_WEIGHT : 1.0f;
+            case 6:                         // L R C LFE Ls Rs
+            case 8:                         // L R C LFE Ls Rs Lb Rb
+                return channel == 3 ? 0.0f : channel >= 4 ? SURROUND_WEIGHT : 1.0f;
+            default:
+                return 1.0f;
+        }
+    }
+}
+
+/**
+ * Accumulates the K-weighted energy and the true peak of a group of channels, one channel per lane.
+ */
+struct LoudnessMeter::Kernel
+{
+    LoudnessMeter& meter;
+    const float* input;
+    const float* weighted;
+    unsigned int frames;
+    int channels;
+
+    template <typename Lanes>
+    void Process(int first)
+    {
+        typedef typename Lanes::Register Register;
+
+        Register energy = Lanes::Load(&meter.channelEnergy[first]);
+        Register peak = Lanes::Load(&meter.truePeaks[first]);
+        int position = meter.historyPosition;
+
+        for (unsigned int frame = 0; frame < frames; ++frame)
+        {
+            const Register y = Lanes::Load(&weighted[frame * channels + first]);
+            energy = Lanes::Add(energy, Lanes::Mul(y, y));
+
+            // The sample itself, then the points between it and the previous sample
+            const Register x = Lanes::Load(&input[frame * channels + first]);
+            peak = Lanes::Max(peak, Lanes::Abs(x));
+            Lanes::Store(&meter.history[position][first], x);
+            Lanes::Store(&meter.history[position + PHASE_TAPS][first], x);
+            position = position + 1 == PHASE_TAPS ? 0 : position + 1;
+
+            for (int phase = 0; phase < OVERSAMPLING; ++phase)
+            {
+                const float* coefficients = meter.phaseCoefficients[phase];
+                Register sum = Lanes::Zero();
+                for (int tap = 0; tap < PHASE_TAPS; ++tap)
+                    sum = Lanes::Add(sum, Lanes::Mul(Lanes::Set(coefficients[tap]), Lanes::Load(&meter.history[position + tap][first])));
+                peak = Lanes::Max(peak, Lanes::Abs(sum));
+            }
+        }
+
+        Lanes::Store(&meter.channelEnergy[first], energy);
+        Lanes::Store(&meter.truePeaks[first], peak);
+    }
+};
+
+LoudnessMeter::LoudnessMeter()
+    : resetRequested(false)
+    , sequence(0)
+    , publishedMomentary(LoudnessSnapshot::SILENCE_LUFS)
+    , publishedShortTerm(LoudnessSnapshot::SILENCE_LUFS)
+    , publishedIntegrated(LoudnessSnapshot::SILENCE_LUFS)
+    , publishedTruePeak(LoudnessSnapshot::SILENCE_LUFS)
+    , publishedSeconds(0.0f)
+{
+    // Windowed sinc interpolator, split into one filter per output phase with taps ordered oldest input first
+    const int length = OVERSAMPLING * PHASE_TAPS;
+    for (int phase = 0; phase < OVERSAMPLING; ++phase)
+    {
+        float sum = 0.0f;
+        for (int tap = 0; tap < PHASE_TAPS; ++tap)
+        {
+            const int n = phase + OVERSAMPLING * (PHASE_TAPS - 1 - tap);
+            const double t = (n - 0.5 * (length - 1)) / OVERSAMPLING;
+            const double x = PI * OVERSAMPLING_PASS_BAND * t;
+            const double sinc = x == 0.0 ? 1.0 : sin(x) / x;
+            const double window = 0.42 - 0.5 * cos(2.0 * PI * (n + 0.5) / length) + 0.08 * cos(4.0 * PI * (n + 0.5) / length);
+            phaseCoefficients[phase][tap] = static_cast<float>(sinc * window);
+            sum += phaseCoefficients[phase][tap];
+        }
+        for (int tap = 0; tap < PHASE_TAPS; ++tap)
+            phaseCoefficients[phase][tap] /= sum;
+    }
+
+    std::fill(channelWeights, channelWeights + MAX_CHANNELS, 1.0f);
+    Prepare(48000);
+}
+
+LoudnessMeter::~LoudnessMeter()
+{
+    Detach();
+}
+
+void LoudnessMeter::Prepare(int sampleRate)
+{
+    subBlockSize = std::max(sampleRate / 10, 1);
+    weighting.SetStageCount(2);
+    weighting.SetStage(0, HeadShelf(sampleRate));
+    weighting.SetStage(1, RlbHighPass(sampleRate));
+    ResetMeasurement();
+}
+
+void LoudnessMeter::Process(const float* input, unsigned int frames, int channels)
+{
+    if (resetRequested.exchange(false, std::memory_order_acquire))
+        ResetMeasurement();
+
+    const int measured = std::min(channels, static_cast<int>(MAX_CHANNELS));
+    if (channels != channelCount)
+    {
+        channelCount = channels;
+        for (int channel = 0; channel < measured; ++channel)
+            channelWeights[channel] = ChannelWeight(channel, channels);
+        weighting.Reset();
+        memset(history, 0, sizeof(history));
+    }
+
+    unsigned int offset = 0;
+    while (offset < frames)
+    {
+        // Chunks never straddle a sub-block, so each one lands in a single 100ms block
+        const unsigned int count = std::min(std::min(frames - offset, static_cast<unsigned int>(CHUNK_FRAMES)),
+                                            static_cast<unsigned int>(subBlockSize - subBlockFill));
+        const float* chunk = input + offset * channels;
+        if (channels > MAX_CHANNELS)
+        {
+            for (unsigned int frame = 0; frame < count; ++frame)
+                memcpy(&narrowed[frame * measured], &chunk[frame * channels], measured * sizeof(float));
+            chunk = narrowed;
+        }
+
+        weighting.Process(chunk, weighted, count, measured);
+        Kernel kernel = { *this, chunk, weighted, count, measured };
+        ForEachChannelGroup(kernel, measured);
+        historyPosition = (historyPosition + count) % PHASE_TAPS;
+
+        offset += count;
+        subBlockFill += count;
+        if (subBlockFill == subBlockSize)
+            CloseSubBlock();
+    }
+}
+
+void LoudnessMeter::CloseSubBlock()
+{
+    double power = 0.0;
+    for (int channel = 0; channel < std::min(channelCount, static_cast<int>(MAX_CHANNELS)); ++channel)
+    {
+        power += channelWeights[channel] * channelEnergy[channel];
+        channelEnergy[channel] = 0.0f;
+    }
+    subBlockPower[subBlockHead] = power / subBlockSize;
+    subBlockHead = (subBlockHead + 1) % SUB_BLOCKS;
+    subBlockFill = 0;
+    ++subBlocksMeasured;
+
+    auto windowPower = [this](int blocks)
+    {
+        double sum = 0.0;
+        for (int i = 1; i <= blocks; ++i)
+            sum += subBlockPower[(subBlockHead - i + SUB_BLOCKS) % SUB_BLOCKS];
+        return sum / blocks;
+    };
+
+    float momentary = LoudnessSnapshot::SILENCE_LUFS;
+    float shortTerm = LoudnessSnapshot::SILENCE_LUFS;
+    if (subBlocksMeasured >= SUB_BLOCKS)
+        shortTerm = PowerToLUFS(windowPower(SUB_BLOCKS));
+
+    // Every momentary window is also a gating block, giving the standard's 75% overlap
+    if (subBlocksMeasured >= MOMENTARY_SUB_BLOCKS)
+    {
+        const double blockPower = windowPower(MOMENTARY_SUB_BLOCKS);
+        momentary = PowerToLUFS(blockPower);
+        if (momentary > ABSOLUTE_GATE_LUFS)
+        {
+            const int bin = std::min(static_cast<int>((momentary - ABSOLUTE_GATE_LUFS) * HISTOGRAM_BINS_PER_LU), HISTOGRAM_BINS - 1);
+            ++histogramCounts[bin];
+            histogramPower[bin] += blockPower;
+        }
+    }
+
+    // Integrated loudness: mean of the blocks above the absolute gate sets the relative gate
+    float integrated = LoudnessSnapshot::SILENCE_LUFS;
+    unsigned long long blocks = 0;
+    double sum = 0.0;
+    for (int bin = 0; bin < HISTOGRAM_BINS; ++bin)
+    {
+        blocks += histogramCounts[bin];
+        sum += histogramPower[bin];
+    }
+    if (blocks > 0)
+    {
+        const float relativeGate = PowerToLUFS(sum / blocks) + RELATIVE_GATE_LU;
+        const int firstBin = std::max(static_cast<int>(floorf((relativeGate - ABSOLUTE_GATE_LUFS) * HISTOGRAM_BINS_PER_LU)), 0);
+        blocks = 0;
+        sum = 0.0;
+        for (int bin = firstBin; bin < HISTOGRAM_BINS; ++bin)
+        {
+            blocks += histogramCounts[bin];
+            sum += histogramPower[bin];
+        }
+        if (blocks > 0)
+            integrated = PowerToLUFS(sum / blocks);
+    }
+
+    Publish(momentary, shortTerm, integrated);
+}
+
+void LoudnessMeter::ResetMeasurement()
+{
+    memset(channelEnergy, 0, sizeof(channelEnergy));
+    memset(subBlockPower, 0, sizeof(subBlockPower));
+    memset(histogramCounts, 0, sizeof(histogramCounts));
+    memset(histogramPower, 0, sizeof(histogramPower));
+    memset(history, 0, sizeof(history));
+    memset(truePeaks, 0, sizeof(truePeaks));
+    weighting.Reset();
+    subBlockFill = 0;
+    subBlockHead = 0;
+    subBlocksMeasured = 0;
+    historyPosition = 0;
+
+    const float silence = LoudnessSnapshot::SILENCE_LUFS;
+    Publish(silence, silence, silence);
+}
+
+void LoudnessMeter::Publish(float momentary, float shortTerm, float integrated)
+{
+    float peak = 0.0f;
+    for (int channel = 0; channel < MAX_CHANNELS; ++channel)
+        peak = std::max(peak, truePeaks[channel]);
+    const float truePeak = fmaxf(peak > 0.0f ? 20.0f * log10f(peak) : LoudnessSnapshot::SILENCE_LUFS, LoudnessSnapshot::SILENCE_LUFS);
+
+    const unsigned int start = sequence.load(std::memory_order_relaxed);
+    sequence.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    publishedMomentary.store(momentary, std::memory_order_relaxed);
+    publishedShortTerm.store(shortTerm, std::memory_order_relaxed);
+    publishedIntegrated.store(integrated, std::memory_order_relaxed);
+    publishedTruePeak.store(truePeak, std::memory_order_relaxed);
+    publishedSeconds.store(subBlocksMeasured * 0.1f, std::memory_order_relaxed);
+    sequence.store(start + 2, std::memory_order_release);
+}
+
+void LoudnessMeter::Reset()
+{
+    resetRequested.store(true, std::memory_order_release);
+}
+
+LoudnessSnapshot LoudnessMeter::GetSnapshot() const
+{
+    // Retry if the mixer was publishing, which lasts a handful of instructions
+    LoudnessSnapshot snapshot;
+    unsigned int before, after;
+    do
+    {
+        before = sequence.load(std::memory_order_acquire);
+        snapshot.momentaryLUFS = publishedMomentary.load(std::memory_order_relaxed);
+        snapshot.shortTermLUFS = publishedShortTerm.load(std::memory_order_relaxed);
+        snapshot.integratedLUFS = publishedIntegrated.load(std::memory_order_relaxed);
+        snapshot.truePeakdBTP = publishedTruePeak.load(std::memory_order_relaxed);
+        snapshot.measuredSeconds = publishedSeconds.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+    return snapshot;
+}
+
+void LoudnessMeter::Attach(FMOD::System* system, FMOD::ChannelGroup* targetBus)
+{
+    static FMOD_DSP_DESCRIPTION description = []()
+    {
+        FMOD_DSP_DESCRIPTION result;
+        memset(&result, 0, sizeof(result));
+        result.pluginsdkversion = FMOD_PLUGIN_SDK_VERSION;
+        strncpy(result.name, "Engine Loudness Meter", sizeof(result.name) - 1);
+        result.version = 0x00010000;
+        result.numinputbuffers = 1;
+        result.numoutputbuffers = 1;
+        result.read = &LoudnessMeter::Read;
+        return result;
+    }();
+
+    int sampleRate = 0;
+    ERRCHECK(system->getSoftwareFormat(&sampleRate, nullptr, nullptr));
+    Prepare(sampleRate);
+
+    bus = targetBus;
+    ERRCHECK(system->createDSP(&description, &dsp));
+    ERRCHECK(dsp->setUserData(this));
+    ERRCHECK(bus->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, dsp));
+}
+
+void LoudnessMeter::Detach()
+{
+    if (!dsp)
+        return;
+
+    ERRCHECK(bus->removeDSP(dsp));
+    ERRCHECK(dsp->release());
+    dsp = nullptr;
+    bus = nullptr;
+}
+
+FMOD_RESULT F_CALL LoudnessMeter::Read
+(
+    FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+    unsigned int length, int inChannels, int* outChannels
+)
+{
+    void* userData = nullptr;
+    FMOD_DSP_GETUSERDATA(dspState, &userData);
+
+    // The meter only listens, the bus passes through untouched
+    *outChannels = inChannels;
+    memcpy(outBuffer, inBuffer, length * inChannels * sizeof(float));
+    if (LoudnessMeter* meter = static_cast<LoudnessMeter*>(userData))
+        meter->Process(inBuffer, length, inChannels);
+    return FMOD_OK;
+}
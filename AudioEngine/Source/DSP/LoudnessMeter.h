@@ -0,0 +1,158 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file LoudnessMeter.h
+///
+/// Loudness meter placed on a bus, measuring it as ITU-R BS.1770 / EBU R128 describe:
+///     momentary  - K-weighted loudness over the last 400ms
+///     short-term - K-weighted loudness over the last 3s
+///     integrated - gated loudness since the last reset (-70 LUFS absolute gate, -10 LU relative gate)
+///     true peak  - highest inter-sample peak since the last reset, found by 4x oversampling
+/// The K-weighting filters and the oversampler run several channels at once (see SimdLanes.h).
+/// The mixer thread publishes a snapshot every 100ms through a sequence lock, so any thread can
+/// read it without locking or stalling the mixer.
+///
+/// Integrated loudness is gated through a histogram of 0.1 LU bins rather than a list of blocks,
+/// so hours of measurement use fixed memory; gate thresholds are rounded down to a bin edge.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+
+#include <atomic>
+
+#include "Filters.h"
+
+struct LoudnessSnapshot
+{
+    // Loudness reported while nothing has been measured, and for silence
+    static constexpr float SILENCE_LUFS = -120.0f;
+
+    float momentaryLUFS = SILENCE_LUFS;
+    float shortTermLUFS = SILENCE_LUFS;
+    float integratedLUFS = SILENCE_LUFS;
+
+    // Highest true peak since the last reset, in decibels relative to full scale
+    float truePeakdBTP = SILENCE_LUFS;
+
+    // Audio measured since the last reset
+    float measuredSeconds = 0.0f;
+};
+
+class LoudnessMeter
+{
+public:
+
+    // Channels past MAX_CHANNELS (7.1) are not measured
+    static const int MAX_CHANNELS = 8;
+
+    LoudnessMeter();
+    ~LoudnessMeter();
+
+    /**
+     * Sets the sample rate of the measured audio and restarts measurement.
+     * Must not be called while attached.
+     */
+    void Prepare(int sampleRate);
+
+    /**
+     * Measures an interleaved buffer. Channels are weighted by position as BS.1770 defines for
+     * FMOD's speaker orders: surrounds by +1.5 dB, the LFE of 5.1 and 7.1 is ignored.
+     */
+    void Process(const float* input, unsigned int frames, int channels);
+
+    /**
+     * Restarts the integrated loudness and true peak. Safe to call from any thread; takes
+     * effect on the mixer's next block.
+     */
+    void Reset();
+
+    /**
+     * Returns the latest measurements. Safe to call from any thread.
+     */
+    LoudnessSnapshot GetSnapshot() const;
+
+    /**
+     * Creates the meter DSP and inserts it at the head (post-fader) of a bus.
+     * Pass the master channel group to meter the final mix.
+     */
+    void Attach(FMOD::System* system, FMOD::ChannelGroup* targetBus);
+
+    /**
+     * Removes the meter DSP from its bus and releases it.
+     */
+    void Detach();
+
+private:
+
+    static FMOD_RESULT F_CALL Read(FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+                                   unsigned int length, int inChannels, int* outChannels);
+
+    struct Kernel;
+
+    // Frames K-weighted at once into the scratch buffers
+    static const int CHUNK_FRAMES = 256;
+
+    // 100ms sub-blocks kept for the short-term window
+    static const int SUB_BLOCKS = 30;
+    static const int MOMENTARY_SUB_BLOCKS = 4;
+
+    // Integrated loudness histogram, 0.1 LU bins from the absolute gate up
+    static const int HISTOGRAM_BINS = 1000;
+
+    // Oversampler: 4 phases of a 48 tap low-pass
+    static const int OVERSAMPLING = 4;
+    static const int PHASE_TAPS = 12;
+
+    /** Closes a 100ms sub-block, updates every measurement and publishes them */
+    void CloseSubBlock();
+
+    /** Clears the integrated loudness, true peak and windows */
+    void ResetMeasurement();
+
+    void Publish(float momentary, float shortTerm, float integrated);
+
+    FMOD::ChannelGroup* bus = nullptr;
+    FMOD::DSP* dsp = nullptr;
+
+    int channelCount = 0;
+    float channelWeights[MAX_CHANNELS];
+    int subBlockSize = 4800;
+
+    // K-weighting: high shelf (head acoustics) then high-pass (RLB curve)
+    BiquadCascade weighting;
+    float weighted[CHUNK_FRAMES * MAX_CHANNELS];
+    float narrowed[CHUNK_FRAMES * MAX_CHANNELS];
+
+    // Sub-block being gathered
+    float channelEnergy[MAX_CHANNELS];
+    int subBlockFill = 0;
+
+    // Mean square of recent sub-blocks, channel weighted
+    double subBlockPower[SUB_BLOCKS];
+    int subBlockHead = 0;
+    long long subBlocksMeasured = 0;
+
+    // Gating blocks above the absolute gate: count and summed power per loudness bin
+    unsigned int histogramCounts[HISTOGRAM_BINS];
+    double histogramPower[HISTOGRAM_BINS];
+
+    // Oversampler state. History is written twice, so the last PHASE_TAPS inputs of each channel
+    // are always contiguous starting at historyPosition.
+    float phaseCoefficients[OVERSAMPLING][PHASE_TAPS];
+    float history[2 * PHASE_TAPS][MAX_CHANNELS];
+    int historyPosition = 0;
+    float truePeaks[MAX_CHANNELS];
+
+    std::atomic<bool> resetRequested;
+
+    // Sequence lock guarding the published snapshot; odd while the mixer is writing
+    std::atomic<unsigned int> sequence;
+    std::atomic<float> publishedMomentary;
+    std::atomic<float> publishedShortTerm;
+    std::atomic<float> publishedIntegrated;
+    std::atomic<float> publishedTruePeak;
+    std::atomic<float> publishedSeconds;
+};
@@ -0,0 +1,133 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file PartitionedConvolver.cpp
+/// @author JDSherbert
+
+#include "PartitionedConvolver.h"
+
+#include "SimdLanes.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Spectra are padded to a multiple of the widest SIMD width
+    const int BIN_PADDING = 8;
+
+    int PaddedBins(int blockSize)
+    {
+        return (blockSize + 1 + BIN_PADDING - 1) / BIN_PADDING * BIN_PADDING;
+    }
+
+    /**
+     * accumulator += x * h over bins complex values, bins being a multiple of Lanes::WIDTH.
+     */
+    template <typename Lanes>
+    void MultiplyAccumulate(const float* xReal, const float* xImaginary, const float* hReal, const float* hImaginary,
+                            float* accumulatorReal, float* accumulatorImaginary, int bins)
+    {
+        for (int bin = 0; bin < bins; bin += Lanes::WIDTH)
+        {
+            const typename Lanes::Register xr = Lanes::Load(xReal + bin);
+            const typename Lanes::Register xi = Lanes::Load(xImaginary + bin);
+            const typename Lanes::Register hr = Lanes::Load(hReal + bin);
+            const typename Lanes::Register hi = Lanes::Load(hImaginary + bin);
+
+            const typename Lanes::Register real = Lanes::Sub(Lanes::Mul(xr, hr), Lanes::Mul(xi, hi));
+            const typename Lanes::Register imaginary = Lanes::Add(Lanes::Mul(xr, hi), Lanes::Mul(xi, hr));
+
+            Lanes::Store(accumulatorReal + bin, Lanes::Add(Lanes::Load(accumulatorReal + bin), real));
+            Lanes::Store(accumulatorImaginary + bin, Lanes::Add(Lanes::Load(accumulatorImaginary + bin), imaginary));
+        }
+    }
+
+#if defined(AUDIO_ENGINE_AVX)
+    typedef AvxLanes SpectrumLanes;
+#else
+    typedef DefaultLanes SpectrumLanes;
+#endif
+}
+
+void ConvolutionFilter::Set(const float* impulse, int length, FFT& fft)
+{
+    blockSize = fft.GetSize() / 2;
+    partitions = std::max((length + blockSize - 1) / blockSize, 1);
+    stride = PaddedBins(blockSize);
+
+    real.resize(static_cast<size_t>(partitions) * stride);
+    imaginary.resize(static_cast<size_t>(partitions) * stride);
+    scratch.resize(fft.GetSize());
+
+    for (int partition = 0; partition < partitions; ++partition)
+    {
+        // Each partition is zero padded to the transform size for overlap-save
+        const int offset = partition * blockSize;
+        const int count = std::max(std::min(blockSize, length - offset), 0);
+        std::fill(scratch.begin(), scratch.end(), 0.0f);
+        if (count > 0)
+            memcpy(scratch.data(), impulse + offset, count * sizeof(float));
+
+        float* partitionReal = &real[partition * stride];
+        float* partitionImaginary = &imaginary[partition * stride];
+        fft.Forward(scratch.data(), partitionReal, partitionImaginary);
+        std::fill(partitionReal + fft.GetBinCount(), partitionReal + stride, 0.0f);
+        std::fill(partitionImaginary + fft.GetBinCount(), partitionImaginary + stride, 0.0f);
+    }
+}
+
+void PartitionedConvolver::Prepare(int newBlockSize, int newMaxPartitions)
+{
+    blockSize = newBlockSize;
+    maxPartitions = std::max(newMaxPartitions, 1);
+    stride = PaddedBins(blockSize);
+
+    fft.reset(new FFT(2 * blockSize));
+    window.assign(2 * blockSize, 0.0f);
+    delayReal.assign(static_cast<size_t>(maxPartitions) * stride, 0.0f);
+    delayImaginary.assign(static_cast<size_t>(maxPartitions) * stride, 0.0f);
+    accumulatorReal.assign(stride, 0.0f);
+    accumulatorImaginary.assign(stride, 0.0f);
+    timeDomain.assign(2 * blockSize, 0.0f);
+    newest = 0;
+}
+
+void PartitionedConvolver::Reset()
+{
+    std::fill(window.begin(), window.end(), 0.0f);
+    std::fill(delayReal.begin(), delayReal.end(), 0.0f);
+    std::fill(delayImaginary.begin(), delayImaginary.end(), 0.0f);
+    newest = 0;
+}
+
+void PartitionedConvolver::PushBlock(const float* input)
+{
+    // Slide the window and transform it into the next delay line slot
+    memmove(window.data(), window.data() + blockSize, blockSize * sizeof(float));
+    memcpy(window.data() + blockSize, input, blockSize * sizeof(float));
+
+    newest = (newest + 1) % maxPartitions;
+    fft->Forward(window.data(), &delayReal[newest * stride], &delayImaginary[newest * stride]);
+}
+
+void PartitionedConvolver::ConvolveBlock(const ConvolutionFilter& filter, float* output, int firstPartition, int partitionCount)
+{
+    int lastPartition = partitionCount < 0 ? filter.GetPartitionCount() : firstPartition + partitionCount;
+    lastPartition = std::min(std::min(lastPartition, filter.GetPartitionCount()), maxPartitions);
+
+    std::fill(accumulatorReal.begin(), accumulatorReal.end(), 0.0f);
+    std::fill(accumulatorImaginary.begin(), accumulatorImaginary.end(), 0.0f);
+
+    // Partition p is applied to the input from p blocks ago
+    for (int partition = firstPartition; partition < lastPartition; ++partition)
+    {
+        const int slot = (newest - partition + maxPartitions) % maxPartitions;
+        MultiplyAccumulate<SpectrumLanes>(&delayReal[slot * stride], &delayImaginary[slot * stride],
+                                          filter.GetReal(partition), filter.GetImaginary(partition),
+                                          accumulatorReal.data(), accumulatorImaginary.data(), stride);
+    }
+
+    // The first half of the window is circular wrap-around; the second half is the linear result
+    fft->Inverse(accumulatorReal.data(), accumulatorImaginary.data(), timeDomain.data());
+    memcpy(output, timeDomain.data() + blockSize, blockSize * sizeof(float));
+}
@@ -0,0 +1,113 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file PartitionedConvolver.h
+///
+/// Uniformly partitioned overlap-save FFT convolution.
+/// An impulse response is cut into blocks which are transformed once (ConvolutionFilter).
+/// Each input block is transformed once into a frequency-domain delay line, and an output
+/// block is the inverse transform of the sum of every delay line entry multiplied by the
+/// matching filter partition. The multiply-accumulate over spectra is SIMD vectorized.
+///
+/// One delay line can be convolved with several filters, e.g. both ears of an HRIR, or the
+/// old and new filter while crossfading between them.
+///
+/// @author JDSherbert
+
+#include <memory>
+#include <vector>
+
+#include "FFT.h"
+
+/**
+ * Frequency-domain partitions of an impulse response.
+ */
+class ConvolutionFilter
+{
+public:
+
+    /**
+     * Splits an impulse response into fft.GetSize() / 2 sample partitions and transforms them.
+     * Replaces the previous contents; only allocates if the response is longer than before.
+     */
+    void Set(const float* impulse, int length, FFT& fft);
+
+    int GetPartitionCount() const { return partitions; }
+    int GetBlockSize() const { return blockSize; }
+
+    /** Bins stored per partition, GetBinCount() padded for SIMD */
+    int GetStride() const { return stride; }
+
+    const float* GetReal(int partition) const { return &real[partition * stride]; }
+    const float* GetImaginary(int partition) const { return &imaginary[partition * stride]; }
+
+private:
+
+    int blockSize = 0;
+    int partitions = 0;
+    int stride = 0;
+
+    std::vector<float> real;
+    std::vector<float> imaginary;
+    std::vector<float> scratch;
+};
+
+class PartitionedConvolver
+{
+public:
+
+    /**
+     * Allocates the transforms and a delay line long enough for filters of maxPartitions
+     * partitions. Must be called before anything else, and never from the mixer thread.
+     * @param blockSize - samples per block and partition, a power of two
+     */
+    void Prepare(int blockSize, int maxPartitions);
+
+    /**
+     * Clears the delay line.
+     */
+    void Reset();
+
+    int GetBlockSize() const { return blockSize; }
+    int GetMaxPartitions() const { return maxPartitions; }
+
+    /**
+     * Returns the FFT of size 2 * blockSize, used to build matching ConvolutionFilters.
+     */
+    FFT& GetFFT() { return *fft; }
+
+    /**
+     * Adds the next blockSize input samples to the delay line.
+     */
+    void PushBlock(const float* input);
+
+    /**
+     * Writes blockSize samples of the delay line convolved with a range of a filter's partitions.
+     * Partitions beyond the delay line length are ignored.
+     * @param firstPartition - partition to start from; output is not delayed, so a tail-only
+     *                         convolution is the caller's to line up
+     * @param partitionCount - number of partitions, or -1 for all from firstPartition
+     */
+    void ConvolveBlock(const ConvolutionFilter& filter, float* output, int firstPartition = 0, int partitionCount = -1);
+
+private:
+
+    int blockSize = 0;
+    int maxPartitions = 0;
+    int stride = 0;
+    int newest = 0;         // delay line slot holding the latest input block
+
+    std::unique_ptr<FFT> fft;
+
+    // Overlap-save window, the previous block followed by the latest
+    std::vector<float> window;
+
+    // Delay line of input spectra, maxPartitions slots of stride bins
+    std::vector<float> delayReal;
+    std::vector<float> delayImaginary;
+
+    std::vector<float> accumulatorReal;
+    std::vector<float> accumulatorImaginary;
+    std::vector<float> timeDomain;
+};
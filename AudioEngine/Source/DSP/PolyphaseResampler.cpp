@@ -0,0 +1,121 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file PolyphaseResampler.cpp
+/// @author JDSherbert
+
+#include "PolyphaseResampler.h"
+
+#include <cmath>
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    // Kaiser window shape for about 100 dB of stopband attenuation
+    const double KAISER_BETA = 10.0;
+
+    // Cutoff as a fraction of the lower Nyquist rate, leaving the transition band just below it
+    const double CUTOFF = 0.95;
+
+    int GreatestCommonDivisor(int a, int b)
+    {
+        while (b != 0)
+        {
+            const int remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        return a;
+    }
+
+    /**
+     * Zeroth order modified Bessel function of the first kind, by its power series
+     */
+    double BesselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 50; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-12)
+                break;
+        }
+        return sum;
+    }
+}
+
+PolyphaseResampler::PolyphaseResampler(int inputRate, int outputRate, int zeroCrossings)
+{
+    const int divisor = GreatestCommonDivisor(inputRate, outputRate);
+    up = outputRate / divisor;
+    down = inputRate / divisor;
+
+    // Downsampling stretches the filter so its cutoff falls below the output's Nyquist rate
+    const double bandwidth = up < down ? static_cast<double>(up) / down : 1.0;
+    tapsPerPhase = static_cast<int>(ceil(2.0 * zeroCrossings / bandwidth));
+    const int length = tapsPerPhase * up;
+
+    // Centred on a whole sample, so removing the delay doesn't shift the output by half a sample
+    delay = length / 2;
+    const double halfWidth = 0.5 * length;
+
+    // Cutoff in cycles per sample at the upsampled rate
+    const double cutoff = CUTOFF * 0.5 * bandwidth / up;
+    const double windowNorm = BesselI0(KAISER_BETA);
+
+    std::vector<double> prototype(length);
+    for (int i = 0; i < length; ++i)
+    {
+        const double t = static_cast<double>(i - delay);
+        const double sinc = t == 0.0 ? 2.0 * cutoff : sin(2.0 * PI * cutoff * t) / (PI * t);
+        const double position = t / halfWidth;
+        const double window = BesselI0(KAISER_BETA * sqrt(fmax(0.0, 1.0 - position * position))) / windowNorm;
+        prototype[i] = sinc * window * up; // up restores the level lost to the zeros inserted by upsampling
+    }
+
+    phases.resize(static_cast<size_t>(length));
+    for (int phase = 0; phase < up; ++phase)
+    {
+        for (int tap = 0; tap < tapsPerPhase; ++tap)
+            phases[static_cast<size_t>(phase) * tapsPerPhase + (tapsPerPhase - 1 - tap)] = static_cast<float>(prototype[phase + tap * up]);
+    }
+}
+
+uint32_t PolyphaseResampler::GetOutputFrames(uint32_t inputFrames) const
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(inputFrames) * up + down - 1) / down);
+}
+
+void PolyphaseResampler::Process(const float* input, uint32_t inputFrames, int inputStride, float* output, int outputStride) const
+{
+    const uint32_t outputFrames = GetOutputFrames(inputFrames);
+    for (uint32_t frame = 0; frame < outputFrames; ++frame)
+    {
+        // Position at the upsampled rate, the input sample at or before it, and the filter phase landing there
+        const int64_t position = static_cast<int64_t>(frame) * down + delay;
+        const int64_t newest = position / up;
+        const float* taps = phases.data() + static_cast<size_t>(position % up) * tapsPerPhase;
+
+        // Taps run forward from the oldest input sample in the window; samples outside the input are silence
+        const int64_t oldest = newest - (tapsPerPhase - 1);
+        const int64_t first = oldest < 0 ? -oldest : 0;
+        const int64_t available = static_cast<int64_t>(inputFrames) - oldest;
+        const int64_t last = available < tapsPerPhase ? available : tapsPerPhase;
+
+        float sum = 0.0f;
+        for (int64_t tap = first; tap < last; ++tap)
+            sum += taps[tap] * input[(oldest + tap) * inputStride];
+        output[static_cast<size_t>(frame) * outputStride] = sum;
+    }
+}
+
+std::vector<float> PolyphaseResampler::ProcessInterleaved(const std::vector<float>& input, int channels) const
+{
+    const uint32_t inputFrames = static_cast<uint32_t>(input.size() / channels);
+    std::vector<float> output(static_cast<size_t>(GetOutputFrames(inputFrames)) * channels);
+    for (int channel = 0; channel < channels; ++channel)
+        Process(input.data() + channel, inputFrames, channels, output.data() + channel, channels);
+    return output;
+}
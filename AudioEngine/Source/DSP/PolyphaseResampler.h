@@ -0,0 +1,60 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file PolyphaseResampler.h
+///
+/// Offline sample rate converter for the asset tools. Converts by the exact ratio of the two
+/// rates, reduced to L/M (44.1 kHz from 48 kHz is 147/160): conceptually the input is upsampled
+/// by L, low-pass filtered and downsampled by M. Only the L phases of the filter that land on an
+/// output sample are ever evaluated, each a short dot product with the input.
+/// The filter is a Kaiser windowed sinc cut off just below the lower of the two Nyquist rates,
+/// attenuating aliases by about 100 dB. Not meant for the mixer thread: it designs its filter
+/// and allocates on construction.
+///
+/// @author JDSherbert
+
+#include <cstdint>
+#include <vector>
+
+class PolyphaseResampler
+{
+public:
+
+    /**
+     * Designs the filter for a conversion.
+     * @param zeroCrossings - sinc lobes kept each side of the centre; more is a sharper cutoff at more cost
+     */
+    PolyphaseResampler(int inputRate, int outputRate, int zeroCrossings = 32);
+
+    /**
+     * Returns the frames Process() produces from inputFrames frames
+     */
+    uint32_t GetOutputFrames(uint32_t inputFrames) const;
+
+    /**
+     * Resamples one channel of an interleaved buffer into one channel of another.
+     * The output is aligned with the input, the filter's delay having been removed.
+     */
+    void Process(const float* input, uint32_t inputFrames, int inputStride, float* output, int outputStride) const;
+
+    /**
+     * Resamples every channel of an interleaved buffer
+     */
+    std::vector<float> ProcessInterleaved(const std::vector<float>& input, int channels) const;
+
+    int GetUpFactor() const { return up; }
+    int GetDownFactor() const { return down; }
+
+private:
+
+    int up = 1;
+    int down = 1;
+    int tapsPerPhase = 0;
+
+    // Filter delay at the upsampled rate, removed from the output
+    int64_t delay = 0;
+
+    // up phases of tapsPerPhase taps, each reversed so it runs forward over the input
+    std::vector<float> phases;
+};
@@ -0,0 +1,210 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SidechainDucking.cpp
+/// @author JDSherbert
+
+#include "SidechainDucking.h"
+
+#include "../../AudioEngine.h"
+#include "../Tools/Utils.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    FMOD_DSP_DESCRIPTION MakeDescription(const char* name, FMOD_DSP_READ_CALLBACK read)
+    {
+        FMOD_DSP_DESCRIPTION description;
+        memset(&description, 0, sizeof(description));
+        description.pluginsdkversion = FMOD_PLUGIN_SDK_VERSION;
+        strncpy(description.name, name, sizeof(description.name) - 1);
+        description.version = 0x00010000;
+        description.numinputbuffers = 1;
+        description.numoutputbuffers = 1;
+        description.read = read;
+        return description;
+    }
+
+    /** One-pole smoothing coefficient reaching ~63% of a step in timeMS */
+    float SmoothingCoefficient(float timeMS, int sampleRate)
+    {
+        if (timeMS <= 0.0f || sampleRate <= 0)
+            return 0.0f;
+        return expf(-1.0f / (0.001f * timeMS * static_cast<float>(sampleRate)));
+    }
+}
+
+// SidechainDetector
+
+SidechainDetector::SidechainDetector()
+    : level(0.0f)
+    , levelClock(0)
+{
+}
+
+SidechainDetector::~SidechainDetector()
+{
+    Detach();
+}
+
+void SidechainDetector::Attach(FMOD::System* system, FMOD::ChannelGroup* triggerBus)
+{
+    static FMOD_DSP_DESCRIPTION description = MakeDescription("Sidechain Detector", &SidechainDetector::Read);
+
+    bus = triggerBus;
+    ERRCHECK(system->createDSP(&description, &dsp));
+    ERRCHECK(dsp->setUserData(this));
+    ERRCHECK(bus->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, dsp));
+}
+
+void SidechainDetector::Detach()
+{
+    if (!dsp)
+        return;
+
+    ERRCHECK(bus->removeDSP(dsp));
+    ERRCHECK(dsp->release());
+    dsp = nullptr;
+    bus = nullptr;
+}
+
+float SidechainDetector::GetLevel(unsigned long long clock, unsigned int window) const
+{
+    // A bus that stopped being processed holds a stale level, treat it as silent instead
+    if (clock > levelClock.load(std::memory_order_acquire) + window)
+        return 0.0f;
+    return level.load(std::memory_order_relaxed);
+}
+
+FMOD_RESULT F_CALL SidechainDetector::Read
+(
+    FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+    unsigned int length, int inChannels, int* outChannels
+)
+{
+    void* userData = nullptr;
+    FMOD_DSP_GETUSERDATA(dspState, &userData);
+    SidechainDetector* detector = static_cast<SidechainDetector*>(userData);
+
+    const unsigned int samples = length * inChannels;
+    memcpy(outBuffer, inBuffer, samples * sizeof(float));
+    *outChannels = inChannels;
+
+    if (!detector)
+        return FMOD_OK;
+
+    float peak = 0.0f;
+    for (unsigned int i = 0; i < samples; ++i)
+        peak = fmaxf(peak, fabsf(inBuffer[i]));
+
+    unsigned long long clock = 0;
+    unsigned int offset = 0, blockLength = 0;
+    FMOD_DSP_GETCLOCK(dspState, &clock, &offset, &blockLength);
+
+    detector->level.store(peak, std::memory_order_relaxed);
+    detector->levelClock.store(clock, std::memory_order_release);
+    return FMOD_OK;
+}
+
+// Ducker
+
+Ducker::Ducker(const SidechainDetector& detector, DuckingSettings settings)
+    : detector(detector)
+    , attackMS(settings.attackMS)
+    , releaseMS(settings.releaseMS)
+    , depthdB(settings.depthdB)
+    , thresholddB(settings.thresholddB)
+    , publishedGain(1.0f)
+{
+}
+
+Ducker::~Ducker()
+{
+    Detach();
+}
+
+void Ducker::Attach(FMOD::System* system, FMOD::ChannelGroup* targetBus)
+{
+    static FMOD_DSP_DESCRIPTION description = MakeDescription("Ducker", &Ducker::Read);
+
+    bus = targetBus;
+    ERRCHECK(system->createDSP(&description, &dsp));
+    ERRCHECK(dsp->setUserData(this));
+    ERRCHECK(bus->addDSP(FMOD_CHANNELCONTROL_DSP_TAIL, dsp));
+}
+
+void Ducker::Detach()
+{
+    if (!dsp)
+        return;
+
+    ERRCHECK(bus->removeDSP(dsp));
+    ERRCHECK(dsp->release());
+    dsp = nullptr;
+    bus = nullptr;
+}
+
+void Ducker::SetSettings(DuckingSettings newSettings)
+{
+    attackMS.store(newSettings.attackMS, std::memory_order_relaxed);
+    releaseMS.store(newSettings.releaseMS, std::memory_order_relaxed);
+    depthdB.store(newSettings.depthdB, std::memory_order_relaxed);
+    thresholddB.store(newSettings.thresholddB, std::memory_order_relaxed);
+}
+
+float Ducker::GetAttenuationdB() const
+{
+    return Utils::ConvertVolumeTodB(publishedGain.load(std::memory_order_relaxed));
+}
+
+FMOD_RESULT F_CALL Ducker::Read
+(
+    FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+    unsigned int length, int inChannels, int* outChannels
+)
+{
+    void* userData = nullptr;
+    FMOD_DSP_GETUSERDATA(dspState, &userData);
+    Ducker* ducker = static_cast<Ducker*>(userData);
+
+    *outChannels = inChannels;
+    if (!ducker)
+    {
+        memcpy(outBuffer, inBuffer, length * inChannels * sizeof(float));
+        return FMOD_OK;
+    }
+
+    int sampleRate = 0;
+    FMOD_DSP_GETSAMPLERATE(dspState, &sampleRate);
+
+    unsigned long long clock = 0;
+    unsigned int offset = 0, blockLength = 0;
+    FMOD_DSP_GETCLOCK(dspState, &clock, &offset, &blockLength);
+
+    // The detector may run before or after this DSP in the same block, so allow two blocks of slack
+    const float triggerLevel = ducker->detector.GetLevel(clock, 2 * length);
+    const float threshold = Utils::ConvertdBToVolume(ducker->thresholddB.load(std::memory_order_relaxed));
+    const float targetGain = triggerLevel > threshold
+        ? Utils::ConvertdBToVolume(ducker->depthdB.load(std::memory_order_relaxed))
+        : 1.0f;
+
+    const float coefficient = targetGain < ducker->gain
+        ? SmoothingCoefficient(ducker->attackMS.load(std::memory_order_relaxed), sampleRate)
+        : SmoothingCoefficient(ducker->releaseMS.load(std::memory_order_relaxed), sampleRate);
+
+    float gain = ducker->gain;
+    for (unsigned int frame = 0; frame < length; ++frame)
+    {
+        gain = targetGain + coefficient * (gain - targetGain);
+        for (int channel = 0; channel < inChannels; ++channel)
+        {
+            const unsigned int i = frame * inChannels + channel;
+            outBuffer[i] = inBuffer[i] * gain;
+        }
+    }
+
+    ducker->gain = gain;
+    ducker->publishedGain.store(gain, std::memory_order_relaxed);
+    return FMOD_OK;
+}
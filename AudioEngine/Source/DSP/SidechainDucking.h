@@ -0,0 +1,126 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SidechainDucking.h
+///
+/// Bus-driven ducking which runs entirely on FMOD's mixer thread.
+/// A SidechainDetector follows the level of a trigger bus (e.g. Voice) and each Ducker
+/// attenuates its target bus (e.g. Music) from that level, so no game-thread work is needed.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+
+#include <atomic>
+
+/**
+ * Settings controlling how a target bus is ducked under a trigger bus.
+ */
+struct DuckingSettings
+{
+    // Time in milliseconds for the target to reach full attenuation once the trigger is active
+    float attackMS = 20.0f;
+
+    // Time in milliseconds for the target to recover once the trigger falls silent
+    float releaseMS = 400.0f;
+
+    // Attenuation in decibels applied to the target while the trigger is active
+    float depthdB = -12.0f;
+
+    // Trigger peak level in decibels above which the trigger counts as active
+    float thresholddB = -40.0f;
+};
+
+/**
+ * Custom DSP placed on the trigger bus which passes audio through untouched
+ * and publishes the peak level of every mixer block.
+ */
+class SidechainDetector
+{
+public:
+
+    SidechainDetector();
+    ~SidechainDetector();
+
+    /**
+     * Creates the detector DSP and inserts it at the head (post-fader) of the trigger bus.
+     */
+    void Attach(FMOD::System* system, FMOD::ChannelGroup* triggerBus);
+
+    /**
+     * Removes the detector DSP from the trigger bus and releases it.
+     */
+    void Detach();
+
+    /**
+     * Returns the peak level of the trigger bus for the latest mixer block, or 0 if the
+     * bus has not been processed within the given DSP clock window (muted, paused or idle).
+     */
+    float GetLevel(unsigned long long clock, unsigned int window) const;
+
+private:
+
+    static FMOD_RESULT F_CALL Read(FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+                                   unsigned int length, int inChannels, int* outChannels);
+
+    FMOD::ChannelGroup* bus = nullptr;
+    FMOD::DSP* dsp = nullptr;
+
+    // Written on the mixer thread once per block
+    std::atomic<float> level;
+    std::atomic<unsigned long long> levelClock;
+};
+
+/**
+ * Custom DSP placed on a target bus which applies gain reduction driven by a SidechainDetector,
+ * smoothed by the attack and release times of its DuckingSettings.
+ */
+class Ducker
+{
+public:
+
+    Ducker(const SidechainDetector& detector, DuckingSettings settings);
+    ~Ducker();
+
+    /**
+     * Creates the ducker DSP and inserts it at the tail (pre-fader) of the target bus.
+     */
+    void Attach(FMOD::System* system, FMOD::ChannelGroup* targetBus);
+
+    /**
+     * Removes the ducker DSP from the target bus and releases it.
+     */
+    void Detach();
+
+    /**
+     * Updates the settings. Takes effect on the next mixer block.
+     */
+    void SetSettings(DuckingSettings newSettings);
+
+    /**
+     * Returns the attenuation currently applied to the target bus in decibels.
+     */
+    float GetAttenuationdB() const;
+
+private:
+
+    static FMOD_RESULT F_CALL Read(FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+                                   unsigned int length, int inChannels, int* outChannels);
+
+    const SidechainDetector& detector;
+
+    FMOD::ChannelGroup* bus = nullptr;
+    FMOD::DSP* dsp = nullptr;
+
+    // Settings written by the game thread, read on the mixer thread
+    std::atomic<float> attackMS;
+    std::atomic<float> releaseMS;
+    std::atomic<float> depthdB;
+    std::atomic<float> thresholddB;
+
+    // Linear gain currently applied, owned by the mixer thread
+    float gain = 1.0f;
+    std::atomic<float> publishedGain;
+};
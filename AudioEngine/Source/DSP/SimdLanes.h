@@ -0,0 +1,149 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SimdLanes.h
+///
+/// Thin wrappers over SSE/AVX registers used by the engine's DSP kernels.
+/// LessEqualMask() returns one bit per lane, lane 0 in the lowest bit.
+/// Kernels are written once against the Lanes interface and process one audio channel per lane,
+/// so a stereo or quad buffer is filtered with a single instruction per operation.
+/// Falls back to scalar code on platforms without SSE.
+///
+/// @author JDSherbert
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    #define AUDIO_ENGINE_SSE 1
+    #include <immintrin.h>
+#endif
+
+#if defined(AUDIO_ENGINE_SSE) && defined(__AVX__)
+    #define AUDIO_ENGINE_AVX 1
+#endif
+
+#include <cmath>
+
+#if defined(AUDIO_ENGINE_SSE)
+
+/**
+ * Four channels per register.
+ */
+struct SseLanes
+{
+    typedef __m128 Register;
+    static const int WIDTH = 4;
+
+    static Register Zero() { return _mm_setzero_ps(); }
+    static Register Set(float value) { return _mm_set1_ps(value); }
+    static Register Load(const float* source) { return _mm_loadu_ps(source); }
+    static void Store(float* destination, Register value) { _mm_storeu_ps(destination, value); }
+    static Register Add(Register a, Register b) { return _mm_add_ps(a, b); }
+    static Register Sub(Register a, Register b) { return _mm_sub_ps(a, b); }
+    static Register Mul(Register a, Register b) { return _mm_mul_ps(a, b); }
+    static Register Min(Register a, Register b) { return _mm_min_ps(a, b); }
+    static Register Max(Register a, Register b) { return _mm_max_ps(a, b); }
+    static Register Abs(Register a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static int LessEqualMask(Register a, Register b) { return _mm_movemask_ps(_mm_cmple_ps(a, b)); }
+
+    static float HorizontalMax(Register a)
+    {
+        __m128 shuffled = _mm_max_ps(a, _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)));
+        shuffled = _mm_max_ps(shuffled, _mm_movehl_ps(shuffled, shuffled));
+        return _mm_cvtss_f32(shuffled);
+    }
+};
+
+/**
+ * Two channels in the low half of a register, so stereo buffers are still vectorized.
+ * Unused upper lanes are zero.
+ */
+struct SseHalfLanes : public SseLanes
+{
+    static const int WIDTH = 2;
+
+    static Register Load(const float* source) { return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(source))); }
+    static void Store(float* destination, Register value) { _mm_store_sd(reinterpret_cast<double*>(destination), _mm_castps_pd(value)); }
+};
+
+#endif
+
+#if defined(AUDIO_ENGINE_AVX)
+
+/**
+ * Eight channels per register, used for 7.1 and wider buffers.
+ */
+struct AvxLanes
+{
+    typedef __m256 Register;
+    static const int WIDTH = 8;
+
+    static Register Zero() { return _mm256_setzero_ps(); }
+    static Register Set(float value) { return _mm256_set1_ps(value); }
+    static Register Load(const float* source) { return _mm256_loadu_ps(source); }
+    static void Store(float* destination, Register value) { _mm256_storeu_ps(destination, value); }
+    static Register Add(Register a, Register b) { return _mm256_add_ps(a, b); }
+    static Register Sub(Register a, Register b) { return _mm256_sub_ps(a, b); }
+    static Register Mul(Register a, Register b) { return _mm256_mul_ps(a, b); }
+    static Register Min(Register a, Register b) { return _mm256_min_ps(a, b); }
+    static Register Max(Register a, Register b) { return _mm256_max_ps(a, b); }
+    static Register Abs(Register a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static int LessEqualMask(Register a, Register b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ)); }
+
+    static float HorizontalMax(Register a)
+    {
+        return SseLanes::HorizontalMax(_mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1)));
+    }
+};
+
+#endif
+
+/**
+ * One channel per "register", used where SSE is unavailable and for leftover channels.
+ */
+struct ScalarLanes
+{
+    typedef float Register;
+    static const int WIDTH = 1;
+
+    static Register Zero() { return 0.0f; }
+    static Register Set(float value) { return value; }
+    static Register Load(const float* source) { return *source; }
+    static void Store(float* destination, Register value) { *destination = value; }
+    static Register Add(Register a, Register b) { return a + b; }
+    static Register Sub(Register a, Register b) { return a - b; }
+    static Register Mul(Register a, Register b) { return a * b; }
+    static Register Min(Register a, Register b) { return a < b ? a : b; }
+    static Register Max(Register a, Register b) { return a > b ? a : b; }
+    static Register Abs(Register a) { return fabsf(a); }
+    static int LessEqualMask(Register a, Register b) { return a <= b ? 1 : 0; }
+    static float HorizontalMax(Register a) { return a; }
+};
+
+#if defined(AUDIO_ENGINE_SSE)
+    typedef SseLanes DefaultLanes;
+#else
+    typedef ScalarLanes DefaultLanes;
+#endif
+
+/**
+ * Runs kernel.template Process<Lanes>(firstChannel) over every channel of an interleaved buffer,
+ * using the widest lanes that fit and finishing leftover channels with scalar lanes.
+ * Lanes load channels straight out of each interleaved frame, so no deinterleaving is needed.
+ */
+template <typename Kernel>
+void ForEachChannelGroup(Kernel& kernel, int channels)
+{
+    int channel = 0;
+#if defined(AUDIO_ENGINE_AVX)
+    for (; channel + AvxLanes::WIDTH <= channels; channel += AvxLanes::WIDTH)
+        kernel.template Process<AvxLanes>(channel);
+#endif
+#if defined(AUDIO_ENGINE_SSE)
+    for (; channel + SseLanes::WIDTH <= channels; channel += SseLanes::WIDTH)
+        kernel.template Process<SseLanes>(channel);
+    for (; channel + SseHalfLanes::WIDTH <= channels; channel += SseHalfLanes::WIDTH)
+        kernel.template Process<SseHalfLanes>(channel);
+#endif
+    for (; channel < channels; ++channel)
+        kernel.template Process<ScalarLanes>(channel);
+}
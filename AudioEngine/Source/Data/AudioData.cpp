@@ -6,6 +6,20 @@
 #include "AudioData.h"
 
 AudioData::AudioData()
+    : uniqueID()
+    , filePath(nullptr)
+    , volume(1.0f)
+    , pitch(1.0f)
+    , loaded(false)
+    , loop(false)
+    , is3D(false)
+    , lengthMS(0)
+    , reverbAmount(0.0f)
+    , position()
+    , bus()
+    , stream(false)
+    , maxDistance(5000.0f)
+    , hrtf(false)
 {
 }
 
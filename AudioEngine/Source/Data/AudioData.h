@@ -10,38 +10,62 @@
 
 #pragma once
 
+#include <string>
+
 #include "../Math/Vector3.h"
+#include "SoundId.h"
 
 class AudioData
 {
 private:
 
-    std::string uniqueID;
+    SoundId uniqueID;
     const char* filePath;
     float volume;
+    float pitch;     // Playback speed multiplier, 1 being the original pitch
     bool loaded;
     bool loop;
     bool is3D;
     unsigned int lengthMS;
     float reverbAmount;
     Vector3 position;
-    
+    std::string bus; // Name of the mixer bus this sound plays through, empty for the master group
+    bool stream;     // Stream from disk instead of decoding the whole file into memory on Load
+    float maxDistance; // Distance at which a 3D sound stops attenuating, beyond it the sound is culled
+    bool hrtf;       // Spatialize a 3D sound binaurally once an HRIR set is loaded with AudioEngine::LoadHrtf()
+
 public:
 
     AudioData();
     ~AudioData();
 
-    std::string GetUniqueID() const { return uniqueID; };
+    SoundId GetUniqueID() const { return uniqueID; };
     const char* GetFilePath() const { return filePath; }
     float GetVolume() const { return volume; }
+    float GetPitch() const { return pitch; }
     bool IsLoaded() const { return loaded; };
     bool Loop() const { return loop; };
     bool Is3D() const { return is3D; };
     float GetReverbAmount() const { return reverbAmount; }
     Vector3 GetPosition() const { return position; }
+    const std::string& GetBus() const { return bus; }
+    bool IsStreaming() const { return stream; }
+    float GetMaxDistance() const { return maxDistance; }
+    bool UsesHrtf() const { return hrtf; }
 
+    void SetUniqueID(SoundId id) { uniqueID = id; }
+    void SetFilePath(const char* newFilePath) { filePath = newFilePath; }
+    void SetLoop(bool isLoop) { loop = isLoop; }
+    void Set3D(bool isSpatialized) { is3D = isSpatialized; }
+    void SetReverbAmount(float amount) { reverbAmount = amount; }
+    void SetPosition(const Vector3& newPosition) { position = newPosition; }
+    void SetStreaming(bool isStreaming) { stream = isStreaming; }
     void SetLoaded(bool isLoaded) { loaded = isLoaded; }
     void SetLengthMS(unsigned int length) { lengthMS = length; }
     void SetVolume(float newVolume) { volume = newVolume; }
+    void SetPitch(float newPitch) { pitch = newPitch; }
+    void SetBus(const std::string& busName) { bus = busName; }
+    void SetMaxDistance(float distance) { maxDistance = distance; }
+    void SetHrtf(bool useHrtf) { hrtf = useHrtf; }
 
 };
\ No newline at end of file
@@ -0,0 +1,89 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file AudioEngineSettings.h
+/// @author JDSherbert
+
+#include <FMOD/fmod_common.h>
+
+#include "LatencyProfile.h"
+#include "../Memory/AudioMemory.h"
+
+/**
+ * Options passed to AudioEngine::Init().
+ */
+struct AudioEngineSettings
+{
+    // Compiled SoundManifest whose sound definitions become available through GetAudioData()
+    const char* manifestPath = nullptr;
+
+    // Create the FMOD Studio system. Tools which only play low-level sounds can disable it
+    // to skip Studio's startup cost; bank and event calls are then unavailable.
+    bool enableStudio = true;
+
+    // Process Studio commands inside Update() rather than on a Studio thread of the engine's own.
+    // Servers running an engine per session, each updated from its session's thread, save a thread per engine.
+    bool synchronousStudioUpdate = false;
+
+    // Skip or virtualize 3D sounds that are out of earshot instead of giving them a channel
+    bool distanceCulling = true;
+
+    // Linear volume under which a 3D sound is out of earshot, 0.001 being -60 dB.
+    // 0 culls by each sound's max distance alone.
+    float cullVolumeThreshold = 0.001f;
+
+    // Output device type. FMOD_OUTPUTTYPE_NOSOUND_NRT mixes one block per Update() with no device,
+    // for tests and offline rendering.
+    FMOD_OUTPUTTYPE outputType = FMOD_OUTPUTTYPE_AUTODETECT;
+
+    // Name of a SharedAudioRing to write the final mix into for another process, instead of
+    // playing it; replaces outputType. The reader's pace then drives the mixer (SharedMemoryOutput).
+    const char* sharedMemoryOutput = nullptr;
+
+    // DSP buffers the shared memory ring holds
+    int sharedMemoryOutputBlocks = 8;
+
+    // 3D listeners, one per split-screen player, up to AudioEngine::MAX_LISTENERS
+    int listeners = 1;
+
+    // Output speaker layout. HRTF spatialization is meant for headphones, i.e. stereo.
+    FMOD_SPEAKERMODE speakerMode = FMOD_SPEAKERMODE_STEREO;
+
+    // Mixer block size, sample rate and stream buffering, traded between latency and CPU wakeups.
+    // Custom applies customLatency. The result is reported by AudioEngine::GetLatencyReport().
+    LatencyProfile latencyProfile = LatencyProfile::Balanced;
+    LatencySettings customLatency;
+
+    // HRTF sounds closest to the listener get full quality, the next closest medium quality,
+    // and the rest the cheap interaural model, so the cost of many emitters stays bounded
+    int hrtfHighQualityEmitters = 16;
+    int hrtfMediumQualityEmitters = 32;
+
+    // Convolve the long tail of convolution reverbs on a worker thread instead of the mixer thread
+    bool convolutionWorkerThread = true;
+
+    // Time every mixer block and count underruns and FMOD errors, reported in GetStats()
+    bool mixerTelemetry = true;
+
+    // Engine allocator FMOD is routed through. Process-wide, so only the first Init() applies it.
+    AudioMemorySettings memory;
+};
+
+/**
+ * Wall-clock cost of each AudioEngine startup phase, in milliseconds.
+ * Subsystems created on first use record their cost when they are created, 0 until then.
+ */
+struct AudioEngineStartupTimings
+{
+    float manifestMS = 0.0f;    // reading the compiled SoundManifest
+    float createMS = 0.0f;      // installing the allocator, creating the Studio and/or core system objects
+    float initializeMS = 0.0f;  // configuring and initializing the systems, opening the output device
+    float busesMS = 0.0f;       // creating the default mixer buses
+    float totalMS = 0.0f;       // the whole of Init()
+
+    float effectsMS = 0.0f;     // registering the engine DSP effects, on the first AddBusEffect()
+    float reverbMS = 0.0f;      // creating the 3D reverb, on the first Play() of a sound with reverb
+    float geometryMS = 0.0f;    // creating the occlusion system, on the first LoadLevelGeometry()
+    float hrtfMS = 0.0f;        // loading the HRIR set and registering the spatializer, on LoadHrtf()
+};
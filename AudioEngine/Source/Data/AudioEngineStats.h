@@ -0,0 +1,130 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file AudioEngineStats.h
+/// @author JDSherbert
+
+/**
+ * Mixer thread timing gathered by MixerTelemetry, part of AudioEngineStats.
+ * Processing time is measured from the start to the end of each mixer block.
+ */
+struct MixerTimingStats
+{
+    static const int HISTOGRAM_BINS = 11;
+
+    // Playback length of one mixer block. A block which takes longer to mix than this
+    // is being mixed slower than it is played.
+    float blockBudgetMS = 0.0f;
+
+    // Blocks measured
+    unsigned int blocks = 0;
+
+    // Processing time percentiles and maximum
+    float p50MS = 0.0f;
+    float p95MS = 0.0f;
+    float p99MS = 0.0f;
+    float maxMS = 0.0f;
+
+    // Mean time spent mixing the buses and channels feeding the master group, and in the master group itself
+    float meanSubmixMS = 0.0f;
+    float meanMasterMS = 0.0f;
+
+    // Mean time from the start of one block to the start of the next, i.e. the pace the output pulls blocks
+    float meanIntervalMS = 0.0f;
+
+    // Blocks by processing time in tenths of the budget; the last bin holds blocks over budget
+    unsigned int histogram[HISTOGRAM_BINS] = { };
+
+    // Blocks which took longer to mix than their budget
+    unsigned int overruns = 0;
+
+    // Blocks which started more than 1.5 budgets after the previous one, close to starving the output
+    unsigned int lateBlocks = 0;
+
+    // Blocks which started so late that the whole output buffer must have played out, i.e. audible dropouts
+    unsigned int underruns = 0;
+
+    // Errors reported by FMOD's error callback, from any thread
+    unsigned int fmodErrors = 0;
+
+    // Measurements lost because Update() was not called often enough to drain them
+    unsigned int droppedMeasurements = 0;
+};
+
+/**
+ * Event parameter writes queued with AudioEngine::SetEventParameters(), part of AudioEngineStats.
+ */
+struct ParameterBatchStats
+{
+    // Writes queued
+    unsigned int writes = 0;
+
+    // Writes overwritten by a later write to the same parameter before Update() applied them
+    unsigned int deduplicated = 0;
+
+    // Parameters Update() skipped because they already had the queued value
+    unsigned int unchanged = 0;
+
+    // Parameters Update() set, and the FMOD calls it took (one per event instance)
+    unsigned int applied = 0;
+    unsigned int fmodCalls = 0;
+};
+
+/**
+ * Plays dropped or made room for by instance limits (AudioEngine::SetSoundLimit()), part of AudioEngineStats.
+ */
+struct PlaybackLimitStats
+{
+    // Plays dropped because their sound or bus already had its most channels, with LimitBehavior::Reject
+    unsigned int rejected = 0;
+
+    // Plays dropped because they came sooner than the minimum retrigger interval
+    unsigned int throttled = 0;
+
+    // Channels stopped to make room for a newer play
+    unsigned int stolen = 0;
+};
+
+/**
+ * Running counters kept by the AudioEngine, returned by AudioEngine::GetStats().
+ */
+struct AudioEngineStats
+{
+    // Play() calls for loaded sounds
+    unsigned int playsRequested = 0;
+
+    // One-shots which were never given a channel because they were out of earshot
+    unsigned int playsCulled = 0;
+
+    // Times a looping sound lost its channel because it moved out of earshot, or started out of earshot
+    unsigned int loopsVirtualized = 0;
+
+    // Times a virtual loop got a channel back because it came into earshot
+    unsigned int loopsResumed = 0;
+
+    // Looping sounds currently playing without a channel
+    unsigned int virtualLoops = 0;
+
+    // Current sizes of the engine's bookkeeping, which should stay bounded over a long session
+    unsigned int loadedSounds = 0;
+    unsigned int playingLoops = 0;
+    unsigned int eventInstances = 0;
+    unsigned int hrtfEmitters = 0;
+
+    // Channels FMOD is playing, and how many of them are real rather than virtual
+    int channelsPlaying = 0;
+    int realChannels = 0;
+
+    // Times a stream ran out of decoded data, checked every Update() with mixer telemetry on
+    unsigned int streamStarvations = 0;
+
+    // Batched event parameter writes
+    ParameterBatchStats parameters;
+
+    // Plays affected by instance limits
+    PlaybackLimitStats limits;
+
+    // Mixer thread timing, empty unless AudioEngineSettings::mixerTelemetry is set
+    MixerTimingStats mixer;
+};
@@ -0,0 +1,62 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file EventId.h
+///
+/// Numeric identity of an FMOD Studio event, hashed from its path ("event:/UI/Click") with the
+/// same 64-bit FNV-1a as SoundId. Lets the engine find events on an integer key instead of
+/// passing path strings through FMOD's parser on every call.
+///
+/// @author JDSherbert
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+#include "SoundId.h"
+
+struct EventId
+{
+    uint64_t value = 0;
+
+    constexpr EventId() = default;
+    constexpr explicit EventId(uint64_t hashValue) : value(hashValue) {}
+
+    /**
+     * Hashes an event path. Evaluated at compile time when path is a literal.
+     */
+    static constexpr EventId FromPath(const char* path) { return EventId(HashFNV1a64(path)); }
+
+    constexpr bool IsValid() const { return value != 0; }
+
+    constexpr bool operator==(EventId other) const { return value == other.value; }
+    constexpr bool operator!=(EventId other) const { return value != other.value; }
+    constexpr bool operator<(EventId other) const { return value < other.value; }
+};
+
+/**
+ * "event:/UI/Click"_eid
+ */
+constexpr EventId operator"" _eid(const char* path, size_t)
+{
+    return EventId::FromPath(path);
+}
+
+inline std::ostream& operator<<(std::ostream& stream, EventId id)
+{
+    const std::ios_base::fmtflags flags = stream.flags();
+    stream << "0x" << std::hex << id.value;
+    stream.flags(flags);
+    return stream;
+}
+
+namespace std
+{
+    template <>
+    struct hash<EventId>
+    {
+        size_t operator()(EventId id) const { return static_cast<size_t>(id.value ^ (id.value >> 32)); }
+    };
+}
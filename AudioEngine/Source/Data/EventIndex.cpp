@@ -0,0 +1,72 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file EventIndex.cpp
+/// @author JDSherbert
+
+#include "EventIndex.h"
+
+#include "../../AudioEngine.h"
+
+#include <vector>
+
+namespace
+{
+    // Most event paths fit; longer ones are fetched again at their full length
+    const int PATH_CAPACITY = 256;
+}
+
+int EventIndex::AddBank(FMOD::Studio::Bank* bank)
+{
+    int count = 0;
+    ERRCHECK(bank->getEventCount(&count));
+    if (count <= 0)
+        return 0;
+
+    std::vector<FMOD::Studio::EventDescription*> descriptions(count);
+    ERRCHECK(bank->getEventList(descriptions.data(), count, &count));
+    descriptions.resize(count);
+
+    byPath.reserve(byPath.size() + count);
+    byGuid.reserve(byGuid.size() + count);
+    std::vector<char> path(PATH_CAPACITY);
+    for (FMOD::Studio::EventDescription* description : descriptions)
+    {
+        FMOD_GUID guid;
+        ERRCHECK(description->getID(&guid));
+        byGuid[guid] = description;
+
+        // Fails without the strings bank, leaving the event reachable by GUID only
+        int length = 0;
+        FMOD_RESULT result = description->getPath(path.data(), static_cast<int>(path.size()), &length);
+        if (result == FMOD_ERR_TRUNCATED)
+        {
+            path.resize(length);
+            result = description->getPath(path.data(), static_cast<int>(path.size()), &length);
+        }
+        if (result != FMOD_OK)
+            continue;
+
+        auto inserted = byPath.insert({ EventId::FromPath(path.data()), description });
+        if (!inserted.second && inserted.first->second != description)
+            std::cout << "Event Index: " << path.data() << " has the same hash as another event, only the first is indexed\n";
+    }
+    return count;
+}
+
+FMOD::Studio::EventDescription* EventIndex::Find(EventId id) const
+{
+    auto it = byPath.find(id);
+    return it != byPath.end() ? it->second : nullptr;
+}
+
+FMOD::Studio::EventDescription* EventIndex::Find(const FMOD_GUID& guid) const
+{
+    auto it = byGuid.find(guid);
+    return it != byGuid.end() ? it->second : nullptr;
+}
+
+void EventIndex::Clear()
+{
+    byPath.clear();
+    byGuid.clear();
+}
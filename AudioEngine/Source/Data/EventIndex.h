@@ -0,0 +1,67 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file EventIndex.h
+///
+/// Hash index of the events in every loaded Studio bank, built once when a bank loads with
+/// Bank::getEventList(). Events are found by hashed path or by GUID in constant time, so
+/// lookups never go through Studio's path parser.
+/// Paths are only available if the bank's strings bank is loaded; without it events are
+/// indexed by GUID alone.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Studio
+
+#include <FMOD/fmod_studio.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+#include "EventId.h"
+
+class EventIndex
+{
+public:
+
+    /**
+     * Indexes every event in a loaded bank. Events already indexed are kept.
+     * @return number of events in the bank
+     */
+    int AddBank(FMOD::Studio::Bank* bank);
+
+    /**
+     * Returns the description of an event, or nullptr if no loaded bank holds it.
+     */
+    FMOD::Studio::EventDescription* Find(EventId id) const;
+    FMOD::Studio::EventDescription* Find(const FMOD_GUID& guid) const;
+
+    /**
+     * Number of events indexed by GUID.
+     */
+    size_t GetCount() const { return byGuid.size(); }
+
+    void Clear();
+
+private:
+
+    struct GuidHash
+    {
+        size_t operator()(const FMOD_GUID& guid) const
+        {
+            uint64_t halves[2];
+            memcpy(halves, &guid, sizeof(halves));
+            return std::hash<uint64_t>()(halves[0] ^ (halves[1] * 0x9E3779B97F4A7C15ull));
+        }
+    };
+
+    struct GuidEqual
+    {
+        bool operator()(const FMOD_GUID& a, const FMOD_GUID& b) const { return memcmp(&a, &b, sizeof(FMOD_GUID)) == 0; }
+    };
+
+    std::unordered_map<EventId, FMOD::Studio::EventDescription*> byPath;
+    std::unordered_map<FMOD_GUID, FMOD::Studio::EventDescription*, GuidHash, GuidEqual> byGuid;
+};
@@ -0,0 +1,65 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file EventParameterBatch.cpp
+/// @author JDSherbert
+
+#include "EventParameterBatch.h"
+
+void EventParameterBatch::Queue(const EventParameterWrite* writes, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const EventParameterWrite& write = writes[i];
+        if (!write.instance.IsValid() || !write.parameter.IsValid())
+            continue;
+
+        ++stats.writes;
+        if (write.instance.index >= instances.size())
+            instances.resize(write.instance.index + 1);
+        InstanceSlots& instance = instances[write.instance.index];
+        if (write.parameter.index >= instance.parameters.size())
+            instance.parameters.resize(write.parameter.index + 1);
+
+        Slot& slot = instance.parameters[write.parameter.index];
+        slot.pendingValue = write.value;
+        if (slot.dirty)
+        {
+            ++stats.deduplicated;
+            continue;
+        }
+
+        slot.dirty = true;
+        instance.dirty.push_back(write.parameter.index);
+        if (!instance.queued)
+        {
+            instance.queued = true;
+            dirtyInstances.push_back(write.instance.index);
+        }
+    }
+}
+
+void EventParameterBatch::ForgetInstance(EventInstanceHandle instance)
+{
+    if (!instance.IsValid() || instance.index >= instances.size())
+        return;
+
+    InstanceSlots& slots = instances[instance.index];
+    if (slots.queued)
+    {
+        for (size_t i = 0; i < dirtyInstances.size(); ++i)
+        {
+            if (dirtyInstances[i] == instance.index)
+            {
+                dirtyInstances.erase(dirtyInstances.begin() + i);
+                break;
+            }
+        }
+    }
+    slots = InstanceSlots();
+}
+
+void EventParameterBatch::Clear()
+{
+    instances.clear();
+    dirtyInstances.clear();
+}
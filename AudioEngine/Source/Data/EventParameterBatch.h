@@ -0,0 +1,143 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file EventParameterBatch.h
+///
+/// Collects event parameter writes made during a frame and applies them together in
+/// AudioEngine::Update(). Writes name their instance and parameter by handles, which index
+/// flat tables instead of maps keyed by strings. Only the last write to a parameter in a frame
+/// is kept, parameters already at the written value are skipped, and every changed parameter
+/// of an instance is set with a single FMOD call.
+///
+/// @author JDSherbert
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "AudioEngineStats.h"
+
+/**
+ * An event instance created with AudioEngine::CreateEventInstance()
+ */
+struct EventInstanceHandle
+{
+    static const uint32_t INVALID = 0xFFFFFFFF;
+
+    uint32_t index = INVALID;
+
+    bool IsValid() const { return index != INVALID; }
+};
+
+/**
+ * A parameter of an event, returned by AudioEngine::GetEventParameterHandle()
+ */
+struct EventParameterHandle
+{
+    static const uint32_t INVALID = 0xFFFFFFFF;
+
+    uint32_t index = INVALID;
+
+    bool IsValid() const { return index != INVALID; }
+};
+
+struct EventParameterWrite
+{
+    EventInstanceHandle instance;
+    EventParameterHandle parameter;
+    float value = 0.0f;
+};
+
+class EventParameterBatch
+{
+public:
+
+    /**
+     * Queues writes, replacing earlier writes to the same parameter of the same instance.
+     * Writes with an invalid handle are ignored.
+     */
+    void Queue(const EventParameterWrite* writes, size_t count);
+
+    /**
+     * Hands the queued parameters whose value changed to apply, one call per instance:
+     *   bool apply(uint32_t instance, const uint32_t* parameters, const float* values, int count)
+     * and empties the queue. Values only count as applied if apply returns true, so a failed
+     * call doesn't make later writes of the same values look unchanged.
+     */
+    template <typename ApplyFunction>
+    void Flush(ApplyFunction apply)
+    {
+        for (uint32_t instanceIndex : dirtyInstances)
+        {
+            InstanceSlots& instance = instances[instanceIndex];
+            instance.queued = false;
+            flushParameters.clear();
+            flushValues.clear();
+            for (uint32_t parameter : instance.dirty)
+            {
+                Slot& slot = instance.parameters[parameter];
+                slot.dirty = false;
+                if (slot.applied && slot.appliedValue == slot.pendingValue)
+                {
+                    ++stats.unchanged;
+                    continue;
+                }
+                flushParameters.push_back(parameter);
+                flushValues.push_back(slot.pendingValue);
+            }
+            instance.dirty.clear();
+
+            if (flushParameters.empty())
+                continue;
+
+            ++stats.fmodCalls;
+            if (!apply(instanceIndex, flushParameters.data(), flushValues.data(), static_cast<int>(flushParameters.size())))
+                continue;
+            for (size_t i = 0; i < flushParameters.size(); ++i)
+            {
+                Slot& slot = instance.parameters[flushParameters[i]];
+                slot.applied = true;
+                slot.appliedValue = flushValues[i];
+            }
+            stats.applied += static_cast<unsigned int>(flushParameters.size());
+        }
+        dirtyInstances.clear();
+    }
+
+    /**
+     * Drops queued writes and applied values of an instance, so its handle can be reused.
+     */
+    void ForgetInstance(EventInstanceHandle instance);
+
+    void Clear();
+
+    const ParameterBatchStats& GetStats() const { return stats; }
+    void ResetStats() { stats = ParameterBatchStats(); }
+
+private:
+
+    struct Slot
+    {
+        float pendingValue = 0.0f;
+        float appliedValue = 0.0f;
+        bool applied = false;   // appliedValue is what FMOD has
+        bool dirty = false;     // pendingValue is waiting for Flush()
+    };
+
+    struct InstanceSlots
+    {
+        std::vector<Slot> parameters;   // indexed by parameter handle
+        std::vector<uint32_t> dirty;    // parameters with a pending value
+        bool queued = false;            // listed in dirtyInstances
+    };
+
+    std::vector<InstanceSlots> instances;   // indexed by instance handle
+    std::vector<uint32_t> dirtyInstances;
+
+    // Reused by Flush() to build each instance's call
+    std::vector<uint32_t> flushParameters;
+    std::vector<float> flushValues;
+
+    ParameterBatchStats stats;
+};
@@ -0,0 +1,54 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file LatencyProfile.cpp
+/// @author JDSherbert
+
+#include "LatencyProfile.h"
+
+LatencySettings LatencySettings::FromProfile(LatencyProfile profile)
+{
+    LatencySettings settings;
+    switch (profile)
+    {
+        case LatencyProfile::LowLatency:
+            // 3 blocks of 256 at 48 kHz queue 16 ms
+            settings.sampleRate = 48000;
+            settings.dspBufferLength = 256;
+            settings.dspBufferCount = 3;
+            settings.streamFileBufferBytes = 16384;
+            settings.streamDecodeBufferMS = 200;
+            break;
+
+        case LatencyProfile::PowerSaving:
+            // 4 blocks of 2048 at 44.1 kHz queue 186 ms
+            settings.sampleRate = 44100;
+            settings.dspBufferLength = 2048;
+            settings.dspBufferCount = 4;
+            settings.streamFileBufferBytes = 65536;
+            settings.streamDecodeBufferMS = 1000;
+            break;
+
+        case LatencyProfile::Balanced:
+        case LatencyProfile::Custom:
+            // 4 blocks of 1024 at 44.1 kHz queue 93 ms
+            break;
+    }
+    return settings;
+}
+
+float LatencySettings::GetBufferLatencyMS() const
+{
+    return sampleRate > 0 ? 1000.0f * dspBufferLength * dspBufferCount / sampleRate : 0.0f;
+}
+
+const char* GetLatencyProfileName(LatencyProfile profile)
+{
+    switch (profile)
+    {
+        case LatencyProfile::LowLatency:  return "low latency";
+        case LatencyProfile::Balanced:    return "balanced";
+        case LatencyProfile::PowerSaving: return "power saving";
+        case LatencyProfile::Custom:      return "custom";
+    }
+    return "unknown";
+}
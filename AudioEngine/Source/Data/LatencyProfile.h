@@ -0,0 +1,86 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file LatencyProfile.h
+///
+/// Init-time presets for the mixer's buffering. FMOD mixes in blocks of dspBufferLength samples
+/// and queues dspBufferCount of them for the output device, so a sample written by the mixer is
+/// heard roughly length * count / sampleRate seconds later. Shorter blocks lower that latency but
+/// wake the mixer thread more often and leave it less slack before the output runs dry.
+/// Streams keep their own file and decode buffers, which set how long they take to start and how
+/// long a slow disk can stall before they starve.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+enum class LatencyProfile
+{
+    LowLatency,     // small blocks for instruments, rhythm games and VR; needs a fast, idle mixer thread
+    Balanced,       // FMOD's default 4 blocks of 1024, but at the engine's 44.1 kHz rather than FMOD's default 48 kHz
+    PowerSaving,    // large blocks and stream buffers, so the mixer and disk wake rarely on handhelds and laptops
+    Custom          // AudioEngineSettings::customLatency as given
+};
+
+/**
+ * Buffering applied by AudioEngine::Init() for a LatencyProfile.
+ */
+struct LatencySettings
+{
+    // Software mixer rate in Hz
+    int sampleRate = 44100;
+
+    // Samples mixed per block, and blocks queued for the output device
+    unsigned int dspBufferLength = 1024;
+    int dspBufferCount = 4;
+
+    // Bytes each stream reads from disk at a time
+    unsigned int streamFileBufferBytes = 16384;
+
+    // Decoded audio each stream keeps ahead of playback, in milliseconds
+    unsigned int streamDecodeBufferMS = 400;
+
+    /**
+     * Returns the buffering of a profile. Custom returns the defaults, i.e. Balanced.
+     */
+    static LatencySettings FromProfile(LatencyProfile profile);
+
+    /**
+     * Returns the delay the queued mixer blocks add, in milliseconds.
+     */
+    float GetBufferLatencyMS() const;
+};
+
+/**
+ * The buffering FMOD settled on and how the mixer is coping with it, returned by
+ * AudioEngine::GetLatencyReport(). The output device may add latency of its own on top.
+ */
+struct LatencyReport
+{
+    LatencyProfile profile = LatencyProfile::Balanced;
+
+    // Buffering in effect. The output may override what the profile asked for.
+    LatencySettings applied;
+
+    // Playback length of one mixer block, and of every block queued for the output
+    float blockMS = 0.0f;
+    float bufferLatencyMS = 0.0f;
+
+    // Mean time between mixer blocks, and the latency of the queued blocks at that pace.
+    // Larger than blockMS when the output device pulls several blocks at once.
+    // 0 without mixer telemetry or before any block has been mixed.
+    float measuredBlockIntervalMS = 0.0f;
+    float measuredLatencyMS = 0.0f;
+
+    // Share of the mixer thread's time spent mixing, from FMOD, in percent
+    float mixerCPUPercent = 0.0f;
+
+    // 99th percentile block processing time as a share of blockMS, in percent.
+    // Close to 100 the profile is too aggressive for the content. 0 without mixer telemetry.
+    float mixerLoadPercent = 0.0f;
+};
+
+/**
+ * Returns the profile's name for logs
+ */
+const char* GetLatencyProfileName(LatencyProfile profile);
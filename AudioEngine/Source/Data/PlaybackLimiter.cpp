@@ -0,0 +1,136 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file PlaybackLimiter.cpp
+/// @author JDSherbert
+
+#include "PlaybackLimiter.h"
+
+PlaybackLimiter::PlaybackLimiter(int maxVoices)
+    : voices(maxVoices > 0 ? maxVoices : 1)
+{
+    ReleaseAll();
+}
+
+void PlaybackLimiter::SetSoundLimit(SoundId sound, const PlaybackLimit& limit)
+{
+    const auto it = soundGroups.find(sound);
+    if (it != soundGroups.end())
+        groups[it->second].limit = limit;
+    else
+        soundGroups.insert({ sound, AddGroup(limit) });
+}
+
+void PlaybackLimiter::SetCategoryLimit(const std::string& category, const PlaybackLimit& limit)
+{
+    const auto it = categoryGroups.find(category);
+    if (it != categoryGroups.end())
+        groups[it->second].limit = limit;
+    else
+        categoryGroups.insert({ category, AddGroup(limit) });
+}
+
+int PlaybackLimiter::Register(const PlaybackTicket& ticket, SoundId sound, void* channel, double nowMS)
+{
+    if (!ticket.IsLimited() || freeVoice < 0)
+        return -1;
+
+    const int voice = freeVoice;
+    freeVoice = voices[voice].next[0];
+    voices[voice] = Voice();
+    voices[voice].channel = channel;
+    voices[voice].sound = sound;
+    voices[voice].held = true;
+
+    const int ticketGroups[LISTS] = { ticket.soundGroup, ticket.categoryGroup };
+    for (int list = 0; list < LISTS; ++list)
+    {
+        if (ticketGroups[list] >= 0)
+        {
+            Link(voice, list, ticketGroups[list]);
+            groups[ticketGroups[list]].lastStartMS = nowMS;
+        }
+    }
+    return voice;
+}
+
+void PlaybackLimiter::SetChannel(int voice, void* channel)
+{
+    if (voice >= 0 && voice < static_cast<int>(voices.size()) && voices[voice].held)
+        voices[voice].channel = channel;
+}
+
+void PlaybackLimiter::Release(int voice)
+{
+    if (voice < 0 || voice >= static_cast<int>(voices.size()) || !voices[voice].held)
+        return;
+
+    for (int list = 0; list < LISTS; ++list)
+        Unlink(voice, list);
+    voices[voice].channel = nullptr;
+    voices[voice].held = false;
+    voices[voice].next[0] = freeVoice;
+    freeVoice = voice;
+}
+
+void PlaybackLimiter::ReleaseAll()
+{
+    for (size_t voice = 0; voice < voices.size(); ++voice)
+    {
+        voices[voice] = Voice();
+        voices[voice].next[0] = voice + 1 < voices.size() ? static_cast<int>(voice + 1) : -1;
+    }
+    freeVoice = 0;
+
+    for (Group& group : groups)
+    {
+        group.count = 0;
+        group.oldest = -1;
+        group.newest = -1;
+    }
+}
+
+int PlaybackLimiter::AddGroup(const PlaybackLimit& limit)
+{
+    groups.emplace_back();
+    groups.back().limit = limit;
+    return static_cast<int>(groups.size()) - 1;
+}
+
+void PlaybackLimiter::Link(int voice, int list, int group)
+{
+    // Appended as the newest, so the oldest is always at the front
+    Group& target = groups[group];
+    Voice& linked = voices[voice];
+    linked.group[list] = group;
+    linked.previous[list] = target.newest;
+    linked.next[list] = -1;
+    if (target.newest >= 0)
+        voices[target.newest].next[list] = voice;
+    else
+        target.oldest = voice;
+    target.newest = voice;
+    ++target.count;
+}
+
+void PlaybackLimiter::Unlink(int voice, int list)
+{
+    Voice& linked = voices[voice];
+    const int group = linked.group[list];
+    if (group < 0)
+        return;
+
+    Group& source = groups[group];
+    if (linked.previous[list] >= 0)
+        voices[linked.previous[list]].next[list] = linked.next[list];
+    else
+        source.oldest = linked.next[list];
+    if (linked.next[list] >= 0)
+        voices[linked.next[list]].previous[list] = linked.previous[list];
+    else
+        source.newest = linked.previous[list];
+    --source.count;
+
+    linked.group[list] = -1;
+    linked.previous[list] = -1;
+    linked.next[list] = -1;
+}
@@ -0,0 +1,212 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file PlaybackLimiter.h
+///
+/// Caps how many channels a sound, or a category of sounds, plays at once, and how soon it can
+/// be retriggered, so game code calling Play() for the same sound many times in a frame doesn't
+/// use up channels or comb-filter. Categories are mixer buses (AudioData::SetBus()).
+/// Each limited sound and category keeps its playing channels in a list, oldest first, threaded
+/// through a fixed pool of voice slots: admitting, registering and releasing a channel are O(1),
+/// except stealing the quietest channel, which compares the channels of the one full list.
+/// Knows nothing of FMOD; channels are opaque pointers and the engine supplies their audibility.
+/// A voice can be held without a channel, e.g. by a loop playing virtually out of earshot, so it
+/// keeps counting against its limits until it is released.
+///
+/// @author JDSherbert
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "AudioEngineStats.h"
+#include "SoundId.h"
+
+enum class LimitBehavior
+{
+    StealOldest,    // stop the channel that started first
+    StealQuietest,  // stop the channel heard least
+    Reject          // don't play the new sound
+};
+
+struct PlaybackLimit
+{
+    // Channels allowed at once; 0 is unlimited
+    int maxInstances = 0;
+
+    // Shortest time between starts; plays sooner than this after the previous start are dropped
+    float minRetriggerMS = 0.0f;
+
+    // What happens to a play over maxInstances
+    LimitBehavior behavior = LimitBehavior::StealOldest;
+};
+
+/**
+ * The limits that apply to a play, found by Admit() and handed to Register()
+ */
+struct PlaybackTicket
+{
+    int soundGroup = -1;
+    int categoryGroup = -1;
+
+    bool IsLimited() const { return soundGroup >= 0 || categoryGroup >= 0; }
+};
+
+class PlaybackLimiter
+{
+public:
+
+    /**
+     * Sizes the voice pool, one slot per channel the engine can play.
+     */
+    explicit PlaybackLimiter(int maxVoices = 256);
+
+    /**
+     * Sets or replaces the limit of a sound or of a category. Channels already playing
+     * count against the new limit.
+     */
+    void SetSoundLimit(SoundId sound, const PlaybackLimit& limit);
+    void SetCategoryLimit(const std::string& category, const PlaybackLimit& limit);
+
+    /**
+     * Decides whether a sound may start now. Every full list it belongs to gives up a voice,
+     * which is released and handed to steal(int voice, void* channel, SoundId sound) to stop;
+     * channel is nullptr for a voice held without one.
+     * @param audibility - float audibility(void* channel), asked only to steal the quietest
+     * @return false if the play is throttled or rejected
+     */
+    template <typename AudibilityFunction, typename StealFunction>
+    bool Admit(SoundId sound, const std::string& category, double nowMS, PlaybackTicket& ticket,
+               AudibilityFunction audibility, StealFunction steal)
+    {
+        ticket = PlaybackTicket();
+        if (groups.empty())
+            return true;
+
+        const auto soundGroup = soundGroups.find(sound);
+        if (soundGroup != soundGroups.end())
+            ticket.soundGroup = soundGroup->second;
+        const auto categoryGroup = categoryGroups.find(category);
+        if (categoryGroup != categoryGroups.end())
+            ticket.categoryGroup = categoryGroup->second;
+        if (!ticket.IsLimited())
+            return true;
+
+        const int ticketGroups[LISTS] = { ticket.soundGroup, ticket.categoryGroup };
+        for (int group : ticketGroups)
+        {
+            if (group >= 0 && groups[group].limit.minRetriggerMS > 0.0f
+                && nowMS - groups[group].lastStartMS < groups[group].limit.minRetriggerMS)
+            {
+                ++stats.throttled;
+                return false;
+            }
+        }
+        for (int group : ticketGroups)
+        {
+            if (group >= 0 && IsFull(group) && groups[group].limit.behavior == LimitBehavior::Reject)
+            {
+                ++stats.rejected;
+                return false;
+            }
+        }
+
+        // Stealing from the sound's list may also make room in the category's
+        for (int list = 0; list < LISTS; ++list)
+        {
+            const int group = ticketGroups[list];
+            if (group < 0 || !IsFull(group))
+                continue;
+
+            int victim = groups[group].oldest;
+            if (groups[group].limit.behavior == LimitBehavior::StealQuietest)
+            {
+                float quietest = audibility(voices[victim].channel);
+                for (int voice = voices[victim].next[list]; voice >= 0; voice = voices[voice].next[list])
+                {
+                    const float level = audibility(voices[voice].channel);
+                    if (level < quietest)
+                    {
+                        quietest = level;
+                        victim = voice;
+                    }
+                }
+            }
+
+            void* channel = voices[victim].channel;
+            const SoundId victimSound = voices[victim].sound;
+            Release(victim);
+            ++stats.stolen;
+            steal(victim, channel, victimSound);
+        }
+        return true;
+    }
+
+    /**
+     * Holds a voice for an admitted play until Release().
+     * @param channel - the play's channel, or nullptr if it has none yet
+     * @return the voice, or -1 if the play isn't limited or the pool is exhausted
+     */
+    int Register(const PlaybackTicket& ticket, SoundId sound, void* channel, double nowMS);
+
+    /**
+     * Changes the channel of a held voice, e.g. when a virtual loop gets one back
+     */
+    void SetChannel(int voice, void* channel);
+
+    /**
+     * Forgets a voice, e.g. when its channel ends
+     */
+    void Release(int voice);
+
+    /**
+     * Forgets every voice, keeping the limits.
+     */
+    void ReleaseAll();
+
+    const PlaybackLimitStats& GetStats() const { return stats; }
+    void ResetStats() { stats = PlaybackLimitStats(); }
+
+private:
+
+    // Each voice is in up to two lists: its sound's and its category's
+    static const int LISTS = 2;
+
+    struct Group
+    {
+        PlaybackLimit limit;
+        int count = 0;
+        int oldest = -1;
+        int newest = -1;
+        double lastStartMS = -1e300;
+    };
+
+    struct Voice
+    {
+        void* channel = nullptr;
+        SoundId sound;
+        bool held = false;
+        int group[LISTS] = { -1, -1 };
+        int previous[LISTS] = { -1, -1 };
+        int next[LISTS] = { -1, -1 };   // in the free list, next[0] is the next free voice
+    };
+
+    bool IsFull(int group) const
+    {
+        return groups[group].limit.maxInstances > 0 && groups[group].count >= groups[group].limit.maxInstances;
+    }
+
+    int AddGroup(const PlaybackLimit& limit);
+    void Link(int voice, int list, int group);
+    void Unlink(int voice, int list);
+
+    std::unordered_map<SoundId, int> soundGroups;
+    std::unordered_map<std::string, int> categoryGroups;
+    std::vector<Group> groups;
+
+    std::vector<Voice> voices;
+    int freeVoice = -1;
+
+    PlaybackLimitStats stats;
+};
@@ -0,0 +1,144 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SoundContainer.cpp
+/// @author JDSherbert
+
+#include "SoundContainer.h"
+
+SoundContainer::SoundContainer()
+{
+}
+
+SoundContainer::SoundContainer(SoundId id, VariationMode variationMode)
+    : uniqueID(id)
+    , mode(variationMode)
+{
+}
+
+void SoundContainer::AddVariant(const AudioData& variant)
+{
+    variants.push_back(variant);
+    lastPicked.push_back(0);
+    order.push_back(static_cast<int>(order.size()));
+
+    // Starts a fresh sequence over every variant
+    next = static_cast<int>(order.size());
+}
+
+void SoundContainer::SetPitchRange(float minimum, float maximum)
+{
+    minPitch = minimum;
+    maxPitch = maximum;
+}
+
+void SoundContainer::SetVolumeRange(float minimum, float maximum)
+{
+    minVolume = minimum;
+    maxVolume = maximum;
+}
+
+void SoundContainer::SetSeed(uint32_t seed)
+{
+    // xorshift never leaves zero
+    randomState = seed != 0 ? seed : 0x9E3779B9u;
+}
+
+int SoundContainer::Select(float& pitch, float& volume)
+{
+    const int count = static_cast<int>(variants.size());
+    if (count == 0)
+        return -1;
+
+    int variant = 0;
+    switch (mode)
+    {
+    case VariationMode::Random:
+        variant = SelectRandom();
+        break;
+    case VariationMode::Shuffle:
+        variant = SelectShuffled();
+        break;
+    case VariationMode::RoundRobin:
+        variant = next % count;
+        next = variant + 1;
+        break;
+    }
+
+    lastPicked[variant] = ++picks;
+    lastVariant = variant;
+    pitch = RandomInRange(minPitch, maxPitch);
+    volume = RandomInRange(minVolume, maxVolume);
+    return variant;
+}
+
+int SoundContainer::SelectRandom()
+{
+    const int count = static_cast<int>(variants.size());
+    int avoid = avoidRepeats < count - 1 ? avoidRepeats : count - 1;
+    if (avoid < 0)
+        avoid = 0;
+
+    // A variant is eligible unless it was among the last avoid picks
+    int eligible = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (lastPicked[i] == 0 || picks - lastPicked[i] >= static_cast<uint32_t>(avoid))
+            ++eligible;
+    }
+
+    int choice = static_cast<int>(NextRandom() % static_cast<uint32_t>(eligible));
+    for (int i = 0; i < count; ++i)
+    {
+        if (lastPicked[i] == 0 || picks - lastPicked[i] >= static_cast<uint32_t>(avoid))
+        {
+            if (choice-- == 0)
+                return i;
+        }
+    }
+    return 0;
+}
+
+int SoundContainer::SelectShuffled()
+{
+    if (next >= static_cast<int>(order.size()))
+        Reshuffle();
+    return order[next++];
+}
+
+void SoundContainer::Reshuffle()
+{
+    // Fisher-Yates
+    const int count = static_cast<int>(order.size());
+    for (int i = count - 1; i > 0; --i)
+    {
+        const int j = static_cast<int>(NextRandom() % static_cast<uint32_t>(i + 1));
+        const int swapped = order[i];
+        order[i] = order[j];
+        order[j] = swapped;
+    }
+
+    // The new sequence mustn't open with the variant that closed the previous one
+    if (count > 1 && order[0] == lastVariant)
+    {
+        const int j = 1 + static_cast<int>(NextRandom() % static_cast<uint32_t>(count - 1));
+        order[0] = order[j];
+        order[j] = lastVariant;
+    }
+    next = 0;
+}
+
+uint32_t SoundContainer::NextRandom()
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+float SoundContainer::RandomInRange(float min, float max)
+{
+    if (min == max)
+        return min;
+    const float unit = static_cast<float>(NextRandom() >> 8) * (1.0f / 16777216.0f);
+    return min + (max - min) * unit;
+}
@@ -0,0 +1,111 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SoundContainer.h
+///
+/// Groups the variants of a sound, e.g. a dozen footsteps on gravel, under one ID. Loaded and
+/// played through AudioEngine::LoadContainer() and PlayContainer(), which pick a variant and
+/// play it with a random pitch and volume from the container's ranges.
+/// Variants are picked one of three ways:
+///     Random      - uniformly, never repeating any of the last few variants played
+///     Shuffle     - each variant once in a random order, then again in a new order which
+///                   doesn't start with the variant that ended the last one
+///     RoundRobin  - in the order they were added
+/// Picking uses state sized by AddVariant(), so it never allocates.
+///
+/// @author JDSherbert
+
+#include <cstdint>
+#include <vector>
+
+#include "AudioData.h"
+#include "SoundId.h"
+
+enum class VariationMode
+{
+    Random,
+    Shuffle,
+    RoundRobin
+};
+
+class SoundContainer
+{
+public:
+
+    SoundContainer();
+    explicit SoundContainer(SoundId id, VariationMode variationMode = VariationMode::Shuffle);
+
+    /**
+     * Adds a variant. Its volume is scaled by the container's volume range when it plays.
+     */
+    void AddVariant(const AudioData& variant);
+
+    /**
+     * Sets the range random pitch multipliers are drawn from, e.g. 0.95 to 1.05
+     */
+    void SetPitchRange(float minPitch, float maxPitch);
+
+    /**
+     * Sets the range random volume multipliers are drawn from, e.g. 0.8 to 1
+     */
+    void SetVolumeRange(float minVolume, float maxVolume);
+
+    /**
+     * Sets how many of the most recent variants Random mode won't pick again, at most all but one.
+     */
+    void SetAvoidRepeats(int count) { avoidRepeats = count; }
+
+    /**
+     * Seeds the random picks and ranges, so a sequence can be reproduced
+     */
+    void SetSeed(uint32_t seed);
+
+    /**
+     * Picks the next variant and a pitch and volume multiplier for it.
+     * @return the variant's index, or -1 if the container is empty
+     */
+    int Select(float& pitch, float& volume);
+
+    SoundId GetUniqueID() const { return uniqueID; }
+    VariationMode GetMode() const { return mode; }
+    int GetVariantCount() const { return static_cast<int>(variants.size()); }
+    const AudioData& GetVariant(int index) const { return variants[index]; }
+    AudioData& GetVariant(int index) { return variants[index]; }
+
+    void SetUniqueID(SoundId id) { uniqueID = id; }
+    void SetMode(VariationMode newMode) { mode = newMode; }
+
+private:
+
+    int SelectRandom();
+    int SelectShuffled();
+
+    /** Reorders the shuffle order, keeping the last variant played away from the front */
+    void Reshuffle();
+
+    /** xorshift32: cheap, allocation-free and reproducible from a seed */
+    uint32_t NextRandom();
+    float RandomInRange(float min, float max);
+
+    SoundId uniqueID;
+    VariationMode mode = VariationMode::Shuffle;
+    std::vector<AudioData> variants;
+
+    float minPitch = 1.0f;
+    float maxPitch = 1.0f;
+    float minVolume = 1.0f;
+    float maxVolume = 1.0f;
+
+    int avoidRepeats = 1;
+    uint32_t randomState = 0x9E3779B9u;
+
+    // Number of picks made so far, and the pick at which each variant was last played (0 for never)
+    uint32_t picks = 0;
+    std::vector<uint32_t> lastPicked;
+
+    // Shuffle mode's play order and the position in it; RoundRobin's position
+    std::vector<int> order;
+    int next = 0;
+    int lastVariant = -1;
+};
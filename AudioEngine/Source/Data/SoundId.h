@@ -0,0 +1,89 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SoundId.h
+///
+/// Numeric sound identity, hashed from the sound's name at compile time with 64-bit FNV-1a.
+/// Call sites use generated constants (see SoundIdGenerator) or the _sid literal, so the
+/// engine compares and stores integers rather than strings.
+///
+/// @author JDSherbert
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+/**
+ * 64-bit FNV-1a hash of a null-terminated string, usable in constant expressions.
+ */
+constexpr uint64_t HashFNV1a64(const char* text)
+{
+    uint64_t hash = 14695981039346656037ull;
+    while (*text)
+    {
+        hash ^= static_cast<uint8_t>(*text++);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+struct SoundId
+{
+    uint64_t value = 0;
+
+    constexpr SoundId() = default;
+    constexpr explicit SoundId(uint64_t hashValue) : value(hashValue) {}
+
+    /**
+     * Hashes a sound name. Evaluated at compile time when name is a literal.
+     */
+    static constexpr SoundId FromName(const char* name) { return SoundId(HashFNV1a64(name)); }
+
+    constexpr bool IsValid() const { return value != 0; }
+
+    constexpr bool operator==(SoundId other) const { return value == other.value; }
+    constexpr bool operator!=(SoundId other) const { return value != other.value; }
+    constexpr bool operator<(SoundId other) const { return value < other.value; }
+};
+
+/**
+ * "Footstep_Grass_01"_sid
+ */
+constexpr SoundId operator"" _sid(const char* name, size_t)
+{
+    return SoundId::FromName(name);
+}
+
+/**
+ * True if the IDs are in strictly increasing order, which also proves there are no duplicates.
+ * Generated ID headers list their IDs sorted so this check stays linear at compile time.
+ */
+template <size_t N>
+constexpr bool AreSoundIdsSortedUnique(const SoundId (&ids)[N])
+{
+    for (size_t i = 1; i < N; ++i)
+    {
+        if (!(ids[i - 1] < ids[i]))
+            return false;
+    }
+    return true;
+}
+
+inline std::ostream& operator<<(std::ostream& stream, SoundId id)
+{
+    const std::ios_base::fmtflags flags = stream.flags();
+    stream << "0x" << std::hex << id.value;
+    stream.flags(flags);
+    return stream;
+}
+
+namespace std
+{
+    template <>
+    struct hash<SoundId>
+    {
+        size_t operator()(SoundId id) const { return static_cast<size_t>(id.value ^ (id.value >> 32)); }
+    };
+}
@@ -0,0 +1,239 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SoundManifest.cpp
+/// @author JDSherbert
+
+#include "SoundManifest.h"
+
+#include "AudioData.h"
+#include "../Tools/Json.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+static_assert(sizeof(SoundManifest::Header) == 24, "Manifest header layout changed");
+static_assert(sizeof(SoundManifest::Entry) == 32, "Manifest entry layout changed");
+
+namespace
+{
+    /**
+     * Builds a deduplicated table of null-terminated strings. Offset 0 is the empty string.
+     */
+    class StringTable
+    {
+    public:
+
+        StringTable() : table(1, '\0') {}
+
+        uint32_t Add(const std::string& text)
+        {
+            if (text.empty())
+                return 0;
+
+            auto it = offsets.find(text);
+            if (it != offsets.end())
+                return it->second;
+
+            const uint32_t offset = static_cast<uint32_t>(table.size());
+            table.insert(table.end(), text.begin(), text.end());
+            table.push_back('\0');
+            offsets.insert({ text, offset });
+            return offset;
+        }
+
+        const std::vector<char>& GetData() const { return table; }
+
+    private:
+
+        std::vector<char> table;
+        std::map<std::string, uint32_t> offsets;
+    };
+}
+
+bool SoundManifest::Compile(const char* jsonPath, const char* binaryPath)
+{
+    JsonValue manifest;
+    std::string error;
+    if (!JsonValue::ParseFile(jsonPath, manifest, error))
+    {
+        std::cout << "SoundManifest: Failed to parse " << jsonPath << ": " << error << '\n';
+        return false;
+    }
+
+    const JsonValue& sounds = manifest["sounds"];
+    if (!sounds.IsArray())
+    {
+        std::cout << "SoundManifest: " << jsonPath << " has no \"sounds\" array\n";
+        return false;
+    }
+
+    std::vector<Entry> compiled;
+    std::map<uint64_t, std::string> names;
+    StringTable stringTable;
+
+    for (const JsonValue& sound : sounds.GetElements())
+    {
+        const std::string& name = sound["id"].AsString();
+        const std::string& path = sound["path"].AsString();
+        if (name.empty() || path.empty())
+        {
+            std::cout << "SoundManifest: Sound entry needs both \"id\" and \"path\" in " << jsonPath << '\n';
+            return false;
+        }
+
+        Entry entry = { };
+        entry.id = SoundId::FromName(name.c_str()).value;
+        entry.pathOffset = stringTable.Add(path);
+        entry.busOffset = stringTable.Add(sound["bus"].AsString());
+        entry.volume = static_cast<float>(sound["volume"].AsNumber(1.0));
+        entry.reverbAmount = static_cast<float>(sound["reverb"].AsNumber(0.0));
+        entry.maxDistance = static_cast<float>(sound["maxDistance"].AsNumber(0.0));
+        entry.flags = (sound["loop"].AsBool() ? static_cast<uint32_t>(FLAG_LOOP) : 0u)
+                    | (sound["3d"].AsBool() ? static_cast<uint32_t>(FLAG_3D) : 0u)
+                    | (sound["stream"].AsBool() ? static_cast<uint32_t>(FLAG_STREAM) : 0u)
+                    | (sound["hrtf"].AsBool() ? static_cast<uint32_t>(FLAG_HRTF) : 0u);
+
+        auto inserted = names.insert({ entry.id, name });
+        if (!inserted.second)
+        {
+            std::cout << "SoundManifest: \"" << name << "\" collides with \"" << inserted.first->second << "\"\n";
+            return false;
+        }
+
+        compiled.push_back(entry);
+    }
+
+    std::sort(compiled.begin(), compiled.end(), [](const Entry& a, const Entry& b) { return a.id < b.id; });
+
+    const std::vector<char>& stringData = stringTable.GetData();
+
+    Header fileHeader = { };
+    fileHeader.magic = MAGIC;
+    fileHeader.version = VERSION;
+    fileHeader.count = static_cast<uint32_t>(compiled.size());
+    fileHeader.stringTableOffset = static_cast<uint32_t>(sizeof(Header) + compiled.size() * sizeof(Entry));
+    fileHeader.stringTableSize = static_cast<uint32_t>(stringData.size());
+
+    std::ofstream output(binaryPath, std::ios::binary);
+    if (!output)
+    {
+        std::cout << "SoundManifest: Could not write " << binaryPath << '\n';
+        return false;
+    }
+    output.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+    output.write(reinterpret_cast<const char*>(compiled.data()), compiled.size() * sizeof(Entry));
+    output.write(stringData.data(), stringData.size());
+
+    std::cout << "SoundManifest: Compiled " << compiled.size() << " sounds to " << binaryPath << '\n';
+    return true;
+}
+
+bool SoundManifest::Load(const char* binaryPath)
+{
+    Unload();
+
+    FILE* file = fopen(binaryPath, "rb");
+    if (!file)
+    {
+        std::cout << "SoundManifest: Could not open " << binaryPath << '\n';
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (size < static_cast<long>(sizeof(Header)))
+    {
+        fclose(file);
+        std::cout << "SoundManifest: " << binaryPath << " is too small to be a manifest\n";
+        return false;
+    }
+
+    data.resize((static_cast<size_t>(size) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    const size_t read = fread(data.data(), 1, static_cast<size_t>(size), file);
+    fclose(file);
+
+    const char* bytes = reinterpret_cast<const char*>(data.data());
+    const Header* loadedHeader = reinterpret_cast<const Header*>(bytes);
+
+    const bool valid = read == static_cast<size_t>(size)
+        && loadedHeader->magic == MAGIC
+        && loadedHeader->version == VERSION
+        && sizeof(Header) + static_cast<size_t>(loadedHeader->count) * sizeof(Entry) <= loadedHeader->stringTableOffset
+        && static_cast<size_t>(loadedHeader->stringTableOffset) + loadedHeader->stringTableSize <= static_cast<size_t>(size)
+        && loadedHeader->stringTableSize > 0
+        && bytes[loadedHeader->stringTableOffset + loadedHeader->stringTableSize - 1] == '\0';
+
+    if (!valid)
+    {
+        data.clear();
+        std::cout << "SoundManifest: " << binaryPath << " is not a valid version " << VERSION << " manifest\n";
+        return false;
+    }
+
+    header = loadedHeader;
+    entries = reinterpret_cast<const Entry*>(bytes + sizeof(Header));
+    strings = bytes + header->stringTableOffset;
+    return true;
+}
+
+void SoundManifest::Unload()
+{
+    data.clear();
+    data.shrink_to_fit();
+    header = nullptr;
+    entries = nullptr;
+    strings = nullptr;
+}
+
+unsigned int SoundManifest::GetCount() const
+{
+    return header ? header->count : 0;
+}
+
+SoundId SoundManifest::GetID(unsigned int index) const
+{
+    return index < GetCount() ? SoundId(entries[index].id) : SoundId();
+}
+
+bool SoundManifest::Contains(SoundId id) const
+{
+    return Find(id) != nullptr;
+}
+
+bool SoundManifest::GetAudioData(SoundId id, AudioData& audioData) const
+{
+    const Entry* entry = Find(id);
+    if (!entry || entry->pathOffset >= header->stringTableSize || entry->busOffset >= header->stringTableSize)
+        return false;
+
+    audioData.SetUniqueID(id);
+    audioData.SetFilePath(strings + entry->pathOffset);
+    audioData.SetBus(strings + entry->busOffset);
+    audioData.SetVolume(entry->volume);
+    audioData.SetReverbAmount(entry->reverbAmount);
+    audioData.SetLoop((entry->flags & FLAG_LOOP) != 0);
+    audioData.Set3D((entry->flags & FLAG_3D) != 0);
+    audioData.SetStreaming((entry->flags & FLAG_STREAM) != 0);
+    audioData.SetHrtf((entry->flags & FLAG_HRTF) != 0);
+    if (entry->maxDistance > 0.0f)
+        audioData.SetMaxDistance(entry->maxDistance);
+    return true;
+}
+
+const SoundManifest::Entry* SoundManifest::Find(SoundId id) const
+{
+    if (!header)
+        return nullptr;
+
+    const Entry* end = entries + header->count;
+    const Entry* entry = std::lower_bound(entries, end, id.value,
+        [](const Entry& candidate, uint64_t value) { return candidate.id < value; });
+    return entry != end && entry->id == id.value ? entry : nullptr;
+}
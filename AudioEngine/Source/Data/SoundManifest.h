@@ -0,0 +1,113 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SoundManifest.h
+///
+/// Table of sound definitions loaded at startup instead of constructing every AudioData in code.
+/// Sounds are authored in JSON and compiled offline to a compact binary table:
+///
+///     { "sounds": [ { "id": "Music_Main", "path": "Audio/main.ogg", "loop": true, "3d": false,
+///                     "volume": 0.8, "reverb": 0.0, "bus": "Music", "stream": true, "maxDistance": 100,
+///                     "hrtf": false } ] }
+///
+/// The binary table is read with a single file read and entries are sorted by SoundId, so
+/// lookups are a binary search over fixed-size records and loading does no per-entry work.
+///
+/// @author JDSherbert
+
+#include <cstdint>
+#include <vector>
+
+#include "SoundId.h"
+
+class AudioData;
+
+class SoundManifest
+{
+public:
+
+    /**
+     * Compiles a JSON manifest to the binary format read by Load(). Offline tooling only.
+     * @return false, after printing the reason, on invalid input or duplicate IDs
+     */
+    static bool Compile(const char* jsonPath, const char* binaryPath);
+
+    /**
+     * Loads a compiled manifest, replacing any previously loaded one.
+     * @return false, after printing the reason, if the file is missing or malformed
+     */
+    bool Load(const char* binaryPath);
+
+    /**
+     * Frees the loaded table. AudioData file paths obtained from it become invalid.
+     */
+    void Unload();
+
+    /**
+     * Number of sound definitions in the loaded table.
+     */
+    unsigned int GetCount() const;
+
+    /**
+     * Returns the ID of the definition at index, in ascending ID order.
+     */
+    SoundId GetID(unsigned int index) const;
+
+    /**
+     * True if the loaded table defines the sound.
+     */
+    bool Contains(SoundId id) const;
+
+    /**
+     * Fills audioData with the sound's definition. Its file path points into the table,
+     * so it stays valid until the manifest is unloaded.
+     * @return false if the sound is not defined
+     */
+    bool GetAudioData(SoundId id, AudioData& audioData) const;
+
+    // Binary format, little-endian
+
+    static const uint32_t MAGIC = 0x4D444E53; // "SNDM"
+    static const uint32_t VERSION = 1;
+
+    enum EntryFlags : uint32_t
+    {
+        FLAG_LOOP   = 1 << 0,
+        FLAG_3D     = 1 << 1,
+        FLAG_STREAM = 1 << 2,
+        FLAG_HRTF   = 1 << 3,
+    };
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t count;             // number of entries following the header
+        uint32_t stringTableOffset; // byte offset of the null-terminated string table
+        uint32_t stringTableSize;
+        uint32_t reserved;
+    };
+
+    struct Entry
+    {
+        uint64_t id;
+        uint32_t pathOffset;        // offset into the string table
+        uint32_t busOffset;         // offset into the string table, 0 is the empty string
+        float volume;
+        float reverbAmount;
+        uint32_t flags;             // EntryFlags
+        float maxDistance;          // 0 keeps the AudioData default
+    };
+
+private:
+
+    const Entry* Find(SoundId id) const;
+
+    // Whole file, stored as 64-bit words so entries are aligned
+    std::vector<uint64_t> data;
+
+    const Header* header = nullptr;
+    const Entry* entries = nullptr;
+    const char* strings = nullptr;
+};
@@ -0,0 +1,271 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file AudioMemory.cpp
+/// @author JDSherbert
+
+#include "AudioMemory.h"
+
+#include "../../AudioEngine.h"
+#include "PoolAllocator.h"
+#include "TlsfArena.h"
+
+#include <FMOD/fmod.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    /**
+     * Written in front of every allocation so frees and reallocs know where the block came from.
+     */
+    struct AllocationHeader
+    {
+        uint32_t size;          // bytes requested by FMOD
+        uint8_t tag;            // AudioMemoryTag
+        int8_t sizeClass;       // PoolAllocator size class, or -1 for the arena
+        uint8_t reserved[10];
+    };
+
+    static_assert(sizeof(AllocationHeader) == TlsfArena::ALIGNMENT, "Allocation header must preserve alignment");
+
+    void* AllocatePage(size_t bytes, void* context);
+
+    struct AllocatorState
+    {
+        AllocatorState() : pools(AllocatePage, this) {}
+
+        std::mutex mutex;
+        bool initialized = false;
+        bool succeeded = false;
+        AudioMemorySettings settings;
+
+        TlsfArena arena;
+        PoolAllocator pools;
+        AudioMemoryStats stats;
+
+        // System heap regions owned by the arena. FMOD may free memory until process exit, so
+        // these are never released.
+        std::vector<void*> regions;
+    };
+
+    AllocatorState& GetState()
+    {
+        static AllocatorState state;
+        return state;
+    }
+
+    AudioMemoryTag ToTag(FMOD_MEMORY_TYPE type)
+    {
+        // FMOD_MEMORY_PERSISTENT is a modifier, the category is the lowest of the first five bits
+        for (int bit = 0; bit < static_cast<int>(AudioMemoryTag::Count) - 1; ++bit)
+        {
+            if (type & (1u << bit))
+                return static_cast<AudioMemoryTag>(bit + 1);
+        }
+        return AudioMemoryTag::Normal;
+    }
+
+    bool AddSystemRegion(AllocatorState& state, size_t bytes)
+    {
+        void* region = malloc(bytes + TlsfArena::ALIGNMENT);
+        if (!region)
+            return false;
+
+        const uintptr_t aligned = (reinterpret_cast<uintptr_t>(region) + TlsfArena::ALIGNMENT - 1) & ~(TlsfArena::ALIGNMENT - 1);
+        if (!state.arena.AddRegion(reinterpret_cast<void*>(aligned), bytes))
+        {
+            free(region);
+            return false;
+        }
+        state.regions.push_back(region);
+        return true;
+    }
+
+    void* AllocateFromArena(AllocatorState& state, size_t bytes)
+    {
+        void* block = state.arena.Allocate(bytes);
+        if (!block && state.settings.budgetBytes == 0)
+        {
+            // Grow by a whole region, or enough for this block and the region's own bookkeeping
+            const size_t needed = bytes + 4 * TlsfArena::BLOCK_OVERHEAD;
+            if (AddSystemRegion(state, needed > state.settings.regionBytes ? needed : state.settings.regionBytes))
+                block = state.arena.Allocate(bytes);
+        }
+        return block;
+    }
+
+    void* AllocatePage(size_t bytes, void* context)
+    {
+        return AllocateFromArena(*static_cast<AllocatorState*>(context), bytes);
+    }
+
+    void* AllocateLocked(AllocatorState& state, unsigned int size, FMOD_MEMORY_TYPE type)
+    {
+        const size_t total = size + sizeof(AllocationHeader);
+        const int sizeClass = PoolAllocator::GetSizeClass(total);
+        void* block = sizeClass >= 0 ? state.pools.Allocate(sizeClass) : AllocateFromArena(state, total);
+        if (!block)
+        {
+            ++state.stats.failedAllocations;
+            return nullptr;
+        }
+
+        const AudioMemoryTag tag = ToTag(type);
+        AllocationHeader* header = static_cast<AllocationHeader*>(block);
+        header->size = size;
+        header->tag = static_cast<uint8_t>(tag);
+        header->sizeClass = static_cast<int8_t>(sizeClass);
+
+        AudioMemoryStats& stats = state.stats;
+        stats.currentBytes += size;
+        ++stats.allocations;
+        if (stats.currentBytes > stats.peakBytes)
+            stats.peakBytes = stats.currentBytes;
+
+        AudioMemoryTagStats& tagStats = stats.tags[static_cast<int>(tag)];
+        tagStats.currentBytes += size;
+        ++tagStats.allocations;
+        if (tagStats.currentBytes > tagStats.peakBytes)
+            tagStats.peakBytes = tagStats.currentBytes;
+
+        return header + 1;
+    }
+
+    void FreeLocked(AllocatorState& state, void* pointer)
+    {
+        AllocationHeader* header = static_cast<AllocationHeader*>(pointer) - 1;
+
+        AudioMemoryStats& stats = state.stats;
+        stats.currentBytes -= header->size;
+        --stats.allocations;
+
+        AudioMemoryTagStats& tagStats = stats.tags[header->tag];
+        tagStats.currentBytes -= header->size;
+        --tagStats.allocations;
+
+        if (header->sizeClass >= 0)
+            state.pools.Free(header, header->sizeClass);
+        else
+            state.arena.Free(header);
+    }
+
+    void* F_CALL Allocate(unsigned int size, FMOD_MEMORY_TYPE type, const char* /*sourcestr*/)
+    {
+        AllocatorState& state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return AllocateLocked(state, size, type);
+    }
+
+    void* F_CALL Reallocate(void* pointer, unsigned int size, FMOD_MEMORY_TYPE type, const char* /*sourcestr*/)
+    {
+        AllocatorState& state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+
+        void* resized = AllocateLocked(state, size, type);
+        if (!resized || !pointer)
+            return resized; // the original block stays valid if the new one could not be allocated
+
+        const unsigned int oldSize = (static_cast<AllocationHeader*>(pointer) - 1)->size;
+        memcpy(resized, pointer, oldSize < size ? oldSize : size);
+        FreeLocked(state, pointer);
+        return resized;
+    }
+
+    void F_CALL Free(void* pointer, FMOD_MEMORY_TYPE /*type*/, const char* /*sourcestr*/)
+    {
+        if (!pointer)
+            return;
+
+        AllocatorState& state = GetState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        FreeLocked(state, pointer);
+    }
+}
+
+bool AudioMemory::Initialize(const AudioMemorySettings& settings)
+{
+    AllocatorState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (state.initialized)
+        return state.succeeded;
+    state.initialized = true;
+    state.settings = settings;
+
+    if (settings.budgetBytes > 0 && !AddSystemRegion(state, settings.budgetBytes))
+    {
+        std::cout << "Audio Memory: Could not reserve a budget of " << settings.budgetBytes << " bytes!\n";
+        return false;
+    }
+
+    const FMOD_RESULT result = FMOD::Memory_Initialize(nullptr, 0, Allocate, Reallocate, Free);
+    ERRCHECK(result);
+    if (result != FMOD_OK)
+    {
+        // FMOD never saw the allocator, so nothing was carved from the budget and it can go back
+        state.arena = TlsfArena();
+        for (void* region : state.regions)
+            free(region);
+        state.regions.clear();
+        std::cout << "Audio Memory: FMOD is already in use, the engine allocator was not installed!\n";
+        return false;
+    }
+
+    state.succeeded = true;
+    return true;
+}
+
+bool AudioMemory::IsInitialized()
+{
+    AllocatorState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.succeeded;
+}
+
+AudioMemoryStats AudioMemory::GetStats()
+{
+    AllocatorState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    AudioMemoryStats stats = state.stats;
+    stats.capacityBytes = state.arena.GetCapacity();
+    stats.freeBytes = state.arena.GetFreeBytes();
+    stats.largestFreeBlock = state.arena.GetLargestFreeBlock();
+    stats.poolReservedBytes = state.pools.GetReservedBytes();
+    stats.poolUsedBytes = state.pools.GetUsedBytes();
+    return stats;
+}
+
+void AudioMemory::PrintStats()
+{
+    const AudioMemoryStats stats = GetStats();
+    std::cout << "Audio Memory: " << stats.currentBytes << " bytes in " << stats.allocations << " allocations (peak "
+              << stats.peakBytes << ", failed " << stats.failedAllocations << "), arena " << stats.freeBytes << " of "
+              << stats.capacityBytes << " bytes free, largest free block " << stats.largestFreeBlock
+              << ", pools " << stats.poolUsedBytes << " of " << stats.poolReservedBytes << " bytes used\n";
+
+    for (int i = 0; i < static_cast<int>(AudioMemoryTag::Count); ++i)
+    {
+        const AudioMemoryTagStats& tag = stats.tags[i];
+        std::cout << "    " << GetTagName(static_cast<AudioMemoryTag>(i)) << ": " << tag.currentBytes
+                  << " bytes in " << tag.allocations << " allocations (peak " << tag.peakBytes << ")\n";
+    }
+}
+
+const char* AudioMemory::GetTagName(AudioMemoryTag tag)
+{
+    switch (tag)
+    {
+        case AudioMemoryTag::Normal:       return "Normal";
+        case AudioMemoryTag::StreamFile:   return "Stream File";
+        case AudioMemoryTag::StreamDecode: return "Stream Decode";
+        case AudioMemoryTag::SampleData:   return "Sample Data";
+        case AudioMemoryTag::DSPBuffer:    return "DSP Buffer";
+        case AudioMemoryTag::Plugin:       return "Plugin";
+        default:                           return "Unknown";
+    }
+}
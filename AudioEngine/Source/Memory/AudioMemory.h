@@ -0,0 +1,99 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file AudioMemory.h
+///
+/// Engine allocator which FMOD routes all of its allocations through. Small blocks come from
+/// PoolAllocator size classes and everything else, such as sample data, from a TlsfArena,
+/// so audio memory stays predictable and unfragmented over long uptimes.
+///
+/// FMOD's allocator is process-wide, so AudioMemory is shared by every AudioEngine and must be
+/// initialized before the first FMOD system is created. AudioEngine::Init() does this.
+///
+/// @author JDSherbert
+
+#include <cstddef>
+
+/**
+ * Accounting categories, one per FMOD_MEMORY_TYPE flag.
+ */
+enum class AudioMemoryTag
+{
+    Normal,
+    StreamFile,
+    StreamDecode,
+    SampleData,
+    DSPBuffer,
+    Plugin,
+
+    Count
+};
+
+struct AudioMemorySettings
+{
+    // Route FMOD allocations through AudioMemory. If false FMOD uses the system heap.
+    bool enabled = true;
+
+    // Fixed budget in bytes, reserved up front. Allocations beyond it fail and FMOD reports
+    // FMOD_ERR_MEMORY. 0 grows the arena from the system heap as needed.
+    size_t budgetBytes = 0;
+
+    // Size of each system heap region added to the arena when there is no budget
+    size_t regionBytes = 8 * 1024 * 1024;
+};
+
+struct AudioMemoryTagStats
+{
+    size_t currentBytes = 0;
+    size_t peakBytes = 0;
+    unsigned int allocations = 0;   // live allocations
+};
+
+struct AudioMemoryStats
+{
+    size_t currentBytes = 0;        // bytes requested by live allocations
+    size_t peakBytes = 0;           // high-water mark of currentBytes
+    unsigned int allocations = 0;   // live allocations
+    unsigned int failedAllocations = 0;
+
+    size_t capacityBytes = 0;       // memory owned by the arena
+    size_t freeBytes = 0;           // arena bytes not allocated
+    size_t largestFreeBlock = 0;    // largest allocation the arena can serve without growing
+    size_t poolReservedBytes = 0;   // arena bytes held by the small block pools
+    size_t poolUsedBytes = 0;
+
+    AudioMemoryTagStats tags[static_cast<int>(AudioMemoryTag::Count)];
+};
+
+class AudioMemory
+{
+public:
+
+    /**
+     * Registers the engine allocator with FMOD. Only the first call has an effect; later calls
+     * return whether that one succeeded.
+     * @return false, after printing the reason, if FMOD was already in use or the budget could not be reserved
+     */
+    static bool Initialize(const AudioMemorySettings& settings);
+
+    /**
+     * Returns true if FMOD allocates through AudioMemory.
+     */
+    static bool IsInitialized();
+
+    /**
+     * Returns a snapshot of the allocator's accounting.
+     */
+    static AudioMemoryStats GetStats();
+
+    /**
+     * Prints the current stats, broken down by tag.
+     */
+    static void PrintStats();
+
+    /**
+     * Returns the display name of a tag.
+     */
+    static const char* GetTagName(AudioMemoryTag tag);
+};
@@ -0,0 +1,62 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file PoolAllocator.cpp
+/// @author JDSherbert
+
+#include "PoolAllocator.h"
+
+PoolAllocator::PoolAllocator(PageSource pageSource, void* context)
+    : pageSource(pageSource)
+    , context(context)
+{
+}
+
+int PoolAllocator::GetSizeClass(size_t bytes)
+{
+    size_t classSize = MIN_BLOCK_SIZE;
+    for (int sizeClass = 0; sizeClass < CLASS_COUNT; ++sizeClass, classSize <<= 1)
+    {
+        if (bytes <= classSize)
+            return sizeClass;
+    }
+    return -1;
+}
+
+size_t PoolAllocator::GetClassSize(int sizeClass)
+{
+    return MIN_BLOCK_SIZE << sizeClass;
+}
+
+void* PoolAllocator::Allocate(int sizeClass)
+{
+    FreeBlock*& head = freeLists[sizeClass];
+    if (!head)
+    {
+        char* page = static_cast<char*>(pageSource(PAGE_BYTES, context));
+        if (!page)
+            return nullptr;
+        reservedBytes += PAGE_BYTES;
+
+        // Thread the new page's blocks onto the free list, lowest address first
+        const size_t blockSize = GetClassSize(sizeClass);
+        for (size_t offset = PAGE_BYTES; offset >= blockSize; offset -= blockSize)
+        {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(page + offset - blockSize);
+            block->next = head;
+            head = block;
+        }
+    }
+
+    FreeBlock* block = head;
+    head = block->next;
+    usedBytes += GetClassSize(sizeClass);
+    return block;
+}
+
+void PoolAllocator::Free(void* pointer, int sizeClass)
+{
+    FreeBlock* block = static_cast<FreeBlock*>(pointer);
+    block->next = freeLists[sizeClass];
+    freeLists[sizeClass] = block;
+    usedBytes -= GetClassSize(sizeClass);
+}
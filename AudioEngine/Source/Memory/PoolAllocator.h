@@ -0,0 +1,75 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file PoolAllocator.h
+///
+/// Fixed-size block pools for small allocations. Each size class keeps a free list of
+/// blocks carved from pages obtained from a page source, so small allocations never
+/// fragment the arena behind it. Pages are kept for reuse rather than returned.
+///
+/// Not thread-safe; AudioMemory serializes access.
+///
+/// @author JDSherbert
+
+#include <cstddef>
+
+class PoolAllocator
+{
+public:
+
+    // Callback which provides a page of PAGE_BYTES, or nullptr when out of memory
+    typedef void* (*PageSource)(size_t bytes, void* context);
+
+    // Block sizes are powers of two from MIN_BLOCK_SIZE to MAX_BLOCK_SIZE
+    static const size_t MIN_BLOCK_SIZE = 32;
+    static const size_t MAX_BLOCK_SIZE = 512;
+    static const int CLASS_COUNT = 5;
+
+    // Bytes requested from the page source whenever a size class runs out of blocks
+    static const size_t PAGE_BYTES = 16 * 1024;
+
+    PoolAllocator(PageSource pageSource, void* context);
+
+    /**
+     * Returns the size class that serves allocations of bytes, or -1 if bytes exceeds MAX_BLOCK_SIZE.
+     */
+    static int GetSizeClass(size_t bytes);
+
+    /**
+     * Returns the block size of a size class.
+     */
+    static size_t GetClassSize(int sizeClass);
+
+    /**
+     * Allocates a block of the size class. Blocks are aligned to 16 bytes if pages are.
+     * @return nullptr if the page source is out of memory
+     */
+    void* Allocate(int sizeClass);
+
+    /**
+     * Returns a block to the size class it was allocated from.
+     */
+    void Free(void* pointer, int sizeClass);
+
+    /** Bytes of pages obtained from the page source */
+    size_t GetReservedBytes() const { return reservedBytes; }
+
+    /** Bytes of blocks currently allocated */
+    size_t GetUsedBytes() const { return usedBytes; }
+
+private:
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    PageSource pageSource;
+    void* context;
+
+    FreeBlock* freeLists[CLASS_COUNT] = { };
+
+    size_t reservedBytes = 0;
+    size_t usedBytes = 0;
+};
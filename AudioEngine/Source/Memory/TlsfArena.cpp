@@ -0,0 +1,242 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file TlsfArena.cpp
+/// @author JDSherbert
+
+#include "TlsfArena.h"
+
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    /** Index of the highest set bit. value must be non-zero. */
+    int FindLastSet(uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanReverse(&index, value);
+        return static_cast<int>(index);
+#else
+        return 31 - __builtin_clz(value);
+#endif
+    }
+
+    /** Index of the lowest set bit. value must be non-zero. */
+    int FindFirstSet(uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward(&index, value);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(value);
+#endif
+    }
+
+    // Largest request served, so rounded sizes always map to a valid bin
+    const size_t MAX_ALLOCATION = static_cast<size_t>(1) << 31;
+}
+
+TlsfArena::TlsfArena()
+{
+    memset(secondLevelMap, 0, sizeof(secondLevelMap));
+    memset(freeLists, 0, sizeof(freeLists));
+}
+
+bool TlsfArena::AddRegion(void* memory, size_t bytes)
+{
+    if (!memory || reinterpret_cast<uintptr_t>(memory) % ALIGNMENT != 0)
+        return false;
+
+    bytes -= bytes % ALIGNMENT;
+    if (bytes < MIN_REGION_BYTES || bytes > 0xFFFFFFFFu)
+        return false;
+
+    // One free block spanning the region, followed by a zero-sized used sentinel so that
+    // merging never walks off the end
+    Block* block = static_cast<Block*>(memory);
+    block->prevPhysical = nullptr;
+    block->SetSize(bytes - 2 * BLOCK_OVERHEAD, true);
+
+    Block* sentinel = block->GetNextPhysical();
+    sentinel->prevPhysical = block;
+    sentinel->SetSize(0, false);
+
+    capacity += bytes;
+    InsertFree(block);
+    return true;
+}
+
+void* TlsfArena::Allocate(size_t bytes)
+{
+    if (bytes > MAX_ALLOCATION)
+        return nullptr;
+
+    size_t size = bytes < MIN_BLOCK_SIZE ? MIN_BLOCK_SIZE : bytes;
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    int firstLevel = 0;
+    int secondLevel = 0;
+    MapSearch(size, firstLevel, secondLevel);
+
+    Block* block = FindFree(firstLevel, secondLevel);
+    if (!block)
+        return nullptr;
+
+    RemoveFree(block);
+
+    // Return the tail to the arena if it can hold a block of its own
+    const size_t remainder = block->GetSize() - size;
+    if (remainder >= BLOCK_OVERHEAD + MIN_BLOCK_SIZE)
+    {
+        Block* rest = reinterpret_cast<Block*>(block->GetPayload() + size);
+        rest->prevPhysical = block;
+        rest->SetSize(remainder - BLOCK_OVERHEAD, true);
+        rest->GetNextPhysical()->prevPhysical = rest;
+        block->SetSize(size, false);
+        InsertFree(rest);
+    }
+    else
+        block->SetSize(block->GetSize(), false);
+
+    return block->GetPayload();
+}
+
+void TlsfArena::Free(void* pointer)
+{
+    if (!pointer)
+        return;
+
+    Block* block = FromPayload(pointer);
+    block->SetSize(block->GetSize(), true);
+
+    Block* next = block->GetNextPhysical();
+    if (next->IsFree())
+    {
+        RemoveFree(next);
+        block->SetSize(block->GetSize() + BLOCK_OVERHEAD + next->GetSize(), true);
+        block->GetNextPhysical()->prevPhysical = block;
+    }
+
+    Block* previous = block->prevPhysical;
+    if (previous && previous->IsFree())
+    {
+        RemoveFree(previous);
+        previous->SetSize(previous->GetSize() + BLOCK_OVERHEAD + block->GetSize(), true);
+        previous->GetNextPhysical()->prevPhysical = previous;
+        block = previous;
+    }
+
+    InsertFree(block);
+}
+
+size_t TlsfArena::GetBlockSize(const void* pointer)
+{
+    return FromPayload(pointer)->GetSize();
+}
+
+size_t TlsfArena::GetLargestFreeBlock() const
+{
+    if (!firstLevelMap)
+        return 0;
+
+    const int firstLevel = FindLastSet(firstLevelMap);
+    const int secondLevel = FindLastSet(secondLevelMap[firstLevel]);
+
+    size_t largest = 0;
+    for (const Block* block = freeLists[firstLevel][secondLevel]; block; block = block->nextFree)
+    {
+        if (block->GetSize() > largest)
+            largest = block->GetSize();
+    }
+    return largest;
+}
+
+TlsfArena::Block* TlsfArena::FromPayload(const void* pointer)
+{
+    return reinterpret_cast<Block*>(const_cast<char*>(static_cast<const char*>(pointer)) - BLOCK_OVERHEAD);
+}
+
+void TlsfArena::MapInsert(size_t size, int& firstLevel, int& secondLevel)
+{
+    if (size < SMALL_BLOCK_SIZE)
+    {
+        // Small blocks are binned linearly in ALIGNMENT steps
+        firstLevel = 0;
+        secondLevel = static_cast<int>(size / (SMALL_BLOCK_SIZE / SL_COUNT));
+    }
+    else
+    {
+        const int log2 = FindLastSet(static_cast<uint32_t>(size));
+        secondLevel = static_cast<int>(size >> (log2 - SL_LOG2)) - SL_COUNT;
+        firstLevel = log2 - FL_SHIFT + 1;
+    }
+}
+
+void TlsfArena::MapSearch(size_t size, int& firstLevel, int& secondLevel)
+{
+    // Round up to the next bin boundary so any block found there is large enough
+    if (size >= SMALL_BLOCK_SIZE)
+        size += (static_cast<size_t>(1) << (FindLastSet(static_cast<uint32_t>(size)) - SL_LOG2)) - 1;
+    MapInsert(size, firstLevel, secondLevel);
+}
+
+TlsfArena::Block* TlsfArena::FindFree(int firstLevel, int secondLevel) const
+{
+    uint32_t secondLevelBins = secondLevelMap[firstLevel] & (~0u << secondLevel);
+    if (!secondLevelBins)
+    {
+        const uint32_t firstLevelBins = firstLevel + 1 < FL_COUNT ? firstLevelMap & (~0u << (firstLevel + 1)) : 0;
+        if (!firstLevelBins)
+            return nullptr;
+
+        firstLevel = FindFirstSet(firstLevelBins);
+        secondLevelBins = secondLevelMap[firstLevel];
+    }
+
+    return freeLists[firstLevel][FindFirstSet(secondLevelBins)];
+}
+
+void TlsfArena::InsertFree(Block* block)
+{
+    int firstLevel = 0;
+    int secondLevel = 0;
+    MapInsert(block->GetSize(), firstLevel, secondLevel);
+
+    Block*& head = freeLists[firstLevel][secondLevel];
+    block->prevFree = nullptr;
+    block->nextFree = head;
+    if (head)
+        head->prevFree = block;
+    head = block;
+
+    firstLevelMap |= 1u << firstLevel;
+    secondLevelMap[firstLevel] |= 1u << secondLevel;
+    freeBytes += block->GetSize();
+}
+
+void TlsfArena::RemoveFree(Block* block)
+{
+    int firstLevel = 0;
+    int secondLevel = 0;
+    MapInsert(block->GetSize(), firstLevel, secondLevel);
+
+    if (block->prevFree)
+        block->prevFree->nextFree = block->nextFree;
+    else
+        freeLists[firstLevel][secondLevel] = block->nextFree;
+    if (block->nextFree)
+        block->nextFree->prevFree = block->prevFree;
+
+    if (!freeLists[firstLevel][secondLevel])
+    {
+        secondLevelMap[firstLevel] &= ~(1u << secondLevel);
+        if (!secondLevelMap[firstLevel])
+            firstLevelMap &= ~(1u << firstLevel);
+    }
+    freeBytes -= block->GetSize();
+}
@@ -0,0 +1,110 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file TlsfArena.h
+///
+/// Two-level segregated fit allocator over caller-provided memory regions.
+/// Free blocks are binned by size class (a power of two split into 16 linear steps), so
+/// allocation and free are O(1) with bounded fragmentation: a request is served from the
+/// first bin whose every block is large enough, and adjacent free blocks are always merged.
+///
+/// Not thread-safe; AudioMemory serializes access.
+///
+/// @author JDSherbert
+
+#include <cstddef>
+#include <cstdint>
+
+class TlsfArena
+{
+public:
+
+    // Alignment of every returned pointer and granularity of block sizes
+    static const size_t ALIGNMENT = 16;
+
+    // Bookkeeping bytes in front of every block
+    static const size_t BLOCK_OVERHEAD = 16;
+
+    // Smallest region AddRegion() accepts
+    static const size_t MIN_REGION_BYTES = 4 * BLOCK_OVERHEAD;
+
+    TlsfArena();
+
+    /**
+     * Hands a region of memory to the arena. The arena never frees regions; the caller owns them
+     * and must keep them alive for as long as the arena is used.
+     * @param memory - start of the region, aligned to ALIGNMENT
+     * @return false if the region is misaligned, too small or larger than 4 GB
+     */
+    bool AddRegion(void* memory, size_t bytes);
+
+    /**
+     * Allocates at least bytes, aligned to ALIGNMENT.
+     * @return nullptr if no free block is large enough
+     */
+    void* Allocate(size_t bytes);
+
+    /**
+     * Returns a block from Allocate() to the arena. nullptr is ignored.
+     */
+    void Free(void* pointer);
+
+    /**
+     * Usable size of a block returned by Allocate(), which may exceed the requested size.
+     */
+    static size_t GetBlockSize(const void* pointer);
+
+    /** Total bytes handed to the arena by AddRegion() */
+    size_t GetCapacity() const { return capacity; }
+
+    /** Bytes currently available for allocation, excluding block overhead */
+    size_t GetFreeBytes() const { return freeBytes; }
+
+    /** Size of the largest single block the arena could currently allocate */
+    size_t GetLargestFreeBlock() const;
+
+private:
+
+    struct Block
+    {
+        Block* prevPhysical;    // nullptr for the first block of a region
+        size_t size;            // payload bytes, low bit set while the block is free
+
+        // Only valid while the block is free; overlaps the payload
+        Block* nextFree;
+        Block* prevFree;
+
+        size_t GetSize() const { return size & ~static_cast<size_t>(1); }
+        bool IsFree() const { return (size & 1) != 0; }
+        void SetSize(size_t newSize, bool free) { size = newSize | (free ? 1 : 0); }
+        char* GetPayload() { return reinterpret_cast<char*>(this) + BLOCK_OVERHEAD; }
+        Block* GetNextPhysical() { return reinterpret_cast<Block*>(GetPayload() + GetSize()); }
+    };
+
+    static const int SL_LOG2 = 4;
+    static const int SL_COUNT = 1 << SL_LOG2;
+    static const int FL_SHIFT = SL_LOG2 + 4;        // log2(ALIGNMENT) + SL_LOG2
+    static const int FL_COUNT = 32 - FL_SHIFT + 1;
+    static const size_t SMALL_BLOCK_SIZE = static_cast<size_t>(1) << FL_SHIFT;
+    static const size_t MIN_BLOCK_SIZE = 2 * sizeof(Block*); // room for the free list links
+
+    static Block* FromPayload(const void* pointer);
+
+    /** Bin holding blocks of exactly this size class */
+    static void MapInsert(size_t size, int& firstLevel, int& secondLevel);
+
+    /** Smallest bin whose blocks are all at least size bytes */
+    static void MapSearch(size_t size, int& firstLevel, int& secondLevel);
+
+    Block* FindFree(int firstLevel, int secondLevel) const;
+    void InsertFree(Block* block);
+    void RemoveFree(Block* block);
+
+    uint32_t firstLevelMap = 0;
+    uint32_t secondLevelMap[FL_COUNT];
+    Block* freeLists[FL_COUNT][SL_COUNT];
+
+    size_t capacity = 0;
+    size_t freeBytes = 0;
+};
@@ -0,0 +1,153 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SharedAudioRing.cpp
+/// @author JDSherbert
+
+#include "SharedAudioRing.h"
+
+#include <cstring>
+#include <iostream>
+#include <new>
+
+SharedAudioRing::~SharedAudioRing()
+{
+    Close();
+}
+
+bool SharedAudioRing::Create(const char* name, int sampleRate, int channels, uint32_t blockFrames, uint32_t blocks)
+{
+    Close();
+    if (sampleRate <= 0 || channels <= 0 || blockFrames == 0 || blocks < 2)
+    {
+        std::cout << "SharedAudioRing: Invalid format for " << name << '\n';
+        return false;
+    }
+
+    const uint64_t frames = static_cast<uint64_t>(blockFrames) * blocks;
+    if (!region.Create(name, sizeof(Header) + frames * channels * sizeof(float)))
+        return false;
+
+    header = new (region.GetData()) Header();
+    header->version = VERSION;
+    header->sampleRate = sampleRate;
+    header->channels = channels;
+    header->blockFrames = blockFrames;
+    header->blocks = blocks;
+    header->writeFrame.store(0, std::memory_order_relaxed);
+    header->readFrame.store(0, std::memory_order_relaxed);
+    header->producerRunning.store(1, std::memory_order_relaxed);
+    header->magic.store(MAGIC, std::memory_order_release);
+
+    capacityFrames = frames;
+    producer = true;
+    return true;
+}
+
+bool SharedAudioRing::Open(const char* name)
+{
+    Close();
+    if (!region.Open(name))
+        return false;
+
+    Header* opened = static_cast<Header*>(region.GetData());
+    if (region.GetSize() < sizeof(Header) || opened->magic.load(std::memory_order_acquire) != MAGIC)
+    {
+        region.Close();
+        return false;
+    }
+    if (opened->version != VERSION)
+    {
+        std::cout << "SharedAudioRing: " << name << " is version " << opened->version << ", expected " << VERSION << '\n';
+        region.Close();
+        return false;
+    }
+
+    const uint64_t frames = static_cast<uint64_t>(opened->blockFrames) * opened->blocks;
+    if (region.GetSize() < sizeof(Header) + frames * opened->channels * sizeof(float))
+    {
+        std::cout << "SharedAudioRing: " << name << " is smaller than its header says\n";
+        region.Close();
+        return false;
+    }
+
+    header = opened;
+    capacityFrames = frames;
+    producer = false;
+    return true;
+}
+
+void SharedAudioRing::Close()
+{
+    if (header && producer)
+        header->producerRunning.store(0, std::memory_order_release);
+    header = nullptr;
+    capacityFrames = 0;
+    producer = false;
+    region.Close();
+}
+
+int SharedAudioRing::GetSampleRate() const
+{
+    return header ? header->sampleRate : 0;
+}
+
+int SharedAudioRing::GetChannels() const
+{
+    return header ? header->channels : 0;
+}
+
+uint32_t SharedAudioRing::GetBlockFrames() const
+{
+    return header ? header->blockFrames : 0;
+}
+
+uint32_t SharedAudioRing::GetCapacityFrames() const
+{
+    return static_cast<uint32_t>(capacityFrames);
+}
+
+float* SharedAudioRing::AcquireBlock()
+{
+    const uint64_t write = header->writeFrame.load(std::memory_order_relaxed);
+    if (write + header->blockFrames - header->readFrame.load(std::memory_order_acquire) > capacityFrames)
+        return nullptr;
+
+    // Writes are whole blocks and the ring is whole blocks, so a block never wraps
+    return GetSamples() + (write % capacityFrames) * header->channels;
+}
+
+void SharedAudioRing::CommitBlock()
+{
+    const uint64_t write = header->writeFrame.load(std::memory_order_relaxed);
+    header->writeFrame.store(write + header->blockFrames, std::memory_order_release);
+}
+
+uint32_t SharedAudioRing::Read(float* output, uint32_t frames)
+{
+    const uint64_t read = header->readFrame.load(std::memory_order_relaxed);
+    const uint64_t available = header->writeFrame.load(std::memory_order_acquire) - read;
+    const uint32_t count = static_cast<uint32_t>(available < frames ? available : frames);
+    if (count == 0)
+        return 0;
+
+    const int channels = header->channels;
+    const uint64_t start = read % capacityFrames;
+    const uint64_t first = capacityFrames - start < count ? capacityFrames - start : count;
+    memcpy(output, GetSamples() + start * channels, first * channels * sizeof(float));
+    memcpy(output + first * channels, GetSamples(), (count - first) * channels * sizeof(float));
+
+    header->readFrame.store(read + count, std::memory_order_release);
+    return count;
+}
+
+uint32_t SharedAudioRing::GetReadableFrames() const
+{
+    if (!header)
+        return 0;
+    return static_cast<uint32_t>(header->writeFrame.load(std::memory_order_acquire) - header->readFrame.load(std::memory_order_relaxed));
+}
+
+bool SharedAudioRing::IsProducerRunning() const
+{
+    return header && header->producerRunning.load(std::memory_order_acquire) != 0;
+}
@@ -0,0 +1,115 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SharedAudioRing.h
+///
+/// Lock-free ring of interleaved float audio in a SharedMemoryRegion, written by exactly one
+/// process and read by exactly one other, e.g. the engine's SharedMemoryOutput handing its mix
+/// to an encoder. The ring holds a whole number of fixed-size blocks. The producer only writes a
+/// block once the consumer has read far enough to free it, so the consumer's reads are the
+/// clock: read in real time for a live stream, or as fast as possible to render offline.
+///
+/// This is also the reader library. It depends on nothing but the standard library and
+/// SharedMemoryRegion, so the consumer can build these two files without FMOD.
+///
+/// @author JDSherbert
+
+#include <atomic>
+#include <cstdint>
+
+#include "SharedMemoryRegion.h"
+
+class SharedAudioRing
+{
+public:
+
+    static const uint32_t MAGIC = 0x52414541; // "AEAR"
+    static const uint32_t VERSION = 1;
+
+    SharedAudioRing() = default;
+    ~SharedAudioRing();
+
+    SharedAudioRing(const SharedAudioRing&) = delete;
+    SharedAudioRing& operator=(const SharedAudioRing&) = delete;
+
+    /**
+     * Creates the ring as its producer.
+     * @param blockFrames Frames the producer writes at a time
+     * @param blocks Blocks the ring holds; the most audio the producer can run ahead of the consumer
+     * @return false if the shared memory can't be created
+     */
+    bool Create(const char* name, int sampleRate, int channels, uint32_t blockFrames, uint32_t blocks);
+
+    /**
+     * Opens a ring created by another process as its consumer.
+     * @return false if the ring doesn't exist yet or was made by an incompatible version
+     */
+    bool Open(const char* name);
+
+    /**
+     * Closes the ring. Closing the producer end tells the consumer no more audio is coming.
+     */
+    void Close();
+
+    bool IsOpen() const { return header != nullptr; }
+
+    int GetSampleRate() const;
+    int GetChannels() const;
+    uint32_t GetBlockFrames() const;
+    uint32_t GetCapacityFrames() const;
+
+    /**
+     * Returns the next block to fill, or nullptr while the consumer hasn't freed one. Producer only.
+     */
+    float* AcquireBlock();
+
+    /**
+     * Hands the block returned by AcquireBlock() to the consumer. Producer only.
+     */
+    void CommitBlock();
+
+    /**
+     * Copies up to frames frames of audio into output and frees their space for the producer.
+     * Consumer only.
+     * @return the number of frames copied, 0 when the producer hasn't caught up
+     */
+    uint32_t Read(float* output, uint32_t frames);
+
+    /**
+     * Returns the frames waiting to be read
+     */
+    uint32_t GetReadableFrames() const;
+
+    /**
+     * Returns false once the producer has closed its end. Consumer only.
+     */
+    bool IsProducerRunning() const;
+
+private:
+
+    // Layout at the start of the shared memory, followed by the samples.
+    // Positions count frames since creation and never wrap, so full and empty can't be confused.
+    struct Header
+    {
+        std::atomic<uint32_t> magic;    // stored last by Create(), so Open() never sees a half-written header
+        uint32_t version;
+        int32_t sampleRate;
+        int32_t channels;
+        uint32_t blockFrames;
+        uint32_t blocks;
+
+        alignas(64) std::atomic<uint64_t> writeFrame;   // written by the producer
+        alignas(64) std::atomic<uint64_t> readFrame;    // written by the consumer
+        alignas(64) std::atomic<uint32_t> producerRunning;
+    };
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "SharedAudioRing needs address-free 64-bit atomics");
+
+    float* GetSamples() const { return reinterpret_cast<float*>(header + 1); }
+
+    SharedMemoryRegion region;
+    Header* header = nullptr;
+    uint64_t capacityFrames = 0;
+    bool producer = false;
+};
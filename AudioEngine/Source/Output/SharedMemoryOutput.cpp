@@ -0,0 +1,140 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SharedMemoryOutput.cpp
+/// @author JDSherbert
+
+#include "SharedMemoryOutput.h"
+#include "SharedAudioRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace
+{
+    const char* DRIVER_NAME = "Shared memory ring";
+
+    struct OutputInstance
+    {
+        SharedAudioRing ring;
+        std::string name;
+        std::thread mixThread;
+        std::atomic<bool> running { false };
+
+        // Time the mixer thread sleeps when the ring is full, a fraction of a block so the
+        // consumer finds the next block ready soon after it frees room
+        std::chrono::microseconds pollInterval { 1000 };
+    };
+
+    OutputInstance* Get(FMOD_OUTPUT_STATE* outputState) { return static_cast<OutputInstance*>(outputState->plugindata); }
+
+    void MixLoop(FMOD_OUTPUT_STATE* outputState)
+    {
+        OutputInstance* instance = Get(outputState);
+        const unsigned int blockFrames = instance->ring.GetBlockFrames();
+        while (instance->running.load(std::memory_order_acquire))
+        {
+            float* block = instance->ring.AcquireBlock();
+            if (!block)
+            {
+                std::this_thread::sleep_for(instance->pollInterval);
+                continue;
+            }
+
+            FMOD_OUTPUT_READFROMMIXER(outputState, block, blockFrames);
+            instance->ring.CommitBlock();
+        }
+    }
+
+    FMOD_RESULT F_CALL GetNumDrivers(FMOD_OUTPUT_STATE* /*outputState*/, int* numDrivers)
+    {
+        *numDrivers = 1;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL GetDriverInfo(FMOD_OUTPUT_STATE* /*outputState*/, int /*id*/, char* name, int nameLength, FMOD_GUID* guid,
+                                     int* /*systemRate*/, FMOD_SPEAKERMODE* /*speakerMode*/, int* /*speakerModeChannels*/)
+    {
+        if (name && nameLength > 0)
+        {
+            strncpy(name, DRIVER_NAME, nameLength - 1);
+            name[nameLength - 1] = '\0';
+        }
+        if (guid)
+            memset(guid, 0, sizeof(FMOD_GUID));
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL Init(FMOD_OUTPUT_STATE* outputState, int /*selectedDriver*/, FMOD_INITFLAGS /*flags*/, int* outputRate,
+                            FMOD_SPEAKERMODE* /*speakerMode*/, int* speakerModeChannels, FMOD_SOUND_FORMAT* outputFormat,
+                            int dspBufferLength, int /*dspNumBuffers*/, void* extraDriverData)
+    {
+        SharedMemoryOutputSettings settings;
+        if (extraDriverData)
+            settings = *static_cast<const SharedMemoryOutputSettings*>(extraDriverData);
+
+        OutputInstance* instance = new OutputInstance();
+        instance->name = settings.name ? settings.name : SharedMemoryOutputSettings().name;
+        const int ringBlocks = settings.ringBlocks < 2 ? 2 : settings.ringBlocks;
+        if (!instance->ring.Create(instance->name.c_str(), *outputRate, *speakerModeChannels,
+                                   static_cast<uint32_t>(dspBufferLength), static_cast<uint32_t>(ringBlocks)))
+        {
+            delete instance;
+            return FMOD_ERR_OUTPUT_INIT;
+        }
+
+        const long long blockMicroseconds = 1000000LL * dspBufferLength / *outputRate;
+        instance->pollInterval = std::chrono::microseconds(blockMicroseconds / 4 > 0 ? blockMicroseconds / 4 : 1);
+
+        *outputFormat = FMOD_SOUND_FORMAT_PCMFLOAT;
+        outputState->plugindata = instance;
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL Start(FMOD_OUTPUT_STATE* outputState)
+    {
+        OutputInstance* instance = Get(outputState);
+        instance->running.store(true, std::memory_order_release);
+        instance->mixThread = std::thread(&MixLoop, outputState);
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL Stop(FMOD_OUTPUT_STATE* outputState)
+    {
+        OutputInstance* instance = Get(outputState);
+        instance->running.store(false, std::memory_order_release);
+        if (instance->mixThread.joinable())
+            instance->mixThread.join();
+        return FMOD_OK;
+    }
+
+    FMOD_RESULT F_CALL Close(FMOD_OUTPUT_STATE* outputState)
+    {
+        delete Get(outputState);
+        outputState->plugindata = nullptr;
+        return FMOD_OK;
+    }
+}
+
+const FMOD_OUTPUT_DESCRIPTION* SharedMemoryOutput::GetDescription()
+{
+    static FMOD_OUTPUT_DESCRIPTION description = []()
+    {
+        FMOD_OUTPUT_DESCRIPTION result;
+        memset(&result, 0, sizeof(result));
+        result.apiversion = FMOD_OUTPUT_PLUGIN_VERSION;
+        result.name = "Engine Shared Memory Output";
+        result.version = 0x00010000;
+        result.method = FMOD_OUTPUT_METHOD_MIX_DIRECT;
+        result.getnumdrivers = &GetNumDrivers;
+        result.getdriverinfo = &GetDriverInfo;
+        result.init = &Init;
+        result.start = &Start;
+        result.stop = &Stop;
+        result.close = &Close;
+        return result;
+    }();
+    return &description;
+}
@@ -0,0 +1,42 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SharedMemoryOutput.h
+///
+/// FMOD output plugin for machines without a sound card. Instead of playing the final mix, it
+/// writes it into a SharedAudioRing for another process, such as a stream encoder, to read.
+/// A thread of the plugin's own pulls one mixer block from FMOD whenever the consumer has freed
+/// room for it, so the mixer runs at whatever pace the consumer reads: real time for a live
+/// stream, faster for offline rendering. With no consumer reading, the mixer waits.
+///
+/// Selected with AudioEngineSettings::sharedMemoryOutput. The mix is always 32-bit float, at the
+/// engine's sample rate and speaker mode, one DSP buffer per ring block.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+#include <FMOD/fmod_output.h>
+
+/**
+ * Passed to System::init() as extradriverdata when the plugin is the output
+ */
+struct SharedMemoryOutputSettings
+{
+    // Name of the shared memory the consumer opens with SharedAudioRing::Open()
+    const char* name = "AudioEngineMix";
+
+    // DSP buffers the ring holds, i.e. how far the mixer can run ahead of the consumer
+    int ringBlocks = 8;
+};
+
+class SharedMemoryOutput
+{
+public:
+
+    /**
+     * Returns the FMOD plugin description of the output.
+     */
+    static const FMOD_OUTPUT_DESCRIPTION* GetDescription();
+};
@@ -0,0 +1,192 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SharedMemoryRegion.cpp
+/// @author JDSherbert
+
+#include "SharedMemoryRegion.h"
+
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+
+bool SharedMemoryRegion::Create(const char* name, size_t newSize)
+{
+    Close();
+    path = std::string("Local\\") + name;
+
+    const unsigned long long mappingSize = newSize;
+    HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(mappingSize >> 32),
+                                       static_cast<DWORD>(mappingSize & 0xFFFFFFFF), path.c_str());
+    if (!handle)
+    {
+        std::cout << "SharedMemoryRegion: Could not create " << name << " (error " << GetLastError() << ")\n";
+        return false;
+    }
+
+    // An existing mapping is reused by name at its old size, so it is mapped whole, checked
+    // to be large enough and cleared by hand
+    const bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+    data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, existed ? 0 : newSize);
+    if (!data)
+    {
+        std::cout << "SharedMemoryRegion: Could not map " << name << " (error " << GetLastError() << ")\n";
+        CloseHandle(handle);
+        return false;
+    }
+    if (existed)
+    {
+        MEMORY_BASIC_INFORMATION info;
+        if (!VirtualQuery(data, &info, sizeof(info)) || info.RegionSize < newSize)
+        {
+            std::cout << "SharedMemoryRegion: " << name << " is still open elsewhere with fewer than " << newSize << " bytes\n";
+            UnmapViewOfFile(data);
+            data = nullptr;
+            CloseHandle(handle);
+            return false;
+        }
+        memset(data, 0, newSize);
+    }
+
+    mapping = handle;
+    size = newSize;
+    owner = true;
+    return true;
+}
+
+bool SharedMemoryRegion::Open(const char* name)
+{
+    Close();
+    path = std::string("Local\\") + name;
+
+    HANDLE handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, path.c_str());
+    if (!handle)
+        return false;
+
+    data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!data || !VirtualQuery(data, &info, sizeof(info)))
+    {
+        if (data)
+            UnmapViewOfFile(data);
+        data = nullptr;
+        CloseHandle(handle);
+        return false;
+    }
+
+    mapping = handle;
+    size = info.RegionSize;
+    owner = false;
+    return true;
+}
+
+void SharedMemoryRegion::Close()
+{
+    if (data)
+        UnmapViewOfFile(data);
+    if (mapping)
+        CloseHandle(mapping);
+    data = nullptr;
+    mapping = nullptr;
+    size = 0;
+    owner = false;
+}
+
+#else
+
+bool SharedMemoryRegion::Create(const char* name, size_t newSize)
+{
+    Close();
+    path = std::string("/") + name;
+
+    // A region left by a crashed producer would keep its old contents, so start from scratch
+    shm_unlink(path.c_str());
+    const int file = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (file < 0)
+    {
+        std::cout << "SharedMemoryRegion: Could not create " << name << '\n';
+        return false;
+    }
+
+    if (ftruncate(file, static_cast<off_t>(newSize)) != 0)
+    {
+        std::cout << "SharedMemoryRegion: Could not size " << name << " to " << newSize << " bytes\n";
+        close(file);
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+    if (mapped == MAP_FAILED)
+    {
+        std::cout << "SharedMemoryRegion: Could not map " << name << '\n';
+        shm_unlink(path.c_str());
+        return false;
+    }
+
+    data = mapped;
+    size = newSize;
+    owner = true;
+    return true;
+}
+
+bool SharedMemoryRegion::Open(const char* name)
+{
+    Close();
+    path = std::string("/") + name;
+
+    const int file = shm_open(path.c_str(), O_RDWR, 0);
+    if (file < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size <= 0)
+    {
+        close(file);
+        return false;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+    if (mapped == MAP_FAILED)
+        return false;
+
+    data = mapped;
+    size = static_cast<size_t>(status.st_size);
+    owner = false;
+    return true;
+}
+
+void SharedMemoryRegion::Close()
+{
+    if (data)
+        munmap(data, size);
+    if (owner)
+        shm_unlink(path.c_str());
+    data = nullptr;
+    size = 0;
+    owner = false;
+}
+
+#endif
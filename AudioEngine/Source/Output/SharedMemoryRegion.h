@@ -0,0 +1,59 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SharedMemoryRegion.h
+///
+/// A named block of memory mapped into more than one process: a file mapping in the session
+/// namespace on Windows, a POSIX shm_open() object elsewhere (link with -lrt on older glibc).
+/// The creator owns the name and removes it on Close(); processes which opened it keep their
+/// mapping until they close it too.
+///
+/// @author JDSherbert
+
+#include <cstddef>
+#include <string>
+
+class SharedMemoryRegion
+{
+public:
+
+    SharedMemoryRegion() = default;
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    /**
+     * Creates and maps a zeroed region, replacing any left behind under the same name.
+     * On Windows a region another process still holds open is reused instead, and must be
+     * at least size bytes.
+     * @return false if the region can't be created
+     */
+    bool Create(const char* name, size_t size);
+
+    /**
+     * Maps a region created by another process.
+     * @return false if no region of that name exists
+     */
+    bool Open(const char* name);
+
+    /**
+     * Unmaps the region, and removes its name if this process created it.
+     */
+    void Close();
+
+    void* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+
+private:
+
+    void* data = nullptr;
+    size_t size = 0;
+    bool owner = false;
+    std::string path;
+
+#if defined(_WIN32)
+    void* mapping = nullptr;
+#endif
+};
@@ -0,0 +1,124 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file AudibilityCuller.cpp
+/// @author JDSherbert
+
+#include "AudibilityCuller.h"
+
+#include "../DSP/SimdLanes.h"
+
+#include <cfloat>
+
+namespace
+{
+    // Arrays are padded so the widest lanes never read past the end
+    const int PADDING = 8;
+
+    /**
+     * Tests emitters [first, first + Lanes::WIDTH) against their nearest listener and writes one flag per emitter.
+     */
+    template <typename Lanes>
+    void TestLanes(const float* x, const float* y, const float* z, const float* radiusSquared,
+                   const Vector3* listeners, int listenerCount, int first, char* audible)
+    {
+        const typename Lanes::Register emitterX = Lanes::Load(x + first);
+        const typename Lanes::Register emitterY = Lanes::Load(y + first);
+        const typename Lanes::Register emitterZ = Lanes::Load(z + first);
+        typename Lanes::Register distanceSquared = Lanes::Set(FLT_MAX);
+        for (int listener = 0; listener < listenerCount; ++listener)
+        {
+            const typename Lanes::Register dx = Lanes::Sub(emitterX, Lanes::Set(listeners[listener].x));
+            const typename Lanes::Register dy = Lanes::Sub(emitterY, Lanes::Set(listeners[listener].y));
+            const typename Lanes::Register dz = Lanes::Sub(emitterZ, Lanes::Set(listeners[listener].z));
+            distanceSquared = Lanes::Min(distanceSquared, Lanes::Add(Lanes::Add(Lanes::Mul(dx, dx), Lanes::Mul(dy, dy)), Lanes::Mul(dz, dz)));
+        }
+
+        const int mask = Lanes::LessEqualMask(distanceSquared, Lanes::Load(radiusSquared + first));
+        for (int lane = 0; lane < Lanes::WIDTH; ++lane)
+            audible[first + lane] = static_cast<char>((mask >> lane) & 1);
+    }
+}
+
+float AudibilityCuller::GetAudibleRadius(float volume, float minDistance, float maxDistance, float volumeThreshold)
+{
+    if (volumeThreshold <= 0.0f)
+        return maxDistance;
+    if (volume < volumeThreshold)
+        return -1.0f;
+
+    // Inverse rolloff: gain = volume * minDistance / distance beyond minDistance
+    const float radius = volume * minDistance / volumeThreshold;
+    return radius < maxDistance ? radius : maxDistance;
+}
+
+bool AudibilityCuller::IsAudible(const Vector3* listeners, int listenerCount, const Vector3& position, float audibleRadius)
+{
+    float distanceSquared = 0.0f;
+    FindNearestListener(listeners, listenerCount, position, distanceSquared);
+    return audibleRadius >= 0.0f && distanceSquared <= audibleRadius * audibleRadius;
+}
+
+int AudibilityCuller::FindNearestListener(const Vector3* listeners, int listenerCount, const Vector3& position, float& distanceSquared)
+{
+    int nearest = 0;
+    distanceSquared = FLT_MAX;
+    for (int listener = 0; listener < listenerCount; ++listener)
+    {
+        const float dx = position.x - listeners[listener].x;
+        const float dy = position.y - listeners[listener].y;
+        const float dz = position.z - listeners[listener].z;
+        const float listenerDistanceSquared = dx * dx + dy * dy + dz * dz;
+        if (listenerDistanceSquared < distanceSquared)
+        {
+            distanceSquared = listenerDistanceSquared;
+            nearest = listener;
+        }
+    }
+    return nearest;
+}
+
+void AudibilityCuller::Clear()
+{
+    x.clear();
+    y.clear();
+    z.clear();
+    radiusSquared.clear();
+    count = 0;
+}
+
+void AudibilityCuller::Add(const Vector3& position, float audibleRadius)
+{
+    const size_t padded = (static_cast<size_t>(count) + PADDING) / PADDING * PADDING;
+    if (x.size() < padded)
+    {
+        // Padding lanes get a negative radius so they never test audible
+        x.resize(padded, 0.0f);
+        y.resize(padded, 0.0f);
+        z.resize(padded, 0.0f);
+        radiusSquared.resize(padded, -1.0f);
+    }
+
+    x[count] = position.x;
+    y[count] = position.y;
+    z[count] = position.z;
+    radiusSquared[count] = audibleRadius >= 0.0f ? audibleRadius * audibleRadius : -1.0f;
+    ++count;
+}
+
+void AudibilityCuller::Test(const Vector3* listeners, int listenerCount, std::vector<char>& audible) const
+{
+    audible.resize(x.size());
+
+    int first = 0;
+#if defined(AUDIO_ENGINE_AVX)
+    for (; first < count; first += AvxLanes::WIDTH)
+        TestLanes<AvxLanes>(x.data(), y.data(), z.data(), radiusSquared.data(), listeners, listenerCount, first, audible.data());
+#elif defined(AUDIO_ENGINE_SSE)
+    for (; first < count; first += SseLanes::WIDTH)
+        TestLanes<SseLanes>(x.data(), y.data(), z.data(), radiusSquared.data(), listeners, listenerCount, first, audible.data());
+#endif
+    for (; first < count; ++first)
+        TestLanes<ScalarLanes>(x.data(), y.data(), z.data(), radiusSquared.data(), listeners, listenerCount, first, audible.data());
+
+    audible.resize(count);
+}
@@ -0,0 +1,72 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file AudibilityCuller.h
+///
+/// Engine-side test of whether 3D emitters can be heard from any listener, used to avoid
+/// spending FMOD channels on sounds that would be silent anyway. With several listeners
+/// (split-screen) an emitter is tested against the nearest one, so it takes one channel
+/// however many players can hear it.
+///
+/// Each emitter is reduced to an audible radius, the distance at which FMOD's default inverse
+/// rolloff brings its volume under a threshold (capped at its max distance). Emitters are kept
+/// in structure-of-arrays form so the per-frame test is a SIMD distance compare across all of them.
+///
+/// @author JDSherbert
+
+#include <vector>
+
+#include "../Math/Vector3.h"
+
+class AudibilityCuller
+{
+public:
+
+    /**
+     * Distance within which an emitter is audible.
+     * @param volume - linear volume of the emitter
+     * @param minDistance - distance at which inverse rolloff starts attenuating
+     * @param maxDistance - distance at which attenuation stops; emitters beyond it are treated as inaudible
+     * @param volumeThreshold - linear volume below which an emitter is inaudible, 0 to use maxDistance alone
+     * @return a negative radius if the emitter is inaudible at any distance
+     */
+    static float GetAudibleRadius(float volume, float minDistance, float maxDistance, float volumeThreshold);
+
+    /**
+     * Tests a single emitter, used when a sound is about to be played.
+     */
+    static bool IsAudible(const Vector3* listeners, int listenerCount, const Vector3& position, float audibleRadius);
+
+    /**
+     * Returns the index of the listener nearest to position, and its squared distance.
+     */
+    static int FindNearestListener(const Vector3* listeners, int listenerCount, const Vector3& position, float& distanceSquared);
+
+    /**
+     * Removes every emitter.
+     */
+    void Clear();
+
+    /**
+     * Adds an emitter to be tested by Test(). Emitters are indexed in the order they are added.
+     */
+    void Add(const Vector3& position, float audibleRadius);
+
+    int GetCount() const { return count; }
+
+    /**
+     * Tests every emitter against its nearest listener. audible[i] is set to 1 if emitter i is audible, else 0.
+     */
+    void Test(const Vector3* listeners, int listenerCount, std::vector<char>& audible) const;
+
+private:
+
+    // Structure of arrays, padded to a multiple of the widest SIMD width
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<float> radiusSquared;
+
+    int count = 0;
+};
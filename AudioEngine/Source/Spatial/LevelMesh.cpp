@@ -0,0 +1,102 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file LevelMesh.cpp
+/// @author JDSherbert
+
+#include "LevelMesh.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    /**
+     * Resolves an OBJ face index ("7", "7/2/7", "-1" ...) to a zero-based vertex index.
+     * @return -1 if the index is invalid
+     */
+    int ResolveIndex(const std::string& token, int vertexCount)
+    {
+        const long index = strtol(token.c_str(), nullptr, 10);
+        const long resolved = index < 0 ? vertexCount + index : index - 1;
+        return resolved >= 0 && resolved < vertexCount ? static_cast<int>(resolved) : -1;
+    }
+}
+
+bool LevelMesh::LoadObj(const char* filePath, LevelMesh& mesh,
+                        const std::map<std::string, OcclusionMaterial>& materialTable,
+                        OcclusionMaterial defaultMaterial)
+{
+    std::ifstream file(filePath);
+    if (!file)
+    {
+        std::cout << "LevelMesh: Could not open " << filePath << '\n';
+        return false;
+    }
+
+    mesh.vertices.clear();
+    mesh.triangles.clear();
+    mesh.materials.assign(1, defaultMaterial);
+
+    std::map<std::string, int> materialIndices;
+    int material = 0;
+
+    std::string line;
+    int lineNumber = 0;
+    std::vector<int> face;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+
+        if (keyword == "v")
+        {
+            Vector3 vertex;
+            tokens >> vertex.x >> vertex.y >> vertex.z;
+            mesh.vertices.push_back(vertex);
+        }
+        else if (keyword == "f")
+        {
+            face.clear();
+            std::string token;
+            while (tokens >> token)
+            {
+                const int index = ResolveIndex(token, static_cast<int>(mesh.vertices.size()));
+                if (index < 0)
+                {
+                    std::cout << "LevelMesh: Invalid vertex index " << token << " in " << filePath << " (line " << lineNumber << ")\n";
+                    return false;
+                }
+                face.push_back(index);
+            }
+
+            for (size_t i = 2; i < face.size(); ++i)
+                mesh.triangles.push_back({ { face[0], face[i - 1], face[i] }, material });
+        }
+        else if (keyword == "usemtl")
+        {
+            std::string name;
+            tokens >> name;
+
+            auto known = materialTable.find(name);
+            if (known == materialTable.end())
+            {
+                material = 0;
+                continue;
+            }
+
+            auto existing = materialIndices.find(name);
+            if (existing == materialIndices.end())
+            {
+                existing = materialIndices.insert({ name, static_cast<int>(mesh.materials.size()) }).first;
+                mesh.materials.push_back(known->second);
+            }
+            material = existing->second;
+        }
+    }
+
+    return true;
+}
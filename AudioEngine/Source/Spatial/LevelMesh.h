@@ -0,0 +1,57 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file LevelMesh.h
+///
+/// Simplified level geometry used for sound occlusion, imported from Wavefront OBJ exports
+/// of the level's collision or proxy meshes.
+///
+/// @author JDSherbert
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../Math/Vector3.h"
+
+/**
+ * How strongly a surface blocks sound passing through it.
+ */
+struct OcclusionMaterial
+{
+    // Attenuation of the direct path, 0 (transparent) to 1 (fully blocked)
+    float directOcclusion = 1.0f;
+
+    // Attenuation of the reverb path, 0 (transparent) to 1 (fully blocked)
+    float reverbOcclusion = 1.0f;
+
+    // Block sound arriving from either side rather than only the front face
+    bool doubleSided = true;
+};
+
+struct LevelMesh
+{
+    struct Triangle
+    {
+        int indices[3];     // into vertices
+        int material;       // into materials
+    };
+
+    std::vector<Vector3> vertices;
+    std::vector<Triangle> triangles;
+
+    // Materials referenced by the triangles. Index 0 is used for faces without a known material.
+    std::vector<OcclusionMaterial> materials;
+
+    /**
+     * Imports the vertices and faces of an OBJ file, replacing the mesh's contents.
+     * Polygons are triangulated as fans; normals, texture coordinates and groups are ignored.
+     * @param materialTable - occlusion material for each OBJ "usemtl" name. Faces using other names,
+     *                        or none, get defaultMaterial.
+     * @return false, after printing the reason, if the file cannot be read or references missing vertices
+     */
+    static bool LoadObj(const char* filePath, LevelMesh& mesh,
+                        const std::map<std::string, OcclusionMaterial>& materialTable = { },
+                        OcclusionMaterial defaultMaterial = OcclusionMaterial());
+};
@@ -0,0 +1,207 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file OcclusionSystem.cpp
+/// @author JDSherbert
+
+#include "OcclusionSystem.h"
+
+#include "../../AudioEngine.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    FMOD_VECTOR ToFMOD(const Vector3& vector)
+    {
+        return { vector.x, vector.y, vector.z };
+    }
+
+    float TriangleArea(const Vector3& a, const Vector3& b, const Vector3& c)
+    {
+        const float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        const float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        const float cx = uy * vz - uz * vy;
+        const float cy = uz * vx - ux * vz;
+        const float cz = ux * vy - uy * vx;
+        return 0.5f * sqrtf(cx * cx + cy * cy + cz * cz);
+    }
+}
+
+OcclusionSystem::OcclusionSystem(FMOD::System* system, const OcclusionSettings& settings)
+    : system(system)
+    , settings(settings)
+{
+    ERRCHECK(system->setGeometrySettings(settings.maxWorldSize));
+}
+
+OcclusionSystem::~OcclusionSystem()
+{
+    Clear();
+}
+
+int OcclusionSystem::AddMesh(const LevelMesh& mesh)
+{
+    // Materials are appended so triangles from earlier meshes keep their indices
+    const int materialOffset = static_cast<int>(materials.size());
+    materials.insert(materials.end(), mesh.materials.begin(), mesh.materials.end());
+    if (mesh.materials.empty())
+        materials.push_back(OcclusionMaterial());
+
+    int kept = 0;
+    for (const LevelMesh::Triangle& triangle : mesh.triangles)
+    {
+        const Vector3& a = mesh.vertices[triangle.indices[0]];
+        const Vector3& b = mesh.vertices[triangle.indices[1]];
+        const Vector3& c = mesh.vertices[triangle.indices[2]];
+        if (TriangleArea(a, b, c) < settings.minTriangleArea)
+            continue;
+
+        // Each triangle lives in the cell containing its centroid, once, so no ray crosses it twice
+        const CellKey key = GetCellKey((a.x + b.x + c.x) / 3.0f, (a.z + b.z + c.z) / 3.0f);
+        Cell& cell = cells[key];
+        const float minX = std::min(std::min(a.x, b.x), c.x);
+        const float maxX = std::max(std::max(a.x, b.x), c.x);
+        const float minZ = std::min(std::min(a.z, b.z), c.z);
+        const float maxZ = std::max(std::max(a.z, b.z), c.z);
+        if (cell.materials.empty())
+        {
+            cell.minX = minX;
+            cell.maxX = maxX;
+            cell.minZ = minZ;
+            cell.maxZ = maxZ;
+        }
+        else
+        {
+            cell.minX = std::min(cell.minX, minX);
+            cell.maxX = std::max(cell.maxX, maxX);
+            cell.minZ = std::min(cell.minZ, minZ);
+            cell.maxZ = std::max(cell.maxZ, maxZ);
+        }
+
+        // The triangle is streamed in with its cell, so it must be found from wherever it reaches
+        const float cellMinX = key.first * settings.cellSize;
+        const float cellMinZ = key.second * settings.cellSize;
+        cellOverhang = std::max(cellOverhang, std::max(std::max(cellMinX - minX, maxX - (cellMinX + settings.cellSize)),
+                                                       std::max(cellMinZ - minZ, maxZ - (cellMinZ + settings.cellSize))));
+
+        cell.vertices.push_back(ToFMOD(a));
+        cell.vertices.push_back(ToFMOD(b));
+        cell.vertices.push_back(ToFMOD(c));
+        cell.materials.push_back(materialOffset + (mesh.materials.empty() ? 0 : triangle.material));
+        ++kept;
+
+        // A loaded cell is rebuilt on the next Update() to include the new triangle
+        if (cell.geometry)
+            UnloadCell(cell);
+    }
+    return kept;
+}
+
+void OcclusionSystem::Clear()
+{
+    for (auto& cell : cells)
+        UnloadCell(cell.second);
+    cells.clear();
+    materials.clear();
+    cellOverhang = 0.0f;
+}
+
+void OcclusionSystem::Update(const Vector3* listenerPositions, int listenerCount)
+{
+    const float unloadDistance = settings.streamRadius + settings.unloadMargin;
+    for (auto& cell : cells)
+    {
+        if (cell.second.geometry && GetDistanceToCell(cell.second, listenerPositions, listenerCount) > unloadDistance)
+            UnloadCell(cell.second);
+    }
+
+    // Gather unloaded cells in range of any listener and build the nearest ones first
+    std::vector<std::pair<float, Cell*>> candidates;
+    for (int listener = 0; listener < listenerCount; ++listener)
+    {
+        const Vector3& listenerPosition = listenerPositions[listener];
+        const float searchRadius = settings.streamRadius + cellOverhang;
+        const CellKey low = GetCellKey(listenerPosition.x - searchRadius, listenerPosition.z - searchRadius);
+        const CellKey high = GetCellKey(listenerPosition.x + searchRadius, listenerPosition.z + searchRadius);
+        for (int x = low.first; x <= high.first; ++x)
+        {
+            for (auto it = cells.lower_bound({ x, low.second }); it != cells.end() && it->first.first == x && it->first.second <= high.second; ++it)
+            {
+                // A cell in range of an earlier listener is already a candidate
+                if (it->second.geometry || GetDistanceToCell(it->second, listenerPositions, listener) <= settings.streamRadius)
+                    continue;
+
+                const float distance = GetDistanceToCell(it->second, listenerPositions, listenerCount);
+                if (distance <= settings.streamRadius)
+                    candidates.push_back({ distance, &it->second });
+            }
+        }
+    }
+
+    const size_t loads = std::min(candidates.size(), static_cast<size_t>(std::max(settings.maxCellLoadsPerUpdate, 0)));
+    std::partial_sort(candidates.begin(), candidates.begin() + loads, candidates.end(),
+        [](const std::pair<float, Cell*>& a, const std::pair<float, Cell*>& b) { return a.first < b.first; });
+    for (size_t i = 0; i < loads; ++i)
+        LoadCell(*candidates[i].second);
+}
+
+OcclusionResult OcclusionSystem::GetOcclusion(const Vector3& listenerPosition, const Vector3& emitterPosition) const
+{
+    OcclusionResult result;
+    const FMOD_VECTOR listener = ToFMOD(listenerPosition);
+    const FMOD_VECTOR emitter = ToFMOD(emitterPosition);
+    ERRCHECK(system->getGeometryOcclusion(&listener, &emitter, &result.direct, &result.reverb));
+    return result;
+}
+
+OcclusionSystem::CellKey OcclusionSystem::GetCellKey(float x, float z) const
+{
+    return { static_cast<int>(floorf(x / settings.cellSize)), static_cast<int>(floorf(z / settings.cellSize)) };
+}
+
+float OcclusionSystem::GetDistanceToCell(const Cell& cell, const Vector3& position) const
+{
+    const float dx = std::max(std::max(cell.minX - position.x, position.x - cell.maxX), 0.0f);
+    const float dz = std::max(std::max(cell.minZ - position.z, position.z - cell.maxZ), 0.0f);
+    return sqrtf(dx * dx + dz * dz);
+}
+
+float OcclusionSystem::GetDistanceToCell(const Cell& cell, const Vector3* listenerPositions, int listenerCount) const
+{
+    float nearest = FLT_MAX;
+    for (int listener = 0; listener < listenerCount; ++listener)
+        nearest = std::min(nearest, GetDistanceToCell(cell, listenerPositions[listener]));
+    return nearest;
+}
+
+void OcclusionSystem::LoadCell(Cell& cell)
+{
+    const int triangleCount = static_cast<int>(cell.materials.size());
+    ERRCHECK(system->createGeometry(triangleCount, triangleCount * 3, &cell.geometry));
+    if (!cell.geometry)
+        return;
+
+    for (int i = 0; i < triangleCount; ++i)
+    {
+        const OcclusionMaterial& material = materials[cell.materials[i]];
+        ERRCHECK(cell.geometry->addPolygon(material.directOcclusion, material.reverbOcclusion, material.doubleSided,
+                                           3, &cell.vertices[i * 3], nullptr));
+    }
+
+    ++loadedCells;
+    loadedTriangles += triangleCount;
+}
+
+void OcclusionSystem::UnloadCell(Cell& cell)
+{
+    if (!cell.geometry)
+        return;
+
+    ERRCHECK(cell.geometry->release());
+    cell.geometry = nullptr;
+
+    --loadedCells;
+    loadedTriangles -= static_cast<int>(cell.materials.size());
+}
@@ -0,0 +1,144 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file OcclusionSystem.h
+///
+/// Feeds level geometry to FMOD's Geometry API so walls occlude 3D sounds.
+/// Imported triangles are partitioned into square cells on the XZ plane and each cell becomes
+/// its own FMOD::Geometry, created when the listener comes within range and released when it
+/// leaves, so FMOD's occlusion raycasts only ever see the geometry near the listener.
+/// A triangle belongs to the cell holding its centroid, but cells are streamed by the bounds of
+/// their triangles, so a long wall is loaded wherever any part of it is near the listener.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "LevelMesh.h"
+
+struct OcclusionSettings
+{
+    // Width of a streaming cell, in world units
+    float cellSize = 32.0f;
+
+    // Cells closer than this to the listener are loaded
+    float streamRadius = 96.0f;
+
+    // Extra distance before a loaded cell is unloaded again, so cells don't thrash at the edge
+    float unloadMargin = 16.0f;
+
+    // Limits how many cells are built in one Update(), bounding the cost of streaming
+    int maxCellLoadsPerUpdate = 4;
+
+    // Triangles smaller than this are dropped on import; they cost raycasts and block little sound
+    float minTriangleArea = 0.01f;
+
+    // Passed to System::setGeometrySettings, should enclose every loaded cell
+    float maxWorldSize = 2000.0f;
+};
+
+/**
+ * Occlusion between the listener and an emitter, as calculated by FMOD.
+ */
+struct OcclusionResult
+{
+    // Attenuation of the direct path, 0 (clear) to 1 (blocked)
+    float direct = 0.0f;
+
+    // Attenuation of the reverb path, 0 (clear) to 1 (blocked)
+    float reverb = 0.0f;
+
+    /** Portion of the attenuation shared by both paths, i.e. the emitter is behind a wall */
+    float GetOcclusion() const { return direct < reverb ? direct : reverb; }
+
+    /** Portion of the direct path blocked beyond the reverb path, i.e. something stands in between */
+    float GetObstruction() const { return direct > reverb ? direct - reverb : 0.0f; }
+};
+
+class OcclusionSystem
+{
+public:
+
+    explicit OcclusionSystem(FMOD::System* system, const OcclusionSettings& settings = OcclusionSettings());
+
+    /**
+     * Releases every loaded FMOD::Geometry.
+     */
+    ~OcclusionSystem();
+
+    OcclusionSystem(const OcclusionSystem&) = delete;
+    OcclusionSystem& operator=(const OcclusionSystem&) = delete;
+
+    /**
+     * Partitions a mesh's triangles into cells. Cells near the listener are built on the next Update().
+     * @return number of triangles kept
+     */
+    int AddMesh(const LevelMesh& mesh);
+
+    /**
+     * Releases all geometry and forgets every imported mesh.
+     */
+    void Clear();
+
+    /**
+     * Streams cells in and out around the listeners. Should be called each frame.
+     * A cell stays loaded while it is near any listener.
+     */
+    void Update(const Vector3* listenerPositions, int listenerCount);
+
+    /**
+     * Returns how much geometry blocks sound travelling from an emitter to the listener.
+     * Only loaded cells are considered.
+     */
+    OcclusionResult GetOcclusion(const Vector3& listenerPosition, const Vector3& emitterPosition) const;
+
+    int GetCellCount() const { return static_cast<int>(cells.size()); }
+    int GetLoadedCellCount() const { return loadedCells; }
+    int GetLoadedTriangleCount() const { return loadedTriangles; }
+
+private:
+
+    typedef std::pair<int, int> CellKey;
+
+    struct Cell
+    {
+        std::vector<FMOD_VECTOR> vertices;      // three per triangle, world space
+        std::vector<int> materials;             // one per triangle, into OcclusionSystem::materials
+        FMOD::Geometry* geometry = nullptr;     // nullptr while unloaded
+
+        // XZ bounds of the cell's triangles, which may reach past the cell
+        float minX = 0.0f, maxX = 0.0f;
+        float minZ = 0.0f, maxZ = 0.0f;
+    };
+
+    CellKey GetCellKey(float x, float z) const;
+
+    /** Horizontal distance from a point to the bounds of a cell's triangles */
+    float GetDistanceToCell(const Cell& cell, const Vector3& position) const;
+
+    /**
+     * Distance from a cell to the nearest of the first listenerCount listeners, FLT_MAX if there are none.
+     */
+    float GetDistanceToCell(const Cell& cell, const Vector3* listenerPositions, int listenerCount) const;
+
+    void LoadCell(Cell& cell);
+    void UnloadCell(Cell& cell);
+
+    FMOD::System* system;
+    OcclusionSettings settings;
+
+    std::map<CellKey, Cell> cells;
+
+    // Furthest any cell's triangles reach past the cell, widening the search for cells in range
+    float cellOverhang = 0.0f;
+    std::vector<OcclusionMaterial> materials;
+
+    int loadedCells = 0;
+    int loadedTriangles = 0;
+};
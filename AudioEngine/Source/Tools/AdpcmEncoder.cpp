@@ -0,0 +1,80 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file AdpcmEncoder.cpp
+/// @author JDSherbert
+
+#include "AdpcmEncoder.h"
+
+#include "../Codec/WavFile.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+bool AdpcmEncoder::EncodeFile(const char* wavPath, const char* outputPath, uint32_t samplesPerBlock)
+{
+    WavFile wav;
+    if (!wav.Load(wavPath))
+        return false;
+
+    const std::vector<float>& source = wav.GetSamples();
+    std::vector<int16_t> pcm(source.size());
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        const float sample = source[i] < -1.0f ? -1.0f : (source[i] > 1.0f ? 1.0f : source[i]);
+        pcm[i] = static_cast<int16_t>(lrintf(sample * 32767.0f));
+    }
+
+    std::vector<uint8_t> encoded;
+    AdpcmCodec::Encode(pcm.data(), wav.GetFrameCount(), wav.GetChannels(), wav.GetSampleRate(), encoded, samplesPerBlock);
+
+    FILE* file = fopen(outputPath, "wb");
+    if (!file)
+    {
+        std::cout << "AdpcmEncoder: Could not create " << outputPath << '\n';
+        return false;
+    }
+    const bool written = fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+    fclose(file);
+    if (!written)
+    {
+        std::cout << "AdpcmEncoder: Could not write " << outputPath << '\n';
+        return false;
+    }
+
+    // Decode the result to measure what the compression cost
+    AdpcmCodec::Header header;
+    memcpy(&header, encoded.data(), sizeof(header));
+    const int channels = wav.GetChannels();
+    const uint32_t unitBytes = AdpcmCodec::GetUnitBytes(header.samplesPerBlock);
+    const uint32_t blockCount = (header.frames + header.samplesPerBlock - 1) / header.samplesPerBlock;
+    std::vector<int16_t> decoded(static_cast<size_t>(blockCount) * header.samplesPerBlock * channels);
+    std::vector<AdpcmUnit> units(static_cast<size_t>(blockCount) * channels);
+    for (size_t unit = 0; unit < units.size(); ++unit)
+    {
+        const size_t block = unit / channels;
+        units[unit].block = encoded.data() + sizeof(header) + unit * unitBytes;
+        units[unit].output = decoded.data() + block * header.samplesPerBlock * channels + unit % channels;
+    }
+    AdpcmCodec::DecodeUnits(units.data(), static_cast<int>(units.size()), header.samplesPerBlock, channels);
+
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < pcm.size(); ++i)
+    {
+        const double error = static_cast<double>(pcm[i]) - decoded[i];
+        signal += static_cast<double>(pcm[i]) * pcm[i];
+        noise += error * error;
+    }
+
+    const size_t pcmBytes = pcm.size() * sizeof(int16_t);
+    std::cout << "AdpcmEncoder: " << wavPath << " -> " << outputPath << ", " << pcmBytes << " -> " << encoded.size() << " bytes ("
+              << (encoded.empty() ? 0.0 : static_cast<double>(pcmBytes) / encoded.size()) << ":1), SNR ";
+    if (noise > 0.0)
+        std::cout << 10.0 * log10(signal / noise) << " dB\n";
+    else
+        std::cout << "lossless\n";
+    return true;
+}
@@ -0,0 +1,28 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file AdpcmEncoder.h
+///
+/// Build step which compresses WAV files into the engine's ADPCM format (.aead, see AdpcmCodec),
+/// for short sound effects which should load fast and ship small.
+///
+/// @author JDSherbert
+
+#include <cstdint>
+
+#include "../Codec/AdpcmCodec.h"
+
+class AdpcmEncoder
+{
+public:
+
+    /**
+     * Compresses a WAV file of any supported bit depth, printing the compression ratio and the
+     * signal-to-noise ratio of the decoded result, so noisy encodes can be spotted.
+     * @param samplesPerBlock - frames per block; shorter blocks seek and recover from transients sooner, at a little more size
+     * @return false, with a console message, if the WAV can't be read or the output written
+     */
+    static bool EncodeFile(const char* wavPath, const char* outputPath,
+                           uint32_t samplesPerBlock = AdpcmCodec::DEFAULT_SAMPLES_PER_BLOCK);
+};
@@ -0,0 +1,266 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file AssetConditioner.cpp
+/// @author JDSherbert
+
+#include "AssetConditioner.h"
+
+#include "../Codec/AdpcmCodec.h"
+#include "../DSP/PolyphaseResampler.h"
+#include "Stopwatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // ITU-R BS.775 downmix gain for the centre and surround channels
+    const float DOWNMIX_GAIN = 0.7071f;
+
+    bool EndsWith(const std::string& text, const char* suffix)
+    {
+        const size_t length = strlen(suffix);
+        return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+    }
+
+    /**
+     * Downmixes one frame to stereo. Layouts follow FMOD's speaker order:
+     * 5.1 is L R C LFE Ls Rs, 7.1 is L R C LFE Ls Rs Lb Rb.
+     */
+    void DownmixToStereo(const float* frame, int channels, float& left, float& right)
+    {
+        if (channels == 1)
+        {
+            left = right = frame[0];
+            return;
+        }
+
+        left = frame[0];
+        right = frame[1];
+        if (channels >= 6)
+        {
+            left += DOWNMIX_GAIN * (frame[2] + frame[4]);
+            right += DOWNMIX_GAIN * (frame[2] + frame[5]);
+        }
+        if (channels >= 8)
+        {
+            left += DOWNMIX_GAIN * frame[6];
+            right += DOWNMIX_GAIN * frame[7];
+        }
+    }
+
+    /**
+     * Converts the channel layout, scaling a downmix down if it would clip.
+     * @return false if there is no conversion between the two layouts
+     */
+    bool ConvertChannels(const std::vector<float>& input, int inputChannels, int outputChannels,
+                         std::vector<float>& output, std::string& message)
+    {
+        if (outputChannels == inputChannels)
+        {
+            output = input;
+            return true;
+        }
+        if (outputChannels > 2 || (inputChannels > 2 && inputChannels != 6 && inputChannels != 8))
+        {
+            message = "no conversion from " + std::to_string(inputChannels) + " to " + std::to_string(outputChannels) + " channels";
+            return false;
+        }
+
+        const size_t frames = input.size() / inputChannels;
+        output.resize(frames * outputChannels);
+        float peak = 0.0f;
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            float left;
+            float right;
+            DownmixToStereo(input.data() + frame * inputChannels, inputChannels, left, right);
+            if (outputChannels == 1)
+            {
+                output[frame] = 0.5f * (left + right);
+                peak = std::max(peak, fabsf(output[frame]));
+            }
+            else
+            {
+                output[frame * 2] = left;
+                output[frame * 2 + 1] = right;
+                peak = std::max(peak, std::max(fabsf(left), fabsf(right)));
+            }
+        }
+
+        if (peak > 1.0f)
+        {
+            const float gain = 1.0f / peak;
+            for (float& sample : output)
+                sample *= gain;
+            message = "downmix scaled by " + std::to_string(20.0f * log10f(gain)) + " dB to avoid clipping";
+        }
+        return true;
+    }
+
+    /**
+     * Removes frames before the first and after the last one with a sample above the threshold,
+     * keeping padding frames either side.
+     * @return frames removed
+     */
+    size_t TrimSilence(std::vector<float>& samples, int channels, float thresholdDB, size_t padding)
+    {
+        const float threshold = powf(10.0f, thresholdDB / 20.0f);
+        const size_t frames = samples.size() / channels;
+        size_t first = frames;
+        size_t last = 0;
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            if (fabsf(samples[i]) > threshold)
+            {
+                first = std::min(first, i / channels);
+                last = i / channels;
+            }
+        }
+
+        // All silent: keep a single frame so the file stays valid
+        if (first == frames)
+        {
+            samples.resize(static_cast<size_t>(channels), 0.0f);
+            return frames > 0 ? frames - 1 : 0;
+        }
+
+        first = first > padding ? first - padding : 0;
+        last = std::min(last + padding, frames - 1);
+        samples.erase(samples.begin() + (last + 1) * channels, samples.end());
+        samples.erase(samples.begin(), samples.begin() + first * channels);
+        return frames - (last - first + 1);
+    }
+
+    bool WriteAdpcm(const WavFile& wav, const std::string& path, std::string& message)
+    {
+        const std::vector<float>& samples = wav.GetSamples();
+        std::vector<int16_t> pcm(samples.size());
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const float sample = samples[i] < -1.0f ? -1.0f : (samples[i] > 1.0f ? 1.0f : samples[i]);
+            pcm[i] = static_cast<int16_t>(lrintf(sample * 32767.0f));
+        }
+
+        std::vector<uint8_t> encoded;
+        AdpcmCodec::Encode(pcm.data(), wav.GetFrameCount(), wav.GetChannels(), wav.GetSampleRate(), encoded);
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (!file)
+        {
+            message = "could not create " + path;
+            return false;
+        }
+        const bool written = fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+        fclose(file);
+        if (!written)
+            message = "could not write " + path;
+        return written;
+    }
+}
+
+AssetConditionerResult AssetConditioner::ConditionFile(const AssetConditionerJob& job, const AssetConditionerSettings& settings)
+{
+    AssetConditionerResult result;
+    Stopwatch stopwatch;
+
+    // Errors go in the result rather than the console, which only ConditionFiles() prints to
+    WavFile wav;
+    if (!wav.Load(job.inputPath.c_str(), &result.message))
+        return result;
+
+    const int inputRate = wav.GetSampleRate();
+    int outputRate = LatencySettings::FromProfile(settings.latencyProfile).sampleRate;
+    if (settings.targetSampleRate > 0)
+        outputRate = settings.targetSampleRate;
+    const int outputChannels = settings.targetChannels > 0 ? settings.targetChannels : wav.GetChannels();
+    result.inputSampleRate = inputRate;
+    result.outputSampleRate = outputRate;
+    result.inputChannels = wav.GetChannels();
+    result.outputChannels = outputChannels;
+    result.inputSeconds = static_cast<float>(wav.GetFrameCount()) / inputRate;
+
+    std::vector<float> samples;
+    if (!ConvertChannels(wav.GetSamples(), wav.GetChannels(), outputChannels, samples, result.message))
+        return result;
+
+    // Trimmed before resampling, so the resampler only works on what is kept
+    if (settings.trimSilence)
+    {
+        const size_t padding = static_cast<size_t>(settings.trimPaddingMS * 0.001f * inputRate);
+        const size_t trimmed = TrimSilence(samples, outputChannels, settings.silenceThresholdDB, padding);
+        result.trimmedMS = 1000.0f * trimmed / inputRate;
+    }
+
+    if (inputRate != outputRate)
+    {
+        const PolyphaseResampler resampler(inputRate, outputRate);
+        samples = resampler.ProcessInterleaved(samples, outputChannels);
+    }
+    wav.Assign(outputRate, outputChannels, std::move(samples));
+    result.outputSeconds = static_cast<float>(wav.GetFrameCount()) / outputRate;
+
+    if (EndsWith(job.outputPath, ".aead"))
+        result.succeeded = WriteAdpcm(wav, job.outputPath, result.message);
+    else
+    {
+        result.succeeded = wav.Save(job.outputPath.c_str(), settings.format, &result.message);
+    }
+
+    result.elapsedMS = stopwatch.ElapsedMS();
+    return result;
+}
+
+std::vector<AssetConditionerResult> AssetConditioner::ConditionFiles(const std::vector<AssetConditionerJob>& jobs,
+                                                                     const AssetConditionerSettings& settings)
+{
+    std::vector<AssetConditionerResult> results(jobs.size());
+    Stopwatch stopwatch;
+
+    // Workers claim the next unstarted job until none are left
+    std::atomic<size_t> nextJob(0);
+    auto worker = [&]()
+    {
+        for (size_t job = nextJob++; job < jobs.size(); job = nextJob++)
+            results[job] = ConditionFile(jobs[job], settings);
+    };
+
+    const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t threadCount = std::min(jobs.size(), static_cast<size_t>(settings.threads > 0 ? settings.threads : hardwareThreads));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // Printed once all are done so lines from different workers don't interleave
+    int failed = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        const AssetConditionerResult& result = results[i];
+        if (!result.succeeded)
+        {
+            ++failed;
+            std::cout << "AssetConditioner: " << jobs[i].inputPath << " failed, " << result.message << '\n';
+            continue;
+        }
+
+        std::cout << "AssetConditioner: " << jobs[i].inputPath << " -> " << jobs[i].outputPath << ", "
+                  << result.inputSampleRate << " Hz x" << result.inputChannels << " -> "
+                  << result.outputSampleRate << " Hz x" << result.outputChannels << ", "
+                  << result.inputSeconds << " s -> " << result.outputSeconds << " s ("
+                  << result.trimmedMS << " ms silence trimmed), " << result.elapsedMS << " ms";
+        if (!result.message.empty())
+            std::cout << ", " << result.message;
+        std::cout << '\n';
+    }
+    std::cout << "AssetConditioner: " << jobs.size() - failed << " of " << jobs.size() << " files conditioned in "
+              << stopwatch.ElapsedMS() << " ms on " << threadCount << " threads\n";
+    return results;
+}
@@ -0,0 +1,91 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file AssetConditioner.h
+///
+/// Build step which converts source WAVs into the engine's mix format, so FMOD doesn't resample
+/// them every time they play. Each file is converted to the target channel layout, trimmed of
+/// leading and trailing silence and resampled with PolyphaseResampler, then written as WAV or,
+/// for an output path ending in ".aead", compressed with AdpcmCodec. Files are conditioned on
+/// a pool of worker threads.
+///
+/// @author JDSherbert
+
+#include <string>
+#include <vector>
+
+#include "../Codec/WavFile.h"
+#include "../Data/LatencyProfile.h"
+
+struct AssetConditionerSettings
+{
+    // Sample rate written; 0 is the mixer rate of latencyProfile
+    int targetSampleRate = 0;
+
+    // Profile the game initializes the engine with (AudioEngineSettings::latencyProfile), whose
+    // mixer rate assets are resampled to. Custom profiles should set targetSampleRate instead.
+    LatencyProfile latencyProfile = LatencyProfile::Balanced;
+
+    // Channels written; 0 keeps the source layout. Stereo and mono can be made from any layout,
+    // 5.1 and 7.1 being downmixed with ITU-R BS.775 coefficients and the LFE dropped
+    int targetChannels = 0;
+
+    // Removes silence before the first and after the last sample above silenceThresholdDB
+    bool trimSilence = true;
+    float silenceThresholdDB = -60.0f;
+
+    // Kept either side of the sound when trimming, so attacks and tails aren't clipped
+    float trimPaddingMS = 10.0f;
+
+    // Sample format of WAV output
+    WavFile::SampleFormat format = WavFile::SampleFormat::Pcm16;
+
+    // Worker threads; 0 uses one per hardware thread
+    int threads = 0;
+};
+
+struct AssetConditionerJob
+{
+    std::string inputPath;
+    std::string outputPath;
+};
+
+struct AssetConditionerResult
+{
+    bool succeeded = false;
+
+    int inputSampleRate = 0;
+    int outputSampleRate = 0;
+    int inputChannels = 0;
+    int outputChannels = 0;
+    float inputSeconds = 0.0f;
+    float outputSeconds = 0.0f;
+
+    // Silence removed from the start and end
+    float trimmedMS = 0.0f;
+
+    // Time taken to condition the file
+    float elapsedMS = 0.0f;
+
+    // Why the file failed, or notes such as the gain applied to avoid clipping a downmix
+    std::string message;
+};
+
+class AssetConditioner
+{
+public:
+
+    /**
+     * Conditions one file on the calling thread.
+     */
+    static AssetConditionerResult ConditionFile(const AssetConditionerJob& job,
+                                                const AssetConditionerSettings& settings = AssetConditionerSettings());
+
+    /**
+     * Conditions files on worker threads and prints a line per file once all are done.
+     * @return a result per job, in the order given
+     */
+    static std::vector<AssetConditionerResult> ConditionFiles(const std::vector<AssetConditionerJob>& jobs,
+                                                              const AssetConditionerSettings& settings = AssetConditionerSettings());
+};
@@ -0,0 +1,161 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file CodecBenchmark.cpp
+/// @author JDSherbert
+
+#include "CodecBenchmark.h"
+
+#include "../../AudioEngine.h"
+#include "../Codec/AdpcmCodec.h"
+#include "Stopwatch.h"
+
+#include <FMOD/fmod.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    // Generated audio for the kernel timing: ten seconds of stereo tones over noise
+    const int KERNEL_RATE = 48000;
+    const uint32_t KERNEL_FRAMES = 10 * KERNEL_RATE;
+    const int KERNEL_PASSES = 20;
+
+    void BenchmarkKernels(CodecBenchmarkResult& result)
+    {
+        std::mt19937 random(1);
+        std::normal_distribution<float> noise(0.0f, 1000.0f);
+        std::vector<int16_t> pcm(KERNEL_FRAMES * 2);
+        for (uint32_t frame = 0; frame < KERNEL_FRAMES; ++frame)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                const float sample = 12000.0f * sinf(frame * 0.03f * (channel + 1)) + noise(random);
+                pcm[frame * 2 + channel] = static_cast<int16_t>(fmaxf(-32768.0f, fminf(32767.0f, sample)));
+            }
+        }
+
+        std::vector<uint8_t> file;
+        AdpcmCodec::Encode(pcm.data(), KERNEL_FRAMES, 2, KERNEL_RATE, file);
+
+        const uint32_t samplesPerBlock = AdpcmCodec::DEFAULT_SAMPLES_PER_BLOCK;
+        const uint32_t unitBytes = AdpcmCodec::GetUnitBytes(samplesPerBlock);
+        const size_t unitCount = (file.size() - sizeof(AdpcmCodec::Header)) / unitBytes;
+        std::vector<int16_t> decoded(unitCount * samplesPerBlock);
+        std::vector<AdpcmUnit> units(unitCount);
+        for (size_t unit = 0; unit < unitCount; ++unit)
+        {
+            units[unit].block = file.data() + sizeof(AdpcmCodec::Header) + unit * unitBytes;
+            units[unit].output = decoded.data() + unit * samplesPerBlock;
+        }
+
+        const double samples = static_cast<double>(unitCount) * samplesPerBlock * KERNEL_PASSES;
+        Stopwatch stopwatch;
+        for (int pass = 0; pass < KERNEL_PASSES; ++pass)
+            AdpcmCodec::DecodeUnitsScalar(units.data(), static_cast<int>(unitCount), samplesPerBlock, 1);
+        result.scalarMegasamples = static_cast<float>(samples / (stopwatch.Lap() * 1000.0));
+        for (int pass = 0; pass < KERNEL_PASSES; ++pass)
+            AdpcmCodec::DecodeUnits(units.data(), static_cast<int>(unitCount), samplesPerBlock, 1);
+        result.simdMegasamples = static_cast<float>(samples / (stopwatch.Lap() * 1000.0));
+    }
+
+    unsigned int GetFileSize(const std::string& path)
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (!file)
+            return 0;
+        fseek(file, 0, SEEK_END);
+        const long size = ftell(file);
+        fclose(file);
+        return size > 0 ? static_cast<unsigned int>(size) : 0;
+    }
+
+    bool BenchmarkFile(FMOD::System* system, const CodecBenchmarkSettings& settings, const std::string& path,
+                       bool compressed, CodecFileResult& result)
+    {
+        const FMOD_MODE mode = FMOD_2D | FMOD_LOOP_NORMAL | (compressed ? FMOD_CREATECOMPRESSEDSAMPLE : FMOD_CREATESAMPLE);
+        result.file = path;
+        result.compressedMode = compressed;
+        result.fileBytes = GetFileSize(path);
+
+        // Loads are timed on their own; the last one stays loaded for the memory and playback figures
+        FMOD::Sound* sound = nullptr;
+        int memoryBefore = 0;
+        float loadSum = 0.0f;
+        for (int load = 0; load < settings.loads; ++load)
+        {
+            if (sound)
+                ERRCHECK(sound->release());
+            FMOD::Memory_GetStats(&memoryBefore, nullptr, false);
+            Stopwatch stopwatch;
+            if (system->createSound(path.c_str(), mode, nullptr, &sound) != FMOD_OK)
+                return false;
+            loadSum += stopwatch.ElapsedMS();
+        }
+        result.loadMS = loadSum / settings.loads;
+        int memoryAfter = 0;
+        FMOD::Memory_GetStats(&memoryAfter, nullptr, false);
+        result.memoryBytes = memoryAfter - memoryBefore;
+
+        FMOD_SOUND_FORMAT format = FMOD_SOUND_FORMAT_NONE;
+        ERRCHECK(sound->getFormat(nullptr, &format, nullptr, nullptr));
+        result.compressedInMemory = format == FMOD_SOUND_FORMAT_BITSTREAM;
+
+        for (int voice = 0; voice < settings.voices; ++voice)
+            ERRCHECK(system->playSound(sound, nullptr, false, nullptr));
+        ERRCHECK(system->update()); // starts the voices outside the timing
+
+        // Non-realtime output mixes one block per update()
+        Stopwatch stopwatch;
+        for (int block = 0; block < settings.blocks; ++block)
+            ERRCHECK(system->update());
+        result.mixMicroseconds = stopwatch.ElapsedMS() * 1000.0f / settings.blocks;
+
+        ERRCHECK(sound->release());
+        ERRCHECK(system->update());
+        return true;
+    }
+}
+
+CodecBenchmarkResult CodecBenchmark::Run(const CodecBenchmarkSettings& settings)
+{
+    CodecBenchmarkResult result;
+    BenchmarkKernels(result);
+    std::cout << "Codec Benchmark: ADPCM decode " << result.scalarMegasamples << " Msamples/s scalar, "
+              << result.simdMegasamples << " Msamples/s SIMD\n";
+    if (settings.files.empty() || settings.loads <= 0 || settings.blocks <= 0)
+        return result;
+
+    FMOD::System* system = nullptr;
+    unsigned int codecHandle = 0;
+    ERRCHECK(FMOD::System_Create(&system));
+    ERRCHECK(system->setOutput(FMOD_OUTPUTTYPE_NOSOUND_NRT));
+    ERRCHECK(system->registerCodec(AdpcmCodec::GetDescription(), &codecHandle, 0));
+    ERRCHECK(system->init(settings.voices + 1, FMOD_INIT_NORMAL, 0));
+
+    std::cout << "  " << settings.voices << " voices, load time averaged over " << settings.loads << " loads\n"
+              << "  file                            mode        bytes      load ms   memory     mix us/block\n";
+    for (const std::string& path : settings.files)
+    {
+        for (int compressed = 0; compressed < 2; ++compressed)
+        {
+            CodecFileResult file;
+            std::cout << "  " << std::left << std::setw(32) << path << std::setw(12) << (compressed ? "compressed" : "sample");
+            if (!BenchmarkFile(system, settings, path, compressed != 0, file))
+            {
+                std::cout << "could not load\n" << std::right;
+                continue;
+            }
+            std::cout << std::right << std::setw(9) << file.fileBytes << std::setw(11) << file.loadMS << std::setw(11)
+                      << file.memoryBytes << std::setw(13) << file.mixMicroseconds
+                      << (compressed && !file.compressedInMemory ? "  (FMOD decompressed it at load)" : "") << '\n';
+            result.files.push_back(file);
+        }
+    }
+
+    ERRCHECK(system->release());
+    return result;
+}
@@ -0,0 +1,69 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file CodecBenchmark.h
+///
+/// Compares the engine's ADPCM format against WAV, Vorbis and MP3 for short sound effects.
+/// First times the ADPCM decode kernel, scalar against SIMD, on generated audio. Then, in its
+/// own non-realtime FMOD system, loads each given file as a decompressed sample and, where FMOD
+/// supports it, as a compressed sample, measuring load time, the memory the sound holds, and
+/// the mixer time of playing many voices of it. Pass the same sound in each format.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <string>
+#include <vector>
+
+struct CodecBenchmarkSettings
+{
+    // Sound files to compare, e.g. footstep.wav, footstep.ogg, footstep.mp3, footstep.aead
+    std::vector<std::string> files;
+
+    // Times each file is loaded, averaged
+    int loads = 20;
+
+    // Voices of each sound mixed at once, and mixer blocks timed
+    int voices = 32;
+    int blocks = 1000;
+};
+
+struct CodecFileResult
+{
+    std::string file;
+
+    // FMOD_CREATECOMPRESSEDSAMPLE rather than FMOD_CREATESAMPLE was asked for, and FMOD kept the data compressed
+    bool compressedMode = false;
+    bool compressedInMemory = false;
+
+    unsigned int fileBytes = 0;
+
+    // Mean createSound() time, i.e. the decoding done at load
+    float loadMS = 0.0f;
+
+    // FMOD memory held by the loaded sound
+    int memoryBytes = 0;
+
+    // Mean mixer time per block with every voice playing, i.e. the decoding done at playback
+    float mixMicroseconds = 0.0f;
+};
+
+struct CodecBenchmarkResult
+{
+    // ADPCM decode throughput in millions of samples per second
+    float scalarMegasamples = 0.0f;
+    float simdMegasamples = 0.0f;
+
+    std::vector<CodecFileResult> files;
+};
+
+class CodecBenchmark
+{
+public:
+
+    /**
+     * Runs the kernel comparison and every file in both load modes, and prints a table.
+     */
+    static CodecBenchmarkResult Run(const CodecBenchmarkSettings& settings = CodecBenchmarkSettings());
+};
@@ -0,0 +1,221 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file CommandRecorder.cpp
+/// @author JDSherbert
+
+#include "CommandRecorder.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    const char MAGIC[4] = { 'A', 'E', 'C', 'L' };
+
+    // Bits of the AudioData flags byte
+    const uint8_t FLAG_LOOP = 1 << 0;
+    const uint8_t FLAG_3D = 1 << 1;
+    const uint8_t FLAG_STREAM = 1 << 2;
+    const uint8_t FLAG_HRTF = 1 << 3;
+}
+
+CommandRecorder::~CommandRecorder()
+{
+    Close();
+}
+
+bool CommandRecorder::Open(const char* filePath)
+{
+    Close();
+    file.open(filePath, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cout << "CommandRecorder: Can't create " << filePath << '\n';
+        return false;
+    }
+
+    buffer.clear();
+    buffer.reserve(FLUSH_BYTES + 1024);
+    buffer.insert(buffer.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    for (int shift = 0; shift < 32; shift += 8)
+        buffer.push_back(static_cast<uint8_t>(VERSION >> shift));
+
+    strings.clear();
+    frame = 0;
+    lastFrame = Clock::now();
+    return true;
+}
+
+void CommandRecorder::Close()
+{
+    if (!file.is_open())
+        return;
+
+    Flush();
+    file.close();
+}
+
+void CommandRecorder::RecordFrame()
+{
+    const Clock::time_point now = Clock::now();
+    const long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(now - lastFrame).count();
+    lastFrame = now;
+    ++frame;
+    Record(EngineCall::Update, static_cast<unsigned int>(microseconds));
+}
+
+void CommandRecorder::Flush()
+{
+    if (file.is_open() && !buffer.empty())
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    buffer.clear();
+}
+
+void CommandRecorder::WriteVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+void CommandRecorder::WriteID(uint64_t id)
+{
+    for (int shift = 0; shift < 64; shift += 8)
+        buffer.push_back(static_cast<uint8_t>(id >> shift));
+}
+
+void CommandRecorder::Write(bool value)
+{
+    buffer.push_back(value ? 1 : 0);
+}
+
+void CommandRecorder::Write(int value)
+{
+    WriteVarint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+}
+
+void CommandRecorder::Write(unsigned int value)
+{
+    WriteVarint(value);
+}
+
+void CommandRecorder::Write(float value)
+{
+    uint8_t bytes[sizeof(float)];
+    memcpy(bytes, &value, sizeof(float));
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(float));
+}
+
+void CommandRecorder::Write(const char* text)
+{
+    Write(std::string(text ? text : ""));
+}
+
+void CommandRecorder::Write(const std::string& text)
+{
+    auto it = strings.find(text);
+    if (it != strings.end())
+    {
+        WriteVarint(it->second);
+        return;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(strings.size());
+    strings.insert({ text, index });
+    WriteVarint(index);
+    WriteVarint(text.size());
+    buffer.insert(buffer.end(), text.begin(), text.end());
+}
+
+void CommandRecorder::Write(const AudioData& audioData)
+{
+    WriteID(audioData.GetUniqueID().value);
+
+    Write(audioData.GetFilePath());
+    Write(audioData.GetVolume());
+    buffer.push_back((audioData.Loop() ? FLAG_LOOP : 0) | (audioData.Is3D() ? FLAG_3D : 0)
+                     | (audioData.IsStreaming() ? FLAG_STREAM : 0) | (audioData.UsesHrtf() ? FLAG_HRTF : 0));
+    Write(audioData.GetReverbAmount());
+    Write(audioData.GetPosition().x);
+    Write(audioData.GetPosition().y);
+    Write(audioData.GetPosition().z);
+    Write(audioData.GetBus());
+    Write(audioData.GetMaxDistance());
+    Write(audioData.GetPitch());
+}
+
+void CommandRecorder::Write(EventId eventId)
+{
+    WriteID(eventId.value);
+}
+
+void CommandRecorder::Write(EventInstanceHandle instance)
+{
+    Write(instance.index);
+}
+
+void CommandRecorder::Write(EventParameterHandle parameter)
+{
+    Write(parameter.index);
+}
+
+void CommandRecorder::Write(SoundId id)
+{
+    WriteID(id.value);
+}
+
+void CommandRecorder::Write(const PlaybackLimit& limit)
+{
+    Write(limit.maxInstances);
+    Write(limit.minRetriggerMS);
+    Write(static_cast<unsigned int>(limit.behavior));
+}
+
+void CommandRecorder::Write(EngineEffect effect)
+{
+    Write(static_cast<unsigned int>(effect));
+}
+
+void CommandRecorder::Write(const DuckingSettings& settings)
+{
+    Write(settings.attackMS);
+    Write(settings.releaseMS);
+    Write(settings.depthdB);
+    Write(settings.thresholddB);
+}
+
+void CommandRecorder::Write(const std::vector<std::pair<const char*, float>>& parameters)
+{
+    Write(static_cast<unsigned int>(parameters.size()));
+    for (const auto& parameter : parameters)
+    {
+        Write(parameter.first);
+        Write(parameter.second);
+    }
+}
+
+void CommandRecorder::Write(const std::vector<EventParameterWrite>& writes)
+{
+    Write(static_cast<unsigned int>(writes.size()));
+    for (const EventParameterWrite& write : writes)
+    {
+        Write(write.instance);
+        Write(write.parameter);
+        Write(write.value);
+    }
+}
+
+void CommandRecorder::Write(const std::map<std::string, OcclusionMaterial>& materials)
+{
+    Write(static_cast<unsigned int>(materials.size()));
+    for (const auto& material : materials)
+    {
+        Write(material.first);
+        Write(material.second.directOcclusion);
+        Write(material.second.reverbOcclusion);
+        Write(material.second.doubleSided);
+    }
+}
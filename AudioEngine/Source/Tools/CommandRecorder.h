@@ -0,0 +1,168 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file CommandRecorder.h
+///
+/// Logs the AudioEngine calls a game makes so CommandReplayer can play them back offline,
+/// e.g. to profile a spike reported from the field.
+/// Every call that changes engine state is recorded with its arguments; queries such as
+/// IsPlaying() or GetStats() are not, as replaying them changes nothing. Update() closes a frame
+/// and records the wall-clock time since the previous one, so replay can keep the original pacing.
+///
+/// Log layout, little-endian:
+///     header  - "AECL", uint32 version
+///     record  - uint8 EngineCall, then its arguments
+/// Integers are LEB128 varints (signed ones zigzag encoded), floats are raw 32-bit, strings are
+/// interned: a varint index into the strings seen so far, and the text if the index is new.
+/// IDs (AudioData, EventId) are raw 64-bit hashes.
+///
+/// Not thread-safe; the engine records from the thread its API is called on.
+///
+/// @author JDSherbert
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../Data/AudioData.h"
+#include "../Data/EventId.h"
+#include "../Data/EventParameterBatch.h"
+#include "../Data/PlaybackLimiter.h"
+#include "../DSP/EngineEffects.h"
+#include "../DSP/SidechainDucking.h"
+#include "../Spatial/LevelMesh.h"
+
+/**
+ * Engine calls that can appear in a command log. Values are part of the file format.
+ */
+enum class EngineCall : uint8_t
+{
+    Update,                     // uint microseconds since the previous Update()
+    Load,                       // AudioData
+    Unload,                     // AudioData
+    Play,                       // AudioData
+    Stop,                       // AudioData
+    UpdateVolume,               // AudioData, float volume, uint fade samples
+    Update3DPosition,           // AudioData
+    Set3DListenerPosition,      // float x 9, int listener
+    LoadBank,                   // string path
+    LoadEvent,                  // string event, uint count, (string parameter, float value) x count
+    SetEventParamValue,         // uint64 event, string parameter, float value
+    PlayEvent,                  // uint64 event, int instance
+    StopEvent,                  // uint64 event, int instance
+    SetEventVolume,             // uint64 event, float volume
+    MuteAll,
+    UnmuteAll,
+    CreateBus,                  // string bus, string parent ("" for the master group)
+    SetBusVolume,               // string bus, float volume
+    SetBusMute,                 // string bus, bool mute
+    SetBusPaused,               // string bus, bool paused
+    SetBusPitch,                // string bus, float pitch
+    AddDucking,                 // string trigger, string target, float x 4 (DuckingSettings)
+    RemoveDucking,              // string trigger, string target
+    AddBusEffect,               // string bus, uint effect
+    RemoveBusEffect,            // string bus, uint effect
+    SetBusEffectParameter,      // string bus, uint effect, int parameter, float value
+    AddConvolutionReverb,       // string bus, string impulse, float wet, float dry
+    SetConvolutionReverbMix,    // string bus, float wet, float dry
+    RemoveConvolutionReverb,    // string bus
+    AddLoudnessMeter,           // string bus
+    RemoveLoudnessMeter,        // string bus
+    ResetLoudness,              // string bus
+    LoadLevelGeometry,          // string path, uint count, (string material, float, float, bool) x count
+    UnloadLevelGeometry,
+    LoadHrtf,                   // string path
+    CreateEventInstance,        // uint64 event
+    ReleaseEventInstance,       // uint instance
+    PlayEventInstance,          // uint instance
+    StopEventInstance,          // uint instance
+    GetEventParameterHandle,    // uint64 event, string parameter
+    SetEventParameters,         // uint count, (uint instance, uint parameter, float value) x count
+    SetListenerCount,           // int count
+    SetSoundLimit,              // uint64 sound, int max instances, float min retrigger ms, uint behavior
+    SetBusLimit,                // string bus, int max instances, float min retrigger ms, uint behavior
+
+    Count
+};
+
+class CommandRecorder
+{
+public:
+
+    static const uint32_t VERSION = 5;
+
+    ~CommandRecorder();
+
+    /**
+     * Creates the log file, replacing any existing one.
+     * @return false, with a console message, if the file can't be created
+     */
+    bool Open(const char* filePath);
+
+    /**
+     * Writes out everything recorded and closes the file.
+     */
+    void Close();
+
+    /**
+     * Appends a call and its arguments to the log.
+     */
+    template <typename... Args>
+    void Record(EngineCall call, const Args&... args)
+    {
+        buffer.push_back(static_cast<uint8_t>(call));
+        const int expand[] = { 0, (Write(args), 0)... };
+        (void)expand;
+        if (buffer.size() >= FLUSH_BYTES)
+            Flush();
+    }
+
+    /**
+     * Records an Update() call, which ends the current frame.
+     */
+    void RecordFrame();
+
+    /** Frames recorded so far */
+    unsigned int GetFrame() const { return frame; }
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    // Recorded calls are buffered and written in chunks of about this size
+    static const size_t FLUSH_BYTES = 64 * 1024;
+
+    void Flush();
+
+    void WriteVarint(uint64_t value);
+    void WriteID(uint64_t id);
+    void Write(bool value);
+    void Write(int value);
+    void Write(unsigned int value);
+    void Write(float value);
+    void Write(const char* text);
+    void Write(const std::string& text);
+    void Write(const AudioData& audioData);
+    void Write(EventId eventId);
+    void Write(EventInstanceHandle instance);
+    void Write(EventParameterHandle parameter);
+    void Write(SoundId id);
+    void Write(const PlaybackLimit& limit);
+    void Write(EngineEffect effect);
+    void Write(const DuckingSettings& settings);
+    void Write(const std::vector<std::pair<const char*, float>>& parameters);
+    void Write(const std::vector<EventParameterWrite>& writes);
+    void Write(const std::map<std::string, OcclusionMaterial>& materials);
+
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+    std::unordered_map<std::string, uint32_t> strings;
+    Clock::time_point lastFrame;
+    unsigned int frame = 0;
+};
@@ -0,0 +1,521 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file CommandReplayer.cpp
+/// @author JDSherbert
+
+#include "CommandReplayer.h"
+
+#include "../../AudioEngine.h"
+#include "CommandRecorder.h"
+#include "Stopwatch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <thread>
+
+namespace
+{
+    // Slowest frames listed in the summary
+    const size_t WORST_FRAMES = 5;
+
+    // Must match the AudioData flags byte written by CommandRecorder
+    const uint8_t FLAG_LOOP = 1 << 0;
+    const uint8_t FLAG_3D = 1 << 1;
+    const uint8_t FLAG_STREAM = 1 << 2;
+    const uint8_t FLAG_HRTF = 1 << 3;
+
+    float FrameMS(const ReplayFrame& frame)
+    {
+        return frame.callsMS + frame.updateMS;
+    }
+}
+
+bool CommandReplayer::Load(const char* filePath)
+{
+    log.clear();
+    strings.clear();
+    cursor = 0;
+
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "CommandReplayer: Can't open " << filePath << '\n';
+        return false;
+    }
+    log.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    uint32_t version = 0;
+    if (log.size() < 8 || memcmp(log.data(), "AECL", 4) != 0)
+    {
+        std::cout << "CommandReplayer: " << filePath << " is not a command log\n";
+        log.clear();
+        return false;
+    }
+    for (int i = 0; i < 4; ++i)
+        version |= static_cast<uint32_t>(log[4 + i]) << (8 * i);
+    if (version != CommandRecorder::VERSION)
+    {
+        std::cout << "CommandReplayer: " << filePath << " is version " << version
+                  << ", expected " << CommandRecorder::VERSION << '\n';
+        log.clear();
+        return false;
+    }
+
+    cursor = 8;
+    return true;
+}
+
+ReplayResult CommandReplayer::Replay(AudioEngine& engine, ReplayMode mode)
+{
+    using Clock = std::chrono::steady_clock;
+
+    ReplayResult result;
+    Stopwatch wallClock;
+    Clock::time_point frameDeadline = Clock::now();
+    ReplayFrame current;
+
+    while (cursor < log.size())
+    {
+        uint8_t call = 0;
+        ReadByte(call);
+
+        if (call != static_cast<uint8_t>(EngineCall::Update))
+        {
+            Stopwatch stopwatch;
+            if (!ReplayCall(engine, call))
+            {
+                std::cout << "CommandReplayer: Log is truncated or corrupt at byte " << cursor
+                          << " in frame " << current.frame << '\n';
+                break;
+            }
+            current.callsMS += stopwatch.ElapsedMS();
+            ++current.calls;
+            continue;
+        }
+
+        unsigned int recordedMicroseconds = 0;
+        if (!Read(recordedMicroseconds))
+            break;
+        current.recordedMS = recordedMicroseconds / 1000.0f;
+
+        // Updates land on the recorded timeline, so a slow frame is followed by a shorter wait
+        if (mode == ReplayMode::RealTime)
+        {
+            frameDeadline += std::chrono::microseconds(recordedMicroseconds);
+            std::this_thread::sleep_until(frameDeadline);
+        }
+
+        Stopwatch stopwatch;
+        engine.Update();
+        current.updateMS = stopwatch.ElapsedMS();
+
+        result.frames.push_back(current);
+        const unsigned int nextFrame = current.frame + 1;
+        current = ReplayFrame();
+        current.frame = nextFrame;
+    }
+
+    // Calls made after the last Update() of the recording form a frame of their own
+    if (current.calls > 0)
+        result.frames.push_back(current);
+
+    result.completed = cursor >= log.size();
+    result.wallClockSeconds = wallClock.ElapsedMS() / 1000.0f;
+
+    if (!result.frames.empty())
+    {
+        std::vector<float> frameMS;
+        frameMS.reserve(result.frames.size());
+        double sum = 0.0;
+        for (const ReplayFrame& frame : result.frames)
+        {
+            frameMS.push_back(FrameMS(frame));
+            sum += frameMS.back();
+        }
+        std::sort(frameMS.begin(), frameMS.end());
+        result.meanFrameMS = static_cast<float>(sum / frameMS.size());
+        result.p99FrameMS = frameMS[static_cast<size_t>(0.99f * (frameMS.size() - 1))];
+        result.maxFrameMS = frameMS.back();
+    }
+
+    std::cout << "CommandReplayer: " << result.frames.size() << " frames in " << result.wallClockSeconds << " s"
+              << (mode == ReplayMode::RealTime ? " (real time)" : " (as fast as possible)")
+              << ", frame mean " << result.meanFrameMS << " ms, p99 " << result.p99FrameMS
+              << " ms, max " << result.maxFrameMS << " ms\n";
+
+    std::vector<ReplayFrame> worst = result.frames;
+    const size_t worstCount = std::min(WORST_FRAMES, worst.size());
+    std::partial_sort(worst.begin(), worst.begin() + worstCount, worst.end(),
+                      [](const ReplayFrame& a, const ReplayFrame& b) { return FrameMS(a) > FrameMS(b); });
+    for (size_t i = 0; i < worstCount; ++i)
+    {
+        std::cout << "  frame " << worst[i].frame << ": " << worst[i].calls << " calls " << worst[i].callsMS
+                  << " ms, update " << worst[i].updateMS << " ms\n";
+    }
+    return result;
+}
+
+bool CommandReplayer::ReadByte(uint8_t& value)
+{
+    if (cursor >= log.size())
+        return false;
+    value = log[cursor++];
+    return true;
+}
+
+bool CommandReplayer::ReadVarint(uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t byte = 0;
+        if (!ReadByte(byte))
+            return false;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool CommandReplayer::ReadID(uint64_t& id)
+{
+    if (log.size() - cursor < sizeof(uint64_t))
+        return false;
+    id = 0;
+    for (int i = 0; i < 8; ++i)
+        id |= static_cast<uint64_t>(log[cursor + i]) << (8 * i);
+    cursor += sizeof(uint64_t);
+    return true;
+}
+
+bool CommandReplayer::Read(bool& value)
+{
+    uint8_t byte = 0;
+    if (!ReadByte(byte))
+        return false;
+    value = byte != 0;
+    return true;
+}
+
+bool CommandReplayer::Read(int& value)
+{
+    uint64_t encoded = 0;
+    if (!ReadVarint(encoded))
+        return false;
+    const uint32_t zigzag = static_cast<uint32_t>(encoded);
+    value = static_cast<int>((zigzag >> 1) ^ (0u - (zigzag & 1)));
+    return true;
+}
+
+bool CommandReplayer::Read(unsigned int& value)
+{
+    uint64_t encoded = 0;
+    if (!ReadVarint(encoded))
+        return false;
+    value = static_cast<unsigned int>(encoded);
+    return true;
+}
+
+bool CommandReplayer::Read(float& value)
+{
+    if (log.size() - cursor < sizeof(float))
+        return false;
+    memcpy(&value, &log[cursor], sizeof(float));
+    cursor += sizeof(float);
+    return true;
+}
+
+bool CommandReplayer::Read(const char*& text)
+{
+    uint64_t index = 0;
+    if (!ReadVarint(index) || index > strings.size())
+        return false;
+
+    if (index == strings.size())
+    {
+        uint64_t length = 0;
+        if (!ReadVarint(length) || length > log.size() - cursor)
+            return false;
+        strings.emplace_back(reinterpret_cast<const char*>(&log[cursor]), static_cast<size_t>(length));
+        cursor += static_cast<size_t>(length);
+    }
+    text = strings[static_cast<size_t>(index)].c_str();
+    return true;
+}
+
+bool CommandReplayer::Read(AudioData& audioData)
+{
+    uint64_t id = 0;
+    if (!ReadID(id))
+        return false;
+
+    const char* filePath = nullptr;
+    const char* bus = nullptr;
+    float volume = 0.0f, reverbAmount = 0.0f, maxDistance = 0.0f, pitch = 1.0f;
+    Vector3 position;
+    uint8_t flags = 0;
+    if (!Read(filePath) || !Read(volume) || !ReadByte(flags) || !Read(reverbAmount)
+        || !Read(position.x) || !Read(position.y) || !Read(position.z) || !Read(bus) || !Read(maxDistance) || !Read(pitch))
+        return false;
+
+    audioData.SetUniqueID(SoundId(id));
+    audioData.SetFilePath(filePath);
+    audioData.SetVolume(volume);
+    audioData.SetLoop((flags & FLAG_LOOP) != 0);
+    audioData.Set3D((flags & FLAG_3D) != 0);
+    audioData.SetStreaming((flags & FLAG_STREAM) != 0);
+    audioData.SetHrtf((flags & FLAG_HRTF) != 0);
+    audioData.SetReverbAmount(reverbAmount);
+    audioData.SetPosition(position);
+    audioData.SetBus(bus);
+    audioData.SetMaxDistance(maxDistance);
+    audioData.SetPitch(pitch);
+    return true;
+}
+
+bool CommandReplayer::Read(EventId& eventId)
+{
+    return ReadID(eventId.value);
+}
+
+bool CommandReplayer::ReplayCall(AudioEngine& engine, uint8_t call)
+{
+    AudioData audioData;
+    EventId eventId;
+    EventInstanceHandle instance;
+    const char* name = nullptr;
+    const char* other = nullptr;
+    float value = 0.0f, other2 = 0.0f;
+    unsigned int count = 0;
+    int index = 0;
+    bool flag = false;
+
+    switch (static_cast<EngineCall>(call))
+    {
+        case EngineCall::Load:
+            if (!Read(audioData)) return false;
+            engine.Load(audioData);
+            return true;
+        case EngineCall::Unload:
+            if (!Read(audioData)) return false;
+            engine.Unload(audioData);
+            return true;
+        case EngineCall::Play:
+            if (!Read(audioData)) return false;
+            engine.Play(audioData);
+            return true;
+        case EngineCall::Stop:
+            if (!Read(audioData)) return false;
+            engine.Stop(audioData);
+            return true;
+        case EngineCall::UpdateVolume:
+            if (!Read(audioData) || !Read(value) || !Read(count)) return false;
+            engine.UpdateVolume(audioData, value, count);
+            return true;
+        case EngineCall::Update3DPosition:
+            if (!Read(audioData)) return false;
+            engine.Update3DPosition(audioData);
+            return true;
+        case EngineCall::Set3DListenerPosition:
+        {
+            float values[9];
+            for (float& listenerValue : values)
+            {
+                if (!Read(listenerValue)) return false;
+            }
+            if (!Read(index)) return false;
+            engine.Set3DListenerPosition(values[0], values[1], values[2], values[3], values[4],
+                                         values[5], values[6], values[7], values[8], index);
+            return true;
+        }
+        case EngineCall::LoadBank:
+            if (!Read(name)) return false;
+            engine.LoadBank(name);
+            return true;
+        case EngineCall::LoadEvent:
+        {
+            if (!Read(name) || !Read(count)) return false;
+            std::vector<std::pair<const char*, float>> parameters;
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                if (!Read(other) || !Read(value)) return false;
+                parameters.emplace_back(other, value);
+            }
+            engine.LoadEvent(name, parameters);
+            return true;
+        }
+        case EngineCall::SetEventParamValue:
+            if (!Read(eventId) || !Read(other) || !Read(value)) return false;
+            engine.SetEventParamValue(eventId, other, value);
+            return true;
+        case EngineCall::PlayEvent:
+            if (!Read(eventId) || !Read(index)) return false;
+            engine.PlayEvent(eventId, index);
+            return true;
+        case EngineCall::StopEvent:
+            if (!Read(eventId) || !Read(index)) return false;
+            engine.StopEvent(eventId, index);
+            return true;
+        case EngineCall::SetEventVolume:
+            if (!Read(eventId) || !Read(value)) return false;
+            engine.SetEventVolume(eventId, value);
+            return true;
+        case EngineCall::MuteAll:
+            engine.MuteAll();
+            return true;
+        case EngineCall::UnmuteAll:
+            engine.UnmuteAll();
+            return true;
+        case EngineCall::CreateBus:
+            if (!Read(name) || !Read(other)) return false;
+            engine.CreateBus(name, *other ? other : nullptr);
+            return true;
+        case EngineCall::SetBusVolume:
+            if (!Read(name) || !Read(value)) return false;
+            engine.SetBusVolume(name, value);
+            return true;
+        case EngineCall::SetBusMute:
+            if (!Read(name) || !Read(flag)) return false;
+            engine.SetBusMute(name, flag);
+            return true;
+        case EngineCall::SetBusPaused:
+            if (!Read(name) || !Read(flag)) return false;
+            engine.SetBusPaused(name, flag);
+            return true;
+        case EngineCall::SetBusPitch:
+            if (!Read(name) || !Read(value)) return false;
+            engine.SetBusPitch(name, value);
+            return true;
+        case EngineCall::AddDucking:
+        {
+            DuckingSettings settings;
+            if (!Read(name) || !Read(other) || !Read(settings.attackMS) || !Read(settings.releaseMS)
+                || !Read(settings.depthdB) || !Read(settings.thresholddB)) return false;
+            engine.AddDucking(name, other, settings);
+            return true;
+        }
+        case EngineCall::RemoveDucking:
+            if (!Read(name) || !Read(other)) return false;
+            engine.RemoveDucking(name, other);
+            return true;
+        case EngineCall::AddBusEffect:
+        case EngineCall::RemoveBusEffect:
+        case EngineCall::SetBusEffectParameter:
+        {
+            if (!Read(name) || !Read(count) || count >= static_cast<unsigned int>(EngineEffect::Count)) return false;
+            const EngineEffect effect = static_cast<EngineEffect>(count);
+            if (static_cast<EngineCall>(call) == EngineCall::AddBusEffect)
+                engine.AddBusEffect(name, effect);
+            else if (static_cast<EngineCall>(call) == EngineCall::RemoveBusEffect)
+                engine.RemoveBusEffect(name, effect);
+            else
+            {
+                if (!Read(index) || !Read(value)) return false;
+                engine.SetBusEffectParameter(name, effect, index, value);
+            }
+            return true;
+        }
+        case EngineCall::AddConvolutionReverb:
+            if (!Read(name) || !Read(other) || !Read(value) || !Read(other2)) return false;
+            engine.AddConvolutionReverb(name, other, value, other2);
+            return true;
+        case EngineCall::SetConvolutionReverbMix:
+            if (!Read(name) || !Read(value) || !Read(other2)) return false;
+            engine.SetConvolutionReverbMix(name, value, other2);
+            return true;
+        case EngineCall::RemoveConvolutionReverb:
+            if (!Read(name)) return false;
+            engine.RemoveConvolutionReverb(name);
+            return true;
+        case EngineCall::AddLoudnessMeter:
+            if (!Read(name)) return false;
+            engine.AddLoudnessMeter(name);
+            return true;
+        case EngineCall::RemoveLoudnessMeter:
+            if (!Read(name)) return false;
+            engine.RemoveLoudnessMeter(name);
+            return true;
+        case EngineCall::ResetLoudness:
+            if (!Read(name)) return false;
+            engine.ResetLoudness(name);
+            return true;
+        case EngineCall::LoadLevelGeometry:
+        {
+            if (!Read(name) || !Read(count)) return false;
+            std::map<std::string, OcclusionMaterial> materials;
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                OcclusionMaterial material;
+                if (!Read(other) || !Read(material.directOcclusion) || !Read(material.reverbOcclusion)
+                    || !Read(material.doubleSided)) return false;
+                materials[other] = material;
+            }
+            engine.LoadLevelGeometry(name, materials);
+            return true;
+        }
+        case EngineCall::UnloadLevelGeometry:
+            engine.UnloadLevelGeometry();
+            return true;
+        case EngineCall::LoadHrtf:
+            if (!Read(name)) return false;
+            engine.LoadHrtf(name);
+            return true;
+        case EngineCall::CreateEventInstance:
+            if (!Read(eventId)) return false;
+            engine.CreateEventInstance(eventId);
+            return true;
+        case EngineCall::ReleaseEventInstance:
+            if (!Read(instance.index)) return false;
+            engine.ReleaseEventInstance(instance);
+            return true;
+        case EngineCall::PlayEventInstance:
+            if (!Read(instance.index)) return false;
+            engine.PlayEvent(instance);
+            return true;
+        case EngineCall::StopEventInstance:
+            if (!Read(instance.index)) return false;
+            engine.StopEvent(instance);
+            return true;
+        case EngineCall::GetEventParameterHandle:
+            if (!Read(eventId) || !Read(name)) return false;
+            engine.GetEventParameterHandle(eventId, name);
+            return true;
+        case EngineCall::SetEventParameters:
+        {
+            // Handles come out of the engine in the recorded order, so recorded indices still match
+            if (!Read(count) || count > log.size() - cursor) return false;
+            std::vector<EventParameterWrite> writes(count);
+            for (EventParameterWrite& write : writes)
+            {
+                if (!Read(write.instance.index) || !Read(write.parameter.index) || !Read(write.value)) return false;
+            }
+            engine.SetEventParameters(writes);
+            return true;
+        }
+        case EngineCall::SetListenerCount:
+            if (!Read(index)) return false;
+            engine.SetListenerCount(index);
+            return true;
+        case EngineCall::SetSoundLimit:
+        case EngineCall::SetBusLimit:
+        {
+            uint64_t sound = 0;
+            PlaybackLimit limit;
+            const bool isSound = static_cast<EngineCall>(call) == EngineCall::SetSoundLimit;
+            if ((isSound ? !ReadID(sound) : !Read(name)) || !Read(limit.maxInstances) || !Read(limit.minRetriggerMS)
+                || !Read(count) || count > static_cast<unsigned int>(LimitBehavior::Reject)) return false;
+            limit.behavior = static_cast<LimitBehavior>(count);
+            if (isSound)
+                engine.SetSoundLimit(SoundId(sound), limit);
+            else
+                engine.SetBusLimit(name, limit);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
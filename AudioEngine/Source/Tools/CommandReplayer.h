@@ -0,0 +1,101 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file CommandReplayer.h
+///
+/// Plays a log written by CommandRecorder back against an AudioEngine, timing every frame.
+/// The engine should be initialized with the settings the log was recorded with and have nothing
+/// loaded; sounds, banks and impulse responses are loaded from the paths in the log.
+/// In real-time mode each frame lasts as long as it did when recorded, reproducing the original
+/// mixer load; as fast as possible mode runs frames back to back to profile the calls themselves.
+///
+/// @author JDSherbert
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "../Data/EventId.h"
+
+class AudioData;
+class AudioEngine;
+
+enum class ReplayMode
+{
+    RealTime,
+    AsFastAsPossible
+};
+
+struct ReplayFrame
+{
+    unsigned int frame = 0;
+
+    // Engine calls made in the frame, not counting Update()
+    unsigned int calls = 0;
+
+    // Time spent in those calls, and in the Update() ending the frame
+    float callsMS = 0.0f;
+    float updateMS = 0.0f;
+
+    // Length of the frame when it was recorded
+    float recordedMS = 0.0f;
+};
+
+struct ReplayResult
+{
+    // False if the log couldn't be read to the end; frames holds what was replayed
+    bool completed = false;
+
+    std::vector<ReplayFrame> frames;
+
+    // Engine time per frame (calls and Update()) across the replay
+    float meanFrameMS = 0.0f;
+    float p99FrameMS = 0.0f;
+    float maxFrameMS = 0.0f;
+
+    float wallClockSeconds = 0.0f;
+};
+
+class CommandReplayer
+{
+public:
+
+    /**
+     * Reads a whole command log into memory.
+     * @return false, with a console message, if the file can't be read or isn't a command log
+     */
+    bool Load(const char* filePath);
+
+    /**
+     * Replays the loaded log and prints a summary including the slowest frames.
+     * Sound paths stay owned by the replayer; keep it alive until the engine is terminated.
+     */
+    ReplayResult Replay(AudioEngine& engine, ReplayMode mode = ReplayMode::AsFastAsPossible);
+
+private:
+
+    bool ReadByte(uint8_t& value);
+    bool ReadVarint(uint64_t& value);
+    bool ReadID(uint64_t& id);
+    bool Read(bool& value);
+    bool Read(int& value);
+    bool Read(unsigned int& value);
+    bool Read(float& value);
+    bool Read(const char*& text);
+    bool Read(AudioData& audioData);
+    bool Read(EventId& eventId);
+
+    /**
+     * Decodes one call and makes it on the engine.
+     * @return false if the log is truncated or holds an unknown call
+     */
+    bool ReplayCall(AudioEngine& engine, uint8_t call);
+
+    std::vector<uint8_t> log;
+    size_t cursor = 0;
+
+    // Interned strings; a deque so the pointers handed to the engine never move
+    std::deque<std::string> strings;
+};
@@ -0,0 +1,93 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file ConvolutionBenchmark.cpp
+/// @author JDSherbert
+
+#include "ConvolutionBenchmark.h"
+
+#include "../DSP/ConvolutionReverb.h"
+#include "Stopwatch.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    const int BENCHMARK_SAMPLE_RATE = 48000;
+    const int BENCHMARK_CHANNELS = 2;
+    const int BLOCK_FRAMES = 1024;
+
+    // An exponentially decaying noise burst, reaching -60 dB at the end like a measured room
+    void MakeImpulse(std::vector<float>& impulse, int length, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+        const float decay = logf(0.001f) / static_cast<float>(length);
+        impulse.resize(length);
+        for (int i = 0; i < length; ++i)
+            impulse[i] = noise(random) * expf(decay * static_cast<float>(i));
+    }
+}
+
+std::vector<ConvolutionBenchmarkResult> ConvolutionBenchmark::Run(const std::vector<float>& impulseSeconds, int impulseChannels, float audioSeconds)
+{
+    std::vector<ConvolutionBenchmarkResult> results;
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+
+    // Same noise for every measurement, processed in place block by block
+    const int blocks = std::max(static_cast<int>(audioSeconds * BENCHMARK_SAMPLE_RATE) / BLOCK_FRAMES, 1);
+    std::vector<float> input(static_cast<size_t>(blocks) * BLOCK_FRAMES * BENCHMARK_CHANNELS);
+    for (float& sample : input)
+        sample = noise(random);
+    std::vector<float> output(BLOCK_FRAMES * BENCHMARK_CHANNELS);
+
+    impulseChannels = std::min(std::max(impulseChannels, 1), static_cast<int>(ConvolutionReverb::MAX_IMPULSE_CHANNELS));
+    std::vector<float> impulses[ConvolutionReverb::MAX_IMPULSE_CHANNELS];
+    const float* pointers[ConvolutionReverb::MAX_IMPULSE_CHANNELS] = { };
+
+    for (float seconds : impulseSeconds)
+    {
+        const int length = static_cast<int>(seconds * BENCHMARK_SAMPLE_RATE);
+        for (int channel = 0; channel < impulseChannels; ++channel)
+        {
+            MakeImpulse(impulses[channel], length, random);
+            pointers[channel] = impulses[channel].data();
+        }
+
+        ConvolutionReverb reverb;
+        reverb.SetImpulse(pointers, impulseChannels, length, false);
+
+        Stopwatch stopwatch;
+        for (int block = 0; block < blocks; ++block)
+            reverb.Process(&input[static_cast<size_t>(block) * BLOCK_FRAMES * BENCHMARK_CHANNELS], output.data(), BLOCK_FRAMES, BENCHMARK_CHANNELS);
+        const double totalMS = stopwatch.ElapsedMS();
+
+        const ConvolutionReverbStats stats = reverb.GetStats();
+        const double processedMS = 1000.0 * blocks * BLOCK_FRAMES / BENCHMARK_SAMPLE_RATE;
+
+        ConvolutionBenchmarkResult result;
+        result.impulseSeconds = seconds;
+        result.workerCPU = static_cast<float>(100.0 * stats.tailMilliseconds / processedMS);
+        result.mixerCPU = static_cast<float>(100.0 * (totalMS - stats.tailMilliseconds) / processedMS);
+        result.cpuPerImpulseSecond = seconds > 0.0f ? (result.mixerCPU + result.workerCPU) / seconds : 0.0f;
+        result.tailBlockMicroseconds = stats.tailBlocks > 0 ? static_cast<float>(1000.0 * stats.tailMilliseconds / stats.tailBlocks) : 0.0f;
+        result.tailDeadlineMicroseconds = 1e6f * ConvolutionReverb::TAIL_BLOCK_SIZE / BENCHMARK_SAMPLE_RATE;
+        results.push_back(result);
+    }
+
+    std::cout << "Convolution Benchmark: " << impulseChannels << " channel impulse responses, " << audioSeconds
+              << "s of audio at " << BENCHMARK_SAMPLE_RATE << "Hz\n";
+    for (const ConvolutionBenchmarkResult& result : results)
+    {
+        std::cout << "  " << std::fixed << std::setprecision(1) << std::setw(5) << result.impulseSeconds << "s IR"
+                  << std::setprecision(2) << "  mixer " << std::setw(6) << result.mixerCPU << "%"
+                  << "  worker " << std::setw(6) << result.workerCPU << "%"
+                  << "  " << std::setw(6) << result.cpuPerImpulseSecond << "% per IR second"
+                  << std::setprecision(0) << "  tail block " << result.tailBlockMicroseconds << "us of "
+                  << result.tailDeadlineMicroseconds << "us\n";
+    }
+
+    return results;
+}
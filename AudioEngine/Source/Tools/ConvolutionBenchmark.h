@@ -0,0 +1,43 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file ConvolutionBenchmark.h
+///
+/// Measures the CPU cost of the convolution reverb against impulse response length.
+/// Drives ConvolutionReverb directly with the tail convolved inline, so it needs no audio device,
+/// runs as fast as possible, and can split the cost between the mixer thread and the worker.
+///
+/// @author JDSherbert
+
+#include <vector>
+
+struct ConvolutionBenchmarkResult
+{
+    float impulseSeconds = 0.0f;
+
+    // Share of one core needed to run in real time, in percent
+    float mixerCPU = 0.0f;          // head segment, on the mixer thread
+    float workerCPU = 0.0f;         // tail segment, on the worker thread
+
+    // Total CPU divided by the impulse response length, in percent per second of response
+    float cpuPerImpulseSecond = 0.0f;
+
+    // Average time to convolve one tail block, against the TAIL_BLOCK_SIZE samples it has to finish in
+    float tailBlockMicroseconds = 0.0f;
+    float tailDeadlineMicroseconds = 0.0f;
+};
+
+class ConvolutionBenchmark
+{
+public:
+
+    /**
+     * Reverberates noise with decaying noise impulse responses of each length and prints the cost.
+     * @param impulseSeconds - impulse response lengths to measure
+     * @param impulseChannels - 1 (mono) or 2 (stereo) impulse responses
+     * @param audioSeconds - length of audio processed per measurement
+     */
+    static std::vector<ConvolutionBenchmarkResult> Run(const std::vector<float>& impulseSeconds = { 0.5f, 1.0f, 2.0f, 4.0f, 8.0f },
+                                                       int impulseChannels = 2, float audioSeconds = 10.0f);
+};
@@ -0,0 +1,159 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file DSPBenchmark.cpp
+/// @author JDSherbert
+
+#include "DSPBenchmark.h"
+
+#include "../../AudioEngine.h"
+#include "../DSP/EngineEffects.h"
+
+#include <FMOD/fmod.hpp>
+
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    const int BENCHMARK_SAMPLE_RATE = 48000;
+    const int WARMUP_BLOCKS = 32;
+    const int OSCILLATOR_TYPE_NOISE = 5;
+
+    FMOD_SPEAKERMODE SpeakerModeFor(int channels)
+    {
+        switch (channels)
+        {
+            case 1:  return FMOD_SPEAKERMODE_MONO;
+            case 4:  return FMOD_SPEAKERMODE_QUAD;
+            case 6:  return FMOD_SPEAKERMODE_5POINT1;
+            case 8:  return FMOD_SPEAKERMODE_7POINT1;
+            default: return FMOD_SPEAKERMODE_STEREO;
+        }
+    }
+
+    /**
+     * Inserts dsp on the master group, mixes the requested number of blocks and returns the
+     * average exclusive time the DSP took per block. Releases the DSP afterwards.
+     */
+    float MeasureDSP(FMOD::System* system, FMOD::ChannelGroup* master, FMOD::DSP* dsp, int blocks)
+    {
+        ERRCHECK(master->addDSP(FMOD_CHANNELCONTROL_DSP_HEAD, dsp));
+
+        for (int i = 0; i < WARMUP_BLOCKS; ++i)
+            ERRCHECK(system->update());
+
+        double total = 0.0;
+        for (int i = 0; i < blocks; ++i)
+        {
+            ERRCHECK(system->update());
+            unsigned int exclusive = 0, inclusive = 0;
+            ERRCHECK(dsp->getCPUUsage(&exclusive, &inclusive));
+            total += exclusive;
+        }
+
+        ERRCHECK(master->removeDSP(dsp));
+        ERRCHECK(dsp->release());
+        return blocks > 0 ? static_cast<float>(total / blocks) : 0.0f;
+    }
+}
+
+std::vector<DSPBenchmarkResult> DSPBenchmark::Run(int channels, int blocks)
+{
+    std::vector<DSPBenchmarkResult> results;
+
+    FMOD::System* system = nullptr;
+    ERRCHECK(FMOD::System_Create(&system));
+    ERRCHECK(system->setOutput(FMOD_OUTPUTTYPE_NOSOUND_NRT));
+    ERRCHECK(system->setSoftwareFormat(BENCHMARK_SAMPLE_RATE, SpeakerModeFor(channels), 0));
+    ERRCHECK(system->init(32, FMOD_INIT_NORMAL | FMOD_INIT_PROFILE_ENABLE, 0));
+
+    unsigned int handles[static_cast<int>(EngineEffect::Count)] = { };
+    EngineEffects::Register(system, handles);
+
+    FMOD::ChannelGroup* master = nullptr;
+    ERRCHECK(system->getMasterChannelGroup(&master));
+
+    // Noise keeps every filter and the limiter busy for the whole run
+    FMOD::DSP* noise = nullptr;
+    FMOD::Channel* channel = nullptr;
+    ERRCHECK(system->createDSPByType(FMOD_DSP_TYPE_OSCILLATOR, &noise));
+    ERRCHECK(noise->setParameterInt(FMOD_DSP_OSCILLATOR_TYPE, OSCILLATOR_TYPE_NOISE));
+    ERRCHECK(system->playDSP(noise, master, false, &channel));
+
+    FMOD::DSP* engineDSP = nullptr;
+    FMOD::DSP* fmodDSP = nullptr;
+
+    // Biquad EQ vs multiband EQ, both set to the same three bands
+    {
+        DSPBenchmarkResult result;
+        result.effect = "Biquad EQ (3 band)";
+
+        ERRCHECK(system->createDSPByPlugin(handles[static_cast<int>(EngineEffect::BiquadEQ)], &engineDSP));
+        ERRCHECK(engineDSP->setParameterFloat(BIQUADEQ_LOW_GAIN, 3.0f));
+        ERRCHECK(engineDSP->setParameterFloat(BIQUADEQ_MID_GAIN, -3.0f));
+        ERRCHECK(engineDSP->setParameterFloat(BIQUADEQ_HIGH_GAIN, 2.0f));
+        result.engineMicroseconds = MeasureDSP(system, master, engineDSP, blocks);
+
+        ERRCHECK(system->createDSPByType(FMOD_DSP_TYPE_MULTIBAND_EQ, &fmodDSP));
+        ERRCHECK(fmodDSP->setParameterInt(FMOD_DSP_MULTIBAND_EQ_A_FILTER, FMOD_DSP_MULTIBAND_EQ_FILTER_LOWSHELF));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_MULTIBAND_EQ_A_FREQUENCY, 200.0f));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_MULTIBAND_EQ_A_GAIN, 3.0f));
+        ERRCHECK(fmodDSP->setParameterInt(FMOD_DSP_MULTIBAND_EQ_B_FILTER, FMOD_DSP_MULTIBAND_EQ_FILTER_PEAKING));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_MULTIBAND_EQ_B_FREQUENCY, 1000.0f));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_MULTIBAND_EQ_B_GAIN, -3.0f));
+        ERRCHECK(fmodDSP->setParameterInt(FMOD_DSP_MULTIBAND_EQ_C_FILTER, FMOD_DSP_MULTIBAND_EQ_FILTER_HIGHSHELF));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_MULTIBAND_EQ_C_FREQUENCY, 8000.0f));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_MULTIBAND_EQ_C_GAIN, 2.0f));
+        result.fmodMicroseconds = MeasureDSP(system, master, fmodDSP, blocks);
+
+        results.push_back(result);
+    }
+
+    // One-pole low-pass vs simple low-pass
+    {
+        DSPBenchmarkResult result;
+        result.effect = "One-pole low-pass";
+
+        ERRCHECK(system->createDSPByPlugin(handles[static_cast<int>(EngineEffect::OnePoleLowPass)], &engineDSP));
+        ERRCHECK(engineDSP->setParameterFloat(ONEPOLE_CUTOFF, 2000.0f));
+        result.engineMicroseconds = MeasureDSP(system, master, engineDSP, blocks);
+
+        ERRCHECK(system->createDSPByType(FMOD_DSP_TYPE_LOWPASS_SIMPLE, &fmodDSP));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_LOWPASS_SIMPLE_CUTOFF, 2000.0f));
+        result.fmodMicroseconds = MeasureDSP(system, master, fmodDSP, blocks);
+
+        results.push_back(result);
+    }
+
+    // Lookahead limiter vs FMOD limiter
+    {
+        DSPBenchmarkResult result;
+        result.effect = "Lookahead limiter";
+
+        ERRCHECK(system->createDSPByPlugin(handles[static_cast<int>(EngineEffect::LookaheadLimiter)], &engineDSP));
+        ERRCHECK(engineDSP->setParameterFloat(LIMITER_CEILING, -3.0f));
+        ERRCHECK(engineDSP->setParameterFloat(LIMITER_RELEASE, 50.0f));
+        result.engineMicroseconds = MeasureDSP(system, master, engineDSP, blocks);
+
+        ERRCHECK(system->createDSPByType(FMOD_DSP_TYPE_LIMITER, &fmodDSP));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_LIMITER_CEILING, -3.0f));
+        ERRCHECK(fmodDSP->setParameterFloat(FMOD_DSP_LIMITER_RELEASETIME, 50.0f));
+        result.fmodMicroseconds = MeasureDSP(system, master, fmodDSP, blocks);
+
+        results.push_back(result);
+    }
+
+    ERRCHECK(channel->stop());
+    ERRCHECK(noise->release());
+    ERRCHECK(system->release());
+
+    std::cout << "DSP Benchmark: " << channels << " channels, " << blocks << " blocks at " << BENCHMARK_SAMPLE_RATE << "Hz\n";
+    for (const DSPBenchmarkResult& result : results)
+    {
+        std::cout << "  " << std::left << std::setw(22) << result.effect
+                  << " engine " << std::fixed << std::setprecision(2) << result.engineMicroseconds << "us"
+                  << "  fmod " << result.fmodMicroseconds << "us per block\n";
+    }
+
+    return results;
+}
@@ -0,0 +1,39 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file DSPBenchmark.h
+///
+/// Measures the mixer CPU cost of the engine's DSP effects against FMOD's built-in equivalents.
+/// Runs in its own non-realtime FMOD system, so it needs no audio device and does not touch
+/// a running AudioEngine.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <string>
+#include <vector>
+
+struct DSPBenchmarkResult
+{
+    std::string effect;
+
+    // Average exclusive mixer time per block, in microseconds
+    float engineMicroseconds = 0.0f;
+    float fmodMicroseconds = 0.0f;
+};
+
+class DSPBenchmark
+{
+public:
+
+    /**
+     * Runs every engine effect and its FMOD counterpart over noise and prints a comparison.
+     *   Biquad EQ          vs FMOD_DSP_TYPE_MULTIBAND_EQ (3 bands)
+     *   One-pole low-pass  vs FMOD_DSP_TYPE_LOWPASS_SIMPLE
+     *   Lookahead limiter  vs FMOD_DSP_TYPE_LIMITER
+     * @param channels - channel count of the mix (1, 2, 4, 6 or 8)
+     * @param blocks - number of mixer blocks to average over
+     */
+    static std::vector<DSPBenchmarkResult> Run(int channels = 2, int blocks = 2000);
+};
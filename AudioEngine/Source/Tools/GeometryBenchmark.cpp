@@ -0,0 +1,162 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file GeometryBenchmark.cpp
+/// @author JDSherbert
+
+#include "GeometryBenchmark.h"
+
+#include "../../AudioEngine.h"
+#include "../Spatial/OcclusionSystem.h"
+#include "Stopwatch.h"
+
+#include <FMOD/fmod.hpp>
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    const int BENCHMARK_SAMPLE_RATE = 48000;
+    const int WARMUP_UPDATES = 16;
+    const int OCCLUSION_QUERIES = 2000;
+    const float WORLD_SIZE = 512.0f;
+    const float WALL_HEIGHT = 4.0f;
+
+    /**
+     * Builds a mesh of randomly placed and rotated wall quads covering the benchmark world.
+     */
+    LevelMesh BuildWalls(int triangles, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE);
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        std::uniform_real_distribution<float> length(2.0f, 8.0f);
+
+        LevelMesh mesh;
+        mesh.materials.push_back(OcclusionMaterial());
+        for (int i = 0; i + 1 < triangles; i += 2)
+        {
+            const float x = position(random), z = position(random);
+            const float theta = angle(random), halfLength = 0.5f * length(random);
+            const float dx = cosf(theta) * halfLength, dz = sinf(theta) * halfLength;
+
+            const int first = static_cast<int>(mesh.vertices.size());
+            mesh.vertices.push_back(Vector3(x - dx, 0.0f, z - dz));
+            mesh.vertices.push_back(Vector3(x + dx, 0.0f, z + dz));
+            mesh.vertices.push_back(Vector3(x + dx, WALL_HEIGHT, z + dz));
+            mesh.vertices.push_back(Vector3(x - dx, WALL_HEIGHT, z - dz));
+            mesh.triangles.push_back({ { first, first + 1, first + 2 }, 0 });
+            mesh.triangles.push_back({ { first, first + 2, first + 3 }, 0 });
+        }
+        return mesh;
+    }
+
+    /**
+     * Position of the listener on a circle around the world centre at the given update.
+     */
+    Vector3 ListenerAt(int update)
+    {
+        const float theta = update * 0.01f;
+        return Vector3(0.5f * WORLD_SIZE + 100.0f * cosf(theta), 1.8f, 0.5f * WORLD_SIZE + 100.0f * sinf(theta));
+    }
+}
+
+std::vector<GeometryBenchmarkResult> GeometryBenchmark::Run(const std::vector<int>& polygonCounts, int emitters, int updates)
+{
+    std::vector<GeometryBenchmarkResult> results;
+
+    for (int polygons : polygonCounts)
+    {
+        FMOD::System* system = nullptr;
+        ERRCHECK(FMOD::System_Create(&system));
+        ERRCHECK(system->setOutput(FMOD_OUTPUTTYPE_NOSOUND_NRT));
+        ERRCHECK(system->setSoftwareFormat(BENCHMARK_SAMPLE_RATE, FMOD_SPEAKERMODE_STEREO, 0));
+        ERRCHECK(system->init(emitters + 1, FMOD_INIT_NORMAL | FMOD_INIT_PROFILE_ENABLE, 0));
+
+        std::mt19937 random(polygons);
+
+        // Load every cell up front so the whole polygon count is active
+        OcclusionSettings settings;
+        settings.cellSize = 64.0f;
+        settings.streamRadius = 2.0f * WORLD_SIZE;
+        settings.maxCellLoadsPerUpdate = 1 << 20;
+        settings.maxWorldSize = 2.0f * WORLD_SIZE;
+
+        OcclusionSystem occlusion(system, settings);
+        occlusion.AddMesh(BuildWalls(polygons, random));
+        const Vector3 listener = ListenerAt(0);
+        occlusion.Update(&listener, 1);
+
+        // Silent looping 3D sound, occlusion is calculated regardless of the signal
+        FMOD_CREATESOUNDEXINFO info = { };
+        info.cbsize = sizeof(info);
+        info.numchannels = 1;
+        info.defaultfrequency = BENCHMARK_SAMPLE_RATE;
+        info.format = FMOD_SOUND_FORMAT_PCM16;
+        info.length = BENCHMARK_SAMPLE_RATE * sizeof(short);
+
+        FMOD::Sound* sound = nullptr;
+        ERRCHECK(system->createSound(nullptr, FMOD_OPENUSER | FMOD_3D | FMOD_LOOP_NORMAL, &info, &sound));
+
+        std::uniform_real_distribution<float> position(0.0f, WORLD_SIZE);
+        std::vector<Vector3> emitterPositions;
+        for (int i = 0; i < emitters; ++i)
+        {
+            const Vector3 emitterPosition(position(random), 1.0f, position(random));
+            const FMOD_VECTOR fmodPosition = { emitterPosition.x, emitterPosition.y, emitterPosition.z };
+            const FMOD_VECTOR velocity = { 0.0f, 0.0f, 0.0f };
+
+            FMOD::Channel* channel = nullptr;
+            ERRCHECK(system->playSound(sound, nullptr, true, &channel));
+            ERRCHECK(channel->set3DMinMaxDistance(1.0f, 2.0f * WORLD_SIZE));
+            ERRCHECK(channel->set3DAttributes(&fmodPosition, &velocity));
+            ERRCHECK(channel->setPaused(false));
+            emitterPositions.push_back(emitterPosition);
+        }
+
+        // Move the listener every update so FMOD recalculates occlusion for every channel
+        const FMOD_VECTOR forward = { 0.0f, 0.0f, 1.0f };
+        const FMOD_VECTOR up = { 0.0f, 1.0f, 0.0f };
+        double totalCPU = 0.0;
+        for (int i = 0; i < WARMUP_UPDATES + updates; ++i)
+        {
+            const Vector3 listener = ListenerAt(i);
+            const FMOD_VECTOR listenerPosition = { listener.x, listener.y, listener.z };
+            ERRCHECK(system->set3DListenerAttributes(0, &listenerPosition, nullptr, &forward, &up));
+            ERRCHECK(system->update());
+
+            if (i >= WARMUP_UPDATES)
+            {
+                float dsp = 0.0f, stream = 0.0f, geometry = 0.0f, update = 0.0f, total = 0.0f;
+                ERRCHECK(system->getCPUUsage(&dsp, &stream, &geometry, &update, &total));
+                totalCPU += geometry;
+            }
+        }
+
+        GeometryBenchmarkResult result;
+        result.polygons = polygons;
+        result.geometryCPU = updates > 0 ? static_cast<float>(totalCPU / updates) : 0.0f;
+
+        Stopwatch stopwatch;
+        for (int i = 0; emitters > 0 && i < OCCLUSION_QUERIES; ++i)
+            occlusion.GetOcclusion(ListenerAt(i), emitterPositions[i % emitterPositions.size()]);
+        result.queryMicroseconds = emitters > 0 ? stopwatch.ElapsedMS() * 1000.0f / OCCLUSION_QUERIES : 0.0f;
+
+        results.push_back(result);
+
+        occlusion.Clear();
+        ERRCHECK(sound->release());
+        ERRCHECK(system->release());
+    }
+
+    std::cout << "Geometry Benchmark: " << emitters << " emitters, " << updates << " updates\n";
+    for (const GeometryBenchmarkResult& result : results)
+    {
+        std::cout << "  " << std::right << std::setw(7) << result.polygons << " polygons"
+                  << "  geometry " << std::fixed << std::setprecision(2) << result.geometryCPU << "% CPU"
+                  << "  query " << result.queryMicroseconds << "us\n";
+    }
+
+    return results;
+}
@@ -0,0 +1,41 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file GeometryBenchmark.h
+///
+/// Measures how occlusion cost grows with the number of loaded polygons: the geometry thread
+/// CPU FMOD spends re-occluding every playing emitter as the listener circles the level, and
+/// the time one OcclusionSystem::GetOcclusion() query takes. Every cell is loaded before timing
+/// starts, so the figures are for a fully streamed-in level, not the cost of streaming cells.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <vector>
+
+struct GeometryBenchmarkResult
+{
+    int polygons = 0;
+
+    // Average geometry thread CPU reported by System::getCPUUsage, in percent
+    float geometryCPU = 0.0f;
+
+    // Average cost of one System::getGeometryOcclusion query, in microseconds
+    float queryMicroseconds = 0.0f;
+};
+
+class GeometryBenchmark
+{
+public:
+
+    /**
+     * Loads randomly placed wall triangles through an OcclusionSystem, plays 3D emitters around
+     * a moving listener and prints the geometry cost for each polygon count.
+     * @param polygonCounts - triangle counts to measure
+     * @param emitters - number of playing 3D channels FMOD calculates occlusion for
+     * @param updates - number of system updates to average over
+     */
+    static std::vector<GeometryBenchmarkResult> Run(const std::vector<int>& polygonCounts = { 1000, 4000, 16000, 64000 },
+                                                    int emitters = 32, int updates = 500);
+};
@@ -0,0 +1,299 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file Json.cpp
+/// @author JDSherbert
+
+#include "Json.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+class JsonParser
+{
+public:
+
+    explicit JsonParser(const std::string& text) : text(text) {}
+
+    bool ParseDocument(JsonValue& result, std::string& error)
+    {
+        SkipWhitespace();
+        if (!ParseValue(result))
+        {
+            error = message + " (line " + std::to_string(line) + ")";
+            return false;
+        }
+        SkipWhitespace();
+        if (position != text.size())
+        {
+            error = "Unexpected trailing characters (line " + std::to_string(line) + ")";
+            return false;
+        }
+        return true;
+    }
+
+private:
+
+    bool Fail(const char* reason)
+    {
+        message = reason;
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while (position < text.size())
+        {
+            const char c = text[position];
+            if (c == '\n')
+                ++line;
+            else if (c != ' ' && c != '\t' && c != '\r')
+                return;
+            ++position;
+        }
+    }
+
+    bool Consume(const char* literal)
+    {
+        const size_t length = strlen(literal);
+        if (text.compare(position, length, literal) != 0)
+            return false;
+        position += length;
+        return true;
+    }
+
+    bool ParseValue(JsonValue& value)
+    {
+        if (position >= text.size())
+            return Fail("Unexpected end of document");
+
+        switch (text[position])
+        {
+            case '{': return ParseObject(value);
+            case '[': return ParseArray(value);
+            case '"':
+                value.type = JsonValue::Type::String;
+                return ParseString(value.stringValue);
+            case 't':
+            case 'f':
+                value.type = JsonValue::Type::Bool;
+                value.boolValue = text[position] == 't';
+                return Consume(value.boolValue ? "true" : "false") || Fail("Invalid literal");
+            case 'n':
+                value.type = JsonValue::Type::Null;
+                return Consume("null") || Fail("Invalid literal");
+            default:
+                return ParseNumber(value);
+        }
+    }
+
+    bool ParseNumber(JsonValue& value)
+    {
+        const char* start = text.c_str() + position;
+        char* end = nullptr;
+        value.numberValue = strtod(start, &end);
+        if (end == start)
+            return Fail("Invalid value");
+        value.type = JsonValue::Type::Number;
+        position += end - start;
+        return true;
+    }
+
+    bool ParseString(std::string& result)
+    {
+        ++position; // opening quote
+        result.clear();
+        while (position < text.size())
+        {
+            const char c = text[position++];
+            if (c == '"')
+                return true;
+            if (c != '\\')
+            {
+                result += c;
+                continue;
+            }
+
+            if (position >= text.size())
+                break;
+            const char escaped = text[position++];
+            switch (escaped)
+            {
+                case '"':  result += '"';  break;
+                case '\\': result += '\\'; break;
+                case '/':  result += '/';  break;
+                case 'b':  result += '\b'; break;
+                case 'f':  result += '\f'; break;
+                case 'n':  result += '\n'; break;
+                case 'r':  result += '\r'; break;
+                case 't':  result += '\t'; break;
+                case 'u':
+                {
+                    if (position + 4 > text.size())
+                        return Fail("Invalid unicode escape");
+                    const unsigned long codePoint = strtoul(text.substr(position, 4).c_str(), nullptr, 16);
+                    position += 4;
+                    // Manifests are expected to be ASCII, encode the basic multilingual plane as UTF-8
+                    if (codePoint < 0x80)
+                        result += static_cast<char>(codePoint);
+                    else if (codePoint < 0x800)
+                    {
+                        result += static_cast<char>(0xC0 | (codePoint >> 6));
+                        result += static_cast<char>(0x80 | (codePoint & 0x3F));
+                    }
+                    else
+                    {
+                        result += static_cast<char>(0xE0 | (codePoint >> 12));
+                        result += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                        result += static_cast<char>(0x80 | (codePoint & 0x3F));
+                    }
+                    break;
+                }
+                default:
+                    return Fail("Invalid escape sequence");
+            }
+        }
+        return Fail("Unterminated string");
+    }
+
+    bool ParseArray(JsonValue& value)
+    {
+        value.type = JsonValue::Type::Array;
+        ++position; // [
+        SkipWhitespace();
+        if (position < text.size() && text[position] == ']')
+        {
+            ++position;
+            return true;
+        }
+
+        while (true)
+        {
+            SkipWhitespace();
+            value.elements.emplace_back();
+            if (!ParseValue(value.elements.back()))
+                return false;
+            SkipWhitespace();
+            if (position < text.size() && text[position] == ',')
+            {
+                ++position;
+                continue;
+            }
+            if (position < text.size() && text[position] == ']')
+            {
+                ++position;
+                return true;
+            }
+            return Fail("Expected ',' or ']' in array");
+        }
+    }
+
+    bool ParseObject(JsonValue& value)
+    {
+        value.type = JsonValue::Type::Object;
+        ++position; // {
+        SkipWhitespace();
+        if (position < text.size() && text[position] == '}')
+        {
+            ++position;
+            return true;
+        }
+
+        while (true)
+        {
+            SkipWhitespace();
+            if (position >= text.size() || text[position] != '"')
+                return Fail("Expected string key in object");
+
+            value.members.emplace_back();
+            if (!ParseString(value.members.back().first))
+                return false;
+
+            SkipWhitespace();
+            if (position >= text.size() || text[position] != ':')
+                return Fail("Expected ':' after object key");
+            ++position;
+            SkipWhitespace();
+
+            if (!ParseValue(value.members.back().second))
+                return false;
+
+            SkipWhitespace();
+            if (position < text.size() && text[position] == ',')
+            {
+                ++position;
+                continue;
+            }
+            if (position < text.size() && text[position] == '}')
+            {
+                ++position;
+                return true;
+            }
+            return Fail("Expected ',' or '}' in object");
+        }
+    }
+
+    const std::string& text;
+    size_t position = 0;
+    int line = 1;
+    std::string message;
+};
+
+bool JsonValue::Parse(const std::string& text, JsonValue& result, std::string& error)
+{
+    result = JsonValue();
+    JsonParser parser(text);
+    return parser.ParseDocument(result, error);
+}
+
+bool JsonValue::ParseFile(const char* filePath, JsonValue& result, std::string& error)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file)
+    {
+        error = std::string("Could not open ") + filePath;
+        return false;
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return Parse(contents.str(), result, error);
+}
+
+bool JsonValue::AsBool(bool fallback) const
+{
+    return type == Type::Bool ? boolValue : fallback;
+}
+
+double JsonValue::AsNumber(double fallback) const
+{
+    return type == Type::Number ? numberValue : fallback;
+}
+
+const std::string& JsonValue::AsString() const
+{
+    static const std::string empty;
+    return type == Type::String ? stringValue : empty;
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const
+{
+    static const JsonValue null;
+    for (const auto& member : members)
+    {
+        if (member.first == key)
+            return member.second;
+    }
+    return null;
+}
+
+bool JsonValue::Has(const char* key) const
+{
+    for (const auto& member : members)
+    {
+        if (member.first == key)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,80 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file Json.h
+///
+/// Minimal JSON reader for offline tooling (asset manifests). Not intended for the runtime path.
+///
+/// @author JDSherbert
+
+#include <string>
+#include <utility>
+#include <vector>
+
+class JsonValue
+{
+public:
+
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    /**
+     * Parses a JSON document.
+     * @param error - receives a message with the line number if parsing fails
+     * @return true on success
+     */
+    static bool Parse(const std::string& text, JsonValue& result, std::string& error);
+
+    /**
+     * Reads and parses a JSON file.
+     */
+    static bool ParseFile(const char* filePath, JsonValue& result, std::string& error);
+
+    Type GetType() const { return type; }
+    bool IsNull() const { return type == Type::Null; }
+    bool IsObject() const { return type == Type::Object; }
+    bool IsArray() const { return type == Type::Array; }
+    bool IsString() const { return type == Type::String; }
+
+    /**
+     * Typed accessors which return the fallback if the value has a different type.
+     */
+    bool AsBool(bool fallback = false) const;
+    double AsNumber(double fallback = 0.0) const;
+    const std::string& AsString() const;
+
+    /**
+     * Array elements, empty for non-arrays.
+     */
+    const std::vector<JsonValue>& GetElements() const { return elements; }
+
+    /**
+     * Returns the member with the given key, or a null value if this is not an object or
+     * has no such member.
+     */
+    const JsonValue& operator[](const char* key) const;
+
+    /**
+     * True if this is an object with the given key.
+     */
+    bool Has(const char* key) const;
+
+private:
+
+    friend class JsonParser;
+
+    Type type = Type::Null;
+    bool boolValue = false;
+    double numberValue = 0.0;
+    std::string stringValue;
+    std::vector<JsonValue> elements;
+    std::vector<std::pair<std::string, JsonValue>> members;
+};
@@ -0,0 +1,228 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file MixerTelemetry.cpp
+/// @author JDSherbert
+
+#include "MixerTelemetry.h"
+
+#include "../../AudioEngine.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // A block starting this many budgets after the previous one has eaten into the output buffer
+    const float LATE_BLOCK_FACTOR = 1.5f;
+
+    float Percentile(const unsigned int* histogram, int bins, unsigned int total, float fraction, float binWidth)
+    {
+        const unsigned int rank = static_cast<unsigned int>(fraction * (total - 1));
+        unsigned int seen = 0;
+        for (int bin = 0; bin < bins; ++bin)
+        {
+            seen += histogram[bin];
+            if (seen > rank)
+                return (bin + 0.5f) * binWidth;
+        }
+        return bins * binWidth;
+    }
+}
+
+MixerTelemetry::MixerTelemetry()
+    : fmodErrors(0)
+    , droppedTimings(0)
+{
+    memset(fineHistogram, 0, sizeof(fineHistogram));
+}
+
+MixerTelemetry::~MixerTelemetry()
+{
+    Detach();
+}
+
+void MixerTelemetry::Attach(FMOD::System* targetSystem, FMOD::ChannelGroup* masterGroup)
+{
+    static FMOD_DSP_DESCRIPTION description = []()
+    {
+        FMOD_DSP_DESCRIPTION result;
+        memset(&result, 0, sizeof(result));
+        result.pluginsdkversion = FMOD_PLUGIN_SDK_VERSION;
+        strncpy(result.name, "Engine Mixer Probe", sizeof(result.name) - 1);
+        result.version = 0x00010000;
+        result.numinputbuffers = 1;
+        result.numoutputbuffers = 1;
+        result.read = &MixerTelemetry::ProbeRead;
+        return result;
+    }();
+
+    system = targetSystem;
+    master = masterGroup;
+
+    int sampleRate = 0;
+    unsigned int blockLength = 0;
+    int blockCount = 0;
+    ERRCHECK(system->getSoftwareFormat(&sampleRate, nullptr, nullptr));
+    ERRCHECK(system->getDSPBufferSize(&blockLength, &blockCount));
+    budgetMicroseconds = 1e6f * blockLength / std::max(sampleRate, 1);
+    outputBufferMicroseconds = budgetMicroseconds * std::max(blockCount, 1);
+    stats.blockBudgetMS = budgetMicroseconds / 1000.0f;
+
+    ERRCHECK(system->createDSP(&description, &probe));
+    ERRCHECK(probe->setUserData(this));
+    ERRCHECK(master->addDSP(FMOD_CHANNELCONTROL_DSP_TAIL, probe));
+
+    ERRCHECK(system->setUserData(this));
+    ERRCHECK(system->setCallback(&MixerTelemetry::SystemCallback,
+                                 FMOD_SYSTEM_CALLBACK_PREMIX | FMOD_SYSTEM_CALLBACK_POSTMIX | FMOD_SYSTEM_CALLBACK_ERROR));
+}
+
+void MixerTelemetry::Detach()
+{
+    if (!probe)
+        return;
+
+    ERRCHECK(system->setCallback(nullptr, 0));
+    ERRCHECK(system->setUserData(nullptr));
+    ERRCHECK(master->removeDSP(probe));
+    ERRCHECK(probe->release());
+    probe = nullptr;
+    master = nullptr;
+    system = nullptr;
+}
+
+void MixerTelemetry::Update()
+{
+    BlockTiming timing;
+    bool received = false;
+    while (timings.TryPop(timing))
+    {
+        received = true;
+        ++stats.blocks;
+
+        const int fineBin = std::min(static_cast<int>(timing.processMicroseconds / FINE_BIN_MICROSECONDS), FINE_BINS - 1);
+        ++fineHistogram[fineBin];
+
+        const float load = timing.processMicroseconds / budgetMicroseconds;
+        ++stats.histogram[std::min(static_cast<int>(load * 10.0f), MixerTimingStats::HISTOGRAM_BINS - 1)];
+        if (load > 1.0f)
+            ++stats.overruns;
+
+        if (timing.intervalMicroseconds > outputBufferMicroseconds)
+            ++stats.underruns;
+        else if (timing.intervalMicroseconds > budgetMicroseconds * LATE_BLOCK_FACTOR)
+            ++stats.lateBlocks;
+
+        stats.maxMS = std::max(stats.maxMS, timing.processMicroseconds / 1000.0f);
+        if (timing.intervalMicroseconds > 0.0f)
+        {
+            intervalSum += timing.intervalMicroseconds;
+            ++intervalBlocks;
+        }
+        if (timing.submixMicroseconds > 0.0f)
+        {
+            submixSum += timing.submixMicroseconds;
+            masterSum += timing.processMicroseconds - timing.submixMicroseconds;
+            ++submixBlocks;
+        }
+    }
+
+    if (received)
+    {
+        const float binMS = FINE_BIN_MICROSECONDS / 1000.0f;
+        stats.p50MS = Percentile(fineHistogram, FINE_BINS, stats.blocks, 0.50f, binMS);
+        stats.p95MS = Percentile(fineHistogram, FINE_BINS, stats.blocks, 0.95f, binMS);
+        stats.p99MS = Percentile(fineHistogram, FINE_BINS, stats.blocks, 0.99f, binMS);
+        if (submixBlocks > 0)
+        {
+            stats.meanSubmixMS = static_cast<float>(submixSum / submixBlocks / 1000.0);
+            stats.meanMasterMS = static_cast<float>(masterSum / submixBlocks / 1000.0);
+        }
+        if (intervalBlocks > 0)
+            stats.meanIntervalMS = static_cast<float>(intervalSum / intervalBlocks / 1000.0);
+    }
+}
+
+MixerTimingStats MixerTelemetry::GetStats() const
+{
+    MixerTimingStats current = stats;
+    current.fmodErrors = fmodErrors.load(std::memory_order_relaxed) - errorsAtReset;
+    current.droppedMeasurements = droppedTimings.load(std::memory_order_relaxed) - droppedAtReset;
+    return current;
+}
+
+void MixerTelemetry::Reset()
+{
+    const float budgetMS = stats.blockBudgetMS;
+    stats = MixerTimingStats();
+    stats.blockBudgetMS = budgetMS;
+    memset(fineHistogram, 0, sizeof(fineHistogram));
+    submixSum = 0.0;
+    masterSum = 0.0;
+    intervalSum = 0.0;
+    submixBlocks = 0;
+    intervalBlocks = 0;
+    errorsAtReset = fmodErrors.load(std::memory_order_relaxed);
+    droppedAtReset = droppedTimings.load(std::memory_order_relaxed);
+}
+
+float MixerTelemetry::Microseconds(Clock::duration duration)
+{
+    return std::chrono::duration<float, std::micro>(duration).count();
+}
+
+FMOD_RESULT F_CALL MixerTelemetry::SystemCallback
+(
+    FMOD_SYSTEM* /*system*/, FMOD_SYSTEM_CALLBACK_TYPE type,
+    void* /*commandData1*/, void* /*commandData2*/, void* userData
+)
+{
+    MixerTelemetry* telemetry = static_cast<MixerTelemetry*>(userData);
+    if (!telemetry)
+        return FMOD_OK;
+
+    if (type == FMOD_SYSTEM_CALLBACK_ERROR)
+    {
+        // Can arrive from any thread; ERRCHECK already reports the engine's own failures
+        telemetry->fmodErrors.fetch_add(1, std::memory_order_relaxed);
+        return FMOD_OK;
+    }
+
+    const Clock::time_point now = Clock::now();
+    if (type == FMOD_SYSTEM_CALLBACK_PREMIX)
+    {
+        telemetry->blockInterval = telemetry->hasPreviousBlock ? Microseconds(now - telemetry->blockStart) : 0.0f;
+        telemetry->blockStart = now;
+        telemetry->hasPreviousBlock = true;
+        telemetry->probeRan = false;
+    }
+    else if (type == FMOD_SYSTEM_CALLBACK_POSTMIX && telemetry->hasPreviousBlock)
+    {
+        BlockTiming timing;
+        timing.processMicroseconds = Microseconds(now - telemetry->blockStart);
+        timing.submixMicroseconds = telemetry->probeRan ? Microseconds(telemetry->submixEnd - telemetry->blockStart) : 0.0f;
+        timing.intervalMicroseconds = telemetry->blockInterval;
+        if (!telemetry->timings.TryPush(timing))
+            telemetry->droppedTimings.fetch_add(1, std::memory_order_relaxed);
+    }
+    return FMOD_OK;
+}
+
+FMOD_RESULT F_CALL MixerTelemetry::ProbeRead
+(
+    FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+    unsigned int length, int inChannels, int* outChannels
+)
+{
+    void* userData = nullptr;
+    FMOD_DSP_GETUSERDATA(dspState, &userData);
+    if (MixerTelemetry* telemetry = static_cast<MixerTelemetry*>(userData))
+    {
+        telemetry->submixEnd = Clock::now();
+        telemetry->probeRan = true;
+    }
+
+    *outChannels = inChannels;
+    memcpy(outBuffer, inBuffer, length * inChannels * sizeof(float));
+    return FMOD_OK;
+}
@@ -0,0 +1,114 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file MixerTelemetry.h
+///
+/// Times every block of FMOD's mixer thread to show how close it is to missing its deadline.
+/// Three timestamps are taken per block, all on the mixer thread:
+///     premix  - FMOD_SYSTEM_CALLBACK_PREMIX, before anything is mixed
+///     tail    - a probe DSP at the tail of the master group, once every bus feeding it is mixed
+///     postmix - FMOD_SYSTEM_CALLBACK_POSTMIX, after the master group has run
+/// The system callbacks stand in for a head probe, so DSPs later added at the head of the master
+/// group (limiters, meters) are still inside the measurement.
+/// Timings go through a lock-free ring to the game thread, which builds the histogram and
+/// percentiles in Update(); the mixer thread only reads the clock.
+///
+/// Takes over the system callback and the system user data.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <FMOD/fmod.hpp>
+
+#include <atomic>
+#include <chrono>
+
+#include "SpscRing.h"
+#include "../Data/AudioEngineStats.h"
+
+class MixerTelemetry
+{
+public:
+
+    MixerTelemetry();
+    ~MixerTelemetry();
+
+    /**
+     * Installs the system callbacks and the master group probe.
+     */
+    void Attach(FMOD::System* system, FMOD::ChannelGroup* masterGroup);
+
+    /**
+     * Removes the callbacks and the probe.
+     */
+    void Detach();
+
+    /**
+     * Drains the timings posted by the mixer thread into the histogram. Game thread.
+     */
+    void Update();
+
+    /**
+     * Returns the timing statistics gathered since the last Reset(). Game thread.
+     */
+    MixerTimingStats GetStats() const;
+
+    /**
+     * Clears the gathered statistics. Game thread.
+     */
+    void Reset();
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    struct BlockTiming
+    {
+        float processMicroseconds;      // premix to postmix
+        float submixMicroseconds;       // premix to the tail probe, 0 if the probe did not run
+        float intervalMicroseconds;     // previous premix to this premix
+    };
+
+    static FMOD_RESULT F_CALL SystemCallback(FMOD_SYSTEM* system, FMOD_SYSTEM_CALLBACK_TYPE type,
+                                             void* commandData1, void* commandData2, void* userData);
+
+    static FMOD_RESULT F_CALL ProbeRead(FMOD_DSP_STATE* dspState, float* inBuffer, float* outBuffer,
+                                        unsigned int length, int inChannels, int* outChannels);
+
+    static float Microseconds(Clock::duration duration);
+
+    // Percentiles come from a fine histogram of FINE_BIN_MICROSECONDS bins; longer blocks fall in the last bin
+    static const int FINE_BINS = 4096;
+    static const int FINE_BIN_MICROSECONDS = 10;
+
+    FMOD::System* system = nullptr;
+    FMOD::ChannelGroup* master = nullptr;
+    FMOD::DSP* probe = nullptr;
+
+    float budgetMicroseconds = 0.0f;
+    float outputBufferMicroseconds = 0.0f;
+
+    // Mixer thread
+    Clock::time_point blockStart;
+    Clock::time_point submixEnd;
+    bool hasPreviousBlock = false;
+    bool probeRan = false;
+    float blockInterval = 0.0f;
+    SpscRing<BlockTiming, 512> timings;
+
+    // Any thread
+    std::atomic<unsigned int> fmodErrors;
+    std::atomic<unsigned int> droppedTimings;
+
+    // Game thread
+    MixerTimingStats stats;
+    unsigned int fineHistogram[FINE_BINS];
+    double submixSum = 0.0;
+    double masterSum = 0.0;
+    double intervalSum = 0.0;
+    unsigned int submixBlocks = 0;
+    unsigned int intervalBlocks = 0;
+    unsigned int errorsAtReset = 0;
+    unsigned int droppedAtReset = 0;
+};
@@ -0,0 +1,53 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file ParameterBatchBenchmark.h
+///
+/// Counts the FMOD calls batched event parameter writes save over calling SetEventParamValue()
+/// for every write. Simulates game code driving a fleet of vehicle engine events, where several
+/// systems write the same parameters each frame and many values don't change between frames.
+/// Drives EventParameterBatch directly, so it needs no audio device or Studio banks.
+///
+/// @author JDSherbert
+
+struct ParameterBatchBenchmarkSettings
+{
+    int instances = 200;
+    int parametersPerInstance = 4;
+
+    // Times game code writes each parameter per frame, e.g. physics, AI and animation
+    int writesPerParameter = 2;
+
+    // Chance that a parameter's value differs from the previous frame
+    float changeProbability = 0.5f;
+
+    int frames = 1000;
+    unsigned int seed = 1;
+};
+
+struct ParameterBatchBenchmarkResult
+{
+    // FMOD calls per frame: one per write without batching, one per changed instance with it
+    float unbatchedCallsPerFrame = 0.0f;
+    float batchedCallsPerFrame = 0.0f;
+
+    // Parameters set per frame once duplicates and unchanged values are dropped
+    float parametersAppliedPerFrame = 0.0f;
+
+    // Share of the FMOD calls saved, in percent
+    float callsSavedPercent = 0.0f;
+
+    // Time to queue and flush a frame's writes
+    float batchMicrosecondsPerFrame = 0.0f;
+};
+
+class ParameterBatchBenchmark
+{
+public:
+
+    /**
+     * Runs the simulation and prints the calls made with and without batching.
+     */
+    static ParameterBatchBenchmarkResult Run(const ParameterBatchBenchmarkSettings& settings = ParameterBatchBenchmarkSettings());
+};
@@ -0,0 +1,160 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SessionScalingBenchmark.cpp
+/// @author JDSherbert
+
+#include "SessionScalingBenchmark.h"
+
+#include "../../AudioEngine.h"
+#include "Stopwatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    // Voices are spread around the listener inside a square of this size
+    const float WORLD_SIZE = 40.0f;
+
+    struct SessionTiming
+    {
+        double wallSeconds = 0.0;
+        double audioSeconds = 0.0;
+        std::vector<float> updateMS;
+    };
+
+    void RunSession(const SessionScalingBenchmarkSettings& settings, const AudioEngineSettings& engineSettings, int session,
+                    std::atomic<int>& sessionsReady, const std::atomic<bool>& start, SessionTiming& timing)
+    {
+        AudioEngine engine;
+        engine.Init(engineSettings);
+        const bool initialized = engine.IsReady();
+        std::vector<AudioData> sounds = settings.sounds;
+        if (initialized)
+        {
+            for (AudioData& sound : sounds)
+                engine.Load(sound);
+        }
+
+        sessionsReady.fetch_add(1);
+        while (!start.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        if (!initialized)
+            return;
+
+        // Each Update() mixes one block
+        const double blockSeconds = engine.GetLatencyReport().blockMS / 1000.0;
+        timing.updateMS.reserve(settings.updates);
+
+        Stopwatch stopwatch;
+        unsigned int nextVoice = session;
+        for (int update = 0; update < settings.updates; ++update)
+        {
+            if (!sounds.empty() && update % 16 == 0)
+            {
+                // Retrigger one-shots which have finished, keeping the voice count steady
+                for (int voice = engine.GetStats().channelsPlaying; voice < settings.voicesPerSession; ++voice, ++nextVoice)
+                {
+                    AudioData& sound = sounds[nextVoice % sounds.size()];
+                    const float angle = nextVoice * 2.39996f; // golden angle, so voices don't bunch up
+                    sound.SetPosition(Vector3(0.5f * WORLD_SIZE * cosf(angle), 0.0f, 0.5f * WORLD_SIZE * sinf(angle)));
+                    engine.Play(sound);
+                }
+            }
+
+            Stopwatch updateStopwatch;
+            engine.Update();
+            timing.updateMS.push_back(updateStopwatch.ElapsedMS());
+        }
+        timing.wallSeconds = stopwatch.ElapsedMS() / 1000.0;
+        timing.audioSeconds = settings.updates * blockSeconds;
+
+        engine.Terminate();
+    }
+
+    SessionScalingStep RunStep(const SessionScalingBenchmarkSettings& settings, const AudioEngineSettings& engineSettings, int sessions)
+    {
+        std::vector<SessionTiming> timings(sessions);
+        std::vector<std::thread> threads;
+        std::atomic<int> sessionsReady(0);
+        std::atomic<bool> start(false);
+        for (int session = 0; session < sessions; ++session)
+        {
+            threads.emplace_back(&RunSession, std::cref(settings), std::cref(engineSettings), session,
+                                 std::ref(sessionsReady), std::cref(start), std::ref(timings[session]));
+        }
+
+        // Sessions start mixing together, after every engine has finished its Init()
+        while (sessionsReady.load() < sessions)
+            std::this_thread::yield();
+        start.store(true, std::memory_order_release);
+        for (std::thread& thread : threads)
+            thread.join();
+
+        SessionScalingStep step;
+        step.sessions = sessions;
+        step.slowestRealTimeFactor = -1.0f;
+        std::vector<float> updateMS;
+        for (const SessionTiming& timing : timings)
+        {
+            if (timing.wallSeconds <= 0.0)
+                continue;
+            const float factor = static_cast<float>(timing.audioSeconds / timing.wallSeconds);
+            step.totalRealTimeFactor += factor;
+            if (step.slowestRealTimeFactor < 0.0f || factor < step.slowestRealTimeFactor)
+                step.slowestRealTimeFactor = factor;
+            updateMS.insert(updateMS.end(), timing.updateMS.begin(), timing.updateMS.end());
+        }
+        step.slowestRealTimeFactor = std::max(step.slowestRealTimeFactor, 0.0f);
+
+        const unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+        step.sessionsPerCore = step.totalRealTimeFactor / std::min(static_cast<unsigned int>(sessions), cores);
+        if (!updateMS.empty())
+        {
+            std::sort(updateMS.begin(), updateMS.end());
+            step.p99UpdateMS = updateMS[static_cast<size_t>(0.99 * (updateMS.size() - 1))];
+        }
+        return step;
+    }
+}
+
+SessionScalingBenchmarkResult SessionScalingBenchmark::Run(const SessionScalingBenchmarkSettings& settings)
+{
+    SessionScalingBenchmarkResult result;
+    if (settings.updates <= 0 || settings.maxSessions <= 0)
+        return result;
+
+    AudioEngineSettings engineSettings = settings.engine;
+    engineSettings.outputType = FMOD_OUTPUTTYPE_NOSOUND_NRT;
+    engineSettings.sharedMemoryOutput = nullptr;
+
+    // Engines already running in this process count against FMOD's limit
+    const int maxSessions = std::min(settings.maxSessions, AudioEngine::MAX_INSTANCES - AudioEngine::GetInstanceCount());
+    std::cout << "Session Scaling Benchmark: up to " << maxSessions << " sessions, " << settings.voicesPerSession << " voices and "
+              << settings.updates << " blocks each, " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    // 1, 2, 4... sessions, ending on maxSessions
+    int sessions = 1;
+    while (sessions <= maxSessions)
+    {
+        SessionScalingStep step = RunStep(settings, engineSettings, sessions);
+        if (!result.steps.empty() && result.steps.front().totalRealTimeFactor > 0.0f)
+            step.efficiencyPercent = 100.0f * step.totalRealTimeFactor / (sessions * result.steps.front().totalRealTimeFactor);
+        else
+            step.efficiencyPercent = 100.0f;
+        result.steps.push_back(step);
+
+        std::cout << "  " << std::setw(2) << sessions << " sessions  slowest " << step.slowestRealTimeFactor
+                  << "x  total " << step.totalRealTimeFactor << "x real time  " << step.sessionsPerCore
+                  << " sessions/core  efficiency " << step.efficiencyPercent << "%  update p99 " << step.p99UpdateMS << " ms\n";
+
+        if (sessions == maxSessions)
+            break;
+        sessions = std::min(sessions * 2, maxSessions);
+    }
+    return result;
+}
@@ -0,0 +1,75 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SessionScalingBenchmark.h
+///
+/// Measures how many game sessions a rendering server can mix per CPU core. Runs 1, 2, 4...
+/// AudioEngines at once, each on its own thread with non-realtime output (one mixer block per
+/// Update(), as fast as the CPU allows) and a fixed number of voices, and reports how much
+/// audio each session renders per second of wall-clock time. A real-time session needs a
+/// factor of at least 1, so the summed factor over the cores in use is the sessions a core
+/// can sustain. Falling efficiency as sessions are added shows contention between engines,
+/// e.g. on the shared allocator or memory bandwidth.
+///
+/// FMOD allows AudioEngine::MAX_INSTANCES systems per process; more sessions than that need
+/// more processes, e.g. each handing its mix out through SharedMemoryOutput.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core
+
+#include <vector>
+
+#include "../Data/AudioData.h"
+#include "../Data/AudioEngineSettings.h"
+
+struct SessionScalingBenchmarkSettings
+{
+    // Engine settings for every session; the output type is forced to FMOD_OUTPUTTYPE_NOSOUND_NRT
+    AudioEngineSettings engine;
+
+    // Sounds each session loads; voices are played from them round robin and retriggered as they end
+    std::vector<AudioData> sounds;
+
+    // Voices each session keeps playing
+    int voicesPerSession = 32;
+
+    // Mixer blocks each session renders per step
+    int updates = 2000;
+
+    // Largest number of sessions to run, capped at AudioEngine::MAX_INSTANCES
+    int maxSessions = 8;
+};
+
+struct SessionScalingStep
+{
+    int sessions = 0;
+
+    // Seconds of audio rendered per wall-clock second, by the slowest session and by all of them together
+    float slowestRealTimeFactor = 0.0f;
+    float totalRealTimeFactor = 0.0f;
+
+    // Real-time sessions one core sustains at this load
+    float sessionsPerCore = 0.0f;
+
+    // Total factor against that many single sessions running alone, in percent
+    float efficiencyPercent = 0.0f;
+
+    // 99th percentile Update() time over all sessions
+    float p99UpdateMS = 0.0f;
+};
+
+struct SessionScalingBenchmarkResult
+{
+    std::vector<SessionScalingStep> steps;
+};
+
+class SessionScalingBenchmark
+{
+public:
+
+    /**
+     * Runs each step and prints its throughput and efficiency.
+     */
+    static SessionScalingBenchmarkResult Run(const SessionScalingBenchmarkSettings& settings);
+};
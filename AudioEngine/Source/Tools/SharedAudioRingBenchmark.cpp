@@ -0,0 +1,142 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SharedAudioRingBenchmark.cpp
+/// @author JDSherbert
+
+#include "SharedAudioRingBenchmark.h"
+
+#include "../Output/SharedAudioRing.h"
+#include "Stopwatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Every sample encodes its frame and channel, small enough to stay exact as a float
+    float ExpectedSample(unsigned long long frame, int channel, int channels)
+    {
+        return static_cast<float>((frame * channels + channel) & 0xFFFFF);
+    }
+}
+
+SharedAudioRingBenchmarkResult SharedAudioRingBenchmark::Run(const SharedAudioRingBenchmarkSettings& settings)
+{
+    SharedAudioRingBenchmarkResult result;
+    if (settings.blocks <= 0 || settings.readFrames == 0)
+        return result;
+
+    SharedAudioRing producer;
+    SharedAudioRing consumer;
+    if (!producer.Create(settings.name, settings.sampleRate, settings.channels, settings.blockFrames, settings.ringBlocks)
+        || !consumer.Open(settings.name))
+    {
+        std::cout << "Shared Audio Ring Benchmark: Could not set up the ring\n";
+        return result;
+    }
+
+    // Written by the producer before each commit, so the ring's release/acquire publishes them too
+    std::vector<Clock::time_point> commitTimes(settings.blocks);
+    std::atomic<bool> abort(false);
+
+    std::thread producerThread([&]()
+    {
+        unsigned long long frame = 0;
+        for (int block = 0; block < settings.blocks && !abort.load(std::memory_order_relaxed); ++block)
+        {
+            float* samples;
+            while (!(samples = producer.AcquireBlock()))
+            {
+                if (abort.load(std::memory_order_relaxed))
+                    return;
+                std::this_thread::yield();
+            }
+
+            for (unsigned int i = 0; i < settings.blockFrames; ++i, ++frame)
+            {
+                for (int channel = 0; channel < settings.channels; ++channel)
+                    samples[i * settings.channels + channel] = ExpectedSample(frame, channel, settings.channels);
+            }
+            commitTimes[block] = Clock::now();
+            producer.CommitBlock();
+        }
+    });
+
+    const unsigned long long totalFrames = static_cast<unsigned long long>(settings.blocks) * settings.blockFrames;
+    std::vector<float> buffer(settings.readFrames * settings.channels);
+    std::vector<float> latencies;
+    latencies.reserve(settings.blocks);
+
+    Stopwatch stopwatch;
+    const Clock::time_point start = Clock::now();
+    unsigned long long framesRead = 0;
+    while (framesRead < totalFrames)
+    {
+        if (settings.realTime)
+        {
+            const long long due = 1000000LL * static_cast<long long>(framesRead) / settings.sampleRate;
+            std::this_thread::sleep_until(start + std::chrono::microseconds(due));
+        }
+
+        const uint32_t frames = consumer.Read(buffer.data(), settings.readFrames);
+        if (frames == 0)
+        {
+            if (stopwatch.ElapsedMS() > 60000.0f)
+            {
+                std::cout << "Shared Audio Ring Benchmark: Producer stalled\n";
+                abort.store(true);
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        const Clock::time_point now = Clock::now();
+        for (uint32_t i = 0; i < frames; ++i)
+        {
+            for (int channel = 0; channel < settings.channels; ++channel)
+            {
+                if (buffer[i * settings.channels + channel] != ExpectedSample(framesRead + i, channel, settings.channels))
+                    ++result.corruptSamples;
+            }
+        }
+
+        // Every block whose last frame arrived in this read
+        const unsigned long long firstBlock = framesRead / settings.blockFrames;
+        framesRead += frames;
+        const unsigned long long endBlock = framesRead / settings.blockFrames;
+        for (unsigned long long block = firstBlock; block < endBlock; ++block)
+            latencies.push_back(std::chrono::duration<float, std::micro>(now - commitTimes[block]).count());
+    }
+    const float seconds = stopwatch.ElapsedMS() / 1000.0f;
+    producerThread.join();
+
+    result.completed = framesRead == totalFrames;
+    if (seconds > 0.0f)
+    {
+        result.realTimeFactor = framesRead / (seconds * settings.sampleRate);
+        result.megabytesPerSecond = framesRead * settings.channels * sizeof(float) / (seconds * 1024.0f * 1024.0f);
+    }
+    if (!latencies.empty())
+    {
+        std::sort(latencies.begin(), latencies.end());
+        result.p50LatencyMicroseconds = latencies[latencies.size() / 2];
+        result.p99LatencyMicroseconds = latencies[static_cast<size_t>(0.99 * (latencies.size() - 1))];
+        result.maxLatencyMicroseconds = latencies.back();
+    }
+
+    std::cout << "Shared Audio Ring Benchmark: " << settings.blocks << " blocks of " << settings.blockFrames << " frames, "
+              << settings.channels << " channels at " << settings.sampleRate << " Hz, " << settings.ringBlocks
+              << " block ring, " << settings.readFrames << " frame reads" << (settings.realTime ? ", real time" : "") << '\n'
+              << "  throughput   " << result.realTimeFactor << "x real time, " << result.megabytesPerSecond << " MB/s\n"
+              << "  latency      p50 " << result.p50LatencyMicroseconds << " us  p99 " << result.p99LatencyMicroseconds
+              << " us  max " << result.maxLatencyMicroseconds << " us\n"
+              << "  corrupt      " << result.corruptSamples << " samples\n";
+    return result;
+}
@@ -0,0 +1,58 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SharedAudioRingBenchmark.h
+///
+/// Measures how fast mixed audio moves through a SharedAudioRing and how long a block waits
+/// between being written and being read. A producer thread stands in for SharedMemoryOutput
+/// and the calling thread for the consumer process; both ends map the ring through the
+/// operating system's shared memory, as two processes would. Needs no audio device or FMOD.
+///
+/// @author JDSherbert
+
+struct SharedAudioRingBenchmarkSettings
+{
+    const char* name = "AudioEngineRingBenchmark";
+
+    int sampleRate = 48000;
+    int channels = 2;
+    unsigned int blockFrames = 512;
+    unsigned int ringBlocks = 8;
+
+    // Frames the consumer asks for per read, like an encoder taking one codec frame at a time
+    unsigned int readFrames = 960;
+
+    // Blocks pushed through the ring
+    int blocks = 20000;
+
+    // Have the consumer read at the sample rate instead of as fast as it can
+    bool realTime = false;
+};
+
+struct SharedAudioRingBenchmarkResult
+{
+    bool completed = false;
+
+    // Audio moved per second of wall-clock time, as a multiple of real time and in MB/s
+    float realTimeFactor = 0.0f;
+    float megabytesPerSecond = 0.0f;
+
+    // Time from the producer committing a block to the consumer reading its last frame
+    float p50LatencyMicroseconds = 0.0f;
+    float p99LatencyMicroseconds = 0.0f;
+    float maxLatencyMicroseconds = 0.0f;
+
+    // Samples which didn't arrive as written; anything but 0 is a bug in the ring
+    unsigned int corruptSamples = 0;
+};
+
+class SharedAudioRingBenchmark
+{
+public:
+
+    /**
+     * Pushes the blocks through the ring and prints throughput and latency.
+     */
+    static SharedAudioRingBenchmarkResult Run(const SharedAudioRingBenchmarkSettings& settings = SharedAudioRingBenchmarkSettings());
+};
@@ -0,0 +1,262 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SoakTest.cpp
+/// @author JDSherbert
+
+#include "SoakTest.h"
+
+#include "../../AudioEngine.h"
+#include "Stopwatch.h"
+
+#include <FMOD/fmod.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <streambuf>
+
+namespace
+{
+    // Relative frequency of each random engine call
+    enum SoakAction { LOAD, UNLOAD, PLAY, STOP, FADE, MOVE, EVENT, ACTION_COUNT };
+    const int ACTION_WEIGHTS[ACTION_COUNT] = { 10, 3, 30, 15, 15, 20, 7 };
+
+    // Emitters and the listener wander inside a cube of this size
+    const float WORLD_SIZE = 200.0f;
+
+    // Updates run after everything is stopped and unloaded, for FMOD to retire the channels
+    const int SHUTDOWN_UPDATES = 16;
+
+    /**
+     * Stream buffer that discards everything written to it.
+     */
+    class DiscardBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+
+    SoakTestSample TakeSample(AudioEngine& engine, double hours, double updateSum, float updateMax, int updates)
+    {
+        const AudioEngineStats stats = engine.GetStats();
+
+        SoakTestSample sample;
+        sample.hours = hours;
+        FMOD::Memory_GetStats(&sample.memoryBytes, nullptr, false);
+        sample.channelsPlaying = stats.channelsPlaying;
+        sample.meanUpdateMS = updates > 0 ? static_cast<float>(updateSum / updates) : 0.0f;
+        sample.maxUpdateMS = updateMax;
+        sample.mixerP99MS = stats.mixer.p99MS;
+        sample.underruns = stats.mixer.underruns;
+        sample.loadedSounds = stats.loadedSounds;
+        sample.playingLoops = stats.playingLoops;
+        sample.eventInstances = stats.eventInstances;
+        sample.hrtfEmitters = stats.hrtfEmitters;
+        return sample;
+    }
+
+    /**
+     * Returns a description of the first metric which drifted too far from the baseline, or an empty string.
+     */
+    std::string FindDrift(const SoakTestSettings& settings, const SoakTestSample& baseline, const SoakTestSample& sample)
+    {
+        std::ostringstream failure;
+        auto timeDrifted = [&settings](float base, float current)
+        {
+            return current > base * settings.maxTimeGrowthRatio && current - base > settings.minTimeGrowthMS;
+        };
+        auto countDrifted = [&settings](unsigned int base, unsigned int current)
+        {
+            return current > base + static_cast<unsigned int>(settings.maxCountGrowth);
+        };
+
+        if (sample.memoryBytes - baseline.memoryBytes > settings.maxMemoryGrowthBytes)
+            failure << "FMOD memory grew from " << baseline.memoryBytes << " to " << sample.memoryBytes << " bytes";
+        else if (timeDrifted(baseline.meanUpdateMS, sample.meanUpdateMS))
+            failure << "mean Update() time grew from " << baseline.meanUpdateMS << " to " << sample.meanUpdateMS << " ms";
+        else if (timeDrifted(baseline.mixerP99MS, sample.mixerP99MS))
+            failure << "mixer p99 grew from " << baseline.mixerP99MS << " to " << sample.mixerP99MS << " ms";
+        else if (countDrifted(baseline.channelsPlaying, sample.channelsPlaying))
+            failure << "channels playing grew from " << baseline.channelsPlaying << " to " << sample.channelsPlaying;
+        else if (countDrifted(baseline.playingLoops, sample.playingLoops))
+            failure << "playing loops grew from " << baseline.playingLoops << " to " << sample.playingLoops;
+        else if (countDrifted(baseline.eventInstances, sample.eventInstances))
+            failure << "event instances grew from " << baseline.eventInstances << " to " << sample.eventInstances;
+        else if (countDrifted(baseline.hrtfEmitters, sample.hrtfEmitters))
+            failure << "HRTF emitters grew from " << baseline.hrtfEmitters << " to " << sample.hrtfEmitters;
+        return failure.str();
+    }
+
+    void PrintSample(std::ostream& out, const SoakTestSample& sample)
+    {
+        out << "  " << std::fixed << std::setprecision(2) << std::setw(6) << sample.hours << "h"
+            << "  memory " << std::setw(10) << sample.memoryBytes
+            << "  channels " << std::setw(3) << sample.channelsPlaying
+            << "  update " << std::setprecision(3) << sample.meanUpdateMS << "/" << sample.maxUpdateMS << " ms"
+            << "  mixer p99 " << sample.mixerP99MS << " ms"
+            << "  underruns " << sample.underruns
+            << "  sounds " << sample.loadedSounds << "  loops " << sample.playingLoops
+            << "  events " << sample.eventInstances << "  hrtf " << sample.hrtfEmitters << '\n';
+    }
+}
+
+SoakTestResult SoakTest::Run(const SoakTestSettings& settings)
+{
+    SoakTestResult result;
+
+    // Engine messages go nowhere while the test runs; the test reports through the real console
+    DiscardBuffer discard;
+    std::streambuf* console = std::cout.rdbuf();
+    std::ostream out(console);
+    if (settings.silenceEngine)
+        std::cout.rdbuf(&discard);
+
+    AudioEngineSettings engineSettings = settings.engine;
+    engineSettings.outputType = FMOD_OUTPUTTYPE_NOSOUND_NRT;
+    engineSettings.mixerTelemetry = true;
+
+    AudioEngine engine;
+    engine.Init(engineSettings);
+    for (const std::string& bank : settings.bankPaths)
+        engine.LoadBank(bank.c_str());
+    for (const std::string& event : settings.eventNames)
+        engine.LoadEvent(event.c_str());
+
+    // Each Update() mixes one block, which sets how much audio time it stands for
+    const double blockHours = engine.GetStats().mixer.blockBudgetMS / 3.6e6;
+    const long long totalUpdates = static_cast<long long>(settings.durationHours / blockHours);
+    const long long warmupUpdates = static_cast<long long>(settings.warmupMinutes / 60.0 / blockHours);
+    const long long sampleUpdates = std::max(static_cast<long long>(settings.sampleMinutes / 60.0 / blockHours), 1LL);
+
+    out << "Soak Test: " << settings.durationHours << "h of audio, " << settings.sounds.size() << " sounds, "
+        << settings.eventNames.size() << " events, " << totalUpdates << " updates\n";
+
+    std::mt19937 random(settings.seed);
+    std::discrete_distribution<int> pickAction(ACTION_WEIGHTS, ACTION_WEIGHTS + ACTION_COUNT);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<unsigned int> fadeSamples(0, 48000);
+    std::vector<AudioData> sounds = settings.sounds;
+
+    double updateSum = 0.0;
+    float updateMax = 0.0f;
+    int updatesSinceSample = 0;
+    bool hasBaseline = false;
+    for (long long update = 0; update < totalUpdates && result.failure.empty(); ++update)
+    {
+        for (int action = 0; action < settings.actionsPerUpdate && !sounds.empty(); ++action)
+        {
+            AudioData& sound = sounds[random() % sounds.size()];
+            const bool loaded = engine.IsLoaded(sound);
+            const bool playing = loaded && sound.Loop() && engine.IsPlaying(sound);
+            switch (pickAction(random))
+            {
+                case LOAD:
+                    if (!loaded)
+                        engine.Load(sound);
+                    break;
+                case UNLOAD:
+                    if (loaded)
+                        engine.Unload(sound);
+                    break;
+                case PLAY:
+                    if (loaded && !playing)
+                    {
+                        sound.SetPosition(Vector3(unit(random) * WORLD_SIZE, 0.0f, unit(random) * WORLD_SIZE));
+                        engine.Play(sound);
+                    }
+                    break;
+                case STOP:
+                    if (playing)
+                        engine.Stop(sound);
+                    break;
+                case FADE:
+                    if (playing)
+                        engine.UpdateVolume(sound, unit(random), fadeSamples(random));
+                    break;
+                case MOVE:
+                    if (playing && sound.Is3D())
+                    {
+                        sound.SetPosition(Vector3(unit(random) * WORLD_SIZE, 0.0f, unit(random) * WORLD_SIZE));
+                        engine.Update3DPosition(sound);
+                    }
+                    break;
+                case EVENT:
+                    if (!settings.eventNames.empty() && engineSettings.enableStudio)
+                    {
+                        const char* event = settings.eventNames[random() % settings.eventNames.size()].c_str();
+                        if (engine.IsPlaying(event))
+                            engine.StopEvent(event);
+                        else
+                            engine.PlayEvent(event);
+                    }
+                    break;
+            }
+        }
+
+        const float angle = update * 1e-3f;
+        engine.Set3DListenerPosition(0.5f * WORLD_SIZE * (1.0f + cosf(angle)), 0.0f, 0.5f * WORLD_SIZE * (1.0f + sinf(angle)),
+                                     0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f);
+
+        Stopwatch stopwatch;
+        engine.Update();
+        const float updateMS = stopwatch.ElapsedMS();
+        updateSum += updateMS;
+        updateMax = std::max(updateMax, updateMS);
+        ++updatesSinceSample;
+
+        // The baseline is taken at the end of warm-up, then a sample every sampleUpdates
+        const long long measured = update + 1 - warmupUpdates;
+        if (measured < 0 || measured % sampleUpdates != 0)
+            continue;
+
+        result.samples.push_back(TakeSample(engine, (update + 1) * blockHours, updateSum, updateMax, updatesSinceSample));
+        PrintSample(out, result.samples.back());
+        if (hasBaseline)
+            result.failure = FindDrift(settings, result.samples.front(), result.samples.back());
+        hasBaseline = true;
+
+        // Each sample covers its own interval
+        engine.ResetStats();
+        updateSum = 0.0;
+        updateMax = 0.0f;
+        updatesSinceSample = 0;
+    }
+
+    // Everything stopped and unloaded must leave nothing behind
+    if (result.failure.empty())
+    {
+        for (const std::string& event : settings.eventNames)
+        {
+            if (engineSettings.enableStudio)
+                engine.StopEvent(event.c_str());
+        }
+        for (AudioData& sound : sounds)
+        {
+            if (engine.IsLoaded(sound))
+                engine.Unload(sound);
+        }
+        for (int i = 0; i < SHUTDOWN_UPDATES; ++i)
+            engine.Update();
+
+        const AudioEngineStats stats = engine.GetStats();
+        std::ostringstream failure;
+        if (stats.loadedSounds != 0 || stats.playingLoops != 0 || stats.hrtfEmitters != 0)
+            failure << "after unloading everything " << stats.loadedSounds << " sounds, " << stats.playingLoops
+                    << " loops and " << stats.hrtfEmitters << " HRTF emitters remain";
+        else if (stats.channelsPlaying > 0 && settings.eventNames.empty())
+            failure << "after unloading everything " << stats.channelsPlaying << " channels are still playing";
+        result.failure = failure.str();
+    }
+
+    engine.Terminate();
+    std::cout.rdbuf(console);
+
+    result.passed = result.failure.empty();
+    if (result.passed)
+        std::cout << "Soak Test: Passed, " << result.samples.size() << " samples within bounds\n";
+    else
+        std::cout << "Soak Test: Failed, " << result.failure << '\n';
+    return result;
+}
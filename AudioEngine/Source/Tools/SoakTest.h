@@ -0,0 +1,91 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SoakTest.h
+///
+/// Long-running stress test for memory creep and slowdown that only show after hours of uptime.
+/// Drives its own AudioEngine with non-realtime output (no device, one mixer block per Update(),
+/// so simulated hours pass in minutes) through random load / unload / play / stop / fade / move
+/// and event calls. FMOD memory, channel counts, Update() time, mixer time and the engine's
+/// container sizes are sampled periodically and compared against a baseline taken after warm-up;
+/// the test fails as soon as one drifts beyond its bound.
+///
+/// @author JDSherbert
+/// @dependencies FMOD Core, FMOD Studio
+
+#include <string>
+#include <vector>
+
+#include "../Data/AudioData.h"
+#include "../Data/AudioEngineSettings.h"
+
+struct SoakTestSettings
+{
+    // Engine settings; the output type is forced to FMOD_OUTPUTTYPE_NOSOUND_NRT and mixer telemetry on
+    AudioEngineSettings engine;
+
+    // Sounds the test loads, plays and unloads at random. Loops are stopped, faded and moved.
+    std::vector<AudioData> sounds;
+
+    // Studio banks to load and events to play and stop at random, if Studio is enabled
+    std::vector<std::string> bankPaths;
+    std::vector<std::string> eventNames;
+
+    // Simulated audio time to run for, and how often to sample the metrics
+    double durationHours = 4.0;
+    double sampleMinutes = 5.0;
+
+    // Simulated time before the baseline sample is taken, letting pools and caches fill
+    double warmupMinutes = 10.0;
+
+    // Random engine calls made per Update()
+    int actionsPerUpdate = 2;
+    unsigned int seed = 1;
+
+    // Bounds on drift from the baseline sample
+    int maxMemoryGrowthBytes = 4 * 1024 * 1024;
+    float maxTimeGrowthRatio = 1.5f;        // mean Update() time and mixer p99, against the baseline
+    float minTimeGrowthMS = 0.1f;           // time growth smaller than this is never a failure
+    int maxCountGrowth = 16;                // channels and container sizes
+
+    // Discard the engine's console messages while the test runs, keeping only the test's own
+    bool silenceEngine = true;
+};
+
+struct SoakTestSample
+{
+    double hours = 0.0;
+    int memoryBytes = 0;
+    int channelsPlaying = 0;
+    float meanUpdateMS = 0.0f;
+    float maxUpdateMS = 0.0f;
+    float mixerP99MS = 0.0f;
+    unsigned int underruns = 0;
+    unsigned int loadedSounds = 0;
+    unsigned int playingLoops = 0;
+    unsigned int eventInstances = 0;
+    unsigned int hrtfEmitters = 0;
+};
+
+struct SoakTestResult
+{
+    bool passed = false;
+
+    // Which metric drifted, or what was left behind after shutdown, if the test failed
+    std::string failure;
+
+    // Every sample taken, the baseline first
+    std::vector<SoakTestSample> samples;
+};
+
+class SoakTest
+{
+public:
+
+    /**
+     * Runs the soak test, printing each sample as it is taken, and a verdict.
+     * Takes about durationHours of simulated audio, usually far less wall-clock time.
+     */
+    static SoakTestResult Run(const SoakTestSettings& settings);
+};
@@ -0,0 +1,201 @@
+// ©2023 JDSherbert. All rights reserved.
+
+/// @file SoundIdGenerator.cpp
+/// @author JDSherbert
+
+#include "SoundIdGenerator.h"
+
+#include "Json.h"
+#include "../Data/SoundId.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    struct GeneratedId
+    {
+        std::string name;
+        std::string identifier;
+        SoundId id;
+    };
+
+    std::string ReadFile(const char* filePath)
+    {
+        std::ifstream file(filePath, std::ios::binary);
+        std::stringstream contents;
+        if (file)
+            contents << file.rdbuf();
+        return contents.str();
+    }
+
+    /**
+     * Returns why an identifier can't be declared in the generated header, or nullptr if it can.
+     * Catches keywords, names the header itself declares or uses unqualified, and names the
+     * standard reserves for the implementation.
+     */
+    const char* GetIdentifierConflict(const std::string& identifier)
+    {
+        static const char* const KEYWORDS[] =
+        {
+            "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+            "case", "catch", "char", "char16_t", "char32_t", "char8_t", "class", "co_await", "co_return",
+            "co_yield", "compl", "concept", "const", "const_cast", "consteval", "constexpr", "constinit",
+            "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum",
+            "explicit", "export", "extern", "false", "float", "for", "friend", "goto", "if", "inline",
+            "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq", "nullptr",
+            "operator", "or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+            "requires", "return", "short", "signed", "sizeof", "static", "static_assert", "static_cast",
+            "struct", "switch", "template", "this", "thread_local", "throw", "true", "try", "typedef",
+            "typeid", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "wchar_t",
+            "while", "xor", "xor_eq"
+        };
+        for (const char* keyword : KEYWORDS)
+        {
+            if (identifier == keyword)
+                return "a C++ keyword";
+        }
+
+        if (identifier == "ALL" || identifier == "SoundId" || identifier == "AreSoundIdsSortedUnique")
+            return "a name the generated header uses";
+
+        if (identifier.find("__") != std::string::npos
+            || (identifier[0] == '_' && std::isupper(static_cast<unsigned char>(identifier[1]))))
+            return "reserved for the C++ implementation";
+
+        return nullptr;
+    }
+
+    /** Escapes a name for use inside a C++ string literal */
+    std::string EscapeLiteral(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+}
+
+bool SoundIdGenerator::GenerateHeader(const char* manifestPath, const char* headerPath,
+                                      const char* namespaceName, const char* soundIdInclude)
+{
+    JsonValue manifest;
+    std::string error;
+    if (!JsonValue::ParseFile(manifestPath, manifest, error))
+    {
+        std::cout << "SoundIdGenerator: Failed to parse " << manifestPath << ": " << error << '\n';
+        return false;
+    }
+
+    const JsonValue& sounds = manifest["sounds"];
+    if (!sounds.IsArray())
+    {
+        std::cout << "SoundIdGenerator: " << manifestPath << " has no \"sounds\" array\n";
+        return false;
+    }
+
+    std::vector<GeneratedId> ids;
+    std::map<uint64_t, std::string> namesByHash;
+    std::map<std::string, std::string> namesByIdentifier;
+    bool valid = true;
+
+    for (const JsonValue& sound : sounds.GetElements())
+    {
+        const std::string& name = sound["id"].AsString();
+        if (name.empty())
+        {
+            std::cout << "SoundIdGenerator: Sound entry without an \"id\" in " << manifestPath << '\n';
+            valid = false;
+            continue;
+        }
+
+        GeneratedId generated = { name, ToIdentifier(name), SoundId::FromName(name.c_str()) };
+
+        const char* conflict = GetIdentifierConflict(generated.identifier);
+        if (conflict)
+        {
+            std::cout << "SoundIdGenerator: \"" << name << "\" maps to the identifier " << generated.identifier
+                      << ", which is " << conflict << "; rename it in " << manifestPath << '\n';
+            valid = false;
+            continue;
+        }
+
+        auto hashed = namesByHash.insert({ generated.id.value, name });
+        if (!hashed.second)
+        {
+            std::cout << "SoundIdGenerator: ID collision between \"" << hashed.first->second
+                      << "\" and \"" << name << "\" (" << generated.id << ")\n";
+            valid = false;
+            continue;
+        }
+
+        auto named = namesByIdentifier.insert({ generated.identifier, name });
+        if (!named.second)
+        {
+            std::cout << "SoundIdGenerator: \"" << named.first->second << "\" and \"" << name
+                      << "\" both map to the identifier " << generated.identifier << "; rename one in " << manifestPath << '\n';
+            valid = false;
+            continue;
+        }
+
+        ids.push_back(generated);
+    }
+
+    if (!valid)
+        return false;
+
+    std::sort(ids.begin(), ids.end(), [](const GeneratedId& a, const GeneratedId& b) { return a.id < b.id; });
+
+    std::ostringstream header;
+    header << "// Generated by SoundIdGenerator from " << manifestPath << ". Do not edit.\n\n"
+           << "#pragma once\n\n"
+           << "#include \"" << soundIdInclude << "\"\n\n"
+           << "namespace " << namespaceName << "\n{\n";
+
+    for (const GeneratedId& generated : ids)
+        header << "    constexpr SoundId " << generated.identifier << " = SoundId::FromName(\"" << EscapeLiteral(generated.name) << "\");\n";
+
+    header << "\n    // Every ID in hash order, checked for collisions when this header is compiled\n"
+           << "    constexpr SoundId ALL[] =\n    {\n";
+    for (const GeneratedId& generated : ids)
+        header << "        " << generated.identifier << ",\n";
+    if (ids.empty())
+        header << "        SoundId(),\n";
+    header << "    };\n\n"
+           << "    static_assert(AreSoundIdsSortedUnique(ALL), \"Sound ID hash collision, regenerate this header\");\n"
+           << "}\n";
+
+    const std::string contents = header.str();
+    if (ReadFile(headerPath) == contents)
+        return true;
+
+    std::ofstream output(headerPath, std::ios::binary);
+    if (!output)
+    {
+        std::cout << "SoundIdGenerator: Could not write " << headerPath << '\n';
+        return false;
+    }
+    output << contents;
+
+    std::cout << "SoundIdGenerator: Wrote " << ids.size() << " sound IDs to " << headerPath << '\n';
+    return true;
+}
+
+std::string SoundIdGenerator::ToIdentifier(const std::string& name)
+{
+    std::string identifier;
+    for (char c : name)
+        identifier += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    if (identifier.empty() || std::isdigit(static_cast<unsigned char>(identifier[0])))
+        identifier.insert(0, "Sound_");
+    return identifier;
+}
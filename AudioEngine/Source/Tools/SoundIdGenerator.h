@@ -0,0 +1,40 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SoundIdGenerator.h
+///
+/// Build step which turns the JSON asset manifest into a header of constexpr SoundId constants.
+///
+/// The manifest lists every sound under "sounds", each with a unique "id":
+///     { "sounds": [ { "id": "Footstep_Grass_01", "path": "Audio/footstep_grass_01.wav" } ] }
+///
+/// @author JDSherbert
+
+#include <string>
+
+class SoundIdGenerator
+{
+public:
+
+    /**
+     * Writes a header declaring one constexpr SoundId per manifest entry, plus a sorted ALL array
+     * guarded by a static_assert, so a hash collision fails both this step and the compile.
+     * The header is only rewritten when its contents change, to avoid needless rebuilds.
+     * @param manifestPath - JSON asset manifest
+     * @param headerPath - header to generate
+     * @param namespaceName - namespace the constants are declared in
+     * @param soundIdInclude - include path of SoundId.h as seen from the generated header
+     * @return false, after printing the reason, if the manifest is invalid, two IDs or identifiers
+     * collide, or a name maps to a C++ keyword or an identifier the header can't declare
+     */
+    static bool GenerateHeader(const char* manifestPath, const char* headerPath,
+                               const char* namespaceName = "SoundIds",
+                               const char* soundIdInclude = "Source/Data/SoundId.h");
+
+    /**
+     * Converts a sound name to a valid C++ identifier by replacing other characters with '_'.
+     * Names starting with a digit are prefixed with "Sound_".
+     */
+    static std::string ToIdentifier(const std::string& name);
+};
@@ -0,0 +1,62 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file SpscRing.h
+///
+/// Fixed-capacity lock-free queue between exactly one producer thread and one consumer thread,
+/// e.g. the mixer thread handing measurements to the game thread. Never allocates or blocks,
+/// so it is safe to push from FMOD callbacks.
+///
+/// @author JDSherbert
+
+#include <atomic>
+#include <cstddef>
+
+template <typename T, size_t CAPACITY>
+class SpscRing
+{
+public:
+
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SpscRing capacity must be a power of two");
+
+    SpscRing() : head(0), tail(0) {}
+
+    /**
+     * Appends an item. Producer thread only.
+     * @return false if the ring is full, in which case the item is dropped
+     */
+    bool TryPush(const T& item)
+    {
+        const size_t write = tail.load(std::memory_order_relaxed);
+        if (write - head.load(std::memory_order_acquire) == CAPACITY)
+            return false;
+
+        items[write & (CAPACITY - 1)] = item;
+        tail.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest item. Consumer thread only.
+     * @return false if the ring is empty
+     */
+    bool TryPop(T& item)
+    {
+        const size_t read = head.load(std::memory_order_relaxed);
+        if (read == tail.load(std::memory_order_acquire))
+            return false;
+
+        item = items[read & (CAPACITY - 1)];
+        head.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+
+    T items[CAPACITY];
+
+    // Kept on separate cache lines so the two threads don't contend over them
+    alignas(64) std::atomic<size_t> head;   // next item to read, written by the consumer
+    alignas(64) std::atomic<size_t> tail;   // next slot to write, written by the producer
+};
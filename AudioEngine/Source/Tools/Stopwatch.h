@@ -0,0 +1,52 @@
+// ©2023 JDSherbert. All rights reserved.
+
+#pragma once
+
+/// @file Stopwatch.h
+/// @author JDSherbert
+
+#include <chrono>
+
+/**
+ * Wall-clock timer used to measure engine phases such as startup.
+ */
+class Stopwatch
+{
+public:
+
+    Stopwatch() : start(Clock::now()), lap(start) {}
+
+    /** Restarts the total and lap timers */
+    void Restart()
+    {
+        start = Clock::now();
+        lap = start;
+    }
+
+    /** Milliseconds since construction or the last Restart() */
+    float ElapsedMS() const
+    {
+        return ToMS(Clock::now() - start);
+    }
+
+    /** Milliseconds since the previous Lap() and starts timing the next one */
+    float Lap()
+    {
+        const Clock::time_point now = Clock::now();
+        const float elapsed = ToMS(now - lap);
+        lap = now;
+        return elapsed;
+    }
+
+private:
+
+    using Clock = std::chrono::steady_clock;
+
+    static float ToMS(Clock::duration duration)
+    {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    }
+
+    Clock::time_point start;
+    Clock::time_point lap;
+};